@@ -0,0 +1,398 @@
+/** ========================================================================= *
+ *
+ * @file ra02_microbench.c
+ * @date 17-10-2026
+ * @author Maksym Tkachuk <max.r.tkachuk@gmail.com>
+ *
+ * @brief Microbenchmarks of driver internals against emulated (or real) radio
+ *
+ * Driver translation unit is included directly, so private hot path
+ * functions (register access, FIFO load & drain) are measured as they are,
+ * without widening public API. SPI transactions are counted by a shim in
+ * front of the SPI transfer function.
+ *
+ * Every benchmark prints one JSON line:
+ * {"name":..., "ops":..., "p50_ns":..., "p90_ns":..., "p99_ns":..., "spi_per_op":...}
+ * With baseline file (output of previous run), p50 regressions above
+ * threshold and any increase of SPI transactions per op fail the run
+ *
+ *  ========================================================================= */
+
+/* Includes ================================================================= */
+#include "../src/ra02.c"
+#include <ra02_emu.h>
+#include <getopt.h>
+#include <fcntl.h>
+
+/* Defines ================================================================== */
+#undef LOG_TAG
+#define LOG_TAG MICROBENCH
+
+/** Default iterations of cheap operations */
+#define MICROBENCH_DEFAULT_OPS          2000
+
+/** Default allowed p50 regression against baseline, percent */
+#define MICROBENCH_DEFAULT_THRESHOLD    20
+
+/** Registers accessed per op in single vs burst benchmarks */
+#define MICROBENCH_REG_SPAN             8
+
+/** Longest benchmark name */
+#define MICROBENCH_NAME_SIZE            32
+
+/** Max benchmarks in baseline */
+#define MICROBENCH_MAX_RESULTS          32
+
+/* Macros =================================================================== */
+/* Exposed macros =========================================================== */
+/* Enums ==================================================================== */
+/* Types ==================================================================== */
+/**
+ * Counting shim in front of SPI transfer
+ */
+typedef struct {
+  spi_transfer_fn_t transfer;  /** Original transfer, NULL - spidev */
+  void *            ctx;
+  spi_t             device;    /** Original SPI handle, when spidev is used */
+  uint64_t          count;
+} microbench_spi_t;
+
+/**
+ * Benchmark result
+ */
+typedef struct {
+  char     name[MICROBENCH_NAME_SIZE];
+  uint32_t ops;
+  uint64_t p50_ns;
+  uint64_t p90_ns;
+  uint64_t p99_ns;
+  double   spi_per_op;
+} microbench_result_t;
+
+/**
+ * Benchmark environment
+ */
+typedef struct {
+  microbench_spi_t    shim;
+  spi_t               spi;
+  ra02_emu_air_t      air;
+  ra02_emu_t          emu;
+  bool                emulated;
+  ra02_t              ra02;
+  uint32_t            ops;
+  uint64_t *          samples;
+  const char *        filter;
+  microbench_result_t results[MICROBENCH_MAX_RESULTS];
+  size_t              count;
+} microbench_t;
+
+/**
+ * Operation under test, returns error of the operation
+ */
+typedef error_t (*microbench_fn_t)(microbench_t * mb, void * arg);
+
+/* Variables ================================================================ */
+/* Private functions ======================================================== */
+static error_t microbench_spi_transfer(void * ctx, uint8_t * tx_buf, uint8_t * rx_buf, size_t size) {
+  microbench_spi_t * shim = ctx;
+
+  shim->count++;
+
+  if (shim->transfer) {
+    return shim->transfer(shim->ctx, tx_buf, rx_buf, size);
+  }
+
+  return spi_transcieve(&shim->device, tx_buf, rx_buf, size);
+}
+
+static int microbench_compare_u64(const void * a, const void * b) {
+  uint64_t x = *(const uint64_t *) a;
+  uint64_t y = *(const uint64_t *) b;
+  return (x > y) - (x < y);
+}
+
+/**
+ * Run op given number of times, record per-op time & SPI traffic
+ */
+static error_t microbench_run(microbench_t * mb, const char * name, uint32_t ops, microbench_fn_t fn, void * arg) {
+  if (mb->filter && !strstr(name, mb->filter)) {
+    return E_OK;
+  }
+
+  ASSERT_RETURN(mb->count < MICROBENCH_MAX_RESULTS, E_OVERFLOW);
+
+  /* Warm up caches & emulator state */
+  ERROR_CHECK_RETURN(fn(mb, arg));
+
+  uint64_t spi_start = mb->shim.count;
+
+  for (uint32_t i = 0; i < ops; ++i) {
+    uint64_t start = timeout_now_ns();
+    error_t err = fn(mb, arg);
+    mb->samples[i] = timeout_now_ns() - start;
+
+    ERROR_CHECK_RETURN(err);
+  }
+
+  microbench_result_t * result = &mb->results[mb->count++];
+
+  qsort(mb->samples, ops, sizeof(uint64_t), microbench_compare_u64);
+
+  snprintf(result->name, sizeof(result->name), "%s", name);
+  result->ops = ops;
+  result->p50_ns = mb->samples[ops / 2];
+  result->p90_ns = mb->samples[ops * 90 / 100];
+  result->p99_ns = mb->samples[ops * 99 / 100];
+  result->spi_per_op = (double) (mb->shim.count - spi_start) / ops;
+
+  printf("{\"name\":\"%s\",\"ops\":%u,\"p50_ns\":%llu,\"p90_ns\":%llu,\"p99_ns\":%llu,\"spi_per_op\":%.2f}\n",
+         result->name, result->ops, (unsigned long long) result->p50_ns, (unsigned long long) result->p90_ns,
+         (unsigned long long) result->p99_ns, result->spi_per_op);
+  fflush(stdout);
+
+  return E_OK;
+}
+
+static error_t microbench_spi(microbench_t * mb, void * arg) {
+  uint8_t tx[2] = {RA02_REG_VERSION & 0x7F, 0};
+  uint8_t rx[2];
+
+  return spi_transcieve(mb->ra02.spi, tx, rx, sizeof(tx));
+}
+
+static error_t microbench_reg_single(microbench_t * mb, void * arg) {
+  uint8_t value;
+
+  for (uint8_t i = 0; i < MICROBENCH_REG_SPAN; ++i) {
+    ERROR_CHECK_RETURN(ra02_read_reg(&mb->ra02, RA02_REG_OP_MODE + i, &value));
+  }
+
+  return E_OK;
+}
+
+static error_t microbench_reg_burst(microbench_t * mb, void * arg) {
+  uint8_t values[MICROBENCH_REG_SPAN];
+
+  return ra02_read_burst(&mb->ra02, RA02_REG_OP_MODE, values, sizeof(values));
+}
+
+static error_t microbench_poll_irq_flags(microbench_t * mb, void * arg) {
+  return ra02_poll_irq_flags(&mb->ra02);
+}
+
+static error_t microbench_fifo_load(microbench_t * mb, void * arg) {
+  uint8_t buf[RA02_MAX_PACKET_SIZE] = {0};
+
+  return ra02_lora_tx_prepare(&mb->ra02, buf, (size_t) arg);
+}
+
+static error_t microbench_fifo_drain(microbench_t * mb, void * arg) {
+  uint8_t buf[RA02_MAX_PACKET_SIZE];
+  size_t size = sizeof(buf);
+
+  /* Pretend a frame of given size has just been received */
+  if (mb->emulated) {
+    mb->emu.regs[RA02_LORA_REG_RX_NB_BYTES] = (size_t) arg;
+    mb->emu.regs[RA02_LORA_REG_FIFO_RX_CURRENT_ADDR] = 0;
+  }
+
+  mb->ra02.irq_flags = RA02_LORA_IRQ_FLAGS_RX_DONE;
+
+  return ra02_lora_read_packet(&mb->ra02, buf, &size);
+}
+
+static error_t microbench_init(microbench_t * mb, void * arg) {
+  /* Handle is re-initialized, so release what previous init allocated */
+  ra02_deinit(&mb->ra02);
+  return ra02_init(&mb->ra02, &(ra02_cfg_t) {.spi = &mb->spi});
+}
+
+static error_t microbench_log_on(microbench_t * mb, void * arg) {
+  log_module_fmt(LOG_DEBUG, "MICROBENCH", "poll: irq=0x%02x size=%d", mb->ra02.irq_flags, 64);
+  return E_OK;
+}
+
+static error_t microbench_log_off(microbench_t * mb, void * arg) {
+  log_debug("poll: irq=0x%02x size=%d", mb->ra02.irq_flags, 64);
+  return E_OK;
+}
+
+/**
+ * Log lines go to stdout, which carries results, so it's pointed to /dev/null meanwhile
+ */
+static error_t microbench_run_muted(microbench_t * mb, const char * name, uint32_t ops, microbench_fn_t fn) {
+  fflush(stdout);
+
+  int saved = dup(STDOUT_FILENO);
+  int null = open("/dev/null", O_WRONLY);
+
+  ASSERT_RETURN(saved >= 0 && null >= 0, E_FAILED);
+
+  dup2(null, STDOUT_FILENO);
+  close(null);
+
+  /* Results are printed after stdout is restored */
+  size_t count = mb->count;
+
+  error_t err = microbench_run(mb, name, ops, fn, NULL);
+
+  fflush(stdout);
+  dup2(saved, STDOUT_FILENO);
+  close(saved);
+
+  if (err == E_OK && mb->count > count) {
+    microbench_result_t * result = &mb->results[count];
+    printf("{\"name\":\"%s\",\"ops\":%u,\"p50_ns\":%llu,\"p90_ns\":%llu,\"p99_ns\":%llu,\"spi_per_op\":%.2f}\n",
+           result->name, result->ops, (unsigned long long) result->p50_ns, (unsigned long long) result->p90_ns,
+           (unsigned long long) result->p99_ns, result->spi_per_op);
+  }
+
+  return err;
+}
+
+/**
+ * Compare results against baseline file, returns number of regressions
+ */
+static int microbench_check(microbench_t * mb, const char * path, uint32_t threshold) {
+  FILE * file = fopen(path, "r");
+  char line[256];
+  int regressions = 0;
+
+  if (!file) {
+    log_error("Can't open baseline '%s'", path);
+    return 1;
+  }
+
+  while (fgets(line, sizeof(line), file)) {
+    char name[MICROBENCH_NAME_SIZE];
+    unsigned long long p50;
+    double spi;
+
+    if (sscanf(line, "{\"name\":\"%31[^\"]\",\"ops\":%*u,\"p50_ns\":%llu,\"p90_ns\":%*u,\"p99_ns\":%*u,\"spi_per_op\":%lf",
+               name, &p50, &spi) != 3) {
+      continue;
+    }
+
+    for (size_t i = 0; i < mb->count; ++i) {
+      microbench_result_t * result = &mb->results[i];
+
+      if (strcmp(result->name, name)) {
+        continue;
+      }
+
+      if (result->p50_ns * 100 > p50 * (100 + threshold)) {
+        fprintf(stderr, "REGRESSION %s: p50 %llu ns, baseline %llu ns (+%u%% allowed)\n",
+                name, (unsigned long long) result->p50_ns, p50, threshold);
+        regressions++;
+      }
+
+      /* SPI traffic is deterministic, so any growth is a regression */
+      if (result->spi_per_op > spi + 0.005) {
+        fprintf(stderr, "REGRESSION %s: %.2f SPI transactions/op, baseline %.2f\n", name, result->spi_per_op, spi);
+        regressions++;
+      }
+    }
+  }
+
+  fclose(file);
+
+  return regressions;
+}
+
+static void microbench_usage(const char * argv0) {
+  fprintf(stderr,
+    "Usage: %s [-n OPS] [-d SPIDEV] [-f FILTER] [-b BASELINE [-t THRESHOLD_PCT]]\n"
+    "  -n  Iterations of cheap operations (default %d), ra02_init runs 1/100 of it\n"
+    "  -d  Run against real module on SPIDEV instead of emulator\n"
+    "  -f  Run only benchmarks, whose name contains FILTER\n"
+    "  -b  Compare with output of previous run, exit code 1 on regression\n"
+    "  -t  Allowed p50 regression in percent (default %d)\n",
+    argv0, MICROBENCH_DEFAULT_OPS, MICROBENCH_DEFAULT_THRESHOLD);
+}
+
+/* Shared functions ========================================================= */
+int main(int argc, char ** argv) {
+  static microbench_t mb;
+  const char * spidev = NULL;
+  const char * baseline = NULL;
+  uint32_t threshold = MICROBENCH_DEFAULT_THRESHOLD;
+  int opt;
+
+  mb.ops = MICROBENCH_DEFAULT_OPS;
+
+  while ((opt = getopt(argc, argv, "n:d:f:b:t:h")) != -1) {
+    switch (opt) {
+      case 'n': mb.ops = UTIL_MAX(atoi(optarg), 100); break;
+      case 'd': spidev = optarg; break;
+      case 'f': mb.filter = optarg; break;
+      case 'b': baseline = optarg; break;
+      case 't': threshold = atoi(optarg); break;
+      default:
+        microbench_usage(argv[0]);
+        return opt == 'h' ? 0 : 1;
+    }
+  }
+
+  if (spidev) {
+    spi_cfg_t cfg;
+    spi_cfg_default(&cfg);
+
+    if (spi_init(&mb.shim.device, &cfg, spidev) != E_OK) {
+      log_error("Can't open '%s'", spidev);
+      return 1;
+    }
+  } else {
+    ra02_emu_air_init(&mb.air);
+    ra02_emu_init(&mb.emu, &mb.air, &mb.spi);
+    mb.shim.transfer = mb.spi.transfer;
+    mb.shim.ctx = mb.spi.ctx;
+    mb.emulated = true;
+  }
+
+  mb.spi.fd = -1;
+  mb.spi.transfer = microbench_spi_transfer;
+  mb.spi.ctx = &mb.shim;
+
+  mb.samples = calloc(mb.ops, sizeof(uint64_t));
+  ASSERT_RETURN(mb.samples, 1);
+
+  error_t err = ra02_init(&mb.ra02, &(ra02_cfg_t) {.spi = &mb.spi});
+
+  if (err != E_OK) {
+    log_error("ra02_init: %s", error2str(err));
+    return 1;
+  }
+
+  /* Driver caps frames at RA02_MAX_PACKET_SIZE, not at 255 byte LoRa FIFO limit */
+  static const size_t fifo_sizes[] = {16, 32, RA02_MAX_PACKET_SIZE};
+  char name[MICROBENCH_NAME_SIZE];
+
+  err = microbench_run(&mb, "spi_transcieve", mb.ops, microbench_spi, NULL);
+  err = err ? err : microbench_run(&mb, "reg_single_x8", mb.ops, microbench_reg_single, NULL);
+  err = err ? err : microbench_run(&mb, "reg_burst_x8", mb.ops, microbench_reg_burst, NULL);
+  err = err ? err : microbench_run(&mb, "poll_irq_flags", mb.ops, microbench_poll_irq_flags, NULL);
+
+  for (size_t i = 0; i < UTIL_ARR_SIZE(fifo_sizes) && err == E_OK; ++i) {
+    snprintf(name, sizeof(name), "fifo_load_%zu", fifo_sizes[i]);
+    err = microbench_run(&mb, name, mb.ops, microbench_fifo_load, (void *) fifo_sizes[i]);
+  }
+
+  for (size_t i = 0; i < UTIL_ARR_SIZE(fifo_sizes) && err == E_OK; ++i) {
+    snprintf(name, sizeof(name), "fifo_drain_%zu", fifo_sizes[i]);
+    err = microbench_run(&mb, name, mb.ops, microbench_fifo_drain, (void *) fifo_sizes[i]);
+  }
+
+  err = err ? err : microbench_run(&mb, "ra02_init", UTIL_MAX(mb.ops / 100, 10), microbench_init, NULL);
+  err = err ? err : microbench_run_muted(&mb, "log_on", mb.ops, microbench_log_on);
+  err = err ? err : microbench_run(&mb, "log_off", mb.ops, microbench_log_off, NULL);
+
+  if (err != E_OK) {
+    log_error("Benchmark failed: %s", error2str(err));
+    return 1;
+  }
+
+  ra02_deinit(&mb.ra02);
+  free(mb.samples);
+
+  return baseline && microbench_check(&mb, baseline, threshold) ? 1 : 0;
+}
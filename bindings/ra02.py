@@ -8,6 +8,8 @@
 #
 # Provides API for RA02 RF module control, SPI & Timeout abstractions
 # Basically a thin FFI interface to C driver implementation
+# Compiled module ra02_native (ra02_native.c) provides the same classes,
+# raising exceptions defined here
 #
 # Example:
 #   # Initialize the library, SPI & RA02 module
@@ -22,8 +24,13 @@
 #   # Run receive for 5s
 #   rf.recv(ra02.Timeout(5000))
 #
+#   # Receive into caller-owned buffer, without allocations
+#   buf = bytearray(ra02.Ra02.MAX_PAYLOAD)
+#   size = rf.recv_into(buf, ra02.Timeout(5000))
+#
 # =========================================================================
 
+import asyncio
 import ctypes
 
 
@@ -134,6 +141,54 @@ def error_check(err: int):
             raise InvalidErrorCodeException(f'{err}')
 
 
+def tx_buffer(data) -> tuple:
+    """
+    Wraps data for passing to driver as read-only uint8_t * buffer
+    bytes & writable contiguous buffers (bytearray, memoryview, numpy arrays)
+    are passed without copying, other buffers are copied once,
+    sequences of ints (e.g. list) are converted to bytes
+
+    :param data: bytes-like object or sequence of ints
+    :return: (pointer argument, size in bytes)
+    """
+
+    if isinstance(data, bytes):
+        return data, len(data)
+
+    try:
+        view = memoryview(data)
+    except TypeError:
+        data = bytes(data)
+        return data, len(data)
+
+    if view.readonly or not view.c_contiguous:
+        data = view.tobytes()
+        return data, len(data)
+
+    view = view.cast('B')
+
+    return (ctypes.c_uint8 * view.nbytes).from_buffer(view), view.nbytes
+
+
+def rx_buffer(buffer) -> tuple:
+    """
+    Wraps caller-owned writable contiguous buffer (bytearray, memoryview,
+    numpy array) for driver to write into, without copying
+
+    :param buffer: writable bytes-like object
+    :return: (ctypes array over buffer, size in bytes)
+    """
+
+    view = memoryview(buffer)
+
+    if view.readonly or not view.c_contiguous:
+        raise TypeError('buffer must be writable & contiguous')
+
+    view = view.cast('B')
+
+    return (ctypes.c_uint8 * view.nbytes).from_buffer(view), view.nbytes
+
+
 class spi_cfg_t(ctypes.Structure):
     """
     Defines SPI config from spi.h
@@ -151,6 +206,8 @@ class spi_t(ctypes.Structure):
     _fields_ = [
         ('cfg', spi_cfg_t),
         ('fd', ctypes.c_int),
+        ('transfer', ctypes.c_void_p),
+        ('ctx', ctypes.c_void_p),
     ]
 
 class Spi:
@@ -217,6 +274,81 @@ class Spi:
         return list(rx_buf)
 
 
+class gpio_t(ctypes.Structure):
+    """
+    Defines GPIO context from gpio.h
+    """
+    _fields_ = [
+        ('fd', ctypes.c_int),
+        ('line', ctypes.c_uint32),
+    ]
+
+class Gpio:
+    """
+    Encapsulates gpio_t and gpio_* APIs from gpio.h
+    """
+
+    # Edges that generate events (gpio_edge_t)
+    EDGE_NONE = 0
+    EDGE_RISING = 1
+    EDGE_FALLING = 2
+    EDGE_BOTH = 3
+
+    def __init__(self, chip: str = None, line: int = 0, edge: int = EDGE_BOTH):
+        """
+        Requests GPIO line as input
+
+        :param chip: Path to linux GPIO chip device (/dev/gpiochipX), or None if it's not needed to be initialized
+        :param line: Line offset on the chip
+        :param edge: Edges that generate events (one of EDGE_*)
+        """
+
+        self.gpio = gpio_t()
+        self.initialized = False
+
+        if chip:
+            self.init(chip, line, edge)
+
+    def __del__(self):
+        """
+        Releases GPIO line
+        """
+
+        self.deinit()
+
+    def init(self, chip: str, line: int, edge: int = EDGE_BOTH):
+        """
+        Requests GPIO line as input
+
+        :param chip: Path to linux GPIO chip device (/dev/gpiochipX)
+        :param line: Line offset on the chip
+        :param edge: Edges that generate events (one of EDGE_*)
+        """
+
+        error_check(RA02_DYNLIB.gpio_init(ctypes.byref(self.gpio), chip.encode('utf-8'), line, edge))
+        self.initialized = True
+
+    def deinit(self):
+        """
+        Releases GPIO line
+        """
+
+        if self.initialized:
+            error_check(RA02_DYNLIB.gpio_deinit(ctypes.byref(self.gpio)))
+            self.initialized = False
+
+    def get(self) -> bool:
+        """
+        Reads GPIO line level
+
+        :return: Line level
+        """
+
+        value = ctypes.c_bool()
+        error_check(RA02_DYNLIB.gpio_get(ctypes.byref(self.gpio), ctypes.byref(value)))
+        return value.value
+
+
 class timeout_t(ctypes.Structure):
     """
     Defines timeout_t from timeout.h
@@ -275,6 +407,16 @@ class Timeout:
 
         RA02_DYNLIB.timeout_expire(ctypes.byref(self.timeout))
 
+    @staticmethod
+    def now_ns() -> int:
+        """
+        Get current CLOCK_MONOTONIC time
+
+        :return: time in nanoseconds
+        """
+
+        return RA02_DYNLIB.timeout_now_ns()
+
 
 class ra02_cfg_t(ctypes.Structure):
     """
@@ -282,6 +424,41 @@ class ra02_cfg_t(ctypes.Structure):
     """
     _fields_ = [
         ('spi', ctypes.POINTER(spi_t)),
+        ('dio0', ctypes.POINTER(gpio_t)),
+        ('dio1', ctypes.POINTER(gpio_t)),
+    ]
+
+class ra02_frame_cfg_t(ctypes.Structure):
+    """
+    Defines RA02 frame format from ra02.h
+    """
+    _fields_ = [
+        ('implicit_header', ctypes.c_bool),
+        ('payload_len', ctypes.c_uint8),
+        ('crc_rate', ctypes.c_int),
+        ('crc', ctypes.c_bool),
+    ]
+
+class ra02_fsk_packet_cfg_t(ctypes.Structure):
+    """
+    Defines RA02 FSK packet format from ra02.h
+    """
+    _fields_ = [
+        ('sync_word', ctypes.c_uint32),
+        ('sync_size', ctypes.c_uint8),
+        ('whitening', ctypes.c_bool),
+        ('crc', ctypes.c_bool),
+    ]
+
+class ra02_async_t(ctypes.Structure):
+    """
+    Defines RA02 split-phase operation from ra02.h
+    """
+    _fields_ = [
+        ('state', ctypes.c_int),
+        ('buf', ctypes.POINTER(ctypes.c_uint8)),
+        ('size', ctypes.POINTER(ctypes.c_size_t)),
+        ('deadline_ns', ctypes.c_uint64),
     ]
 
 class ra02_t(ctypes.Structure):
@@ -290,7 +467,74 @@ class ra02_t(ctypes.Structure):
     """
     _fields_ = [
         ('spi', ctypes.POINTER(spi_t)),
-        ('irq_flags', ctypes.c_uint8),
+        ('dio0', ctypes.POINTER(gpio_t)),
+        ('dio1', ctypes.POINTER(gpio_t)),
+        ('irq_flags', ctypes.c_uint16),
+        ('last_rssi', ctypes.c_int8),
+        ('frame', ra02_frame_cfg_t),
+        ('sf', ctypes.c_uint8),
+        ('bandwidth', ctypes.c_uint32),
+        ('preamble', ctypes.c_uint16),
+        ('modem', ctypes.c_int),
+        ('bitrate', ctypes.c_uint32),
+        ('fdev', ctypes.c_uint32),
+        ('fsk_packet', ra02_fsk_packet_cfg_t),
+        ('last_rx_ns', ctypes.c_uint64),
+        ('last_tx_ns', ctypes.c_uint64),
+        ('last_snr', ctypes.c_int8),
+        ('sync', ctypes.c_void_p),
+        ('async_', ra02_async_t),
+    ]
+
+class ra02_wor_stats_t(ctypes.Structure):
+    """
+    Defines RA02 wake-on-radio statistics from ra02.h
+    """
+    _fields_ = [
+        ('cad_runs', ctypes.c_uint32),
+        ('cad_detected', ctypes.c_uint32),
+        ('rx_ok', ctypes.c_uint32),
+        ('rx_missed', ctypes.c_uint32),
+        ('latency_us', ctypes.c_uint64),
+        ('last_latency_us', ctypes.c_uint64),
+    ]
+
+RA02_SCAN_SF_MIN = 7
+RA02_SCAN_SF_COUNT = 6
+
+class ra02_scan_stats_t(ctypes.Structure):
+    """
+    Defines RA02 multi-SF scan statistics from ra02.h, indexed by (sf - RA02_SCAN_SF_MIN)
+    """
+    _fields_ = [
+        ('cad_runs', ctypes.c_uint32 * RA02_SCAN_SF_COUNT),
+        ('cad_detected', ctypes.c_uint32 * RA02_SCAN_SF_COUNT),
+        ('rx_ok', ctypes.c_uint32 * RA02_SCAN_SF_COUNT),
+        ('rx_missed', ctypes.c_uint32 * RA02_SCAN_SF_COUNT),
+    ]
+
+class ra02_scan_sim_cfg_t(ctypes.Structure):
+    """
+    Defines RA02 multi-SF scan simulation parameters from ra02.h
+    """
+    _fields_ = [
+        ('sf_mask', ctypes.c_uint16),
+        ('preamble', ctypes.c_uint16),
+        ('payload_size', ctypes.c_size_t),
+        ('interval_ms', ctypes.c_uint32),
+        ('duration_ms', ctypes.c_uint32),
+        ('switch_us', ctypes.c_uint32),
+        ('seed', ctypes.c_uint32),
+    ]
+
+class ra02_scan_sim_result_t(ctypes.Structure):
+    """
+    Defines RA02 multi-SF scan simulation results from ra02.h
+    """
+    _fields_ = [
+        ('sent', ctypes.c_uint32 * RA02_SCAN_SF_COUNT),
+        ('detected', ctypes.c_uint32 * RA02_SCAN_SF_COUNT),
+        ('cycle_us', ctypes.c_uint32),
     ]
 
 class Ra02:
@@ -301,17 +545,46 @@ class Ra02:
     # Max packet size in bytes
     MAX_PAYLOAD = 64
 
-    def __init__(self, spi: Spi = None):
+    # Modems (ra02_modem_t)
+    MODEM_LORA = 0
+    MODEM_FSK = 1
+
+    # Coding rates (ra02_crc_rate_t)
+    CRC_RATE_4_5 = 1
+    CRC_RATE_4_6 = 2
+    CRC_RATE_4_7 = 3
+    CRC_RATE_4_8 = 4
+
+    # Max frame size in bytes for FSK streaming
+    MAX_STREAM_SIZE = 2047
+
+    # Default max lateness of send_at in ns
+    SEND_AT_MAX_LATE_NS = 100000
+
+    # Split-phase operation states (ra02_state_t)
+    STATE_IDLE = 0
+    STATE_TX = 1
+    STATE_RX = 2
+
+    # Result of receive, that was stopped to let async_send through
+    _PREEMPTED = object()
+
+    # Scan mask of all supported spreading factors (SF7-SF12)
+    SF_MASK_ALL = sum(1 << sf for sf in range(7, 13))
+
+    def __init__(self, spi: Spi = None, dio0: Gpio = None, dio1: Gpio = None):
         """
         Initializes RA02 driver
 
         :param spi: Initializes SPI handle. Can be None, but won't be initialized
+        :param dio0: Optional DIO0 line, IRQ flags are polled over SPI if None
+        :param dio1: Optional DIO1 line, IRQ flags are polled over SPI if None
         """
 
         self.ra02 = ra02_t()
 
         if spi:
-            self.init(spi)
+            self.init(spi, dio0, dio1)
 
     def __del__(self):
         """
@@ -320,16 +593,24 @@ class Ra02:
 
         self.deinit()
 
-    def init(self, spi: Spi):
+    def init(self, spi: Spi, dio0: Gpio = None, dio1: Gpio = None):
         """
         Initializes RA02 driver
 
         :param spi: Initializes SPI handle. Can be None, but won't be initialized
+        :param dio0: Optional DIO0 line, IRQ flags are polled over SPI if None
+        :param dio1: Optional DIO1 line, IRQ flags are polled over SPI if None
         """
 
         self.spi = spi
+        self.dio0 = dio0
+        self.dio1 = dio1
 
-        cfg = ra02_cfg_t(spi=ctypes.pointer(spi.spi))
+        cfg = ra02_cfg_t(
+            spi=ctypes.pointer(spi.spi),
+            dio0=ctypes.pointer(dio0.gpio) if dio0 else None,
+            dio1=ctypes.pointer(dio1.gpio) if dio1 else None,
+        )
 
         error_check(RA02_DYNLIB.ra02_init(ctypes.byref(self.ra02), ctypes.byref(cfg)))
 
@@ -354,6 +635,15 @@ class Ra02:
 
         error_check(RA02_DYNLIB.ra02_sleep(ctypes.byref(self.ra02)))
 
+    def set_modem(self, modem: int):
+        """
+        Selects modem. Resets modem configuration to defaults of selected modem
+
+        :param modem: MODEM_LORA or MODEM_FSK
+        """
+
+        error_check(RA02_DYNLIB.ra02_set_modem(ctypes.byref(self.ra02), ctypes.c_int(modem)))
+
     def set_freq(self, freq: int):
         """
         Sets frequency
@@ -392,15 +682,47 @@ class Ra02:
 
         error_check(RA02_DYNLIB.ra02_set_sync_word(ctypes.byref(self.ra02), ctypes.c_uint32(sync_word)))
 
+    def set_invert_iq(self, on: bool):
+        """
+        Set I/Q inversion (LoRa only)
+
+        :param on: Invert I/Q
+        """
+
+        error_check(RA02_DYNLIB.ra02_set_invert_iq(ctypes.byref(self.ra02), ctypes.c_bool(on)))
+
     def set_baudrate(self, baudrate: int):
         """
         Set baudrate
 
-        :param baudrate: Baudrate
+        :param baudrate: Baudrate in bits/s (FSK only)
         """
 
         error_check(RA02_DYNLIB.ra02_set_baudrate(ctypes.byref(self.ra02), ctypes.c_uint32(baudrate)))
 
+    def set_fdev(self, fdev: int):
+        """
+        Set frequency deviation
+
+        :param fdev: Frequency deviation in Hz (FSK only)
+        """
+
+        error_check(RA02_DYNLIB.ra02_set_fdev(ctypes.byref(self.ra02), ctypes.c_uint32(fdev)))
+
+    def set_fsk_packet_cfg(self, sync_word: int = 0x2DD4, sync_size: int = 2,
+                           whitening: bool = True, crc: bool = True):
+        """
+        Set FSK packet format
+
+        :param sync_word: Sync word, sent MSB first
+        :param sync_size: Sync word size in bytes (1-4), 0 disables sync word
+        :param whitening: Enable data whitening
+        :param crc: Append/check CRC-16
+        """
+
+        cfg = ra02_fsk_packet_cfg_t(sync_word=sync_word, sync_size=sync_size, whitening=whitening, crc=crc)
+        error_check(RA02_DYNLIB.ra02_set_fsk_packet_cfg(ctypes.byref(self.ra02), ctypes.byref(cfg)))
+
     def set_bandwidth(self, bandwidth: int):
         """
         Sets bandwidth
@@ -426,6 +748,33 @@ class Ra02:
         """
         error_check(RA02_DYNLIB.ra02_set_sf(ctypes.byref(self.ra02), ctypes.c_uint8(sf)))
 
+    def set_frame_cfg(self, implicit_header: bool = False, payload_len: int = 0,
+                      crc_rate: int = CRC_RATE_4_7, crc: bool = False):
+        """
+        Set frame format. In implicit header mode payload length, coding rate & CRC
+        must be agreed by both sides, as they are not sent over the air
+
+        :param implicit_header: Omit explicit header (fixed length frames)
+        :param payload_len: Fixed payload length, used only in implicit header mode
+        :param crc_rate: Coding rate (one of CRC_RATE_*)
+        :param crc: Append payload CRC on TX
+        """
+
+        cfg = ra02_frame_cfg_t(implicit_header=implicit_header, payload_len=payload_len, crc_rate=crc_rate, crc=crc)
+        error_check(RA02_DYNLIB.ra02_set_frame_cfg(ctypes.byref(self.ra02), ctypes.byref(cfg)))
+
+    def get_time_on_air(self, size: int) -> int:
+        """
+        Calculates time on air for a packet with current modem configuration
+
+        :param size: Payload size in bytes
+        :return: Time on air in microseconds
+        """
+
+        us = ctypes.c_uint32()
+        error_check(RA02_DYNLIB.ra02_get_time_on_air(ctypes.byref(self.ra02), ctypes.c_size_t(size), ctypes.byref(us)))
+        return us.value
+
     def get_rssi(self):
         """
         Returns current measured RSSI
@@ -449,19 +798,44 @@ class Ra02:
         """
         Send data over radio
 
-        :param data: list of bytes to send via radio
+        :param data: bytes-like object to send via radio (see tx_buffer)
+        """
+
+        buf, size = tx_buffer(data)
+
+        error_check(RA02_DYNLIB.ra02_send(ctypes.byref(self.ra02), buf, ctypes.c_size_t(size)))
+
+    def send_at(self, data: bytes, at_ns: int, max_late_ns: int = SEND_AT_MAX_LATE_NS):
+        """
+        Send data over radio, starting transmission at precise instant
+        Raises TimeoutException, if instant was missed by more than max_late_ns
+        Lateness of sent frame is self.ra02.last_tx_ns - at_ns
+
+        :param data: bytes-like object to send via radio (see tx_buffer)
+        :param at_ns: CLOCK_MONOTONIC time of TX start, see Timeout.now_ns
+        :param max_late_ns: Lateness, after which nothing is sent, 2 ** 64 - 1 - always send
+        """
+
+        buf, size = tx_buffer(data)
+
+        error_check(RA02_DYNLIB.ra02_send_at(ctypes.byref(self.ra02), buf, ctypes.c_size_t(size),
+                                             ctypes.c_uint64(at_ns), ctypes.c_uint64(max_late_ns)))
+
+    def last_rx_ns(self) -> int:
         """
+        Get CLOCK_MONOTONIC time of last RX_DONE
 
-        buf = (ctypes.c_uint8 * len(data))(*data)
+        :return: time in nanoseconds
+        """
 
-        error_check(RA02_DYNLIB.ra02_send(ctypes.byref(self.ra02), buf, ctypes.c_size_t(len(data))))
+        return self.ra02.last_rx_ns
 
     def recv(self, timeout: Timeout) -> bytes:
         """
         Receive data over radio for specified amount of time
 
         :param timeout: Initialized Timeout
-        :return: list of received bytes, if receive was successful
+        :return: received bytes, if receive was successful
         """
 
         buf = (ctypes.c_uint8 * self.MAX_PAYLOAD)()
@@ -469,7 +843,419 @@ class Ra02:
 
         error_check(RA02_DYNLIB.ra02_recv(ctypes.byref(self.ra02), buf, ctypes.byref(size), ctypes.byref(timeout.timeout)))
 
-        return bytes(buf[:size.value])
+        return ctypes.string_at(buf, size.value)
+
+    def recv_into(self, buffer, timeout: Timeout) -> int:
+        """
+        Receive data over radio into caller-owned buffer, without allocations
+        Frame, that doesn't fit into buffer, is truncated (as in ra02_recv)
+
+        :param buffer: writable bytes-like object, e.g. bytearray(Ra02.MAX_PAYLOAD)
+        :param timeout: Initialized Timeout
+        :return: number of received bytes
+        """
+
+        buf, size = rx_buffer(buffer)
+        size = ctypes.c_size_t(size)
+
+        error_check(RA02_DYNLIB.ra02_recv(ctypes.byref(self.ra02), buf, ctypes.byref(size), ctypes.byref(timeout.timeout)))
+
+        return size.value
+
+    def send_start(self, data: bytes):
+        """
+        Starts transmission without waiting for it to end, complete it with step
+
+        :param data: bytes-like object to send via radio (see tx_buffer)
+        """
+
+        buf, size = tx_buffer(data)
+
+        error_check(RA02_DYNLIB.ra02_send_start(ctypes.byref(self.ra02), buf, ctypes.c_size_t(size)))
+
+    def recv_start(self, timeout_ms: int = 0):
+        """
+        Starts reception without waiting for frame, complete it with step
+
+        :param timeout_ms: time to wait for frame, 0 - until frame arrives or cancel
+        """
+
+        # Driver writes into them until reception completes
+        self.rx_buf = (ctypes.c_uint8 * self.MAX_PAYLOAD)()
+        self.rx_size = ctypes.c_size_t(self.MAX_PAYLOAD)
+
+        error_check(RA02_DYNLIB.ra02_recv_start(ctypes.byref(self.ra02), self.rx_buf, ctypes.byref(self.rx_size), ctypes.c_uint32(timeout_ms)))
+
+    def step(self) -> tuple[bool, int, bytes]:
+        """
+        Advances operation started by send_start or recv_start, never blocks
+        Raises exception if operation failed (e.g. TimeoutException)
+
+        :return: (done, wake_ns, frame): done - whether operation completed,
+                 wake_ns - CLOCK_MONOTONIC time of next step, if not done (see Timeout.now_ns),
+                 frame - received bytes, if reception completed, otherwise None
+        """
+
+        rx = self.ra02.async_.state == self.STATE_RX
+        wake_ns = ctypes.c_uint64()
+
+        err = RA02_DYNLIB.ra02_step(ctypes.byref(self.ra02), ctypes.byref(wake_ns))
+
+        if err == 10:  # E_AGAIN, still in progress
+            return False, wake_ns.value, None
+
+        error_check(err)
+
+        return True, wake_ns.value, ctypes.string_at(self.rx_buf, self.rx_size.value) if rx else None
+
+    def cancel(self):
+        """
+        Cancels blocking call running in other thread (e.g. recv), it raises CancelledException
+        If no call is blocking, the next one is cancelled
+        """
+
+        error_check(RA02_DYNLIB.ra02_cancel(ctypes.byref(self.ra02)))
+
+    async def async_send(self, data):
+        """
+        Send data over radio without blocking the running asyncio loop
+        Operations of one radio run one at a time, in order of calls, except
+        that pending async_recv is preempted: its reception is stopped, frame
+        is sent and reception restarts (frame being received then is lost)
+
+        :param data: bytes-like object to send via radio (see tx_buffer)
+        """
+
+        self.async_tx_pending = getattr(self, 'async_tx_pending', 0) + 1
+
+        # Wake up receive in progress, so that it gives the radio up
+        if getattr(self, 'async_preempt', None):
+            self.async_preempt()
+
+        try:
+            async with self._async_lock():
+                self.send_start(data)
+                await self._async_complete()
+        finally:
+            self.async_tx_pending -= 1
+
+    async def async_recv(self, timeout_ms: int = 0) -> bytes:
+        """
+        Receive data over radio without blocking the running asyncio loop
+        Raises TimeoutException, if no frame arrived in time
+        Cancelling the awaiting task stops reception & leaves radio in sleep mode
+
+        :param timeout_ms: time to wait for frame, 0 - until frame arrives or task is cancelled
+        :return: received bytes
+        """
+
+        deadline_ns = Timeout.now_ns() + timeout_ms * 1000000 if timeout_ms else None
+
+        while True:
+            async with self._async_lock():
+                if not getattr(self, 'async_tx_pending', 0):
+                    left_ms = 0
+
+                    if deadline_ns is not None:
+                        left_ms = -(-(deadline_ns - Timeout.now_ns()) // 1000000)
+
+                        if left_ms <= 0:
+                            raise TimeoutException()
+
+                    self.recv_start(left_ms)
+                    frame = await self._async_complete(preemptible=True)
+
+                    if frame is not self._PREEMPTED:
+                        return frame
+
+            # Lock is handed over to queued sends, reception restarts after them
+
+    async def frames(self, timeout_ms: int = 0):
+        """
+        Async iterator over received frames, e.g. `async for frame in rf.frames()`
+        Frames with bad CRC are skipped, iteration ends on timeout
+
+        :param timeout_ms: time to wait for each frame, 0 - forever
+        """
+
+        while True:
+            try:
+                yield await self.async_recv(timeout_ms)
+            except CorruptException:
+                continue
+            except TimeoutException:
+                return
+
+    def __aiter__(self):
+        """
+        Async iterator over received frames, waiting for each forever (see frames)
+        """
+
+        return self.frames()
+
+    def _async_lock(self) -> asyncio.Lock:
+        """
+        Lock, that serializes async operations of this radio
+        """
+
+        if getattr(self, 'async_lock', None) is None:
+            self.async_lock = asyncio.Lock()
+
+        return self.async_lock
+
+    async def _async_complete(self, preemptible: bool = False):
+        """
+        Drives operation started by send_start/recv_start with step, waking up on
+        DIO edges (fds registered with loop.add_reader) or at wake_ns from step
+        Without DIO lines IRQ flags are polled every symbol, so connect DIO0 & DIO1
+        for idle radios to cost nothing
+
+        :param preemptible: stop operation, when async_send is waiting for the radio
+        :return: frame, if reception completed, _PREEMPTED if stopped for a send, otherwise None
+        """
+
+        loop = asyncio.get_running_loop()
+        fds = [dio.gpio.fd for dio in (getattr(self, 'dio0', None), getattr(self, 'dio1', None)) if dio]
+        waiter = None
+        timer = None
+
+        def wake():
+            if waiter is not None and not waiter.done():
+                waiter.set_result(None)
+
+        for fd in fds:
+            loop.add_reader(fd, wake)
+
+        try:
+            while True:
+                done, wake_ns, frame = self.step()
+
+                if done:
+                    return frame
+
+                if preemptible and getattr(self, 'async_tx_pending', 0):
+                    # Driver checks cancellation first, so this step can't complete the operation
+                    self.cancel()
+
+                    try:
+                        self.step()
+                    except CancelledException:
+                        pass
+
+                    return self._PREEMPTED
+
+                waiter = loop.create_future()
+
+                # UINT64_MAX - only DIO edge completes the operation
+                if wake_ns != 2 ** 64 - 1:
+                    timer = loop.call_later(max(wake_ns - Timeout.now_ns(), 0) / 1e9, wake)
+
+                if preemptible:
+                    self.async_preempt = wake
+
+                try:
+                    await waiter
+                finally:
+                    self.async_preempt = None
+
+                    if timer:
+                        timer.cancel()
+                        timer = None
+        except asyncio.CancelledError:
+            # Cancelled operation completes with E_CANCELLED on next step
+            self.cancel()
+
+            try:
+                self.step()
+            except CancelledException:
+                pass
+
+            raise
+        finally:
+            for fd in fds:
+                loop.remove_reader(fd)
+
+    def cad(self) -> bool:
+        """
+        Runs single Channel Activity Detection (LoRa only)
+
+        :return: True if LoRa preamble was detected
+        """
+
+        detected = ctypes.c_bool()
+        error_check(RA02_DYNLIB.ra02_cad(ctypes.byref(self.ra02), ctypes.byref(detected)))
+        return detected.value
+
+    def listen(self, khz: int):
+        """
+        Retunes and starts continuous reception, e.g. for RSSI sampling (LoRa only)
+
+        :param khz: Frequency in kHz
+        """
+
+        error_check(RA02_DYNLIB.ra02_listen(ctypes.byref(self.ra02), ctypes.c_uint32(khz)))
+
+    def sample_rssi(self, count: int, interval_us: int = 0) -> list[int]:
+        """
+        Samples current channel RSSI, radio must be receiving (see listen)
+
+        :param count: Number of samples
+        :param interval_us: Delay between samples
+        :return: RSSI samples in dBm
+        """
+
+        rssi = (ctypes.c_int8 * count)()
+        error_check(RA02_DYNLIB.ra02_sample_rssi(ctypes.byref(self.ra02), rssi, None, ctypes.c_size_t(count),
+                                                 ctypes.c_uint16(interval_us)))
+        return list(rssi)
+
+    def send_wor(self, period_ms: int, data: bytes):
+        """
+        Send data with preamble spanning whole wake-on-radio period of receiver
+
+        :param period_ms: Receiver CAD period in ms
+        :param data: bytes-like object to send via radio (see tx_buffer)
+        """
+
+        buf, size = tx_buffer(data)
+
+        error_check(RA02_DYNLIB.ra02_send_wor(ctypes.byref(self.ra02), ctypes.c_uint32(period_ms), buf, ctypes.c_size_t(size)))
+
+    def recv_wor(self, period_ms: int, timeout: Timeout, stats: ra02_wor_stats_t = None) -> bytes:
+        """
+        Duty-cycled receive, runs CAD every period_ms and sleeps in between
+
+        :param period_ms: CAD period in ms
+        :param timeout: Initialized Timeout
+        :param stats: Optional ra02_wor_stats_t, accumulated across calls
+        :return: received bytes, if receive was successful
+        """
+
+        buf = (ctypes.c_uint8 * self.MAX_PAYLOAD)()
+        size = ctypes.c_size_t(self.MAX_PAYLOAD)
+        stats = stats if stats is not None else ra02_wor_stats_t()
+
+        error_check(RA02_DYNLIB.ra02_recv_wor(
+            ctypes.byref(self.ra02), ctypes.c_uint32(period_ms), buf, ctypes.byref(size),
+            ctypes.byref(timeout.timeout), ctypes.byref(stats)
+        ))
+
+        return ctypes.string_at(buf, size.value)
+
+    def get_scan_preamble(self, sf_mask: int, sf: int) -> int:
+        """
+        Calculates preamble length for sender, so that scanning receiver catches it
+
+        :param sf_mask: Receiver scan mask (bit per SF)
+        :param sf: Sender spreading factor
+        :return: Preamble length in symbols
+        """
+
+        symbols = ctypes.c_uint16()
+        error_check(RA02_DYNLIB.ra02_get_scan_preamble(ctypes.byref(self.ra02), ctypes.c_uint16(sf_mask),
+                                                       ctypes.c_uint8(sf), ctypes.byref(symbols)))
+        return symbols.value
+
+    def recv_scan(self, sf_mask: int, timeout: Timeout, stats: ra02_scan_stats_t = None) -> tuple[bytes, int]:
+        """
+        Scanning receive, cycles CAD over SFs from mask and locks onto detected one
+
+        :param sf_mask: SFs to scan (bit per SF)
+        :param timeout: Initialized Timeout
+        :param stats: Optional ra02_scan_stats_t, accumulated across calls
+        :return: received bytes and SF they were received on
+        """
+
+        buf = (ctypes.c_uint8 * self.MAX_PAYLOAD)()
+        size = ctypes.c_size_t(self.MAX_PAYLOAD)
+        sf = ctypes.c_uint8()
+        stats = stats if stats is not None else ra02_scan_stats_t()
+
+        error_check(RA02_DYNLIB.ra02_recv_scan(
+            ctypes.byref(self.ra02), ctypes.c_uint16(sf_mask), buf, ctypes.byref(size),
+            ctypes.byref(sf), ctypes.byref(timeout.timeout), ctypes.byref(stats)
+        ))
+
+        return ctypes.string_at(buf, size.value), sf.value
+
+    def scan_simulate(self, cfg: ra02_scan_sim_cfg_t) -> ra02_scan_sim_result_t:
+        """
+        Simulates scanning receiver against random preamble schedule
+
+        :param cfg: Simulation parameters
+        :return: Per SF detections
+        """
+
+        result = ra02_scan_sim_result_t()
+        error_check(RA02_DYNLIB.ra02_scan_simulate(ctypes.byref(self.ra02), ctypes.byref(cfg), ctypes.byref(result)))
+        return result
+
+    def get_window_symbols(self, ms: int) -> int:
+        """
+        Converts receive window length to symbols with current SF & bandwidth
+
+        :param ms: Window length in ms
+        :return: Window length in symbols
+        """
+
+        symbols = ctypes.c_uint16()
+        error_check(RA02_DYNLIB.ra02_get_window_symbols(ctypes.byref(self.ra02), ctypes.c_uint32(ms), ctypes.byref(symbols)))
+        return symbols.value
+
+    def recv_window(self, symbols: int) -> bytes:
+        """
+        Receive data within a window bounded by modem symbol timeout
+
+        :param symbols: Window length in symbols (4-1023)
+        :return: received bytes, if receive was successful
+        """
+
+        buf = (ctypes.c_uint8 * self.MAX_PAYLOAD)()
+        size = ctypes.c_size_t(self.MAX_PAYLOAD)
+
+        error_check(RA02_DYNLIB.ra02_recv_window(ctypes.byref(self.ra02), buf, ctypes.byref(size), ctypes.c_uint16(symbols)))
+
+        return ctypes.string_at(buf, size.value)
+
+    def send_stream(self, data: bytes):
+        """
+        Send a single FSK frame larger than FIFO (up to MAX_STREAM_SIZE)
+        Receiver must expect exactly the same size with recv_stream
+
+        :param data: bytes-like object to send via radio (see tx_buffer)
+        """
+
+        buf, size = tx_buffer(data)
+
+        error_check(RA02_DYNLIB.ra02_send_stream(ctypes.byref(self.ra02), buf, ctypes.c_size_t(size)))
+
+    def recv_stream(self, size: int, timeout: Timeout) -> bytes:
+        """
+        Receive a single FSK frame larger than FIFO
+
+        :param size: Expected frame size
+        :param timeout: Initialized Timeout
+        :return: received bytes, if receive was successful
+        """
+
+        buf = (ctypes.c_uint8 * size)()
+
+        error_check(RA02_DYNLIB.ra02_recv_stream(ctypes.byref(self.ra02), buf, ctypes.c_size_t(size), ctypes.byref(timeout.timeout)))
+
+        return bytes(buf)
+
+    def recv_stream_into(self, buffer, timeout: Timeout):
+        """
+        Receive a single FSK frame larger than FIFO into caller-owned buffer,
+        frame size is size of the buffer
+
+        :param buffer: writable bytes-like object
+        :param timeout: Initialized Timeout
+        """
+
+        buf, size = rx_buffer(buffer)
+
+        error_check(RA02_DYNLIB.ra02_recv_stream(ctypes.byref(self.ra02), buf, ctypes.c_size_t(size), ctypes.byref(timeout.timeout)))
 
 
 def __init__(dynlib_path: str):
@@ -509,6 +1295,20 @@ def __init__(dynlib_path: str):
     ]
     RA02_DYNLIB.spi_transcieve.restype = ctypes.c_int
 
+    # gpio.h
+
+    # error_t gpio_init(gpio_t * gpio, const char * chip, uint32_t line, gpio_edge_t edge);
+    RA02_DYNLIB.gpio_init.argtypes = [ctypes.POINTER(gpio_t), ctypes.c_char_p, ctypes.c_uint32, ctypes.c_int]
+    RA02_DYNLIB.gpio_init.restype = ctypes.c_int
+
+    # error_t gpio_deinit(gpio_t * gpio);
+    RA02_DYNLIB.gpio_deinit.argtypes = [ctypes.POINTER(gpio_t)]
+    RA02_DYNLIB.gpio_deinit.restype = ctypes.c_int
+
+    # error_t gpio_get(gpio_t * gpio, bool * value);
+    RA02_DYNLIB.gpio_get.argtypes = [ctypes.POINTER(gpio_t), ctypes.POINTER(ctypes.c_bool)]
+    RA02_DYNLIB.gpio_get.restype = ctypes.c_int
+
     # timeout.h
 
     # void timeout_start(timeout_t * timeout, uint64_t ms);
@@ -527,6 +1327,10 @@ def __init__(dynlib_path: str):
     RA02_DYNLIB.timeout_expire.argtypes = [ctypes.POINTER(timeout_t)]
     RA02_DYNLIB.timeout_expire.restype = None
 
+    # uint64_t timeout_now_ns(void);
+    RA02_DYNLIB.timeout_now_ns.argtypes = []
+    RA02_DYNLIB.timeout_now_ns.restype = ctypes.c_uint64
+
     # ra02.h
 
     # error_t ra02_init(ra02_t * ra02, ra02_cfg_t * cfg);
@@ -545,6 +1349,10 @@ def __init__(dynlib_path: str):
     RA02_DYNLIB.ra02_sleep.argtypes = [ctypes.POINTER(ra02_t)]
     RA02_DYNLIB.ra02_sleep.restype = ctypes.c_int
 
+    # error_t ra02_set_modem(ra02_t * ra02, ra02_modem_t modem);
+    RA02_DYNLIB.ra02_set_modem.argtypes = [ctypes.POINTER(ra02_t), ctypes.c_int]
+    RA02_DYNLIB.ra02_set_modem.restype = ctypes.c_int
+
     # error_t ra02_set_freq(ra02_t * ra02, uint32_t khz);
     RA02_DYNLIB.ra02_set_freq.argtypes = [ctypes.POINTER(ra02_t), ctypes.c_uint32]
     RA02_DYNLIB.ra02_set_freq.restype = ctypes.c_int
@@ -561,10 +1369,22 @@ def __init__(dynlib_path: str):
     RA02_DYNLIB.ra02_set_sync_word.argtypes = [ctypes.POINTER(ra02_t), ctypes.c_uint32]
     RA02_DYNLIB.ra02_set_sync_word.restype = ctypes.c_int
 
+    # error_t ra02_set_invert_iq(ra02_t * ra02, bool on);
+    RA02_DYNLIB.ra02_set_invert_iq.argtypes = [ctypes.POINTER(ra02_t), ctypes.c_bool]
+    RA02_DYNLIB.ra02_set_invert_iq.restype = ctypes.c_int
+
     # error_t ra02_set_baudrate(ra02_t * ra02, uint32_t baudrate);
     RA02_DYNLIB.ra02_set_baudrate.argtypes = [ctypes.POINTER(ra02_t), ctypes.c_uint32]
     RA02_DYNLIB.ra02_set_baudrate.restype = ctypes.c_int
 
+    # error_t ra02_set_fdev(ra02_t * ra02, uint32_t hz);
+    RA02_DYNLIB.ra02_set_fdev.argtypes = [ctypes.POINTER(ra02_t), ctypes.c_uint32]
+    RA02_DYNLIB.ra02_set_fdev.restype = ctypes.c_int
+
+    # error_t ra02_set_fsk_packet_cfg(ra02_t * ra02, const ra02_fsk_packet_cfg_t * cfg);
+    RA02_DYNLIB.ra02_set_fsk_packet_cfg.argtypes = [ctypes.POINTER(ra02_t), ctypes.POINTER(ra02_fsk_packet_cfg_t)]
+    RA02_DYNLIB.ra02_set_fsk_packet_cfg.restype = ctypes.c_int
+
     # error_t ra02_set_bandwidth(ra02_t * ra02, uint32_t bandwidth);
     RA02_DYNLIB.ra02_set_bandwidth.argtypes = [ctypes.POINTER(ra02_t), ctypes.c_uint32]
     RA02_DYNLIB.ra02_set_bandwidth.restype = ctypes.c_int
@@ -577,6 +1397,18 @@ def __init__(dynlib_path: str):
     RA02_DYNLIB.ra02_set_sf.argtypes = [ctypes.POINTER(ra02_t), ctypes.c_uint8]
     RA02_DYNLIB.ra02_set_sf.restype = ctypes.c_int
 
+    # error_t ra02_set_frame_cfg(ra02_t * ra02, const ra02_frame_cfg_t * cfg);
+    RA02_DYNLIB.ra02_set_frame_cfg.argtypes = [ctypes.POINTER(ra02_t), ctypes.POINTER(ra02_frame_cfg_t)]
+    RA02_DYNLIB.ra02_set_frame_cfg.restype = ctypes.c_int
+
+    # error_t ra02_get_time_on_air(ra02_t * ra02, size_t size, uint32_t * us);
+    RA02_DYNLIB.ra02_get_time_on_air.argtypes = [
+        ctypes.POINTER(ra02_t),
+        ctypes.c_size_t,
+        ctypes.POINTER(ctypes.c_uint32)
+    ]
+    RA02_DYNLIB.ra02_get_time_on_air.restype = ctypes.c_int
+
     # error_t ra02_get_rssi(ra02_t * ra02, int8_t * rssi);
     RA02_DYNLIB.ra02_get_rssi.argtypes = [ctypes.POINTER(ra02_t), ctypes.POINTER(ctypes.c_uint8)]
     RA02_DYNLIB.ra02_get_rssi.restype = ctypes.c_int
@@ -588,11 +1420,21 @@ def __init__(dynlib_path: str):
     # error_t ra02_send(ra02_t * ra02, uint8_t * buf, size_t size);
     RA02_DYNLIB.ra02_send.argtypes = [
         ctypes.POINTER(ra02_t),
-        ctypes.POINTER(ctypes.c_uint8),
+        ctypes.c_void_p,
         ctypes.c_size_t
     ]
     RA02_DYNLIB.ra02_send.restype = ctypes.c_int
 
+    # error_t ra02_send_at(ra02_t * ra02, uint8_t * buf, size_t size, uint64_t at_ns, uint64_t max_late_ns);
+    RA02_DYNLIB.ra02_send_at.argtypes = [
+        ctypes.POINTER(ra02_t),
+        ctypes.c_void_p,
+        ctypes.c_size_t,
+        ctypes.c_uint64,
+        ctypes.c_uint64
+    ]
+    RA02_DYNLIB.ra02_send_at.restype = ctypes.c_int
+
     # error_t ra02_recv(ra02_t * ra02, uint8_t * buf, size_t * size, timeout_t * timeout);
     RA02_DYNLIB.ra02_recv.argtypes = [
         ctypes.POINTER(ra02_t),
@@ -601,3 +1443,131 @@ def __init__(dynlib_path: str):
         ctypes.POINTER(timeout_t)
     ]
     RA02_DYNLIB.ra02_recv.restype = ctypes.c_int
+
+    # error_t ra02_send_start(ra02_t * ra02, uint8_t * buf, size_t size);
+    RA02_DYNLIB.ra02_send_start.argtypes = [
+        ctypes.POINTER(ra02_t),
+        ctypes.c_void_p,
+        ctypes.c_size_t
+    ]
+    RA02_DYNLIB.ra02_send_start.restype = ctypes.c_int
+
+    # error_t ra02_recv_start(ra02_t * ra02, uint8_t * buf, size_t * size, uint32_t timeout_ms);
+    RA02_DYNLIB.ra02_recv_start.argtypes = [
+        ctypes.POINTER(ra02_t),
+        ctypes.POINTER(ctypes.c_uint8),
+        ctypes.POINTER(ctypes.c_size_t),
+        ctypes.c_uint32
+    ]
+    RA02_DYNLIB.ra02_recv_start.restype = ctypes.c_int
+
+    # error_t ra02_step(ra02_t * ra02, uint64_t * wake_ns);
+    RA02_DYNLIB.ra02_step.argtypes = [ctypes.POINTER(ra02_t), ctypes.POINTER(ctypes.c_uint64)]
+    RA02_DYNLIB.ra02_step.restype = ctypes.c_int
+
+    # error_t ra02_cancel(ra02_t * ra02);
+    RA02_DYNLIB.ra02_cancel.argtypes = [ctypes.POINTER(ra02_t)]
+    RA02_DYNLIB.ra02_cancel.restype = ctypes.c_int
+
+    # error_t ra02_cad(ra02_t * ra02, bool * detected);
+    RA02_DYNLIB.ra02_cad.argtypes = [ctypes.POINTER(ra02_t), ctypes.POINTER(ctypes.c_bool)]
+    RA02_DYNLIB.ra02_cad.restype = ctypes.c_int
+
+    # error_t ra02_listen(ra02_t * ra02, uint32_t khz);
+    RA02_DYNLIB.ra02_listen.argtypes = [ctypes.POINTER(ra02_t), ctypes.c_uint32]
+    RA02_DYNLIB.ra02_listen.restype = ctypes.c_int
+
+    # error_t ra02_sample_rssi(ra02_t * ra02, int8_t * rssi, uint8_t * wideband, size_t count, uint16_t interval_us);
+    RA02_DYNLIB.ra02_sample_rssi.argtypes = [
+        ctypes.POINTER(ra02_t),
+        ctypes.POINTER(ctypes.c_int8),
+        ctypes.POINTER(ctypes.c_uint8),
+        ctypes.c_size_t,
+        ctypes.c_uint16
+    ]
+    RA02_DYNLIB.ra02_sample_rssi.restype = ctypes.c_int
+
+    # error_t ra02_send_wor(ra02_t * ra02, uint32_t period_ms, uint8_t * buf, size_t size);
+    RA02_DYNLIB.ra02_send_wor.argtypes = [
+        ctypes.POINTER(ra02_t),
+        ctypes.c_uint32,
+        ctypes.c_void_p,
+        ctypes.c_size_t
+    ]
+    RA02_DYNLIB.ra02_send_wor.restype = ctypes.c_int
+
+    # error_t ra02_recv_wor(ra02_t * ra02, uint32_t period_ms, uint8_t * buf, size_t * size,
+    #                       timeout_t * timeout, ra02_wor_stats_t * stats);
+    RA02_DYNLIB.ra02_recv_wor.argtypes = [
+        ctypes.POINTER(ra02_t),
+        ctypes.c_uint32,
+        ctypes.POINTER(ctypes.c_uint8),
+        ctypes.POINTER(ctypes.c_size_t),
+        ctypes.POINTER(timeout_t),
+        ctypes.POINTER(ra02_wor_stats_t)
+    ]
+    RA02_DYNLIB.ra02_recv_wor.restype = ctypes.c_int
+
+    # error_t ra02_get_scan_preamble(ra02_t * ra02, uint16_t sf_mask, uint8_t sf, uint16_t * symbols);
+    RA02_DYNLIB.ra02_get_scan_preamble.argtypes = [
+        ctypes.POINTER(ra02_t),
+        ctypes.c_uint16,
+        ctypes.c_uint8,
+        ctypes.POINTER(ctypes.c_uint16)
+    ]
+    RA02_DYNLIB.ra02_get_scan_preamble.restype = ctypes.c_int
+
+    # error_t ra02_recv_scan(ra02_t * ra02, uint16_t sf_mask, uint8_t * buf, size_t * size, uint8_t * sf,
+    #                        timeout_t * timeout, ra02_scan_stats_t * stats);
+    RA02_DYNLIB.ra02_recv_scan.argtypes = [
+        ctypes.POINTER(ra02_t),
+        ctypes.c_uint16,
+        ctypes.POINTER(ctypes.c_uint8),
+        ctypes.POINTER(ctypes.c_size_t),
+        ctypes.POINTER(ctypes.c_uint8),
+        ctypes.POINTER(timeout_t),
+        ctypes.POINTER(ra02_scan_stats_t)
+    ]
+    RA02_DYNLIB.ra02_recv_scan.restype = ctypes.c_int
+
+    # error_t ra02_scan_simulate(ra02_t * ra02, const ra02_scan_sim_cfg_t * cfg, ra02_scan_sim_result_t * result);
+    RA02_DYNLIB.ra02_scan_simulate.argtypes = [
+        ctypes.POINTER(ra02_t),
+        ctypes.POINTER(ra02_scan_sim_cfg_t),
+        ctypes.POINTER(ra02_scan_sim_result_t)
+    ]
+    RA02_DYNLIB.ra02_scan_simulate.restype = ctypes.c_int
+
+    # error_t ra02_get_window_symbols(ra02_t * ra02, uint32_t ms, uint16_t * symbols);
+    RA02_DYNLIB.ra02_get_window_symbols.argtypes = [
+        ctypes.POINTER(ra02_t),
+        ctypes.c_uint32,
+        ctypes.POINTER(ctypes.c_uint16)
+    ]
+    RA02_DYNLIB.ra02_get_window_symbols.restype = ctypes.c_int
+
+    # error_t ra02_recv_window(ra02_t * ra02, uint8_t * buf, size_t * size, uint16_t symbols);
+    RA02_DYNLIB.ra02_recv_window.argtypes = [
+        ctypes.POINTER(ra02_t),
+        ctypes.POINTER(ctypes.c_uint8),
+        ctypes.POINTER(ctypes.c_size_t),
+        ctypes.c_uint16
+    ]
+    RA02_DYNLIB.ra02_recv_window.restype = ctypes.c_int
+
+    # error_t ra02_send_stream(ra02_t * ra02, uint8_t * buf, size_t size);
+    RA02_DYNLIB.ra02_send_stream.argtypes = [
+        ctypes.POINTER(ra02_t),
+        ctypes.c_void_p,
+        ctypes.c_size_t
+    ]
+    RA02_DYNLIB.ra02_send_stream.restype = ctypes.c_int
+
+    # error_t ra02_recv_stream(ra02_t * ra02, uint8_t * buf, size_t size, timeout_t * timeout);
+    RA02_DYNLIB.ra02_recv_stream.argtypes = [
+        ctypes.POINTER(ra02_t),
+        ctypes.POINTER(ctypes.c_uint8),
+        ctypes.c_size_t,
+        ctypes.POINTER(timeout_t)
+    ]
+    RA02_DYNLIB.ra02_recv_stream.restype = ctypes.c_int
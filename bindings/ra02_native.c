@@ -0,0 +1,1422 @@
+/** ========================================================================= *
+ *
+ * @file ra02_native.c
+ * @date 17-10-2026
+ * @author Maksym Tkachuk <max.r.tkachuk@gmail.com>
+ *
+ * @brief CPython extension module ra02_native, native counterpart of ra02.py
+ *
+ * Exposes same Spi, Gpio, Timeout & Ra02 classes as ctypes bindings, with
+ * driver linked in. Calls, that do SPI/GPIO I/O or wait, release the GIL, so
+ * other Python threads (e.g. one calling Ra02.cancel) keep running during
+ * blocking receive. Errors raise exceptions of ra02.py (ra02.EXCEPTIONS),
+ * so ra02.py must be importable.
+ *
+ * Buffers are taken with buffer protocol: send accepts any bytes-like object
+ * (or sequence of ints), *_into calls write into caller-owned buffers.
+ *
+ *  ========================================================================= */
+
+/* Includes ================================================================= */
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <ra02.h>
+#include <spi.h>
+#include <gpio.h>
+#include <timeout.h>
+#include <error.h>
+#include <stdbool.h>
+#include <string.h>
+
+/* Defines ================================================================== */
+/** Module, that defines exception hierarchy */
+#define RA02_PY_EXCEPTIONS_MODULE "ra02"
+
+/* Macros =================================================================== */
+/**
+ * Run driver call without GIL
+ */
+#define RA02_PY_CALL(err, call)   \
+  do {                            \
+    Py_BEGIN_ALLOW_THREADS        \
+    (err) = (call);               \
+    Py_END_ALLOW_THREADS          \
+  } while (0)
+
+/**
+ * Run driver call on initialized Ra02 without GIL, deinit is refused meanwhile
+ */
+#define RA02_PY_IO(self, err, call)         \
+  do {                                      \
+    if (!(self)->initialized) {             \
+      return ra02_py_error(E_NULL);         \
+    }                                       \
+    (self)->users++;                        \
+    RA02_PY_CALL(err, call);                \
+    (self)->users--;                        \
+  } while (0)
+
+/**
+ * Return None or raise exception for error_t
+ */
+#define RA02_PY_RETURN(err)               \
+  do {                                    \
+    error_t __err = (err);                \
+    if (__err != E_OK) {                  \
+      return ra02_py_error(__err);        \
+    }                                     \
+    Py_RETURN_NONE;                       \
+  } while (0)
+
+/* Types ==================================================================== */
+/**
+ * Spi object
+ */
+typedef struct {
+  PyObject_HEAD
+  spi_t spi;
+  bool  initialized;
+} ra02_py_spi_t;
+
+/**
+ * Gpio object
+ */
+typedef struct {
+  PyObject_HEAD
+  gpio_t gpio;
+  bool   initialized;
+} ra02_py_gpio_t;
+
+/**
+ * Timeout object
+ */
+typedef struct {
+  PyObject_HEAD
+  timeout_t timeout;
+} ra02_py_timeout_t;
+
+/**
+ * Ra02 object
+ */
+typedef struct {
+  PyObject_HEAD
+  ra02_t     ra02;
+  bool       initialized;
+  int        users;                           /** Calls running without GIL */
+  PyObject * spi;                             /** Handles referenced by ra02, kept alive */
+  PyObject * dio0;
+  PyObject * dio1;
+  uint8_t    rx_buf[RA02_MAX_PACKET_SIZE];    /** Output of recv_start */
+  size_t     rx_size;
+} ra02_py_ra02_t;
+
+/* Variables ================================================================ */
+static PyTypeObject ra02_py_spi_type;
+static PyTypeObject ra02_py_gpio_type;
+static PyTypeObject ra02_py_timeout_type;
+static PyTypeObject ra02_py_ra02_type;
+
+/** ra02.EXCEPTIONS & ra02.InvalidErrorCodeException */
+static PyObject * ra02_py_exceptions = NULL;
+static PyObject * ra02_py_invalid_error = NULL;
+
+/** ra02.ra02_scan_sim_result_t, result of scan_simulate */
+static PyObject * ra02_py_scan_sim_result_type = NULL;
+
+/* Private functions ======================================================== */
+/**
+ * Raise exception of ra02.py for error_t, returns NULL
+ */
+static PyObject * ra02_py_error(error_t err) {
+  PyObject * code = PyLong_FromLong(err);
+
+  if (!code) {
+    return NULL;
+  }
+
+  PyObject * exception = PyDict_GetItemWithError(ra02_py_exceptions, code);
+
+  if (exception) {
+    PyErr_SetNone(exception);
+  } else if (!PyErr_Occurred()) {
+    PyErr_Format(ra02_py_invalid_error, "%d", err);
+  }
+
+  Py_DECREF(code);
+
+  return NULL;
+}
+
+/**
+ * Take read-only buffer of bytes-like object, other objects (sequence of
+ * ints, non-contiguous buffers) are converted to bytes first
+ *
+ * @return 0 on success, release with PyBuffer_Release
+ */
+static int ra02_py_tx_buffer(PyObject * data, Py_buffer * view) {
+  if (PyObject_GetBuffer(data, view, PyBUF_SIMPLE) == 0) {
+    return 0;
+  }
+
+  PyErr_Clear();
+
+  PyObject * bytes = PyBytes_FromObject(data);
+
+  if (!bytes) {
+    return -1;
+  }
+
+  int res = PyObject_GetBuffer(bytes, view, PyBUF_SIMPLE);
+
+  Py_DECREF(bytes);
+
+  return res;
+}
+
+/**
+ * Take writable buffer of struct, that must be exactly size bytes (e.g. ctypes structure from ra02.py)
+ *
+ * @return 0 on success, release with PyBuffer_Release
+ */
+static int ra02_py_struct_buffer(PyObject * obj, Py_buffer * view, size_t size, bool writable) {
+  if (PyObject_GetBuffer(obj, view, writable ? PyBUF_WRITABLE : PyBUF_SIMPLE) < 0) {
+    return -1;
+  }
+
+  if ((size_t) view->len != size) {
+    PyBuffer_Release(view);
+    PyErr_Format(PyExc_TypeError, "expected structure of %zu bytes, got %zd", size, view->len);
+    return -1;
+  }
+
+  return 0;
+}
+
+/**
+ * Check, that object is Timeout
+ */
+static timeout_t * ra02_py_timeout_arg(PyObject * obj) {
+  if (!PyObject_TypeCheck(obj, &ra02_py_timeout_type)) {
+    PyErr_SetString(PyExc_TypeError, "timeout must be Timeout");
+    return NULL;
+  }
+
+  return &((ra02_py_timeout_t *) obj)->timeout;
+}
+
+/* Spi ====================================================================== */
+static PyObject * ra02_py_spi_init_method(ra02_py_spi_t * self, PyObject * args) {
+  const char * spidev;
+
+  if (!PyArg_ParseTuple(args, "s", &spidev)) {
+    return NULL;
+  }
+
+  if (self->initialized) {
+    return ra02_py_error(E_BUSY);
+  }
+
+  spi_cfg_t cfg;
+  spi_cfg_default(&cfg);
+
+  error_t err = spi_init(&self->spi, &cfg, spidev);
+  self->initialized = err == E_OK;
+
+  RA02_PY_RETURN(err);
+}
+
+static PyObject * ra02_py_spi_deinit(ra02_py_spi_t * self, PyObject * Py_UNUSED(args)) {
+  if (!self->initialized) {
+    Py_RETURN_NONE;
+  }
+
+  self->initialized = false;
+
+  RA02_PY_RETURN(spi_deinit(&self->spi));
+}
+
+static PyObject * ra02_py_spi_transceive(ra02_py_spi_t * self, PyObject * data) {
+  Py_buffer tx;
+
+  if (ra02_py_tx_buffer(data, &tx) < 0) {
+    return NULL;
+  }
+
+  PyObject * rx = PyBytes_FromStringAndSize(NULL, tx.len);
+  PyObject * result = NULL;
+  error_t err;
+
+  if (rx) {
+    RA02_PY_CALL(err, spi_transcieve(&self->spi, tx.buf, (uint8_t *) PyBytes_AS_STRING(rx), tx.len));
+    result = err == E_OK ? PySequence_List(rx) : ra02_py_error(err);
+    Py_DECREF(rx);
+  }
+
+  PyBuffer_Release(&tx);
+
+  return result;
+}
+
+static int ra02_py_spi_tp_init(ra02_py_spi_t * self, PyObject * args, PyObject * kwargs) {
+  static char * keywords[] = {"spidev", NULL};
+  PyObject * spidev = Py_None;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|O", keywords, &spidev)) {
+    return -1;
+  }
+
+  if (spidev == Py_None) {
+    return 0;
+  }
+
+  PyObject * res = PyObject_CallMethod((PyObject *) self, "init", "O", spidev);
+  Py_XDECREF(res);
+
+  return res ? 0 : -1;
+}
+
+static void ra02_py_spi_dealloc(ra02_py_spi_t * self) {
+  if (self->initialized) {
+    spi_deinit(&self->spi);
+  }
+
+  Py_TYPE(self)->tp_free((PyObject *) self);
+}
+
+static PyObject * ra02_py_spi_address(ra02_py_spi_t * self, void * Py_UNUSED(closure)) {
+  return PyLong_FromVoidPtr(&self->spi);
+}
+
+static PyMethodDef ra02_py_spi_methods[] = {
+  {"init",       (PyCFunction) ra02_py_spi_init_method, METH_VARARGS, "init(spidev): open spidev"},
+  {"deinit",     (PyCFunction) ra02_py_spi_deinit,      METH_NOARGS,  "deinit(): close spidev"},
+  {"transceive", (PyCFunction) ra02_py_spi_transceive,  METH_O,       "transceive(data) -> list[int]: full-duplex transfer"},
+  {NULL},
+};
+
+static PyGetSetDef ra02_py_spi_getset[] = {
+  {"address", (getter) ra02_py_spi_address, NULL, "Address of spi_t, for C API through ctypes", NULL},
+  {NULL},
+};
+
+static PyTypeObject ra02_py_spi_type = {
+  PyVarObject_HEAD_INIT(NULL, 0)
+  .tp_name      = "ra02_native.Spi",
+  .tp_doc       = "Spi(spidev=None): spi_t and spi_* APIs from spi.h",
+  .tp_basicsize = sizeof(ra02_py_spi_t),
+  .tp_flags     = Py_TPFLAGS_DEFAULT,
+  .tp_new       = PyType_GenericNew,
+  .tp_init      = (initproc) ra02_py_spi_tp_init,
+  .tp_dealloc   = (destructor) ra02_py_spi_dealloc,
+  .tp_methods   = ra02_py_spi_methods,
+  .tp_getset    = ra02_py_spi_getset,
+};
+
+/* Gpio ===================================================================== */
+static PyObject * ra02_py_gpio_init_method(ra02_py_gpio_t * self, PyObject * args, PyObject * kwargs) {
+  static char * keywords[] = {"chip", "line", "edge", NULL};
+  const char * chip;
+  unsigned int line;
+  int edge = GPIO_EDGE_BOTH;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "sI|i", keywords, &chip, &line, &edge)) {
+    return NULL;
+  }
+
+  if (self->initialized) {
+    return ra02_py_error(E_BUSY);
+  }
+
+  error_t err = gpio_init(&self->gpio, chip, line, edge);
+  self->initialized = err == E_OK;
+
+  RA02_PY_RETURN(err);
+}
+
+static PyObject * ra02_py_gpio_deinit(ra02_py_gpio_t * self, PyObject * Py_UNUSED(args)) {
+  if (!self->initialized) {
+    Py_RETURN_NONE;
+  }
+
+  self->initialized = false;
+
+  RA02_PY_RETURN(gpio_deinit(&self->gpio));
+}
+
+static PyObject * ra02_py_gpio_get(ra02_py_gpio_t * self, PyObject * Py_UNUSED(args)) {
+  bool value = false;
+  error_t err = gpio_get(&self->gpio, &value);
+
+  return err == E_OK ? PyBool_FromLong(value) : ra02_py_error(err);
+}
+
+static int ra02_py_gpio_tp_init(ra02_py_gpio_t * self, PyObject * args, PyObject * kwargs) {
+  static char * keywords[] = {"chip", "line", "edge", NULL};
+  PyObject * chip = Py_None;
+  unsigned int line = 0;
+  int edge = GPIO_EDGE_BOTH;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|OIi", keywords, &chip, &line, &edge)) {
+    return -1;
+  }
+
+  if (chip == Py_None) {
+    return 0;
+  }
+
+  PyObject * res = PyObject_CallMethod((PyObject *) self, "init", "OIi", chip, line, edge);
+  Py_XDECREF(res);
+
+  return res ? 0 : -1;
+}
+
+static void ra02_py_gpio_dealloc(ra02_py_gpio_t * self) {
+  if (self->initialized) {
+    gpio_deinit(&self->gpio);
+  }
+
+  Py_TYPE(self)->tp_free((PyObject *) self);
+}
+
+static PyObject * ra02_py_gpio_address(ra02_py_gpio_t * self, void * Py_UNUSED(closure)) {
+  return PyLong_FromVoidPtr(&self->gpio);
+}
+
+static PyMethodDef ra02_py_gpio_methods[] = {
+  {"init",   (PyCFunction) (void (*)(void)) ra02_py_gpio_init_method, METH_VARARGS | METH_KEYWORDS,
+   "init(chip, line, edge=EDGE_BOTH): request line as input"},
+  {"deinit", (PyCFunction) ra02_py_gpio_deinit,      METH_NOARGS, "deinit(): release line"},
+  {"get",    (PyCFunction) ra02_py_gpio_get,         METH_NOARGS, "get() -> bool: line level"},
+  {NULL},
+};
+
+static PyGetSetDef ra02_py_gpio_getset[] = {
+  {"address", (getter) ra02_py_gpio_address, NULL, "Address of gpio_t, for C API through ctypes", NULL},
+  {NULL},
+};
+
+static PyTypeObject ra02_py_gpio_type = {
+  PyVarObject_HEAD_INIT(NULL, 0)
+  .tp_name      = "ra02_native.Gpio",
+  .tp_doc       = "Gpio(chip=None, line=0, edge=EDGE_BOTH): gpio_t and gpio_* APIs from gpio.h",
+  .tp_basicsize = sizeof(ra02_py_gpio_t),
+  .tp_flags     = Py_TPFLAGS_DEFAULT,
+  .tp_new       = PyType_GenericNew,
+  .tp_init      = (initproc) ra02_py_gpio_tp_init,
+  .tp_dealloc   = (destructor) ra02_py_gpio_dealloc,
+  .tp_methods   = ra02_py_gpio_methods,
+  .tp_getset    = ra02_py_gpio_getset,
+};
+
+/* Timeout ================================================================== */
+static PyObject * ra02_py_timeout_start(ra02_py_timeout_t * self, PyObject * arg) {
+  unsigned long long duration = PyLong_AsUnsignedLongLong(arg);
+
+  if (PyErr_Occurred()) {
+    return NULL;
+  }
+
+  timeout_start(&self->timeout, duration);
+
+  Py_RETURN_NONE;
+}
+
+static PyObject * ra02_py_timeout_restart(ra02_py_timeout_t * self, PyObject * Py_UNUSED(args)) {
+  timeout_restart(&self->timeout);
+
+  Py_RETURN_NONE;
+}
+
+static PyObject * ra02_py_timeout_is_expired(ra02_py_timeout_t * self, PyObject * Py_UNUSED(args)) {
+  return PyBool_FromLong(timeout_is_expired(&self->timeout));
+}
+
+static PyObject * ra02_py_timeout_expire(ra02_py_timeout_t * self, PyObject * Py_UNUSED(args)) {
+  timeout_expire(&self->timeout);
+
+  Py_RETURN_NONE;
+}
+
+static PyObject * ra02_py_timeout_now_ns(PyObject * Py_UNUSED(cls), PyObject * Py_UNUSED(args)) {
+  return PyLong_FromUnsignedLongLong(timeout_now_ns());
+}
+
+static int ra02_py_timeout_tp_init(ra02_py_timeout_t * self, PyObject * args, PyObject * kwargs) {
+  static char * keywords[] = {"duration", NULL};
+  unsigned long long duration = 0;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|K", keywords, &duration)) {
+    return -1;
+  }
+
+  if (duration) {
+    timeout_start(&self->timeout, duration);
+  }
+
+  return 0;
+}
+
+static PyMethodDef ra02_py_timeout_methods[] = {
+  {"start",      (PyCFunction) ra02_py_timeout_start,      METH_O,      "start(duration): start timeout of duration ms"},
+  {"restart",    (PyCFunction) ra02_py_timeout_restart,    METH_NOARGS, "restart(): restart with same duration"},
+  {"is_expired", (PyCFunction) ra02_py_timeout_is_expired, METH_NOARGS, "is_expired() -> bool"},
+  {"expire",     (PyCFunction) ra02_py_timeout_expire,     METH_NOARGS, "expire(): force expire"},
+  {"now_ns",     (PyCFunction) ra02_py_timeout_now_ns,     METH_NOARGS | METH_STATIC,
+   "now_ns() -> int: driver clock (CLOCK_MONOTONIC by default) in ns"},
+  {NULL},
+};
+
+static PyTypeObject ra02_py_timeout_type = {
+  PyVarObject_HEAD_INIT(NULL, 0)
+  .tp_name      = "ra02_native.Timeout",
+  .tp_doc       = "Timeout(duration=0): timeout_t and timeout_* APIs from timeout.h",
+  .tp_basicsize = sizeof(ra02_py_timeout_t),
+  .tp_flags     = Py_TPFLAGS_DEFAULT,
+  .tp_new       = PyType_GenericNew,
+  .tp_init      = (initproc) ra02_py_timeout_tp_init,
+  .tp_methods   = ra02_py_timeout_methods,
+};
+
+/* Ra02 ===================================================================== */
+static PyObject * ra02_py_ra02_init_method(ra02_py_ra02_t * self, PyObject * args, PyObject * kwargs) {
+  static char * keywords[] = {"spi", "dio0", "dio1", NULL};
+  PyObject * spi;
+  PyObject * dio0 = Py_None;
+  PyObject * dio1 = Py_None;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!|OO", keywords, &ra02_py_spi_type, &spi, &dio0, &dio1)) {
+    return NULL;
+  }
+
+  PyObject * dios[] = {dio0, dio1};
+
+  for (size_t i = 0; i < 2; ++i) {
+    if (dios[i] != Py_None && !PyObject_TypeCheck(dios[i], &ra02_py_gpio_type)) {
+      PyErr_SetString(PyExc_TypeError, "dio must be Gpio or None");
+      return NULL;
+    }
+  }
+
+  if (self->initialized) {
+    return ra02_py_error(E_BUSY);
+  }
+
+  ra02_cfg_t cfg = {
+    .spi  = &((ra02_py_spi_t *) spi)->spi,
+    .dio0 = dio0 != Py_None ? &((ra02_py_gpio_t *) dio0)->gpio : NULL,
+    .dio1 = dio1 != Py_None ? &((ra02_py_gpio_t *) dio1)->gpio : NULL,
+  };
+
+  Py_INCREF(spi);
+  Py_INCREF(dio0);
+  Py_INCREF(dio1);
+  Py_XSETREF(self->spi, spi);
+  Py_XSETREF(self->dio0, dio0);
+  Py_XSETREF(self->dio1, dio1);
+
+  error_t err;
+  RA02_PY_CALL(err, ra02_init(&self->ra02, &cfg));
+
+  self->initialized = err == E_OK;
+
+  RA02_PY_RETURN(err);
+}
+
+static PyObject * ra02_py_ra02_deinit(ra02_py_ra02_t * self, PyObject * Py_UNUSED(args)) {
+  if (!self->initialized) {
+    Py_RETURN_NONE;
+  }
+
+  if (self->users) {
+    return ra02_py_error(E_BUSY);
+  }
+
+  self->initialized = false;
+
+  RA02_PY_RETURN(ra02_deinit(&self->ra02));
+}
+
+static PyObject * ra02_py_ra02_reset(ra02_py_ra02_t * self, PyObject * Py_UNUSED(args)) {
+  error_t err;
+  RA02_PY_IO(self, err, ra02_reset(&self->ra02));
+  RA02_PY_RETURN(err);
+}
+
+static PyObject * ra02_py_ra02_sleep(ra02_py_ra02_t * self, PyObject * Py_UNUSED(args)) {
+  error_t err;
+  RA02_PY_IO(self, err, ra02_sleep(&self->ra02));
+  RA02_PY_RETURN(err);
+}
+
+static PyObject * ra02_py_ra02_set_modem(ra02_py_ra02_t * self, PyObject * args) {
+  int modem;
+
+  if (!PyArg_ParseTuple(args, "i", &modem)) {
+    return NULL;
+  }
+
+  error_t err;
+  RA02_PY_IO(self, err, ra02_set_modem(&self->ra02, modem));
+  RA02_PY_RETURN(err);
+}
+
+static PyObject * ra02_py_ra02_set_freq(ra02_py_ra02_t * self, PyObject * args) {
+  unsigned int khz;
+
+  if (!PyArg_ParseTuple(args, "I", &khz)) {
+    return NULL;
+  }
+
+  error_t err;
+  RA02_PY_IO(self, err, ra02_set_freq(&self->ra02, khz));
+  RA02_PY_RETURN(err);
+}
+
+static PyObject * ra02_py_ra02_get_power(ra02_py_ra02_t * self, PyObject * Py_UNUSED(args)) {
+  uint8_t db = 0;
+  error_t err;
+  RA02_PY_IO(self, err, ra02_get_power(&self->ra02, &db));
+
+  return err == E_OK ? PyLong_FromLong(db) : ra02_py_error(err);
+}
+
+static PyObject * ra02_py_ra02_set_power(ra02_py_ra02_t * self, PyObject * args) {
+  unsigned char db;
+
+  if (!PyArg_ParseTuple(args, "b", &db)) {
+    return NULL;
+  }
+
+  error_t err;
+  RA02_PY_IO(self, err, ra02_set_power(&self->ra02, db));
+  RA02_PY_RETURN(err);
+}
+
+static PyObject * ra02_py_ra02_set_sync_word(ra02_py_ra02_t * self, PyObject * args) {
+  unsigned int sync_word;
+
+  if (!PyArg_ParseTuple(args, "I", &sync_word)) {
+    return NULL;
+  }
+
+  error_t err;
+  RA02_PY_IO(self, err, ra02_set_sync_word(&self->ra02, sync_word));
+  RA02_PY_RETURN(err);
+}
+
+static PyObject * ra02_py_ra02_set_invert_iq(ra02_py_ra02_t * self, PyObject * args) {
+  int on;
+
+  if (!PyArg_ParseTuple(args, "p", &on)) {
+    return NULL;
+  }
+
+  error_t err;
+  RA02_PY_IO(self, err, ra02_set_invert_iq(&self->ra02, on));
+  RA02_PY_RETURN(err);
+}
+
+static PyObject * ra02_py_ra02_set_baudrate(ra02_py_ra02_t * self, PyObject * args) {
+  unsigned int baudrate;
+
+  if (!PyArg_ParseTuple(args, "I", &baudrate)) {
+    return NULL;
+  }
+
+  error_t err;
+  RA02_PY_IO(self, err, ra02_set_baudrate(&self->ra02, baudrate));
+  RA02_PY_RETURN(err);
+}
+
+static PyObject * ra02_py_ra02_set_fdev(ra02_py_ra02_t * self, PyObject * args) {
+  unsigned int fdev;
+
+  if (!PyArg_ParseTuple(args, "I", &fdev)) {
+    return NULL;
+  }
+
+  error_t err;
+  RA02_PY_IO(self, err, ra02_set_fdev(&self->ra02, fdev));
+  RA02_PY_RETURN(err);
+}
+
+static PyObject * ra02_py_ra02_set_fsk_packet_cfg(ra02_py_ra02_t * self, PyObject * args, PyObject * kwargs) {
+  static char * keywords[] = {"sync_word", "sync_size", "whitening", "crc", NULL};
+  unsigned int sync_word = 0x2DD4;
+  unsigned char sync_size = 2;
+  int whitening = true;
+  int crc = true;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|Ibpp", keywords, &sync_word, &sync_size, &whitening, &crc)) {
+    return NULL;
+  }
+
+  ra02_fsk_packet_cfg_t cfg = {
+    .sync_word = sync_word,
+    .sync_size = sync_size,
+    .whitening = whitening,
+    .crc       = crc,
+  };
+
+  error_t err;
+  RA02_PY_IO(self, err, ra02_set_fsk_packet_cfg(&self->ra02, &cfg));
+  RA02_PY_RETURN(err);
+}
+
+static PyObject * ra02_py_ra02_set_bandwidth(ra02_py_ra02_t * self, PyObject * args) {
+  unsigned int bandwidth;
+
+  if (!PyArg_ParseTuple(args, "I", &bandwidth)) {
+    return NULL;
+  }
+
+  error_t err;
+  RA02_PY_IO(self, err, ra02_set_bandwidth(&self->ra02, bandwidth));
+  RA02_PY_RETURN(err);
+}
+
+static PyObject * ra02_py_ra02_set_preamble(ra02_py_ra02_t * self, PyObject * args) {
+  unsigned int preamble;
+
+  if (!PyArg_ParseTuple(args, "I", &preamble)) {
+    return NULL;
+  }
+
+  error_t err;
+  RA02_PY_IO(self, err, ra02_set_preamble(&self->ra02, preamble));
+  RA02_PY_RETURN(err);
+}
+
+static PyObject * ra02_py_ra02_set_sf(ra02_py_ra02_t * self, PyObject * args) {
+  unsigned char sf;
+
+  if (!PyArg_ParseTuple(args, "b", &sf)) {
+    return NULL;
+  }
+
+  error_t err;
+  RA02_PY_IO(self, err, ra02_set_sf(&self->ra02, sf));
+  RA02_PY_RETURN(err);
+}
+
+static PyObject * ra02_py_ra02_set_frame_cfg(ra02_py_ra02_t * self, PyObject * args, PyObject * kwargs) {
+  static char * keywords[] = {"implicit_header", "payload_len", "crc_rate", "crc", NULL};
+  int implicit_header = false;
+  unsigned char payload_len = 0;
+  int crc_rate = RA02_CRC_RATE_4_7;
+  int crc = false;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|pbip", keywords, &implicit_header, &payload_len, &crc_rate, &crc)) {
+    return NULL;
+  }
+
+  ra02_frame_cfg_t cfg = {
+    .implicit_header = implicit_header,
+    .payload_len     = payload_len,
+    .crc_rate        = crc_rate,
+    .crc             = crc,
+  };
+
+  error_t err;
+  RA02_PY_IO(self, err, ra02_set_frame_cfg(&self->ra02, &cfg));
+  RA02_PY_RETURN(err);
+}
+
+static PyObject * ra02_py_ra02_get_time_on_air(ra02_py_ra02_t * self, PyObject * args) {
+  Py_ssize_t size;
+
+  if (!PyArg_ParseTuple(args, "n", &size)) {
+    return NULL;
+  }
+
+  uint32_t us = 0;
+  error_t err = ra02_get_time_on_air(&self->ra02, size, &us);
+
+  return err == E_OK ? PyLong_FromUnsignedLong(us) : ra02_py_error(err);
+}
+
+static PyObject * ra02_py_ra02_get_rssi(ra02_py_ra02_t * self, PyObject * Py_UNUSED(args)) {
+  int8_t rssi = 0;
+  error_t err = ra02_get_rssi(&self->ra02, &rssi);
+
+  return err == E_OK ? PyLong_FromLong(rssi) : ra02_py_error(err);
+}
+
+static PyObject * ra02_py_ra02_poll_irq_flags(ra02_py_ra02_t * self, PyObject * Py_UNUSED(args)) {
+  error_t err;
+  RA02_PY_IO(self, err, ra02_poll_irq_flags(&self->ra02));
+  RA02_PY_RETURN(err);
+}
+
+static PyObject * ra02_py_ra02_send(ra02_py_ra02_t * self, PyObject * data) {
+  Py_buffer view;
+
+  if (ra02_py_tx_buffer(data, &view) < 0) {
+    return NULL;
+  }
+
+  error_t err = E_NULL;
+
+  if (self->initialized) {
+    RA02_PY_IO(self, err, ra02_send(&self->ra02, view.buf, view.len));
+  }
+
+  PyBuffer_Release(&view);
+
+  RA02_PY_RETURN(err);
+}
+
+static PyObject * ra02_py_ra02_send_at(ra02_py_ra02_t * self, PyObject * args) {
+  PyObject * data;
+  unsigned long long at_ns;
+  unsigned long long max_late_ns = RA02_SEND_AT_MAX_LATE_NS;
+  Py_buffer view;
+
+  if (!PyArg_ParseTuple(args, "OK|K", &data, &at_ns, &max_late_ns) || ra02_py_tx_buffer(data, &view) < 0) {
+    return NULL;
+  }
+
+  error_t err = E_NULL;
+
+  if (self->initialized) {
+    RA02_PY_IO(self, err, ra02_send_at(&self->ra02, view.buf, view.len, at_ns, max_late_ns));
+  }
+
+  PyBuffer_Release(&view);
+
+  RA02_PY_RETURN(err);
+}
+
+static PyObject * ra02_py_ra02_last_rx_ns(ra02_py_ra02_t * self, PyObject * Py_UNUSED(args)) {
+  return PyLong_FromUnsignedLongLong(self->ra02.last_rx_ns);
+}
+
+static PyObject * ra02_py_ra02_recv(ra02_py_ra02_t * self, PyObject * arg) {
+  timeout_t * timeout = ra02_py_timeout_arg(arg);
+
+  if (!timeout) {
+    return NULL;
+  }
+
+  uint8_t buf[RA02_MAX_PACKET_SIZE];
+  size_t size = sizeof(buf);
+  error_t err;
+  RA02_PY_IO(self, err, ra02_recv(&self->ra02, buf, &size, timeout));
+
+  return err == E_OK ? PyBytes_FromStringAndSize((char *) buf, size) : ra02_py_error(err);
+}
+
+static PyObject * ra02_py_ra02_recv_into(ra02_py_ra02_t * self, PyObject * args) {
+  Py_buffer view;
+  PyObject * arg;
+
+  if (!PyArg_ParseTuple(args, "w*O", &view, &arg)) {
+    return NULL;
+  }
+
+  timeout_t * timeout = ra02_py_timeout_arg(arg);
+  size_t size = view.len;
+  error_t err = E_NULL;
+
+  if (timeout && self->initialized) {
+    RA02_PY_IO(self, err, ra02_recv(&self->ra02, view.buf, &size, timeout));
+  }
+
+  PyBuffer_Release(&view);
+
+  if (!timeout) {
+    return NULL;
+  }
+
+  return err == E_OK ? PyLong_FromSize_t(size) : ra02_py_error(err);
+}
+
+static PyObject * ra02_py_ra02_send_start(ra02_py_ra02_t * self, PyObject * data) {
+  Py_buffer view;
+
+  if (ra02_py_tx_buffer(data, &view) < 0) {
+    return NULL;
+  }
+
+  /* Frame is in FIFO when start returns, buffer isn't referenced afterwards */
+  error_t err = E_NULL;
+
+  if (self->initialized) {
+    RA02_PY_IO(self, err, ra02_send_start(&self->ra02, view.buf, view.len));
+  }
+
+  PyBuffer_Release(&view);
+
+  RA02_PY_RETURN(err);
+}
+
+static PyObject * ra02_py_ra02_recv_start(ra02_py_ra02_t * self, PyObject * args) {
+  unsigned int timeout_ms = 0;
+
+  if (!PyArg_ParseTuple(args, "|I", &timeout_ms)) {
+    return NULL;
+  }
+
+  /* Driver writes into them until reception completes */
+  self->rx_size = sizeof(self->rx_buf);
+
+  error_t err;
+  RA02_PY_IO(self, err, ra02_recv_start(&self->ra02, self->rx_buf, &self->rx_size, timeout_ms));
+  RA02_PY_RETURN(err);
+}
+
+static PyObject * ra02_py_ra02_step(ra02_py_ra02_t * self, PyObject * Py_UNUSED(args)) {
+  bool rx = self->ra02.async.state == RA02_STATE_RX;
+  uint64_t wake_ns = 0;
+  error_t err;
+  RA02_PY_IO(self, err, ra02_step(&self->ra02, &wake_ns));
+
+  if (err == E_AGAIN) {
+    return Py_BuildValue("OKO", Py_False, (unsigned long long) wake_ns, Py_None);
+  }
+
+  if (err != E_OK) {
+    return ra02_py_error(err);
+  }
+
+  if (rx) {
+    return Py_BuildValue("OKy#", Py_True, (unsigned long long) wake_ns, self->rx_buf, (Py_ssize_t) self->rx_size);
+  }
+
+  return Py_BuildValue("OKO", Py_True, (unsigned long long) wake_ns, Py_None);
+}
+
+static PyObject * ra02_py_ra02_cancel(ra02_py_ra02_t * self, PyObject * Py_UNUSED(args)) {
+  if (!self->initialized) {
+    return ra02_py_error(E_NULL);
+  }
+
+  RA02_PY_RETURN(ra02_cancel(&self->ra02));
+}
+
+static PyObject * ra02_py_ra02_cad(ra02_py_ra02_t * self, PyObject * Py_UNUSED(args)) {
+  bool detected = false;
+  error_t err;
+  RA02_PY_IO(self, err, ra02_cad(&self->ra02, &detected));
+
+  return err == E_OK ? PyBool_FromLong(detected) : ra02_py_error(err);
+}
+
+static PyObject * ra02_py_ra02_listen(ra02_py_ra02_t * self, PyObject * args) {
+  unsigned int khz;
+
+  if (!PyArg_ParseTuple(args, "I", &khz)) {
+    return NULL;
+  }
+
+  error_t err;
+  RA02_PY_IO(self, err, ra02_listen(&self->ra02, khz));
+  RA02_PY_RETURN(err);
+}
+
+static PyObject * ra02_py_ra02_sample_rssi(ra02_py_ra02_t * self, PyObject * args) {
+  Py_ssize_t count;
+  unsigned short interval_us = 0;
+
+  if (!PyArg_ParseTuple(args, "n|H", &count, &interval_us)) {
+    return NULL;
+  }
+
+  if (count < 0) {
+    return ra02_py_error(E_INVAL);
+  }
+
+  int8_t * rssi = PyMem_Malloc(count ? count : 1);
+
+  if (!rssi) {
+    return PyErr_NoMemory();
+  }
+
+  PyObject * result = NULL;
+  error_t err = E_NULL;
+
+  if (self->initialized) {
+    RA02_PY_IO(self, err, ra02_sample_rssi(&self->ra02, rssi, NULL, count, interval_us));
+  }
+
+  if (err == E_OK) {
+    result = PyList_New(count);
+
+    for (Py_ssize_t i = 0; result && i < count; ++i) {
+      PyList_SET_ITEM(result, i, PyLong_FromLong(rssi[i]));
+    }
+  } else {
+    ra02_py_error(err);
+  }
+
+  PyMem_Free(rssi);
+
+  return result;
+}
+
+static PyObject * ra02_py_ra02_send_wor(ra02_py_ra02_t * self, PyObject * args) {
+  unsigned int period_ms;
+  PyObject * data;
+  Py_buffer view;
+
+  if (!PyArg_ParseTuple(args, "IO", &period_ms, &data) || ra02_py_tx_buffer(data, &view) < 0) {
+    return NULL;
+  }
+
+  error_t err = E_NULL;
+
+  if (self->initialized) {
+    RA02_PY_IO(self, err, ra02_send_wor(&self->ra02, period_ms, view.buf, view.len));
+  }
+
+  PyBuffer_Release(&view);
+
+  RA02_PY_RETURN(err);
+}
+
+static PyObject * ra02_py_ra02_recv_wor(ra02_py_ra02_t * self, PyObject * args) {
+  unsigned int period_ms;
+  PyObject * arg;
+  PyObject * stats_obj = Py_None;
+
+  if (!PyArg_ParseTuple(args, "IO|O", &period_ms, &arg, &stats_obj)) {
+    return NULL;
+  }
+
+  timeout_t * timeout = ra02_py_timeout_arg(arg);
+
+  if (!timeout) {
+    return NULL;
+  }
+
+  /* Stats object (ra02.ra02_wor_stats_t) is accumulated in place */
+  ra02_wor_stats_t local = {0};
+  Py_buffer stats = {.buf = &local};
+
+  if (stats_obj != Py_None && ra02_py_struct_buffer(stats_obj, &stats, sizeof(local), true) < 0) {
+    return NULL;
+  }
+
+  uint8_t buf[RA02_MAX_PACKET_SIZE];
+  size_t size = sizeof(buf);
+  error_t err = E_NULL;
+
+  if (self->initialized) {
+    RA02_PY_IO(self, err, ra02_recv_wor(&self->ra02, period_ms, buf, &size, timeout, stats.buf));
+  }
+
+  if (stats_obj != Py_None) {
+    PyBuffer_Release(&stats);
+  }
+
+  return err == E_OK ? PyBytes_FromStringAndSize((char *) buf, size) : ra02_py_error(err);
+}
+
+static PyObject * ra02_py_ra02_get_scan_preamble(ra02_py_ra02_t * self, PyObject * args) {
+  unsigned short sf_mask;
+  unsigned char sf;
+
+  if (!PyArg_ParseTuple(args, "Hb", &sf_mask, &sf)) {
+    return NULL;
+  }
+
+  uint16_t symbols = 0;
+  error_t err = ra02_get_scan_preamble(&self->ra02, sf_mask, sf, &symbols);
+
+  return err == E_OK ? PyLong_FromLong(symbols) : ra02_py_error(err);
+}
+
+static PyObject * ra02_py_ra02_recv_scan(ra02_py_ra02_t * self, PyObject * args) {
+  unsigned short sf_mask;
+  PyObject * arg;
+  PyObject * stats_obj = Py_None;
+
+  if (!PyArg_ParseTuple(args, "HO|O", &sf_mask, &arg, &stats_obj)) {
+    return NULL;
+  }
+
+  timeout_t * timeout = ra02_py_timeout_arg(arg);
+
+  if (!timeout) {
+    return NULL;
+  }
+
+  /* Stats object (ra02.ra02_scan_stats_t) is accumulated in place */
+  ra02_scan_stats_t local = {0};
+  Py_buffer stats = {.buf = &local};
+
+  if (stats_obj != Py_None && ra02_py_struct_buffer(stats_obj, &stats, sizeof(local), true) < 0) {
+    return NULL;
+  }
+
+  uint8_t buf[RA02_MAX_PACKET_SIZE];
+  size_t size = sizeof(buf);
+  uint8_t sf = 0;
+  error_t err = E_NULL;
+
+  if (self->initialized) {
+    RA02_PY_IO(self, err, ra02_recv_scan(&self->ra02, sf_mask, buf, &size, &sf, timeout, stats.buf));
+  }
+
+  if (stats_obj != Py_None) {
+    PyBuffer_Release(&stats);
+  }
+
+  return err == E_OK ? Py_BuildValue("y#i", buf, (Py_ssize_t) size, sf) : ra02_py_error(err);
+}
+
+static PyObject * ra02_py_ra02_scan_simulate(ra02_py_ra02_t * self, PyObject * cfg_obj) {
+  Py_buffer cfg;
+
+  if (ra02_py_struct_buffer(cfg_obj, &cfg, sizeof(ra02_scan_sim_cfg_t), false) < 0) {
+    return NULL;
+  }
+
+  PyObject * result = PyObject_CallNoArgs(ra02_py_scan_sim_result_type);
+  Py_buffer view;
+
+  if (result && ra02_py_struct_buffer(result, &view, sizeof(ra02_scan_sim_result_t), true) == 0) {
+    error_t err;
+    RA02_PY_CALL(err, ra02_scan_simulate(&self->ra02, cfg.buf, view.buf));
+    PyBuffer_Release(&view);
+
+    if (err != E_OK) {
+      Py_CLEAR(result);
+      ra02_py_error(err);
+    }
+  } else {
+    Py_CLEAR(result);
+  }
+
+  PyBuffer_Release(&cfg);
+
+  return result;
+}
+
+static PyObject * ra02_py_ra02_get_window_symbols(ra02_py_ra02_t * self, PyObject * args) {
+  unsigned int ms;
+
+  if (!PyArg_ParseTuple(args, "I", &ms)) {
+    return NULL;
+  }
+
+  uint16_t symbols = 0;
+  error_t err = ra02_get_window_symbols(&self->ra02, ms, &symbols);
+
+  return err == E_OK ? PyLong_FromLong(symbols) : ra02_py_error(err);
+}
+
+static PyObject * ra02_py_ra02_recv_window(ra02_py_ra02_t * self, PyObject * args) {
+  unsigned short symbols;
+
+  if (!PyArg_ParseTuple(args, "H", &symbols)) {
+    return NULL;
+  }
+
+  uint8_t buf[RA02_MAX_PACKET_SIZE];
+  size_t size = sizeof(buf);
+  error_t err;
+  RA02_PY_IO(self, err, ra02_recv_window(&self->ra02, buf, &size, symbols));
+
+  return err == E_OK ? PyBytes_FromStringAndSize((char *) buf, size) : ra02_py_error(err);
+}
+
+static PyObject * ra02_py_ra02_send_stream(ra02_py_ra02_t * self, PyObject * data) {
+  Py_buffer view;
+
+  if (ra02_py_tx_buffer(data, &view) < 0) {
+    return NULL;
+  }
+
+  error_t err = E_NULL;
+
+  if (self->initialized) {
+    RA02_PY_IO(self, err, ra02_send_stream(&self->ra02, view.buf, view.len));
+  }
+
+  PyBuffer_Release(&view);
+
+  RA02_PY_RETURN(err);
+}
+
+static PyObject * ra02_py_ra02_recv_stream(ra02_py_ra02_t * self, PyObject * args) {
+  Py_ssize_t size;
+  PyObject * arg;
+
+  if (!PyArg_ParseTuple(args, "nO", &size, &arg)) {
+    return NULL;
+  }
+
+  timeout_t * timeout = ra02_py_timeout_arg(arg);
+
+  if (!timeout) {
+    return NULL;
+  }
+
+  if (size < 0) {
+    return ra02_py_error(E_INVAL);
+  }
+
+  /* Not shared until returned, so driver may fill it without GIL */
+  PyObject * frame = PyBytes_FromStringAndSize(NULL, size);
+
+  if (!frame) {
+    return NULL;
+  }
+
+  error_t err = E_NULL;
+
+  if (self->initialized) {
+    RA02_PY_IO(self, err, ra02_recv_stream(&self->ra02, (uint8_t *) PyBytes_AS_STRING(frame), size, timeout));
+  }
+
+  if (err != E_OK) {
+    Py_DECREF(frame);
+    return ra02_py_error(err);
+  }
+
+  return frame;
+}
+
+static PyObject * ra02_py_ra02_recv_stream_into(ra02_py_ra02_t * self, PyObject * args) {
+  Py_buffer view;
+  PyObject * arg;
+
+  if (!PyArg_ParseTuple(args, "w*O", &view, &arg)) {
+    return NULL;
+  }
+
+  timeout_t * timeout = ra02_py_timeout_arg(arg);
+  error_t err = E_NULL;
+
+  if (timeout && self->initialized) {
+    RA02_PY_IO(self, err, ra02_recv_stream(&self->ra02, view.buf, view.len, timeout));
+  }
+
+  PyBuffer_Release(&view);
+
+  if (!timeout) {
+    return NULL;
+  }
+
+  RA02_PY_RETURN(err);
+}
+
+static int ra02_py_ra02_tp_init(ra02_py_ra02_t * self, PyObject * args, PyObject * kwargs) {
+  static char * keywords[] = {"spi", "dio0", "dio1", NULL};
+  PyObject * spi = Py_None;
+  PyObject * dio0 = Py_None;
+  PyObject * dio1 = Py_None;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|OOO", keywords, &spi, &dio0, &dio1)) {
+    return -1;
+  }
+
+  if (spi == Py_None) {
+    return 0;
+  }
+
+  PyObject * res = PyObject_CallMethod((PyObject *) self, "init", "OOO", spi, dio0, dio1);
+  Py_XDECREF(res);
+
+  return res ? 0 : -1;
+}
+
+static void ra02_py_ra02_dealloc(ra02_py_ra02_t * self) {
+  if (self->initialized) {
+    ra02_deinit(&self->ra02);
+  }
+
+  Py_XDECREF(self->spi);
+  Py_XDECREF(self->dio0);
+  Py_XDECREF(self->dio1);
+
+  Py_TYPE(self)->tp_free((PyObject *) self);
+}
+
+static PyObject * ra02_py_ra02_address(ra02_py_ra02_t * self, void * Py_UNUSED(closure)) {
+  return PyLong_FromVoidPtr(&self->ra02);
+}
+
+static PyMethodDef ra02_py_ra02_methods[] = {
+  {"init",               (PyCFunction) (void (*)(void)) ra02_py_ra02_init_method,       METH_VARARGS | METH_KEYWORDS,
+   "init(spi, dio0=None, dio1=None): initialize driver"},
+  {"deinit",             (PyCFunction) ra02_py_ra02_deinit,            METH_NOARGS,  "deinit(): deinitialize driver"},
+  {"reset",              (PyCFunction) ra02_py_ra02_reset,             METH_NOARGS,  "reset(): reset module"},
+  {"sleep",              (PyCFunction) ra02_py_ra02_sleep,             METH_NOARGS,  "sleep(): go to sleep mode"},
+  {"set_modem",          (PyCFunction) ra02_py_ra02_set_modem,         METH_VARARGS, "set_modem(modem): MODEM_LORA or MODEM_FSK"},
+  {"set_freq",           (PyCFunction) ra02_py_ra02_set_freq,          METH_VARARGS, "set_freq(khz)"},
+  {"get_power",          (PyCFunction) ra02_py_ra02_get_power,         METH_NOARGS,  "get_power() -> int: output power in dB"},
+  {"set_power",          (PyCFunction) ra02_py_ra02_set_power,         METH_VARARGS, "set_power(db)"},
+  {"set_sync_word",      (PyCFunction) ra02_py_ra02_set_sync_word,     METH_VARARGS, "set_sync_word(sync_word)"},
+  {"set_invert_iq",      (PyCFunction) ra02_py_ra02_set_invert_iq,     METH_VARARGS, "set_invert_iq(on): LoRa only"},
+  {"set_baudrate",       (PyCFunction) ra02_py_ra02_set_baudrate,      METH_VARARGS, "set_baudrate(baudrate): FSK only"},
+  {"set_fdev",           (PyCFunction) ra02_py_ra02_set_fdev,          METH_VARARGS, "set_fdev(hz): FSK only"},
+  {"set_fsk_packet_cfg", (PyCFunction) (void (*)(void)) ra02_py_ra02_set_fsk_packet_cfg, METH_VARARGS | METH_KEYWORDS,
+   "set_fsk_packet_cfg(sync_word=0x2DD4, sync_size=2, whitening=True, crc=True)"},
+  {"set_bandwidth",      (PyCFunction) ra02_py_ra02_set_bandwidth,     METH_VARARGS, "set_bandwidth(hz)"},
+  {"set_preamble",       (PyCFunction) ra02_py_ra02_set_preamble,      METH_VARARGS, "set_preamble(preamble)"},
+  {"set_sf",             (PyCFunction) ra02_py_ra02_set_sf,            METH_VARARGS, "set_sf(sf)"},
+  {"set_frame_cfg",      (PyCFunction) (void (*)(void)) ra02_py_ra02_set_frame_cfg,     METH_VARARGS | METH_KEYWORDS,
+   "set_frame_cfg(implicit_header=False, payload_len=0, crc_rate=CRC_RATE_4_7, crc=False)"},
+  {"get_time_on_air",    (PyCFunction) ra02_py_ra02_get_time_on_air,   METH_VARARGS, "get_time_on_air(size) -> int: us"},
+  {"get_rssi",           (PyCFunction) ra02_py_ra02_get_rssi,          METH_NOARGS,  "get_rssi() -> int: RSSI of last frame"},
+  {"poll_irq_flags",     (PyCFunction) ra02_py_ra02_poll_irq_flags,    METH_NOARGS,  "poll_irq_flags()"},
+  {"send",               (PyCFunction) ra02_py_ra02_send,              METH_O,       "send(data): data is bytes-like or sequence of ints"},
+  {"send_at",            (PyCFunction) ra02_py_ra02_send_at,           METH_VARARGS, "send_at(data, at_ns, max_late_ns=SEND_AT_MAX_LATE_NS)"},
+  {"last_rx_ns",         (PyCFunction) ra02_py_ra02_last_rx_ns,        METH_NOARGS,  "last_rx_ns() -> int"},
+  {"recv",               (PyCFunction) ra02_py_ra02_recv,              METH_O,       "recv(timeout) -> bytes"},
+  {"recv_into",          (PyCFunction) ra02_py_ra02_recv_into,         METH_VARARGS,
+   "recv_into(buffer, timeout) -> int: receive into writable buffer, returns size"},
+  {"send_start",         (PyCFunction) ra02_py_ra02_send_start,        METH_O,       "send_start(data): complete with step"},
+  {"recv_start",         (PyCFunction) ra02_py_ra02_recv_start,        METH_VARARGS, "recv_start(timeout_ms=0): complete with step"},
+  {"step",               (PyCFunction) ra02_py_ra02_step,              METH_NOARGS,  "step() -> (done, wake_ns, frame)"},
+  {"cancel",             (PyCFunction) ra02_py_ra02_cancel,            METH_NOARGS,  "cancel(): cancel blocking call of other thread"},
+  {"cad",                (PyCFunction) ra02_py_ra02_cad,               METH_NOARGS,  "cad() -> bool"},
+  {"listen",             (PyCFunction) ra02_py_ra02_listen,            METH_VARARGS, "listen(khz)"},
+  {"sample_rssi",        (PyCFunction) ra02_py_ra02_sample_rssi,       METH_VARARGS, "sample_rssi(count, interval_us=0) -> list[int]"},
+  {"send_wor",           (PyCFunction) ra02_py_ra02_send_wor,          METH_VARARGS, "send_wor(period_ms, data)"},
+  {"recv_wor",           (PyCFunction) ra02_py_ra02_recv_wor,          METH_VARARGS,
+   "recv_wor(period_ms, timeout, stats=None) -> bytes: stats is ra02.ra02_wor_stats_t"},
+  {"get_scan_preamble",  (PyCFunction) ra02_py_ra02_get_scan_preamble, METH_VARARGS, "get_scan_preamble(sf_mask, sf) -> int"},
+  {"recv_scan",          (PyCFunction) ra02_py_ra02_recv_scan,         METH_VARARGS,
+   "recv_scan(sf_mask, timeout, stats=None) -> (bytes, sf): stats is ra02.ra02_scan_stats_t"},
+  {"scan_simulate",      (PyCFunction) ra02_py_ra02_scan_simulate,     METH_O,
+   "scan_simulate(cfg) -> ra02.ra02_scan_sim_result_t: cfg is ra02.ra02_scan_sim_cfg_t"},
+  {"get_window_symbols", (PyCFunction) ra02_py_ra02_get_window_symbols, METH_VARARGS, "get_window_symbols(ms) -> int"},
+  {"recv_window",        (PyCFunction) ra02_py_ra02_recv_window,       METH_VARARGS, "recv_window(symbols) -> bytes"},
+  {"send_stream",        (PyCFunction) ra02_py_ra02_send_stream,       METH_O,       "send_stream(data): FSK frame larger than FIFO"},
+  {"recv_stream",        (PyCFunction) ra02_py_ra02_recv_stream,       METH_VARARGS, "recv_stream(size, timeout) -> bytes"},
+  {"recv_stream_into",   (PyCFunction) ra02_py_ra02_recv_stream_into,  METH_VARARGS,
+   "recv_stream_into(buffer, timeout): frame size is size of buffer"},
+  {NULL},
+};
+
+static PyGetSetDef ra02_py_ra02_getset[] = {
+  {"address", (getter) ra02_py_ra02_address, NULL, "Address of ra02_t, e.g. ra02.ra02_t.from_address(rf.address)", NULL},
+  {NULL},
+};
+
+static PyTypeObject ra02_py_ra02_type = {
+  PyVarObject_HEAD_INIT(NULL, 0)
+  .tp_name      = "ra02_native.Ra02",
+  .tp_doc       = "Ra02(spi=None, dio0=None, dio1=None): ra02_t and ra02_* APIs from ra02.h",
+  .tp_basicsize = sizeof(ra02_py_ra02_t),
+  .tp_flags     = Py_TPFLAGS_DEFAULT,
+  .tp_new       = PyType_GenericNew,
+  .tp_init      = (initproc) ra02_py_ra02_tp_init,
+  .tp_dealloc   = (destructor) ra02_py_ra02_dealloc,
+  .tp_methods   = ra02_py_ra02_methods,
+  .tp_getset    = ra02_py_ra02_getset,
+};
+
+/**
+ * Set integer class attributes, mirror of constants in ra02.py
+ */
+static int ra02_py_add_constants(PyTypeObject * type, const char * const * names, const long * values, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    PyObject * value = PyLong_FromLong(values[i]);
+
+    if (!value || PyDict_SetItemString(type->tp_dict, names[i], value) < 0) {
+      Py_XDECREF(value);
+      return -1;
+    }
+
+    Py_DECREF(value);
+  }
+
+  PyType_Modified(type);
+
+  return 0;
+}
+
+/**
+ * Look up exception hierarchy & structures of ra02.py
+ */
+static int ra02_py_import_bindings(void) {
+  PyObject * bindings = PyImport_ImportModule(RA02_PY_EXCEPTIONS_MODULE);
+
+  if (!bindings) {
+    return -1;
+  }
+
+  ra02_py_exceptions = PyObject_GetAttrString(bindings, "EXCEPTIONS");
+  ra02_py_invalid_error = PyObject_GetAttrString(bindings, "InvalidErrorCodeException");
+  ra02_py_scan_sim_result_type = PyObject_GetAttrString(bindings, "ra02_scan_sim_result_t");
+
+  Py_DECREF(bindings);
+
+  if (!ra02_py_exceptions || !ra02_py_invalid_error || !ra02_py_scan_sim_result_type) {
+    return -1;
+  }
+
+  if (!PyDict_Check(ra02_py_exceptions)) {
+    PyErr_SetString(PyExc_ImportError, "ra02.EXCEPTIONS must be dict");
+    return -1;
+  }
+
+  return 0;
+}
+
+static struct PyModuleDef ra02_py_module = {
+  PyModuleDef_HEAD_INIT,
+  .m_name = "ra02_native",
+  .m_doc  = "Native RA-02 driver bindings, same API as ctypes bindings of ra02.py",
+  .m_size = -1,
+};
+
+/* Shared functions ========================================================= */
+PyMODINIT_FUNC PyInit_ra02_native(void) {
+  static const char * const gpio_names[] = {"EDGE_NONE", "EDGE_RISING", "EDGE_FALLING", "EDGE_BOTH"};
+  static const long gpio_values[] = {GPIO_EDGE_NONE, GPIO_EDGE_RISING, GPIO_EDGE_FALLING, GPIO_EDGE_BOTH};
+
+  static const char * const ra02_names[] = {
+    "MAX_PAYLOAD", "MODEM_LORA", "MODEM_FSK",
+    "CRC_RATE_4_5", "CRC_RATE_4_6", "CRC_RATE_4_7", "CRC_RATE_4_8",
+    "MAX_STREAM_SIZE", "STATE_IDLE", "STATE_TX", "STATE_RX", "SF_MASK_ALL",
+    "SEND_AT_MAX_LATE_NS",
+  };
+  static const long ra02_values[] = {
+    RA02_MAX_PACKET_SIZE, RA02_MODEM_LORA, RA02_MODEM_FSK,
+    RA02_CRC_RATE_4_5, RA02_CRC_RATE_4_6, RA02_CRC_RATE_4_7, RA02_CRC_RATE_4_8,
+    RA02_FSK_MAX_STREAM_SIZE, RA02_STATE_IDLE, RA02_STATE_TX, RA02_STATE_RX, RA02_SF_MASK_ALL,
+    RA02_SEND_AT_MAX_LATE_NS,
+  };
+
+  if (ra02_py_import_bindings() < 0) {
+    return NULL;
+  }
+
+  PyTypeObject * types[] = {&ra02_py_spi_type, &ra02_py_gpio_type, &ra02_py_timeout_type, &ra02_py_ra02_type};
+
+  for (size_t i = 0; i < sizeof(types) / sizeof(types[0]); ++i) {
+    if (PyType_Ready(types[i]) < 0) {
+      return NULL;
+    }
+  }
+
+  if (ra02_py_add_constants(&ra02_py_gpio_type, gpio_names, gpio_values, sizeof(gpio_values) / sizeof(gpio_values[0])) < 0
+      || ra02_py_add_constants(&ra02_py_ra02_type, ra02_names, ra02_values, sizeof(ra02_values) / sizeof(ra02_values[0])) < 0) {
+    return NULL;
+  }
+
+  PyObject * module = PyModule_Create(&ra02_py_module);
+
+  if (!module) {
+    return NULL;
+  }
+
+  const char * names[] = {"Spi", "Gpio", "Timeout", "Ra02"};
+
+  for (size_t i = 0; i < sizeof(types) / sizeof(types[0]); ++i) {
+    Py_INCREF(types[i]);
+
+    if (PyModule_AddObject(module, names[i], (PyObject *) types[i]) < 0) {
+      Py_DECREF(types[i]);
+      Py_DECREF(module);
+      return NULL;
+    }
+  }
+
+  return module;
+}
@@ -19,7 +19,7 @@ extern "C" {
 /**
  * Generic errors
  */
-typedef enum {
+enum error_e {
   E_OK          = 0,  /** Successful result */
   E_FAILED      = 1,  /** Operation failed (Generic error) */
   E_ASSERT      = 2,  /** Assertion failed */
@@ -39,9 +39,18 @@ typedef enum {
   E_EMPTY       = 16, /** Buffer/Response is empty */
   E_NOMEM       = 17, /** No memory left */
   E_OUTOFBOUNDS = 18, /** Out Of Bounds Access */
-} error_t;
+};
 
 /* Types ==================================================================== */
+/**
+ * Error code, glibc declares its own error_t (int) with _GNU_SOURCE, which is
+ * always on in C++, so whichever comes first is used, values are the same
+ */
+#ifndef __error_t_defined
+#define __error_t_defined 1
+typedef enum error_e error_t;
+#endif
+
 /* Variables ================================================================ */
 /* Shared functions ========================================================= */
 /**
@@ -0,0 +1,120 @@
+/** ========================================================================= *
+ *
+ * @file gpio.h
+ * @date 17-10-2026
+ * @author Maksym Tkachuk <max.r.tkachuk@gmail.com>
+ *
+ * @brief GPIO input lines with edge events, uses linux GPIO character device
+ *
+ *  ========================================================================= */
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ================================================================= */
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <error.h>
+
+/* Defines ================================================================== */
+/* Macros =================================================================== */
+/* Enums ==================================================================== */
+/**
+ * Edges that generate events
+ */
+typedef enum {
+  GPIO_EDGE_NONE    = 0,
+  GPIO_EDGE_RISING  = 1,
+  GPIO_EDGE_FALLING = 2,
+  GPIO_EDGE_BOTH    = 3,
+} gpio_edge_t;
+
+/* Types ==================================================================== */
+/**
+ * GPIO Context
+ */
+typedef struct {
+  int fd;
+  uint32_t line;
+} gpio_t;
+
+/* Variables ================================================================ */
+/* Shared functions ========================================================= */
+/**
+ * Request GPIO line as input
+ *
+ * @param gpio GPIO Handle
+ * @param chip Name of GPIO chip device (/dev/gpiochipX)
+ * @param line Line offset on the chip
+ * @param edge Edges that generate events
+ */
+error_t gpio_init(gpio_t * gpio, const char * chip, uint32_t line, gpio_edge_t edge);
+
+/**
+ * Release GPIO line
+ *
+ * @param gpio GPIO Handle
+ */
+error_t gpio_deinit(gpio_t * gpio);
+
+/**
+ * Read GPIO line level
+ *
+ * @param gpio GPIO Handle
+ * @param value Output
+ */
+error_t gpio_get(gpio_t * gpio, bool * value);
+
+/**
+ * Wait for edge event
+ *
+ * @param gpio GPIO Handle
+ * @param timeout_us Time to wait for in microseconds, in time source of calling thread
+ * @param timestamp_ns Output, kernel timestamp of the event (CLOCK_MONOTONIC), can be NULL
+ */
+error_t gpio_wait_edge(gpio_t * gpio, uint32_t timeout_us, uint64_t * timestamp_ns);
+
+/**
+ * Wait for edge event on any of the lines
+ *
+ * @param gpios GPIO Handles, NULL entries are skipped
+ * @param count Number of handles
+ * @param timeout_us Time to wait for in microseconds, in time source of calling thread
+ * @param index Output, index of line that had an event, can be NULL
+ * @param timestamp_ns Output, kernel timestamp of the event (CLOCK_MONOTONIC), can be NULL
+ */
+error_t gpio_wait_edge_any(
+  gpio_t ** gpios,
+  size_t count,
+  uint32_t timeout_us,
+  size_t * index,
+  uint64_t * timestamp_ns
+);
+
+/**
+ * Wait for edge event on any of the lines, or until file descriptor becomes readable
+ *
+ * @param gpios GPIO Handles, NULL entries are skipped
+ * @param count Number of handles
+ * @param fd File descriptor to wake on (e.g. eventfd), isn't read, -1 - none
+ * @param timeout_us Time to wait for in microseconds, in time source of calling thread
+ * @param index Output, index of line that had an event, can be NULL
+ * @param timestamp_ns Output, kernel timestamp of the event (CLOCK_MONOTONIC), can be NULL
+ *
+ * @retval E_CANCELLED fd became readable before any edge
+ */
+error_t gpio_wait_edge_any_fd(
+  gpio_t ** gpios,
+  size_t count,
+  int fd,
+  uint32_t timeout_us,
+  size_t * index,
+  uint64_t * timestamp_ns
+);
+
+#ifdef __cplusplus
+}
+#endif
@@ -16,8 +16,10 @@ extern "C" {
 /* Includes ================================================================= */
 #include <stdint.h>
 #include <stddef.h>
+#include <stdbool.h>
 #include <timeout.h>
 #include <spi.h>
+#include <gpio.h>
 
 /* Defines ================================================================== */
 /**
@@ -27,43 +29,276 @@ extern "C" {
 #define RA02_SEND_IRQ_TIMEOUT 500
 #endif
 
+/**
+ * Default max lateness in ns of ra02_send_at transmission, after which it
+ * is not sent
+ */
+#ifndef RA02_SEND_AT_MAX_LATE_NS
+#define RA02_SEND_AT_MAX_LATE_NS 100000
+#endif
+
 /**
  * Max packet payload in bytes
  */
 #define RA02_MAX_PACKET_SIZE 64
 
+/**
+ * Max packet payload in bytes for FSK modem (FIFO also holds length byte)
+ */
+#define RA02_FSK_MAX_PACKET_SIZE (RA02_MAX_PACKET_SIZE - 1)
+
+/**
+ * Max frame size in bytes for FSK streaming (ra02_send_stream/ra02_recv_stream)
+ */
+#define RA02_FSK_MAX_STREAM_SIZE 2047
+
+/**
+ * Worst case host reaction time in us to a FIFO threshold event, used
+ * to size FIFO headroom for streaming
+ */
+#ifndef RA02_FSK_STREAM_LATENCY_US
+#define RA02_FSK_STREAM_LATENCY_US 500
+#endif
+
+/**
+ * Spreading factor range, that scanning receiver can cycle through
+ * (SF6 requires implicit header and is excluded)
+ */
+#define RA02_SCAN_SF_MIN   7
+#define RA02_SCAN_SF_MAX   12
+#define RA02_SCAN_SF_COUNT (RA02_SCAN_SF_MAX - RA02_SCAN_SF_MIN + 1)
+
+/**
+ * LoRa symbol duration in us, above which LowDataRateOptimize is required
+ */
+#define RA02_LDRO_SYMBOL_US 16000
+
+/**
+ * Default LoRa RX symbol timeout for single reception
+ */
+#define RA02_DEFAULT_SYMB_TIMEOUT 0x2FF
+
 /* Macros =================================================================== */
+/**
+ * Bit of spreading factor in scan mask
+ */
+#define RA02_SF_BIT(sf) (1 << (sf))
+
+/**
+ * Scan mask of all supported spreading factors
+ */
+#define RA02_SF_MASK_ALL \
+  (RA02_SF_BIT(7) | RA02_SF_BIT(8) | RA02_SF_BIT(9) | RA02_SF_BIT(10) | RA02_SF_BIT(11) | RA02_SF_BIT(12))
+
 /* Enums ==================================================================== */
+/**
+ * RA-02 Modem
+ */
+typedef enum {
+  RA02_MODEM_LORA = 0,
+  RA02_MODEM_FSK  = 1,
+} ra02_modem_t;
+
+/**
+ * RA-02 Coding Rate values
+ */
+typedef enum {
+  RA02_CRC_RATE_4_5 = 1,
+  RA02_CRC_RATE_4_6 = 2,
+  RA02_CRC_RATE_4_7 = 3,
+  RA02_CRC_RATE_4_8 = 4,
+} ra02_crc_rate_t;
+
+/**
+ * RA-02 split-phase operation state (ra02_send_start, ra02_recv_start, ra02_step)
+ */
+typedef enum {
+  RA02_STATE_IDLE = 0,
+  RA02_STATE_TX   = 1,
+  RA02_STATE_RX   = 2,
+} ra02_state_t;
+
 /* Types ==================================================================== */
+/**
+ * RA-02 LoRa frame format
+ *
+ * In implicit header mode payload length, coding rate and CRC presence are
+ * not transmitted over the air, so both sides must agree on them beforehand
+ */
+typedef struct {
+  bool            implicit_header;  /** Omit the explicit header */
+  uint8_t         payload_len;      /** Fixed payload length (implicit header mode only) */
+  ra02_crc_rate_t crc_rate;         /** Coding rate */
+  bool            crc;              /** Append payload CRC on TX */
+} ra02_frame_cfg_t;
+
+/**
+ * RA-02 FSK packet format
+ *
+ * Packets are variable length, with length byte sent after the sync word
+ */
+typedef struct {
+  uint32_t sync_word;   /** Sync word, sent MSB first */
+  uint8_t  sync_size;   /** Sync word size in bytes (1-4), 0 disables sync word */
+  bool     whitening;   /** Enable data whitening */
+  bool     crc;         /** Append/check CRC-16 */
+} ra02_fsk_packet_cfg_t;
+
+/**
+ * RA-02 wake-on-radio receive statistics, accumulated across ra02_recv_wor calls
+ */
+typedef struct {
+  uint32_t cad_runs;        /** CAD cycles performed */
+  uint32_t cad_detected;    /** CAD cycles that detected a preamble (hits) */
+  uint32_t rx_ok;           /** Packets received after detection */
+  uint32_t rx_missed;       /** Detections that didn't yield a packet (false alarm, RX timeout, CRC) */
+  uint64_t latency_us;      /** Accumulated time from detection to RX_DONE */
+  uint64_t last_latency_us; /** Time from detection to RX_DONE of last packet */
+} ra02_wor_stats_t;
+
+/**
+ * RA-02 multi-SF scan statistics, indexed by (sf - RA02_SCAN_SF_MIN),
+ * accumulated across ra02_recv_scan calls
+ */
+typedef struct {
+  uint32_t cad_runs[RA02_SCAN_SF_COUNT];      /** CAD cycles performed */
+  uint32_t cad_detected[RA02_SCAN_SF_COUNT];  /** CAD cycles that detected a preamble */
+  uint32_t rx_ok[RA02_SCAN_SF_COUNT];         /** Packets received after detection */
+  uint32_t rx_missed[RA02_SCAN_SF_COUNT];     /** Detections that didn't yield a packet */
+} ra02_scan_stats_t;
+
+/**
+ * RA-02 multi-SF scan simulation parameters
+ *
+ * Every SF in mask gets independent Poisson packet arrivals, all of them
+ * sent with the same preamble length and payload size
+ */
+typedef struct {
+  uint16_t sf_mask;       /** Scanned SFs (RA02_SF_BIT) */
+  uint16_t preamble;      /** Transmitter preamble length in symbols, 0 - ra02_get_scan_preamble per SF */
+  size_t   payload_size;  /** Payload size in bytes */
+  uint32_t interval_ms;   /** Mean interval between packets of each SF */
+  uint32_t duration_ms;   /** Simulated time */
+  uint32_t switch_us;     /** Profile switch & CAD setup overhead per step (SPI traffic) */
+  uint32_t seed;          /** PRNG seed of preamble schedule */
+} ra02_scan_sim_cfg_t;
+
+/**
+ * RA-02 multi-SF scan simulation results, indexed by (sf - RA02_SCAN_SF_MIN)
+ */
+typedef struct {
+  uint32_t sent[RA02_SCAN_SF_COUNT];      /** Packets in schedule */
+  uint32_t detected[RA02_SCAN_SF_COUNT];  /** Packets detected and locked onto */
+  uint32_t cycle_us;                      /** Duration of one scan cycle over all SFs */
+} ra02_scan_sim_result_t;
+
 /**
  * RA-02 driver config
  */
 typedef struct {
   spi_t * spi;
+  gpio_t * dio0; /* Optional, polls IRQ flags over SPI if NULL */
+  gpio_t * dio1; /* Optional, polls IRQ flags over SPI if NULL */
 } ra02_cfg_t;
 
+/**
+ * RA-02 split-phase operation in progress
+ */
+typedef struct {
+  ra02_state_t state;
+  uint8_t *    buf;         /** RX: frame output, owned by caller until completion */
+  size_t *     size;        /** RX: in - size of buf, out - size of frame */
+  uint64_t     deadline_ns; /** CLOCK_MONOTONIC time, when operation times out, UINT64_MAX - never */
+} ra02_async_t;
+
+/**
+ * Synchronization of concurrent callers, private to the driver
+ */
+struct ra02_sync_s;
+
 /**
  * RA-02 driver context
+ *
+ * Initialized handle can be used from several threads. Every call owns the
+ * handle until it returns, other threads wait for it, except for frequency,
+ * power, sync word, bandwidth, SF, preamble & frame format setters: while
+ * other thread owns the handle, they are queued and applied at the next safe
+ * point (between reception attempts of ra02_recv or when the call returns).
+ * Blocking calls can be cancelled with ra02_cancel
  */
 typedef struct {
   spi_t * spi;
-  uint8_t irq_flags;
-  int8_t last_rssi;
+  gpio_t * dio0;
+  gpio_t * dio1;
+  uint16_t irq_flags; /* LoRa: RegIrqFlags, FSK: RegIrqFlags1 << 8 | RegIrqFlags2 */
+  int8_t last_rssi;    /* RSSI of last received packet, dBm */
+  ra02_frame_cfg_t frame;
+  uint8_t sf;
+  uint32_t bandwidth;
+  uint16_t preamble;
+  ra02_modem_t modem;
+  uint32_t bitrate;
+  uint32_t fdev;
+  ra02_fsk_packet_cfg_t fsk_packet;
+  uint64_t last_rx_ns; /* CLOCK_MONOTONIC time of last RX_DONE (DIO0 edge if connected) */
+  uint64_t last_tx_ns; /* CLOCK_MONOTONIC time of last TX start */
+  int8_t last_snr;     /* LoRa: SNR of last received packet, dB */
+  struct ra02_sync_s * sync; /* Set by ra02_init, NULL - no synchronization (e.g. model for calculations) */
+  ra02_async_t async;        /* Split-phase operation, see ra02_step */
 } ra02_t;
 
+/**
+ * Precomputed LoRa register image, for deployments with fixed radio
+ * parameters (see ra02_init_image, ra02::StaticRadio)
+ *
+ * Register fields hold raw values, in register address order, so each
+ * group is written in one SPI burst
+ */
+typedef struct {
+  uint8_t rf[4];          /** FRF_MSB, FRF_MID, FRF_LSB, PA_CFG (0x06-0x09) */
+  uint8_t modem[5];       /** MODEM_CFG_1, MODEM_CFG_2, SYMB_TIMEOUT_LSB, PREAMBLE_MSB, PREAMBLE_LSB (0x1D-0x21) */
+  uint8_t modem_cfg_3;    /** MODEM_CFG_3 (0x26) */
+  uint8_t sync_word;      /** SYNC_WORD (0x39) */
+  uint8_t sf;             /** Spreading factor, mirrored into ra02_t */
+  uint32_t bandwidth;     /** Bandwidth in Hz, mirrored into ra02_t */
+  uint16_t preamble;      /** Preamble length in symbols, mirrored into ra02_t */
+  ra02_frame_cfg_t frame; /** Frame format, mirrored into ra02_t */
+} ra02_lora_image_t;
+
 /* Variables ================================================================ */
 /* Shared functions ========================================================= */
 /**
  * Initializes RA02
  *
+ * @note Allocates synchronization state, freed by ra02_deinit, or right away
+ *       if init fails
+ *
  * @param ra02 RA02 Context
  * @param cfg Valid RA02 Config
  */
 error_t ra02_init(ra02_t * ra02, ra02_cfg_t * cfg);
 
+/**
+ * Initializes RA02 in LoRa mode from precomputed register image
+ *
+ * After reset & version check whole configuration is written in one
+ * SPI transaction, instead of read-modify-write sequence of setters
+ *
+ * @note Allocates synchronization state, freed by ra02_deinit, or right away
+ *       if init fails
+ * @note Image is trusted, no range checks are done on its values
+ *
+ * @param ra02 RA02 Context
+ * @param cfg Valid RA02 Config
+ * @param image Register image
+ */
+error_t ra02_init_image(ra02_t * ra02, ra02_cfg_t * cfg, const ra02_lora_image_t * image);
+
 /**
  * Deinitializes RA02
  *
+ * @note Must not be called while other thread uses the handle
+ *
  * @param ra02 RA02 Context
  */
 error_t ra02_deinit(ra02_t * ra02);
@@ -82,6 +317,17 @@ error_t ra02_reset(ra02_t * ra02);
  */
 error_t ra02_sleep(ra02_t * ra02);
 
+/**
+ * Selects modem (LoRa or FSK)
+ *
+ * @note Modem configuration (bandwidth, preamble, sync word, etc.) is reset
+ *       to defaults of selected modem. Frequency & output power are kept
+ *
+ * @param ra02 RA02 Context
+ * @param modem Modem
+ */
+error_t ra02_set_modem(ra02_t * ra02, ra02_modem_t modem);
+
 /**
  * Sets frequency
  *
@@ -109,32 +355,67 @@ error_t ra02_set_power(ra02_t * ra02, uint8_t db);
 /**
  * Set sync word
  *
+ * @note For FSK sync word size set by ra02_set_fsk_packet_cfg is kept
+ *
  * @param ra02 RA02 Context
  * @param sync_word Sync word
  */
 error_t ra02_set_sync_word(ra02_t * ra02, uint32_t sync_word);
 
+/**
+ * Set inverted I/Q for both TX & RX, e.g. LoRaWAN downlinks are sent with
+ * inverted I/Q, so that they are heard by nodes only
+ *
+ * @note LoRa only
+ *
+ * @param ra02 RA02 Context
+ * @param on Invert I/Q
+ */
+error_t ra02_set_invert_iq(ra02_t * ra02, bool on);
+
 /**
  * Set baudrate
  *
+ * @note FSK only, LoRa data rate is defined by SF, bandwidth & coding rate
+ *
  * @param ra02 RA02 Context
- * @param baudrate Baudrate
+ * @param baudrate Baudrate in bits/s
  */
 error_t ra02_set_baudrate(ra02_t * ra02, uint32_t baudrate);
 
+/**
+ * Set frequency deviation
+ *
+ * @note FSK only
+ *
+ * @param ra02 RA02 Context
+ * @param hz Frequency deviation in Hz
+ */
+error_t ra02_set_fdev(ra02_t * ra02, uint32_t hz);
+
 /**
  * Set bandwidth
  *
+ * @note For FSK sets single side receiver channel filter bandwidth
+ *
  * @param ra02 RA02 Context
- * @param bandwidth Bandwidth
+ * @param bandwidth Bandwidth in Hz
  */
 error_t ra02_set_bandwidth(ra02_t * ra02, uint32_t bandwidth);
 
+/**
+ * Set FSK packet format (sync word, whitening & CRC)
+ *
+ * @param ra02 RA02 Context
+ * @param cfg Packet format
+ */
+error_t ra02_set_fsk_packet_cfg(ra02_t * ra02, const ra02_fsk_packet_cfg_t * cfg);
+
 /**
  * Set preamble length
  *
  * @param ra02 RA02 Context
- * @param preamble Preamble length in bytes
+ * @param preamble Preamble length in symbols (LoRa) or bytes (FSK)
  */
 error_t ra02_set_preamble(ra02_t * ra02, uint32_t preamble);
 
@@ -143,6 +424,26 @@ error_t ra02_set_preamble(ra02_t * ra02, uint32_t preamble);
  */
 error_t ra02_set_sf(ra02_t * ra02, uint8_t sf);
 
+/**
+ * Set frame format (header mode, fixed payload length, coding rate & CRC)
+ *
+ * @note In implicit header mode ra02_send accepts only payload_len bytes
+ *       and ra02_recv rejects frames of any other length with E_CORRUPT
+ *
+ * @param ra02 RA02 Context
+ * @param cfg Frame format
+ */
+error_t ra02_set_frame_cfg(ra02_t * ra02, const ra02_frame_cfg_t * cfg);
+
+/**
+ * Calculates time on air for a packet with current modem configuration
+ *
+ * @param ra02 RA02 Context
+ * @param size Payload size in bytes
+ * @param us Output, time on air in microseconds
+ */
+error_t ra02_get_time_on_air(ra02_t * ra02, size_t size, uint32_t * us);
+
 /**
  * Retrieves current RSSI
  *
@@ -167,6 +468,26 @@ error_t ra02_poll_irq_flags(ra02_t * ra02);
  */
 error_t ra02_send(ra02_t * ra02, uint8_t * buf, size_t size);
 
+/**
+ * Send data over radio, starting transmission at precise instant
+ *
+ * FIFO is loaded beforehand, so that only op mode switch is left at the
+ * given instant. Actual start time is stored in ra02->last_tx_ns, so caller
+ * gets lateness as ra02->last_tx_ns - at_ns
+ *
+ * @note LoRa only
+ *
+ * @param ra02 RA02 Context
+ * @param buf Buffer to send
+ * @param size Buffer size
+ * @param at_ns Absolute CLOCK_MONOTONIC time of TX start in ns
+ * @param max_late_ns Lateness, after which nothing is sent (e.g. RA02_SEND_AT_MAX_LATE_NS),
+ *                    UINT64_MAX - always send
+ *
+ * @retval E_TIMEOUT If the instant was missed by more than max_late_ns, nothing is sent
+ */
+error_t ra02_send_at(ra02_t * ra02, uint8_t * buf, size_t size, uint64_t at_ns, uint64_t max_late_ns);
+
 /**
  * Receive data over radio
  *
@@ -177,6 +498,252 @@ error_t ra02_send(ra02_t * ra02, uint8_t * buf, size_t size);
  */
 error_t ra02_recv(ra02_t * ra02, uint8_t * buf, size_t * size, timeout_t * timeout);
 
+/**
+ * Start transmission and return without waiting for TX_DONE, completion is
+ * reported by ra02_step
+ *
+ * @note Frame is copied into RA-02 FIFO, so buf can be reused right away
+ *
+ * @param ra02 RA02 Context
+ * @param buf Data to send
+ * @param size Data size
+ *
+ * @retval E_BUSY Other split-phase operation is in progress
+ */
+error_t ra02_send_start(ra02_t * ra02, uint8_t * buf, size_t size);
+
+/**
+ * Start reception and return without waiting for a frame, completion is
+ * reported by ra02_step
+ *
+ * @note buf & size must stay valid until ra02_step completes the operation
+ *
+ * @param ra02 RA02 Context
+ * @param buf Buffer to receive into
+ * @param size On input - pointer to variable with buffer size. On output - size of received data
+ * @param timeout_ms Time to wait for frame, 0 - until frame arrives or ra02_cancel
+ *
+ * @retval E_BUSY Other split-phase operation is in progress
+ */
+error_t ra02_recv_start(ra02_t * ra02, uint8_t * buf, size_t * size, uint32_t timeout_ms);
+
+/**
+ * Advance split-phase operation started by ra02_send_start or ra02_recv_start,
+ * never blocks: every step reads IRQ flags, and only on completion reads the
+ * frame or puts RA-02 to sleep
+ *
+ * Lets single thread drive several radios: call it when wake_ns is reached or
+ * when fd of DIO0/DIO1 (if connected) becomes readable, edges are consumed
+ * here. If DIO lines needed by the operation are connected, wake_ns is only
+ * the operation timeout, otherwise it's the next IRQ poll
+ *
+ * @note Until operation completes, handle must not be used for other calls,
+ *       except ra02_cancel, that completes it with E_CANCELLED on next step
+ *
+ * @param ra02 RA02 Context
+ * @param wake_ns Output, CLOCK_MONOTONIC time of next step, UINT64_MAX - only on DIO edge
+ *
+ * @retval E_AGAIN Operation is in progress
+ * @retval E_EMPTY No operation is in progress
+ * @retval E_OK Frame was sent or received, RA-02 is in sleep mode
+ * @retval E_TIMEOUT, E_CORRUPT, E_CANCELLED Operation failed, RA-02 is in sleep mode
+ */
+error_t ra02_step(ra02_t * ra02, uint64_t * wake_ns);
+
+/**
+ * Cancel blocking call (send, receive, CAD, streaming, wake-on-radio, scan)
+ * made by other thread, it returns E_CANCELLED and leaves RA-02 in sleep or
+ * standby. Safe to call from any thread. If no call is blocking, the next
+ * one is cancelled
+ *
+ * Wakes the call through an eventfd when DIO lines are connected, otherwise
+ * it's noticed on the next IRQ poll
+ *
+ * @param ra02 RA02 Context
+ */
+error_t ra02_cancel(ra02_t * ra02);
+
+/**
+ * Run single Channel Activity Detection
+ *
+ * @note LoRa only
+ *
+ * @param ra02 RA02 Context
+ * @param detected Output, whether LoRa preamble was detected
+ */
+error_t ra02_cad(ra02_t * ra02, bool * detected);
+
+/**
+ * Retune and start continuous reception, e.g. for channel RSSI sampling
+ *
+ * @note LoRa only, RA-02 stays in RX until other operation or ra02_sleep
+ *
+ * @param ra02 RA02 Context
+ * @param khz Frequency in kHz
+ */
+error_t ra02_listen(ra02_t * ra02, uint32_t khz);
+
+/**
+ * Sample current channel RSSI, reads are batched into few SPI syscalls
+ *
+ * @note LoRa only, RA-02 must be receiving (see ra02_listen)
+ *
+ * @param ra02 RA02 Context
+ * @param rssi Output, count samples in dBm
+ * @param wideband Output, count raw RegRssiWideband samples, may be NULL
+ * @param count Number of samples
+ * @param interval_us Delay between samples
+ */
+error_t ra02_sample_rssi(ra02_t * ra02, int8_t * rssi, uint8_t * wideband, size_t count, uint16_t interval_us);
+
+/**
+ * Send data with preamble long enough for wake-on-radio receiver to catch it
+ *
+ * @note LoRa only, preamble spans whole CAD period, so airtime grows accordingly
+ *
+ * @param ra02 RA02 Context
+ * @param period_ms Receiver CAD period in ms
+ * @param buf Buffer to send
+ * @param size Buffer size
+ */
+error_t ra02_send_wor(ra02_t * ra02, uint32_t period_ms, uint8_t * buf, size_t size);
+
+/**
+ * Duty-cycled receive (wake-on-radio)
+ *
+ * Sleeps and runs CAD every period_ms. When preamble is detected switches to
+ * single RX with symbol timeout sized to the remaining preamble, then goes
+ * back to sleep if nothing was received. Preamble length & symbol timeout are
+ * restored on return, whatever the result
+ *
+ * @note LoRa only, sender must use ra02_send_wor with the same period
+ * @note Symbol timeout is capped at 1023 symbols (10-bit register), so with
+ *       longer preambles (period above ~1000 symbols) packets, whose preamble
+ *       is detected early, are missed
+ *
+ * @param ra02 RA02 Context
+ * @param period_ms CAD period in ms
+ * @param buf Buffer to receive into
+ * @param size On input - pointer to variable with buffer size. On output - size of received data
+ * @param timeout Timeout to wait for
+ * @param stats Statistics to update (CAD hit/miss, latency)
+ */
+error_t ra02_recv_wor(
+  ra02_t * ra02,
+  uint32_t period_ms,
+  uint8_t * buf,
+  size_t * size,
+  timeout_t * timeout,
+  ra02_wor_stats_t * stats
+);
+
+/**
+ * Calculate preamble length, that guarantees that scanning receiver visits
+ * sender's SF at least once while preamble is on air
+ *
+ * @note LoRa only
+ *
+ * @param ra02 RA02 Context
+ * @param sf_mask Receiver scan mask (RA02_SF_BIT)
+ * @param sf Sender spreading factor
+ * @param symbols Output, preamble length in symbols
+ */
+error_t ra02_get_scan_preamble(ra02_t * ra02, uint16_t sf_mask, uint8_t sf, uint16_t * symbols);
+
+/**
+ * Scanning receive over multiple spreading factors
+ *
+ * Cycles CAD over SFs from mask, switching only SF related registers between
+ * steps. When activity is detected, locks onto that SF and receives a packet,
+ * otherwise resumes scanning. Bandwidth and frame format are shared by all SFs
+ *
+ * @note LoRa only, senders should use preamble from ra02_get_scan_preamble
+ *
+ * @param ra02 RA02 Context
+ * @param sf_mask SFs to scan (RA02_SF_BIT)
+ * @param buf Buffer to receive into
+ * @param size On input - pointer to variable with buffer size. On output - size of received data
+ * @param sf Output, SF of received packet
+ * @param timeout Timeout to wait for
+ * @param stats Statistics to update (per SF CAD hit/miss)
+ */
+error_t ra02_recv_scan(
+  ra02_t * ra02,
+  uint16_t sf_mask,
+  uint8_t * buf,
+  size_t * size,
+  uint8_t * sf,
+  timeout_t * timeout,
+  ra02_scan_stats_t * stats
+);
+
+/**
+ * Simulate scanning receiver against random preamble schedule and measure
+ * detection probability per SF
+ *
+ * Uses same timing model as ra02_recv_scan (CAD duration, profile switch,
+ * lock margin) and current bandwidth & frame format. Doesn't access hardware
+ *
+ * @param ra02 RA02 Context
+ * @param cfg Simulation parameters
+ * @param result Output, per SF detections
+ */
+error_t ra02_scan_simulate(ra02_t * ra02, const ra02_scan_sim_cfg_t * cfg, ra02_scan_sim_result_t * result);
+
+/**
+ * Convert receive window length from milliseconds to symbols with current
+ * SF & bandwidth, rounding up and capping to supported range (4-1023)
+ *
+ * @note LoRa only
+ *
+ * @param ra02 RA02 Context
+ * @param ms Window length in ms
+ * @param symbols Output, window length in symbols
+ */
+error_t ra02_get_window_symbols(ra02_t * ra02, uint32_t ms, uint16_t * symbols);
+
+/**
+ * Receive data within a window bounded by symbol timeout
+ *
+ * Window is measured by the modem itself: if no preamble is detected within
+ * given number of symbols, RX_TIMEOUT fires and E_TIMEOUT is returned right
+ * away. Packet, whose preamble started within the window, is received fully
+ *
+ * @note LoRa only
+ *
+ * @param ra02 RA02 Context
+ * @param buf Buffer to receive into
+ * @param size On input - pointer to variable with buffer size. On output - size of received data
+ * @param symbols Window length in symbols (4-1023)
+ */
+error_t ra02_recv_window(ra02_t * ra02, uint8_t * buf, size_t * size, uint16_t symbols);
+
+/**
+ * Send a single frame larger than FSK FIFO, refilling FIFO on FifoLevel events
+ *
+ * @note FSK only. Frame is sent in fixed length packet format, so receiver
+ *       must expect exactly the same size with ra02_recv_stream
+ * @note FifoLevel events are taken from DIO1, if available, otherwise
+ *       IRQ flags are polled
+ *
+ * @param ra02 RA02 Context
+ * @param buf Buffer to send
+ * @param size Buffer size (up to RA02_FSK_MAX_STREAM_SIZE)
+ */
+error_t ra02_send_stream(ra02_t * ra02, uint8_t * buf, size_t size);
+
+/**
+ * Receive a single frame larger than FSK FIFO, draining FIFO on FifoLevel events
+ *
+ * @note FSK only, see ra02_send_stream
+ *
+ * @param ra02 RA02 Context
+ * @param buf Buffer to receive into
+ * @param size Expected frame size (up to RA02_FSK_MAX_STREAM_SIZE)
+ * @param timeout Timeout to wait for
+ */
+error_t ra02_recv_stream(ra02_t * ra02, uint8_t * buf, size_t size, timeout_t * timeout);
+
 #ifdef __cplusplus
 }
 #endif
\ No newline at end of file
@@ -0,0 +1,795 @@
+/** ========================================================================= *
+ *
+ * @file ra02.hpp
+ * @date 17-10-2026
+ * @author Maksym Tkachuk <max.r.tkachuk@gmail.com>
+ *
+ * @brief C++20 coroutine layer over split-phase API of ra02.h (header-only)
+ *
+ * Radio owns SPI, DIO lines & driver handle. Loop drives its radios from one
+ * thread: it waits on DIO fds & a timerfd with epoll and calls ra02_step
+ * when they fire. `co_await radio.send(data)` & `co_await radio.recv(deadline)`
+ * suspend calling coroutine until the operation completes. Operations of one
+ * radio run in order of submission, queue nodes live in awaiters, that is in
+ * coroutine frames, so nothing is allocated per operation.
+ *
+ * Radios, their operations & coroutines resumed by them belong to the thread
+ * that runs their Loop, more threads can run a Loop each.
+ *
+ * StaticRadio fixes LoRa configuration at compile time, for deployments that
+ * never change it.
+ *
+ *  ========================================================================= */
+#pragma once
+
+/* Includes ================================================================= */
+#include <ra02.h>
+#include <ra02_regs.h>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+/* Defines ================================================================== */
+/* Macros =================================================================== */
+/* Enums ==================================================================== */
+/* Types ==================================================================== */
+namespace ra02 {
+
+class Loop;
+class Radio;
+
+/**
+ * Setup failure, thrown by constructors & check. Operations report error_t instead
+ */
+class Error : public std::runtime_error {
+public:
+  Error(error_t code, const std::string & what)
+    : std::runtime_error(what + ": " + error2str(code)), code(code) {}
+
+  const error_t code;
+};
+
+/**
+ * Driver clock (timeout_now_ns), follows clock set by timeout_set_clock
+ */
+struct Clock {
+  using rep        = int64_t;
+  using period     = std::nano;
+  using duration   = std::chrono::duration<rep, period>;
+  using time_point = std::chrono::time_point<Clock>;
+
+  static constexpr bool is_steady = true;
+
+  static time_point now() noexcept {
+    return time_point(duration(static_cast<rep>(timeout_now_ns())));
+  }
+};
+
+/**
+ * Received frame
+ */
+struct Frame {
+  error_t  err = E_OK;                           /** E_OK, E_TIMEOUT, E_CORRUPT, E_CANCELLED, ... */
+  size_t   size = 0;
+  std::array<uint8_t, RA02_MAX_PACKET_SIZE> data{};
+  int8_t   rssi = 0;
+  int8_t   snr = 0;                              /** LoRa only */
+  uint64_t rx_ns = 0;                            /** Clock time of RX_DONE */
+
+  std::span<const uint8_t> payload() const noexcept { return {data.data(), size}; }
+
+  explicit operator bool() const noexcept { return err == E_OK; }
+};
+
+/**
+ * Detached coroutine for logical flows: starts right away and frees its frame
+ * when it returns, exception escaping it terminates the program
+ */
+struct Task {
+  struct promise_type {
+    Task get_return_object() noexcept { return {}; }
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_never final_suspend() noexcept { return {}; }
+    void return_void() noexcept {}
+    void unhandled_exception() noexcept { std::terminate(); }
+  };
+};
+
+namespace detail {
+
+/**
+ * Operation queued on radio, lives in its awaiter
+ */
+struct Op {
+  Op *                     next = nullptr;
+  std::coroutine_handle<>  waiter;
+  error_t                  err = E_OK;
+  std::span<const uint8_t> tx;                   /** Send: frame */
+  Frame *                  rx = nullptr;         /** Recv: output, nullptr - send */
+  Clock::time_point        deadline = Clock::time_point::max();
+};
+
+/**
+ * PA_CFG values of output power in dB, mirrors ra02_power_mapping_db of ra02.c
+ */
+constexpr uint8_t pa_cfg(uint8_t db) {
+  return db <= 13 ? 0xF6 : db <= 16 ? 0xF9 : db <= 19 ? 0xFC : 0xFF;
+}
+
+/**
+ * LoRa bandwidths in Hz, indexed by MODEM_CFG_1 BW field, mirrors ra02_bandwidth_hz of ra02.c
+ */
+inline constexpr uint32_t bandwidth_hz[] = {
+  7800, 10400, 15600, 20800, 31250, 41700, 62500, 125000, 250000, 500000,
+};
+
+/**
+ * Index of bandwidth in bandwidth_hz, -1 - not supported
+ */
+constexpr int bandwidth_index(uint32_t hz) {
+  for (size_t i = 0; i < std::size(bandwidth_hz); ++i) {
+    if (bandwidth_hz[i] == hz) {
+      return static_cast<int>(i);
+    }
+  }
+
+  return -1;
+}
+
+} /* namespace detail */
+
+/**
+ * Fixed LoRa configuration of StaticRadio, defaults match ra02_init
+ */
+struct Profile {
+  uint32_t        freq_khz = 433000;
+  uint8_t         sf = 8;
+  uint32_t        bandwidth = 125000;            /** Hz, one of LoRa bandwidths exactly */
+  ra02_crc_rate_t crc_rate = RA02_CRC_RATE_4_7;
+  uint8_t         power = 17;                    /** dB */
+  uint8_t         sync_word = 0x12;
+  uint16_t        preamble = 10;                 /** Symbols */
+  bool            crc = false;
+  bool            implicit_header = false;
+  uint8_t         payload_len = 0;               /** Implicit header mode only */
+};
+
+/**
+ * Event loop, that drives radios registered with it, must outlive them
+ */
+class Loop {
+public:
+  Loop();
+  ~Loop();
+
+  Loop(const Loop &) = delete;
+  Loop & operator=(const Loop &) = delete;
+
+  /**
+   * Run until stop is called (e.g. by one of the flows)
+   */
+  void run();
+
+  /**
+   * Make run return after current iteration, without waiting for next event
+   */
+  void stop() noexcept;
+
+  /**
+   * Step radios, whose wake up time came, then wait for DIO edge or next wake up
+   *
+   * @param timeout_ms Longest wait, -1 - until next event, 0 - don't wait
+   */
+  void run_once(int timeout_ms = -1);
+
+  /**
+   * epoll fd, readable when run_once has something to do, for embedding into other loops
+   */
+  int fd() const noexcept { return epoll_fd_; }
+
+private:
+  friend class Radio;
+
+  void close_fds() noexcept;
+  void add(Radio & radio);
+  void remove(Radio & radio) noexcept;
+  void arm_timer();
+
+  int     epoll_fd_ = -1;
+  int     timer_fd_ = -1;
+  int     stop_fd_ = -1;                         /** eventfd, wakes up wait of run_once on stop */
+  Radio * radios_ = nullptr;
+  bool    running_ = false;
+};
+
+/**
+ * Radio, driven by Loop
+ *
+ * Non-movable, as driver handle points to SPI & DIO handles inside it
+ */
+class Radio {
+public:
+  /**
+   * Awaiter of send, result is error_t of the operation
+   */
+  class SendAwaiter {
+  public:
+    SendAwaiter(const SendAwaiter &) = delete;
+    SendAwaiter & operator=(const SendAwaiter &) = delete;
+
+    bool await_ready() const noexcept { return false; }
+    bool await_suspend(std::coroutine_handle<> waiter) { op_.waiter = waiter; return radio_.submit(op_); }
+    error_t await_resume() const noexcept { return op_.err; }
+
+  private:
+    friend class Radio;
+
+    SendAwaiter(Radio & radio, std::span<const uint8_t> data) : radio_(radio) { op_.tx = data; }
+
+    Radio &    radio_;
+    detail::Op op_;
+  };
+
+  /**
+   * Awaiter of recv, result is received Frame (see Frame::err)
+   */
+  class RecvAwaiter {
+  public:
+    RecvAwaiter(const RecvAwaiter &) = delete;
+    RecvAwaiter & operator=(const RecvAwaiter &) = delete;
+
+    bool await_ready() const noexcept { return false; }
+    bool await_suspend(std::coroutine_handle<> waiter) { op_.waiter = waiter; return radio_.submit(op_); }
+    Frame await_resume() const noexcept { return frame_; }
+
+  private:
+    friend class Radio;
+
+    RecvAwaiter(Radio & radio, Clock::time_point deadline) : radio_(radio) {
+      op_.rx = &frame_;
+      op_.deadline = deadline;
+    }
+
+    Radio &    radio_;
+    detail::Op op_;
+    Frame      frame_;
+  };
+
+  /**
+   * Open spidev & DIO lines, initialize driver
+   *
+   * @param loop Loop, that drives the radio
+   * @param spidev SPI device (/dev/spidevX.Y)
+   * @param gpiochip Chip of DIO lines, nullptr - DIOs are not connected (IRQ flags are polled)
+   * @param dio0 Line offset of DIO0, -1 - not connected
+   * @param dio1 Line offset of DIO1, -1 - not connected
+   */
+  Radio(Loop & loop, const char * spidev, const char * gpiochip = nullptr, int dio0 = -1, int dio1 = -1);
+
+  /**
+   * Initialize driver on SPI & DIO handles owned by caller (e.g. emulated radio)
+   */
+  Radio(Loop & loop, spi_t & spi, gpio_t * dio0 = nullptr, gpio_t * dio1 = nullptr);
+
+  /**
+   * Release radio, its flows must have finished (suspended ones are never resumed)
+   */
+  ~Radio();
+
+  Radio(const Radio &) = delete;
+  Radio & operator=(const Radio &) = delete;
+
+  /**
+   * Driver handle for configuration with C API (e.g. ra02_set_sf), when no operation is running
+   */
+  ra02_t * handle() noexcept { return &ra02_; }
+
+  /**
+   * Transmit frame, data must stay valid until co_await returns
+   */
+  SendAwaiter send(std::span<const uint8_t> data) noexcept { return {*this, data}; }
+
+  /**
+   * Receive frame, timing out at deadline (operation, that waited in queue, gets the time left)
+   */
+  RecvAwaiter recv(Clock::time_point deadline = Clock::time_point::max()) noexcept { return {*this, deadline}; }
+
+  /**
+   * Receive frame, timing out after timeout
+   */
+  template <class Rep, class Period>
+  RecvAwaiter recv(std::chrono::duration<Rep, Period> timeout) noexcept {
+    return {*this, Clock::now() + std::chrono::ceil<Clock::duration>(timeout)};
+  }
+
+  /**
+   * Complete running operation with E_CANCELLED on next loop iteration, queued ones start afterwards
+   */
+  void cancel() noexcept;
+
+protected:
+  /**
+   * Constructors of StaticRadio, image - nullptr initializes with ra02_init
+   */
+  Radio(Loop & loop, const ra02_lora_image_t * image, const char * spidev, const char * gpiochip, int dio0, int dio1);
+  Radio(Loop & loop, const ra02_lora_image_t * image, spi_t & spi, gpio_t * dio0, gpio_t * dio1);
+
+private:
+  friend class Loop;
+
+  void init(spi_t * spi, gpio_t * dio0, gpio_t * dio1, const ra02_lora_image_t * image);
+  void release() noexcept;
+  bool submit(detail::Op & op);
+  error_t start(detail::Op & op);
+  void finish(detail::Op & op, error_t err) noexcept;
+  void start_next();
+  void step();
+
+  Loop &       loop_;
+  spi_t        spi_{};
+  gpio_t       dio_[2]{};
+  bool         owns_spi_ = false;
+  bool         owns_dio_[2] = {false, false};
+  bool         ready_ = false;                   /** ra02_init was called */
+  ra02_t       ra02_{};
+  detail::Op * current_ = nullptr;
+  detail::Op * head_ = nullptr;
+  detail::Op * tail_ = nullptr;
+  uint64_t     wake_ns_ = UINT64_MAX;            /** Next step of current operation */
+  Radio *      next_ = nullptr;                  /** Next radio of the loop */
+};
+
+/**
+ * Radio with configuration fixed at compile time
+ *
+ * Profile is validated by static_assert and turned into constant register
+ * image, that is written in one SPI transaction on init (ra02_init_image).
+ * Symbol duration & time on air are constants too, e.g. for application
+ * timeouts. Changing configuration through handle() is still possible, but
+ * then these constants no longer apply.
+ */
+template <Profile P>
+class StaticRadio : public Radio {
+  static_assert(P.freq_khz >= 410000 && P.freq_khz <= 525000, "frequency out of RA-02 range");
+  static_assert(P.sf >= 6 && P.sf <= 12, "spreading factor out of range");
+  static_assert(P.sf != 6 || P.implicit_header, "SF6 requires implicit header");
+  static_assert(detail::bandwidth_index(P.bandwidth) >= 0, "unsupported LoRa bandwidth");
+  static_assert(P.crc_rate >= RA02_CRC_RATE_4_5 && P.crc_rate <= RA02_CRC_RATE_4_8, "coding rate out of range");
+  static_assert(P.power >= 1 && P.power <= 20, "output power out of range");
+  static_assert(!P.implicit_header || (P.payload_len && P.payload_len <= RA02_MAX_PACKET_SIZE),
+                "implicit header requires payload length");
+
+public:
+  /** Symbol duration in us */
+  static constexpr uint32_t symbol_us = (static_cast<uint64_t>(1000000) << P.sf) / P.bandwidth;
+
+  /** Whether LowDataRateOptimize is on */
+  static constexpr bool ldro = symbol_us > RA02_LDRO_SYMBOL_US;
+
+  /** Register image, written by ra02_init_image */
+  static constexpr ra02_lora_image_t image = [] {
+    uint32_t frf = ((static_cast<uint64_t>(P.freq_khz) << 19) + RA02_FXOSC / 2000) / (RA02_FXOSC / 1000);
+    int bw = detail::bandwidth_index(P.bandwidth);
+
+    return ra02_lora_image_t{
+      .rf = {
+        static_cast<uint8_t>(frf >> 16), static_cast<uint8_t>(frf >> 8), static_cast<uint8_t>(frf),
+        detail::pa_cfg(P.power),
+      },
+      .modem = {
+        static_cast<uint8_t>(RA02_LORA_MODEM_CFG_1_BW(bw) | RA02_LORA_MODEM_CFG_1_CR(P.crc_rate)
+                             | (P.implicit_header ? RA02_LORA_MODEM_CFG_1_IMPLICIT_HDR : 0)),
+        static_cast<uint8_t>(RA02_LORA_MODEM_CFG_2_SF(P.sf) | (P.crc ? RA02_LORA_MODEM_CFG_2_RX_CRC_ON : 0)
+                             | ((RA02_DEFAULT_SYMB_TIMEOUT >> 8) & RA02_LORA_MODEM_CFG_2_SYMB_TIMEOUT_MASK)),
+        static_cast<uint8_t>(RA02_DEFAULT_SYMB_TIMEOUT & 0xFF),
+        static_cast<uint8_t>(P.preamble >> 8),
+        static_cast<uint8_t>(P.preamble),
+      },
+      /* AgcAutoOn is on after reset, ra02_init keeps it */
+      .modem_cfg_3 = static_cast<uint8_t>(RA02_LORA_MODEM_CFG_3_AGC_AUTO | (ldro ? RA02_LORA_MODEM_CFG_3_LDRO : 0)),
+      .sync_word = P.sync_word,
+      .sf = P.sf,
+      .bandwidth = P.bandwidth,
+      .preamble = P.preamble,
+      .frame = {
+        .implicit_header = P.implicit_header,
+        .payload_len = P.payload_len,
+        .crc_rate = P.crc_rate,
+        .crc = P.crc,
+      },
+    };
+  }();
+
+  /**
+   * Time on air in us of frame of size bytes, same as ra02_get_time_on_air
+   */
+  static constexpr uint32_t time_on_air_us(size_t size) {
+    /* See SX1276/77/78 datasheet, 4.1.1.7 "Time on air" */
+    int32_t sf  = P.sf;
+    int32_t de  = ldro;
+    int32_t num = 8 * static_cast<int32_t>(size) - 4 * sf + 28 + 16 * P.crc - 20 * P.implicit_header;
+    int32_t den = 4 * (sf - 2 * de);
+    int32_t payload_symbols = 8 + std::max(((num + den - 1) / den) * (P.crc_rate + 4), 0);
+
+    uint64_t quarters = (P.preamble + payload_symbols) * 4 + 17;
+
+    return (quarters * (static_cast<uint64_t>(1000000) << sf)) / (4 * static_cast<uint64_t>(P.bandwidth));
+  }
+
+  /**
+   * Worst case duration in ms of send of size bytes, same bound as the driver uses
+   */
+  static constexpr uint32_t send_timeout_ms(size_t size) {
+    return time_on_air_us(size) / 1000 + RA02_SEND_IRQ_TIMEOUT;
+  }
+
+  /**
+   * Open spidev & DIO lines, initialize driver with image (see Radio)
+   */
+  StaticRadio(Loop & loop, const char * spidev, const char * gpiochip = nullptr, int dio0 = -1, int dio1 = -1)
+    : Radio(loop, &image, spidev, gpiochip, dio0, dio1) {}
+
+  /**
+   * Initialize driver with image on SPI & DIO handles owned by caller
+   */
+  StaticRadio(Loop & loop, spi_t & spi, gpio_t * dio0 = nullptr, gpio_t * dio1 = nullptr)
+    : Radio(loop, &image, spi, dio0, dio1) {}
+};
+
+/* Variables ================================================================ */
+/* Shared functions ========================================================= */
+/**
+ * Throw Error if err isn't E_OK, e.g. for C API setters
+ */
+inline void check(error_t err, const char * what = "ra02") {
+  if (err != E_OK) {
+    throw Error(err, what);
+  }
+}
+
+inline Loop::Loop() {
+  epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+  timer_fd_ = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+  stop_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+  epoll_event timer_event = {.events = EPOLLIN, .data = {.ptr = nullptr}};
+  epoll_event stop_event = {.events = EPOLLIN, .data = {.ptr = &stop_fd_}};
+
+  if (epoll_fd_ < 0 || timer_fd_ < 0 || stop_fd_ < 0 ||
+      epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, timer_fd_, &timer_event) < 0 ||
+      epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, stop_fd_, &stop_event) < 0) {
+    close_fds();
+    throw Error(E_FAILED, "ra02::Loop");
+  }
+}
+
+inline Loop::~Loop() {
+  close_fds();
+}
+
+inline void Loop::close_fds() noexcept {
+  if (timer_fd_ >= 0) {
+    close(timer_fd_);
+    timer_fd_ = -1;
+  }
+
+  if (stop_fd_ >= 0) {
+    close(stop_fd_);
+    stop_fd_ = -1;
+  }
+
+  if (epoll_fd_ >= 0) {
+    close(epoll_fd_);
+    epoll_fd_ = -1;
+  }
+}
+
+inline void Loop::run() {
+  running_ = true;
+
+  while (running_) {
+    run_once();
+  }
+}
+
+inline void Loop::stop() noexcept {
+  running_ = false;
+
+  /* Flow may stop the loop from step pass of run_once, that would then block in epoll_wait */
+  uint64_t value = 1;
+  (void) !write(stop_fd_, &value, sizeof(value));
+}
+
+inline void Loop::run_once(int timeout_ms) {
+  uint64_t now = timeout_now_ns();
+
+  /* Completions resume flows, that may queue more operations, so next radio is taken beforehand */
+  for (Radio * radio = radios_, * next; radio; radio = next) {
+    next = radio->next_;
+
+    if (radio->current_ && radio->wake_ns_ <= now) {
+      radio->step();
+    }
+  }
+
+  arm_timer();
+
+  epoll_event events[16];
+  int count = epoll_wait(epoll_fd_, events, 16, timeout_ms);
+
+  for (int i = 0; i < count; ++i) {
+    if (events[i].data.ptr == &stop_fd_) {
+      uint64_t value;
+      (void) !read(stop_fd_, &value, sizeof(value));
+      continue;
+    }
+
+    auto * radio = static_cast<Radio *>(events[i].data.ptr);
+
+    if (!radio) {
+      uint64_t expirations;
+      (void) !read(timer_fd_, &expirations, sizeof(expirations));
+    } else if (radio->current_) {
+      radio->step();
+    } else {
+      /* Edge without operation, consume it so that fd doesn't stay readable */
+      for (gpio_t * dio : {radio->ra02_.dio0, radio->ra02_.dio1}) {
+        while (dio && gpio_wait_edge(dio, 0, nullptr) == E_OK) {}
+      }
+    }
+  }
+}
+
+inline void Loop::add(Radio & radio) {
+  for (gpio_t * dio : {radio.ra02_.dio0, radio.ra02_.dio1}) {
+    epoll_event event = {.events = EPOLLIN, .data = {.ptr = &radio}};
+
+    if (dio && epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, dio->fd, &event) < 0) {
+      throw Error(E_FAILED, "ra02::Loop: DIO");
+    }
+  }
+
+  radio.next_ = radios_;
+  radios_ = &radio;
+}
+
+inline void Loop::remove(Radio & radio) noexcept {
+  for (gpio_t * dio : {radio.ra02_.dio0, radio.ra02_.dio1}) {
+    if (dio) {
+      epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, dio->fd, nullptr);
+    }
+  }
+
+  for (Radio ** link = &radios_; *link; link = &(*link)->next_) {
+    if (*link == &radio) {
+      *link = radio.next_;
+      break;
+    }
+  }
+}
+
+inline void Loop::arm_timer() {
+  uint64_t wake_ns = UINT64_MAX;
+
+  for (Radio * radio = radios_; radio; radio = radio->next_) {
+    if (radio->current_ && radio->wake_ns_ < wake_ns) {
+      wake_ns = radio->wake_ns_;
+    }
+  }
+
+  /* Relative time, so that it follows driver clock, zero disarms the timer */
+  itimerspec spec = {};
+
+  if (wake_ns != UINT64_MAX) {
+    uint64_t now = timeout_now_ns();
+    uint64_t delta = wake_ns > now ? wake_ns - now : 1;
+
+    spec.it_value.tv_sec = delta / 1000000000;
+    spec.it_value.tv_nsec = delta % 1000000000;
+  }
+
+  timerfd_settime(timer_fd_, 0, &spec, nullptr);
+}
+
+inline Radio::Radio(Loop & loop, const char * spidev, const char * gpiochip, int dio0, int dio1)
+  : Radio(loop, nullptr, spidev, gpiochip, dio0, dio1) {}
+
+inline Radio::Radio(Loop & loop, spi_t & spi, gpio_t * dio0, gpio_t * dio1)
+  : Radio(loop, nullptr, spi, dio0, dio1) {}
+
+inline Radio::Radio(Loop & loop, const ra02_lora_image_t * image,
+                    const char * spidev, const char * gpiochip, int dio0, int dio1) : loop_(loop) {
+  try {
+    spi_cfg_t cfg;
+    spi_cfg_default(&cfg);
+    check(spi_init(&spi_, &cfg, spidev), "spi_init");
+    owns_spi_ = true;
+
+    int lines[] = {dio0, dio1};
+
+    for (size_t i = 0; i < 2; ++i) {
+      if (gpiochip && lines[i] >= 0) {
+        check(gpio_init(&dio_[i], gpiochip, lines[i], GPIO_EDGE_RISING), "gpio_init");
+        owns_dio_[i] = true;
+      }
+    }
+
+    init(&spi_, owns_dio_[0] ? &dio_[0] : nullptr, owns_dio_[1] ? &dio_[1] : nullptr, image);
+  } catch (...) {
+    release();
+    throw;
+  }
+}
+
+inline Radio::Radio(Loop & loop, const ra02_lora_image_t * image, spi_t & spi, gpio_t * dio0, gpio_t * dio1)
+  : loop_(loop) {
+  try {
+    init(&spi, dio0, dio1, image);
+  } catch (...) {
+    release();
+    throw;
+  }
+}
+
+inline Radio::~Radio() {
+  release();
+}
+
+inline void Radio::init(spi_t * spi, gpio_t * dio0, gpio_t * dio1, const ra02_lora_image_t * image) {
+  ra02_cfg_t cfg = {.spi = spi, .dio0 = dio0, .dio1 = dio1};
+
+  ready_ = true;
+
+  if (image) {
+    check(ra02_init_image(&ra02_, &cfg, image), "ra02_init_image");
+  } else {
+    check(ra02_init(&ra02_, &cfg), "ra02_init");
+  }
+
+  loop_.add(*this);
+}
+
+inline void Radio::release() noexcept {
+  loop_.remove(*this);
+
+  if (ready_) {
+    ra02_deinit(&ra02_);
+    ready_ = false;
+  }
+
+  for (size_t i = 0; i < 2; ++i) {
+    if (owns_dio_[i]) {
+      gpio_deinit(&dio_[i]);
+      owns_dio_[i] = false;
+    }
+  }
+
+  if (owns_spi_) {
+    spi_deinit(&spi_);
+    owns_spi_ = false;
+  }
+}
+
+inline void Radio::cancel() noexcept {
+  if (current_) {
+    ra02_cancel(&ra02_);
+    wake_ns_ = 0;
+  }
+}
+
+/**
+ * Start operation right away, if radio is idle, otherwise queue it
+ *
+ * @return Whether awaiting coroutine is suspended, false - operation failed to start
+ */
+inline bool Radio::submit(detail::Op & op) {
+  if (current_) {
+    op.next = nullptr;
+    (tail_ ? tail_->next : head_) = &op;
+    tail_ = &op;
+    return true;
+  }
+
+  error_t err = start(op);
+
+  if (err != E_OK) {
+    finish(op, err);
+    return false;
+  }
+
+  current_ = &op;
+  wake_ns_ = 0;
+
+  return true;
+}
+
+inline error_t Radio::start(detail::Op & op) {
+  if (!op.rx) {
+    /* Driver doesn't modify frame, it's copied into FIFO */
+    return ra02_send_start(&ra02_, const_cast<uint8_t *>(op.tx.data()), op.tx.size());
+  }
+
+  uint64_t timeout_ms = 0;
+
+  if (op.deadline != Clock::time_point::max()) {
+    auto left = op.deadline - Clock::now();
+
+    if (left.count() <= 0) {
+      return E_TIMEOUT;
+    }
+
+    timeout_ms = std::min<uint64_t>(std::chrono::ceil<std::chrono::milliseconds>(left).count(), UINT32_MAX);
+  }
+
+  op.rx->size = op.rx->data.size();
+
+  return ra02_recv_start(&ra02_, op.rx->data.data(), &op.rx->size, timeout_ms);
+}
+
+inline void Radio::finish(detail::Op & op, error_t err) noexcept {
+  op.err = err;
+
+  if (op.rx) {
+    op.rx->err = err;
+    op.rx->size = err == E_OK ? op.rx->size : 0;
+    op.rx->rssi = ra02_.last_rssi;
+    op.rx->snr = ra02_.last_snr;
+    op.rx->rx_ns = ra02_.last_rx_ns;
+  }
+}
+
+/**
+ * Start queued operations until one runs, resuming those that failed to start
+ */
+inline void Radio::start_next() {
+  while (!current_ && head_) {
+    detail::Op * op = head_;
+
+    head_ = op->next;
+    tail_ = head_ ? tail_ : nullptr;
+
+    error_t err = start(*op);
+
+    if (err == E_OK) {
+      current_ = op;
+      wake_ns_ = 0;
+    } else {
+      finish(*op, err);
+      op->waiter.resume();
+    }
+  }
+}
+
+inline void Radio::step() {
+  uint64_t wake_ns;
+  error_t err = ra02_step(&ra02_, &wake_ns);
+
+  if (err == E_AGAIN) {
+    wake_ns_ = wake_ns;
+    return;
+  }
+
+  detail::Op * op = current_;
+
+  current_ = nullptr;
+  wake_ns_ = UINT64_MAX;
+
+  finish(*op, err);
+
+  /* Next operation starts before the flow runs, so that radio doesn't idle while it does */
+  start_next();
+
+  op->waiter.resume();
+}
+
+} /* namespace ra02 */
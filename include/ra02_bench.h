@@ -0,0 +1,161 @@
+/** ========================================================================= *
+ *
+ * @file ra02_bench.h
+ * @date 17-10-2026
+ * @author Maksym Tkachuk <max.r.tkachuk@gmail.com>
+ *
+ * @brief Link benchmark: throughput, packet error rate and latency
+ *
+ * Sender emits sequence-numbered, timestamped frames of configured size at
+ * configured interval, receiver counts them and reports goodput, PER, RSSI &
+ * SNR statistics and inter-arrival jitter. Ping-pong mode measures round
+ * trip: responder answers every ping and reports its turnaround (RX_DONE to
+ * TX start) in the pong, so radio & host overhead can be told apart.
+ * Timestamps are CLOCK_MONOTONIC of the side, that measured them, frames
+ * from different hosts are never compared against each other's clock
+ *
+ * Frame: [magic] [type] [seq, 4 bytes] [count, 4 bytes] [time in ns,
+ * 8 bytes] [padding up to frame size], little endian
+ *
+ *  ========================================================================= */
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ================================================================= */
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <error.h>
+#include <ra02.h>
+
+/* Defines ================================================================== */
+/**
+ * Benchmark frame header size, smallest frame size
+ */
+#define RA02_BENCH_HEADER_SIZE 18
+
+/**
+ * Max frames in one run, receiver ignores frames announcing more, as its
+ * sequence bitmap is sized by the announced count
+ */
+#define RA02_BENCH_MAX_COUNT 1000000
+
+/* Macros =================================================================== */
+/* Enums ==================================================================== */
+/**
+ * Benchmark role
+ */
+typedef enum {
+  RA02_BENCH_MODE_TX = 0,   /** Send frames */
+  RA02_BENCH_MODE_RX,       /** Count frames */
+  RA02_BENCH_MODE_PING,     /** Send pings, measure round trip */
+  RA02_BENCH_MODE_PONG,     /** Answer pings */
+} ra02_bench_mode_t;
+
+/* Types ==================================================================== */
+/**
+ * Benchmark config, same on both sides
+ */
+typedef struct {
+  ra02_t * ra02;
+  uint32_t count;           /** Frames (pings) to send, up to RA02_BENCH_MAX_COUNT, 0 - default */
+  uint8_t  size;            /** Frame size, RA02_BENCH_HEADER_SIZE..RA02_MAX_PACKET_SIZE, 0 - default */
+  uint32_t interval_ms;     /** Between TX starts, 0 - back-to-back */
+  uint8_t  sf;              /** Profile, 0 - keep current */
+  uint32_t bandwidth;       /** Profile in Hz, 0 - keep current */
+  uint32_t timeout_ms;      /** RX & pong: idle time to give up after, ping: reply timeout, 0 - default */
+} ra02_bench_cfg_t;
+
+/**
+ * Running statistics of a value
+ */
+typedef struct {
+  uint32_t count;
+  int64_t  min;
+  int64_t  max;
+  double   sum;
+  double   sum_sq;
+} ra02_bench_stat_t;
+
+/**
+ * Benchmark results, fields not relevant to mode are zero
+ */
+typedef struct {
+  ra02_bench_mode_t mode;
+  uint32_t          airtime_us;    /** Time on air of one frame */
+  uint64_t          duration_us;   /** TX: first to last TX start, RX: first to last RX_DONE */
+  uint32_t          sent;          /** Frames (pings, pongs) sent */
+  uint32_t          failed;        /** TX errors */
+  uint32_t          expected;      /** RX: frames announced by sender, PING: pings sent */
+  uint32_t          received;      /** Valid frames (pongs) received */
+  uint32_t          corrupt;       /** Frames with CRC error */
+  uint32_t          duplicates;
+  uint32_t          out_of_order;
+  double            per;           /** Packet error rate, 0..1 */
+  double            goodput_bps;   /** RX: payload bits per second */
+  ra02_bench_stat_t rssi;          /** dBm */
+  ra02_bench_stat_t snr;           /** dB */
+  ra02_bench_stat_t interarrival_us; /** RX: normalized by sequence gap */
+  ra02_bench_stat_t rtt_us;        /** PING: round trip */
+  ra02_bench_stat_t turnaround_us; /** PING: reported by responder, PONG: measured */
+} ra02_bench_result_t;
+
+/* Variables ================================================================ */
+/* Shared functions ========================================================= */
+/**
+ * Parse mode name: "tx", "rx", "ping" or "pong"
+ *
+ * @param name Mode name
+ * @param mode Output
+ */
+error_t ra02_bench_parse_mode(const char * name, ra02_bench_mode_t * mode);
+
+/**
+ * Run benchmark role until done, idle timeout or stop flag
+ *
+ * @param cfg Benchmark config
+ * @param mode Role
+ * @param running Stop flag, may be cleared from signal handler, NULL - until done
+ * @param result Output
+ */
+error_t ra02_bench_run(
+  const ra02_bench_cfg_t * cfg,
+  ra02_bench_mode_t mode,
+  volatile bool * running,
+  ra02_bench_result_t * result
+);
+
+/**
+ * Run benchmark between 2 emulated radios in real time, local side runs
+ * given role and emulated peer the matching one (RX for TX, PONG for PING)
+ *
+ * @param cfg Benchmark config, ra02 is ignored
+ * @param mode Local role, RA02_BENCH_MODE_TX or RA02_BENCH_MODE_PING
+ * @param result Output, local results
+ * @param peer_result Output, peer results
+ */
+error_t ra02_bench_simulate(
+  const ra02_bench_cfg_t * cfg,
+  ra02_bench_mode_t mode,
+  ra02_bench_result_t * result,
+  ra02_bench_result_t * peer_result
+);
+
+/**
+ * Write results as JSON object
+ *
+ * @param file Output
+ * @param cfg Benchmark config, that was run
+ * @param result Results
+ *
+ * @note Output is flushed before return
+ */
+error_t ra02_bench_write_json(FILE * file, const ra02_bench_cfg_t * cfg, const ra02_bench_result_t * result);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,265 @@
+/** ========================================================================= *
+ *
+ * @file ra02_daemon.h
+ * @date 17-10-2026
+ * @author Maksym Tkachuk <max.r.tkachuk@gmail.com>
+ *
+ * @brief Radio daemon, that owns ra02 and serves clients over Unix socket
+ *
+ * Daemon receives continuously in short slices between serving clients, so
+ * frames are not lost while no client is waiting: they are kept in a backlog
+ * and returned by following recv requests. Subscribed clients get every
+ * received frame as it arrives.
+ *
+ * Protocol runs over SOCK_SEQPACKET, one message per datagram:
+ * [type] [status] [payload size, 2 bytes] [payload], in host byte order,
+ * as both ends are on the same machine. Every request is answered with a
+ * message of the same type, where status is error_t of the operation
+ *
+ *  ========================================================================= */
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ================================================================= */
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <error.h>
+#include <ra02.h>
+
+/* Defines ================================================================== */
+/**
+ * Socket path, used when RA02_SOCKET environment variable is not set
+ */
+#ifndef RA02_DAEMON_DEFAULT_SOCKET
+#define RA02_DAEMON_DEFAULT_SOCKET "/tmp/linux-ra02.sock"
+#endif
+
+/**
+ * Max connected clients
+ */
+#ifndef RA02_DAEMON_MAX_CLIENTS
+#define RA02_DAEMON_MAX_CLIENTS 8
+#endif
+
+/**
+ * Received frames kept for following recv requests
+ */
+#ifndef RA02_DAEMON_BACKLOG_SIZE
+#define RA02_DAEMON_BACKLOG_SIZE 16
+#endif
+
+/**
+ * Message header size
+ */
+#define RA02_DAEMON_HEADER_SIZE 4
+
+/**
+ * Max message size
+ */
+#define RA02_DAEMON_MAX_MESSAGE (RA02_DAEMON_HEADER_SIZE + sizeof(ra02_daemon_packet_t))
+
+/* Macros =================================================================== */
+/* Enums ==================================================================== */
+/**
+ * Message types
+ */
+typedef enum {
+  RA02_DAEMON_MSG_SEND = 1,   /** Request: frame, response: empty */
+  RA02_DAEMON_MSG_RECV,       /** Request: timeout in ms (uint32_t), response: ra02_daemon_packet_t */
+  RA02_DAEMON_MSG_SUBSCRIBE,  /** Request: empty, response: empty, followed by RA02_DAEMON_MSG_PACKET */
+  RA02_DAEMON_MSG_CONFIG,     /** Request: ra02_daemon_config_t, response: empty */
+  RA02_DAEMON_MSG_STATS,      /** Request: empty, response: ra02_daemon_stats_t */
+  RA02_DAEMON_MSG_PACKET,     /** Daemon to subscriber: ra02_daemon_packet_t */
+} ra02_daemon_msg_type_t;
+
+/**
+ * Radio parameters, that can be changed by clients
+ */
+typedef enum {
+  RA02_DAEMON_PARAM_FREQ = 0, /** kHz */
+  RA02_DAEMON_PARAM_POWER,    /** dBm */
+  RA02_DAEMON_PARAM_SF,
+  RA02_DAEMON_PARAM_BANDWIDTH,/** Hz */
+  RA02_DAEMON_PARAM_PREAMBLE, /** Symbols */
+  RA02_DAEMON_PARAM_CRC_RATE, /** ra02_crc_rate_t */
+  RA02_DAEMON_PARAM_SYNC_WORD,
+} ra02_daemon_param_t;
+
+/* Types ==================================================================== */
+/**
+ * Configuration request
+ */
+typedef struct {
+  uint32_t param;             /** ra02_daemon_param_t */
+  uint32_t value;
+} ra02_daemon_config_t;
+
+/**
+ * Received frame, only first size bytes of data are transferred
+ */
+typedef struct {
+  uint64_t rx_ns;             /** CLOCK_MONOTONIC time of RX_DONE */
+  int8_t   rssi;
+  int8_t   snr;
+  uint8_t  size;
+  uint8_t  data[RA02_MAX_PACKET_SIZE];
+} ra02_daemon_packet_t;
+
+/**
+ * Daemon statistics
+ */
+typedef struct {
+  uint64_t uptime_ms;
+  uint32_t rx;
+  uint32_t rx_bad;            /** Frames with CRC error */
+  uint32_t rx_dropped;        /** Frames lost because backlog was full */
+  uint32_t tx;
+  uint32_t tx_failed;
+  uint32_t clients;           /** Currently connected */
+  uint32_t requests;
+} ra02_daemon_stats_t;
+
+/**
+ * Connected client
+ */
+typedef struct {
+  int      fd;                /** -1 - free */
+  bool     subscribed;
+  uint64_t recv_deadline_ns;  /** Pending recv request, 0 - none */
+} ra02_daemon_client_t;
+
+/**
+ * Daemon context
+ */
+typedef struct {
+  ra02_t *             ra02;
+  const char *         path;
+  int                  fd;
+  volatile bool        running;
+  uint64_t             start_ns;
+  ra02_daemon_client_t clients[RA02_DAEMON_MAX_CLIENTS];
+  ra02_daemon_packet_t backlog[RA02_DAEMON_BACKLOG_SIZE];
+  uint8_t              backlog_head;
+  uint8_t              backlog_count;
+  ra02_daemon_stats_t  stats;
+} ra02_daemon_t;
+
+/* Variables ================================================================ */
+/* Shared functions ========================================================= */
+/**
+ * Get socket path: RA02_SOCKET environment variable or default
+ */
+const char * ra02_daemon_socket_path(void);
+
+/**
+ * Initialize daemon and start listening on socket
+ *
+ * @param daemon Daemon Handle
+ * @param ra02 Initialized radio, owned by daemon from now on
+ * @param path Socket path
+ *
+ * @retval E_BUSY Other daemon is already listening on path
+ */
+error_t ra02_daemon_init(ra02_daemon_t * daemon, ra02_t * ra02, const char * path);
+
+/**
+ * Close client connections and remove socket
+ *
+ * @param daemon Daemon Handle
+ */
+error_t ra02_daemon_deinit(ra02_daemon_t * daemon);
+
+/**
+ * Serve clients and receive frames until ra02_daemon_stop is called
+ *
+ * @param daemon Daemon Handle
+ */
+error_t ra02_daemon_run(ra02_daemon_t * daemon);
+
+/**
+ * Ask running daemon to stop, safe to call from signal handler
+ *
+ * @param daemon Daemon Handle
+ */
+void ra02_daemon_stop(ra02_daemon_t * daemon);
+
+/**
+ * Connect to daemon
+ *
+ * @param path Socket path
+ * @param fd Output, connection
+ *
+ * @retval E_NOTFOUND Daemon is not running
+ */
+error_t ra02_client_connect(const char * path, int * fd);
+
+/**
+ * Close connection to daemon
+ *
+ * @param fd Connection
+ */
+error_t ra02_client_disconnect(int fd);
+
+/**
+ * Send frame through daemon
+ *
+ * @param fd Connection
+ * @param buf Frame
+ * @param size Frame size
+ */
+error_t ra02_client_send(int fd, const uint8_t * buf, size_t size);
+
+/**
+ * Receive frame through daemon, frames received since last request are
+ * returned first
+ *
+ * @param fd Connection
+ * @param packet Output, frame & metadata
+ * @param timeout_ms Timeout
+ *
+ * @retval E_TIMEOUT Nothing received in time
+ */
+error_t ra02_client_recv(int fd, ra02_daemon_packet_t * packet, uint32_t timeout_ms);
+
+/**
+ * Subscribe to all received frames, read them with ra02_client_next
+ *
+ * @param fd Connection
+ */
+error_t ra02_client_subscribe(int fd);
+
+/**
+ * Wait for next frame after subscribing
+ *
+ * @param fd Connection
+ * @param packet Output, frame & metadata
+ * @param timeout_ms Timeout, -1 - infinite
+ *
+ * @retval E_TIMEOUT Nothing received in time
+ */
+error_t ra02_client_next(int fd, ra02_daemon_packet_t * packet, int timeout_ms);
+
+/**
+ * Change radio parameter
+ *
+ * @param fd Connection
+ * @param param Parameter
+ * @param value Value
+ */
+error_t ra02_client_config(int fd, ra02_daemon_param_t param, uint32_t value);
+
+/**
+ * Get daemon statistics
+ *
+ * @param fd Connection
+ * @param stats Output
+ */
+error_t ra02_client_stats(int fd, ra02_daemon_stats_t * stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,183 @@
+/** ========================================================================= *
+ *
+ * @file ra02_emu.h
+ * @date 17-10-2026
+ * @author Maksym Tkachuk <max.r.tkachuk@gmail.com>
+ *
+ * @brief Register level SX1278 emulator, plugs into spi_t instead of spidev
+ *
+ * Emulates LoRa modem only: FIFO, op modes (TX, RX single/continuous, CAD),
+ * symbol timeout, IRQ flags, packet & channel RSSI and SNR. Frames are
+ * exchanged over shared emulated air in real (CLOCK_MONOTONIC) time, with
+ * time on air calculated from modem configuration. Overlapping frames on
+ * the same channel & SF collide and are received with CRC error
+ *
+ * Optionally air models path loss between radios: received power decides
+ * sensitivity (SNR floor per SF), capture (frame survives same SF
+ * interferer weaker by capture threshold) and imperfect SF orthogonality
+ * (other SF corrupts frame only when much stronger). Frames can also be
+ * made visible to other radios only after a latency, so radios running on
+ * separate virtual clocks can be synchronized conservatively
+ *
+ * DIO0 & DIO1 can be emulated as gpio_t backed by a pipe, carrying edge
+ * events with exact emulated timestamps. Emulated state advances on SPI
+ * access, so events show up when driver polls IRQ flags
+ *
+ *  ========================================================================= */
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ================================================================= */
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <error.h>
+#include <spi.h>
+#include <gpio.h>
+
+/* Defines ================================================================== */
+/**
+ * Max frames remembered by emulated air
+ */
+#ifndef RA02_EMU_MAX_FRAMES
+#define RA02_EMU_MAX_FRAMES 256
+#endif
+
+/**
+ * SX1278 FIFO size
+ */
+#define RA02_EMU_FIFO_SIZE 256
+
+/**
+ * SX1278 register space size
+ */
+#define RA02_EMU_REG_COUNT 128
+
+/**
+ * Number of emulated DIO lines (DIO0, DIO1)
+ */
+#define RA02_EMU_DIO_COUNT 2
+
+/* Macros =================================================================== */
+/* Enums ==================================================================== */
+/* Types ==================================================================== */
+struct ra02_emu_s;
+
+/**
+ * Path loss between two emulated radios in dB
+ */
+typedef float (*ra02_emu_path_loss_fn_t)(void * ctx, const struct ra02_emu_s * from, const struct ra02_emu_s * to);
+
+/**
+ * Frame on emulated air
+ */
+typedef struct {
+  uint64_t start_ns;      /** TX start */
+  uint64_t preamble_ns;   /** End of preamble */
+  uint64_t end_ns;        /** TX end */
+  uint32_t frf;           /** Carrier frequency (raw FRF registers) */
+  uint8_t  sf;            /** Spreading factor */
+  uint8_t  bw;            /** Bandwidth (raw MODEM_CFG_1 bits) */
+  uint8_t  sync_word;     /** LoRa sync word */
+  uint8_t  size;          /** Payload size */
+  int8_t   power;         /** TX power in dBm */
+  uint8_t  data[256];     /** Payload */
+  const void * sender;    /** Emulated radio, that sent the frame */
+} ra02_emu_frame_t;
+
+/**
+ * Emulated air, shared by emulated radios
+ */
+typedef struct {
+  pthread_mutex_t  lock;
+  ra02_emu_frame_t frames[RA02_EMU_MAX_FRAMES]; /** Ring of last frames */
+  uint64_t         count;                       /** Total frames sent */
+  uint64_t         latency_ns;                  /** Delay after TX start, before other radios see frame, 0 - none */
+  ra02_emu_path_loss_fn_t path_loss;            /** Optional, NULL - every radio receives with its own rssi */
+  void *           ctx;                         /** Context passed to path_loss */
+} ra02_emu_air_t;
+
+/**
+ * Emulated SX1278
+ */
+typedef struct ra02_emu_s {
+  ra02_emu_air_t * air;
+  uint8_t  regs[RA02_EMU_REG_COUNT];
+  uint8_t  fifo[RA02_EMU_FIFO_SIZE];
+  uint64_t mode_start_ns; /** Time current op mode was entered */
+  uint64_t mode_end_ns;   /** Time current op mode ends (TX end, CAD end, symbol timeout) */
+  uint64_t rx_frame;      /** Index of frame being received + 1, 0 if none */
+  bool     rx_header;     /** VALID_HDR was raised for rx_frame */
+  int8_t   rssi;          /** Simulated RSSI of received frames in dBm, unless air has path loss */
+  int8_t   snr;           /** Simulated SNR of received frames in dB, unless air has path loss */
+  int8_t   noise;         /** Simulated noise floor in dBm, reported as channel RSSI while air is idle */
+  int8_t   power;         /** Simulated TX power in dBm, used with air path loss */
+  int      dio_fd[RA02_EMU_DIO_COUNT]; /** Write ends of emulated DIO lines, -1 if not used */
+} ra02_emu_t;
+
+/* Variables ================================================================ */
+/* Shared functions ========================================================= */
+/**
+ * Initialize emulated air
+ *
+ * @param air Air Handle
+ */
+error_t ra02_emu_air_init(ra02_emu_air_t * air);
+
+/**
+ * Deinitialize emulated air
+ *
+ * @param air Air Handle
+ */
+error_t ra02_emu_air_deinit(ra02_emu_air_t * air);
+
+/**
+ * Initialize emulated radio and attach it to SPI handle, which then can be
+ * passed to ra02_init as usual
+ *
+ * @param emu Emulator Handle
+ * @param air Air to send/receive frames to/from
+ * @param spi SPI Handle to attach to, must not be initialized with spi_init
+ */
+error_t ra02_emu_init(ra02_emu_t * emu, ra02_emu_air_t * air, spi_t * spi);
+
+/**
+ * Deinitialize emulated radio
+ *
+ * @param emu Emulator Handle
+ */
+error_t ra02_emu_deinit(ra02_emu_t * emu);
+
+/**
+ * Create emulated DIO line, that can be passed to ra02_init
+ *
+ * @note Line must be released with gpio_deinit
+ *
+ * @param emu Emulator Handle
+ * @param dio DIO index (0 or 1)
+ * @param gpio Output, GPIO Handle
+ */
+error_t ra02_emu_dio_init(ra02_emu_t * emu, uint8_t dio, gpio_t * gpio);
+
+/**
+ * Get time of next state change, that emulated radio already knows about:
+ * TX or CAD end, symbol timeout, header or end of frame being received
+ *
+ * @param emu Emulator Handle
+ *
+ * @return CLOCK_MONOTONIC time in ns, UINT64_MAX if radio only waits for air
+ */
+uint64_t ra02_emu_next_event_ns(ra02_emu_t * emu);
+
+/**
+ * Handle SPI transfer to emulated radio, see spi_transfer_fn_t
+ */
+error_t ra02_emu_transfer(void * ctx, uint8_t * tx_buf, uint8_t * rx_buf, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
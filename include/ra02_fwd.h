@@ -0,0 +1,202 @@
+/** ========================================================================= *
+ *
+ * @file ra02_fwd.h
+ * @date 17-10-2026
+ * @author Maksym Tkachuk <max.r.tkachuk@gmail.com>
+ *
+ * @brief Gateway packet forwarder (Semtech UDP protocol) on top of ra02 driver
+ *
+ * Radio thread (caller of ra02_fwd_run) receives continuously in short
+ * slices and transmits queued downlinks at their exact instants. Received
+ * frames are passed through a queue to network thread, which does all JSON
+ * and base64 work and talks to network server: PUSH_DATA with rxpk & stat,
+ * PULL_DATA keepalive, PULL_RESP with txpk answered by TX_ACK.
+ * Timestamps (tmst) are CLOCK_MONOTONIC microseconds, truncated to 32 bits
+ *
+ *  ========================================================================= */
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ================================================================= */
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <error.h>
+#include <timeout.h>
+#include <ra02.h>
+
+/* Defines ================================================================== */
+/**
+ * Semtech UDP protocol version
+ */
+#define RA02_FWD_PROTOCOL_VERSION 2
+
+/**
+ * Received frames waiting for network thread
+ */
+#ifndef RA02_FWD_RX_QUEUE_SIZE
+#define RA02_FWD_RX_QUEUE_SIZE 16
+#endif
+
+/**
+ * Scheduled downlinks
+ */
+#ifndef RA02_FWD_TX_QUEUE_SIZE
+#define RA02_FWD_TX_QUEUE_SIZE 8
+#endif
+
+/* Macros =================================================================== */
+/* Enums ==================================================================== */
+/**
+ * Semtech UDP packet types
+ */
+typedef enum {
+  RA02_FWD_PUSH_DATA = 0x00,
+  RA02_FWD_PUSH_ACK  = 0x01,
+  RA02_FWD_PULL_DATA = 0x02,
+  RA02_FWD_PULL_RESP = 0x03,
+  RA02_FWD_PULL_ACK  = 0x04,
+  RA02_FWD_TX_ACK    = 0x05,
+} ra02_fwd_packet_type_t;
+
+/* Types ==================================================================== */
+/**
+ * Forwarder config
+ */
+typedef struct {
+  ra02_t *     ra02;          /** Configured for reception (SF, bandwidth, coding rate) */
+  const char * host;          /** Network server address */
+  uint16_t     port_up;       /** PUSH_DATA port */
+  uint16_t     port_down;     /** PULL_DATA port, 0 - same as port_up */
+  uint64_t     gateway_eui;
+  uint32_t     freq_khz;      /** Channel frequency */
+  uint32_t     keepalive_ms;  /** PULL_DATA interval, 0 - default */
+  uint32_t     stat_ms;       /** Status report interval, 0 - default */
+  uint32_t     rx_slice_ms;   /** Longest RX slice between checks of downlink queue, 0 - default */
+  uint32_t     tx_lead_ms;    /** Time reserved to reconfigure radio before TX, 0 - default */
+} ra02_fwd_cfg_t;
+
+/**
+ * Received frame
+ */
+typedef struct {
+  uint64_t rx_ns;             /** CLOCK_MONOTONIC time of RX_DONE */
+  int8_t   rssi;
+  int8_t   snr;
+  uint8_t  sf;
+  uint8_t  crc_rate;
+  uint32_t bandwidth;
+  uint8_t  size;
+  uint8_t  data[RA02_MAX_PACKET_SIZE];
+} ra02_fwd_rxpk_t;
+
+/**
+ * Scheduled downlink
+ */
+typedef struct {
+  uint64_t at_ns;             /** CLOCK_MONOTONIC TX instant, 0 - immediately */
+  uint32_t freq_khz;
+  int8_t   power;             /** dBm, -1 - keep current */
+  uint8_t  sf;
+  uint8_t  crc_rate;
+  bool     crc;
+  bool     ipol;              /** Inverted I/Q (LoRaWAN downlinks) */
+  uint32_t bandwidth;
+  uint32_t airtime_us;
+  uint8_t  size;
+  uint8_t  data[RA02_MAX_PACKET_SIZE];
+} ra02_fwd_txpk_t;
+
+/**
+ * Forwarder statistics
+ */
+typedef struct {
+  uint32_t rx_ok;
+  uint32_t rx_bad;            /** Frames with CRC error */
+  uint32_t rx_forwarded;
+  uint32_t rx_dropped;        /** Frames lost because RX queue was full */
+  uint32_t push_sent;
+  uint32_t push_acked;
+  uint32_t pull_sent;
+  uint32_t pull_acked;
+  uint32_t tx_received;       /** PULL_RESP datagrams */
+  uint32_t tx_rejected;       /** Downlinks refused in TX_ACK */
+  uint32_t tx_sent;
+  uint32_t tx_late;           /** Downlinks that missed their instant */
+  uint32_t tx_failed;         /** Downlinks that failed with radio error */
+} ra02_fwd_stats_t;
+
+/**
+ * Forwarder context
+ */
+typedef struct {
+  ra02_fwd_cfg_t   cfg;
+  int              sock_up;
+  int              sock_down;
+  int              wake_fd;   /** eventfd, wakes network thread */
+  pthread_t        thread;
+  pthread_mutex_t  lock;      /** Guards queues & stats */
+  volatile bool    running;
+  uint16_t         push_token;
+  uint16_t         pull_token;
+  unsigned int     seed;
+  ra02_fwd_rxpk_t  rx[RA02_FWD_RX_QUEUE_SIZE];
+  uint8_t          rx_head;
+  uint8_t          rx_count;
+  ra02_fwd_txpk_t  tx[RA02_FWD_TX_QUEUE_SIZE]; /** Sorted by at_ns */
+  uint8_t          tx_count;
+  ra02_fwd_stats_t stats;
+} ra02_fwd_t;
+
+/* Variables ================================================================ */
+/* Shared functions ========================================================= */
+/**
+ * Initialize forwarder: resolve server, open sockets, tune radio to channel
+ *
+ * @param fwd Forwarder Handle
+ * @param cfg Config
+ *
+ * @retval E_NOTFOUND Server address can't be resolved
+ */
+error_t ra02_fwd_init(ra02_fwd_t * fwd, const ra02_fwd_cfg_t * cfg);
+
+/**
+ * Release sockets
+ *
+ * @param fwd Forwarder Handle
+ */
+error_t ra02_fwd_deinit(ra02_fwd_t * fwd);
+
+/**
+ * Run forwarder: starts network thread and services the radio in calling
+ * thread, until ra02_fwd_stop is called or timeout expires
+ *
+ * @param fwd Forwarder Handle
+ * @param timeout Time to run for, NULL - until stopped
+ */
+error_t ra02_fwd_run(ra02_fwd_t * fwd, timeout_t * timeout);
+
+/**
+ * Ask running forwarder to stop, safe to call from signal handler
+ *
+ * @note Radio thread notices it after current RX slice or TX
+ *
+ * @param fwd Forwarder Handle
+ */
+void ra02_fwd_stop(ra02_fwd_t * fwd);
+
+/**
+ * Copy statistics
+ *
+ * @param fwd Forwarder Handle
+ * @param stats Output
+ */
+error_t ra02_fwd_get_stats(ra02_fwd_t * fwd, ra02_fwd_stats_t * stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,270 @@
+/** ========================================================================= *
+ *
+ * @file ra02_mac.h
+ * @date 17-10-2026
+ * @author Maksym Tkachuk <max.r.tkachuk@gmail.com>
+ *
+ * @brief TDMA MAC on top of ra02 driver
+ *
+ * Coordinator defines a superframe by periodic beacons (time sync beacon
+ * extended with slot plan and join grants). Superframe is split into beacon
+ * slot and equal data slots: [beacon] [join x J] [uplink x U] [downlink x D]. Nodes join by
+ * sending a request in a random join slot (slotted ALOHA), coordinator grants
+ * an uplink slot in following beacons. Each uplink slot is owned by a single
+ * node, downlink slots carry coordinator frames, node listens only to the
+ * downlink slot mapped to its uplink slot. Guard time covers clock drift
+ * over a superframe and TX/RX timing jitter
+ *
+ *  ========================================================================= */
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ================================================================= */
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <error.h>
+#include <ra02.h>
+#include <ra02_timesync.h>
+
+/* Defines ================================================================== */
+/**
+ * Max slots in superframe (excluding beacon)
+ */
+#ifndef RA02_MAC_MAX_SLOTS
+#define RA02_MAC_MAX_SLOTS 64
+#endif
+
+/**
+ * Frames queued per slot
+ */
+#ifndef RA02_MAC_QUEUE_SIZE
+#define RA02_MAC_QUEUE_SIZE 4
+#endif
+
+/**
+ * Max join grants announced in a single beacon
+ */
+#define RA02_MAC_MAX_GRANTS 4
+
+/**
+ * MAC header size of data frame: [type] [src, 2 bytes LE] [dst, 2 bytes LE]
+ */
+#define RA02_MAC_HEADER_SIZE 5
+
+/**
+ * Max MAC payload per frame, so that frame with header fits into a packet
+ */
+#define RA02_MAC_MAX_PAYLOAD (RA02_MAX_PACKET_SIZE - RA02_MAC_HEADER_SIZE)
+
+/**
+ * Beacon size: time sync beacon, [join] [uplink] [downlink] [payload]
+ * [slot_us, 4 bytes LE] [grant count] and grants [node, 2 bytes LE] [slot]
+ */
+#define RA02_MAC_BEACON_SIZE(grants) (RA02_TIMESYNC_BEACON_SIZE + 9 + (grants) * 3)
+
+/**
+ * Coordinator address
+ */
+#define RA02_MAC_COORDINATOR 0x0000
+
+/**
+ * Uplink slot is not assigned
+ */
+#define RA02_MAC_NO_SLOT 0xFF
+
+/* Macros =================================================================== */
+/* Enums ==================================================================== */
+/**
+ * Channel access protocols compared by ra02_mac_simulate
+ */
+typedef enum {
+  RA02_MAC_PROTO_ALOHA = 0, /** Transmit as soon as frame is queued */
+  RA02_MAC_PROTO_LBT,       /** CAD before transmit, random backoff if busy */
+  RA02_MAC_PROTO_TDMA,      /** Transmit in own uplink slot */
+} ra02_mac_proto_t;
+
+/* Types ==================================================================== */
+/**
+ * Received frame handler
+ */
+typedef void (*ra02_mac_rx_fn_t)(void * ctx, uint16_t src, const uint8_t * buf, size_t size);
+
+/**
+ * MAC config
+ */
+typedef struct {
+  ra02_t * ra02;
+  uint16_t address;        /** Own address, RA02_MAC_COORDINATOR for coordinator */
+  uint8_t  join_slots;     /** Coordinator only, rest is learned from beacons */
+  uint8_t  uplink_slots;
+  uint8_t  downlink_slots;
+  uint8_t  max_payload;    /** Max MAC payload, sets slot length */
+  uint16_t drift_ppm;      /** Max clock drift between coordinator and nodes */
+  uint32_t jitter_us;      /** TX/RX timing uncertainty */
+  ra02_mac_rx_fn_t rx;     /** Optional, received frame handler */
+  void *   rx_ctx;
+} ra02_mac_cfg_t;
+
+/**
+ * Superframe timing, calculated from config & modem settings
+ */
+typedef struct {
+  uint32_t airtime_us;     /** Time on air of the longest data frame */
+  uint32_t guard_us;       /** Guard time per slot */
+  uint32_t beacon_slot_us; /** Beacon slot length, time on air of the longest beacon + guard */
+  uint32_t slot_us;        /** Data slot length, airtime + guard */
+  uint32_t superframe_us;  /** Beacon period */
+} ra02_mac_plan_t;
+
+/**
+ * Queued frame
+ */
+typedef struct {
+  uint16_t dst;
+  uint8_t  size;
+  uint8_t  data[RA02_MAC_MAX_PAYLOAD];
+} ra02_mac_frame_t;
+
+/**
+ * Per slot TX queue
+ */
+typedef struct {
+  ra02_mac_frame_t frames[RA02_MAC_QUEUE_SIZE];
+  uint8_t head;
+  uint8_t count;
+} ra02_mac_queue_t;
+
+/**
+ * Join grant
+ */
+typedef struct {
+  uint16_t node;
+  uint8_t  slot;
+  uint8_t  beacons;        /** Beacons left to announce grant in */
+} ra02_mac_grant_t;
+
+/**
+ * MAC statistics
+ */
+typedef struct {
+  uint32_t superframes;
+  uint32_t beacons_missed;
+  uint32_t tx;
+  uint32_t rx;
+  uint32_t joins;          /** Coordinator: grants issued, node: join requests sent */
+  uint32_t dropped;        /** Frames rejected because queue was full */
+} ra02_mac_stats_t;
+
+/**
+ * MAC context
+ */
+typedef struct {
+  ra02_mac_cfg_t   cfg;
+  ra02_mac_plan_t  plan;
+  ra02_timesync_t  ts;
+  bool             synced;       /** Node: superframe start is known */
+  uint8_t          missed;       /** Node: consecutive beacons missed */
+  uint8_t          slot;         /** Node: own uplink slot */
+  uint64_t         start_ns;     /** CLOCK_MONOTONIC start of current superframe */
+  uint16_t         owners[RA02_MAC_MAX_SLOTS]; /** Coordinator: uplink slot owners */
+  ra02_mac_grant_t grants[RA02_MAC_MAX_GRANTS];
+  ra02_mac_queue_t queues[RA02_MAC_MAX_SLOTS]; /** Indexed by slot (join slots excluded) */
+  unsigned int     seed;
+  ra02_mac_stats_t stats;
+} ra02_mac_t;
+
+/**
+ * Channel access simulation parameters
+ */
+typedef struct {
+  ra02_mac_proto_t proto;
+  uint8_t  nodes;
+  uint8_t  payload_size;   /** Application payload, MAC header is added on top */
+  uint8_t  join_slots;     /** TDMA superframe overhead */
+  float    load;           /** Offered load in frame airtimes per airtime (G) */
+  uint16_t drift_ppm;
+  uint32_t jitter_us;
+  uint32_t duration_ms;    /** Simulated (virtual) time */
+  uint32_t seed;
+} ra02_mac_sim_cfg_t;
+
+/**
+ * Channel access simulation results
+ */
+typedef struct {
+  uint32_t offered;        /** Frames generated */
+  uint32_t sent;           /** Transmissions */
+  uint32_t delivered;      /** Frames received without collision */
+  uint32_t collided;
+  uint32_t dropped;        /** Frames dropped on full queue */
+  double   goodput_bps;    /** Delivered application bits per second */
+  double   utilization;    /** Share of time channel carried delivered frames */
+} ra02_mac_sim_result_t;
+
+/* Variables ================================================================ */
+/* Shared functions ========================================================= */
+/**
+ * Calculate superframe timing
+ *
+ * Guard time is 2 * (drift over a superframe + jitter), superframe length
+ * itself depends on guard, so it is solved for both
+ *
+ * @param ra02 RA02 Handle, modem settings are used for time on air
+ * @param cfg MAC config (slot counts, payload, drift, jitter)
+ * @param plan Output, timing
+ */
+error_t ra02_mac_get_plan(ra02_t * ra02, const ra02_mac_cfg_t * cfg, ra02_mac_plan_t * plan);
+
+/**
+ * Initialize MAC
+ *
+ * @param mac MAC Handle
+ * @param cfg Config
+ */
+error_t ra02_mac_init(ra02_mac_t * mac, const ra02_mac_cfg_t * cfg);
+
+/**
+ * Queue frame for transmission in next suitable slot
+ *
+ * @note Node can only send to coordinator and only after joining
+ *
+ * @param mac MAC Handle
+ * @param dst Destination address
+ * @param buf Payload
+ * @param size Payload size, up to max_payload
+ *
+ * @retval E_AGAIN Node hasn't joined yet
+ * @retval E_OVERFLOW Slot queue is full
+ */
+error_t ra02_mac_send(ra02_mac_t * mac, uint16_t dst, const uint8_t * buf, size_t size);
+
+/**
+ * Run single superframe: beacon, join, uplink & downlink slots
+ *
+ * Coordinator transmits beacon and downlink frames, listens in join & uplink
+ * slots. Node waits for beacon (up to 2 superframes, if not synced), then
+ * joins or transmits in own slot and listens in mapped downlink slot
+ *
+ * @param mac MAC Handle
+ *
+ * @retval E_TIMEOUT Node didn't receive beacon
+ */
+error_t ra02_mac_run(ra02_mac_t * mac);
+
+/**
+ * Simulate many nodes sending to a single gateway on shared channel with
+ * given access protocol, in virtual time. Frames overlapping in time are lost
+ *
+ * @param ra02 RA02 Handle, modem settings are used for time on air
+ * @param cfg Simulation parameters
+ * @param result Output, throughput
+ */
+error_t ra02_mac_simulate(ra02_t * ra02, const ra02_mac_sim_cfg_t * cfg, ra02_mac_sim_result_t * result);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,275 @@
+/** ========================================================================= *
+ *
+ * @file ra02_mesh.h
+ * @date 17-10-2026
+ * @author Maksym Tkachuk <max.r.tkachuk@gmail.com>
+ *
+ * @brief Flooding mesh on top of ra02 driver
+ *
+ * Every frame carries origin, sequence number and TTL. Nodes remember recent
+ * (origin, seq) pairs in a fixed-size hash set with expiry, so each frame is
+ * relayed at most once. Flood relays are delayed proportionally to RSSI, so
+ * farthest nodes relay first, and are cancelled if a node overhears enough
+ * relays of the same frame. Relays are sent only when CAD finds the channel
+ * free, otherwise they back off, which lets the overheard relay cancel them.
+ * Optionally, nodes learn next hops towards frame
+ * origins and turn floods into unicast along learned routes
+ *
+ * Core (process/pop) doesn't touch the radio and works on caller's clock,
+ * so it can be driven by a simulated channel as well
+ *
+ *  ========================================================================= */
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ================================================================= */
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <error.h>
+#include <timeout.h>
+#include <ra02.h>
+
+/* Defines ================================================================== */
+/**
+ * Mesh header: [type] [ttl] [hops] [origin] [seq] [dst] [prev] [via], 2 byte fields are LE
+ */
+#define RA02_MESH_HEADER_SIZE 13
+
+/**
+ * Max mesh payload
+ */
+#define RA02_MESH_MAX_PAYLOAD (RA02_MAX_PACKET_SIZE - RA02_MESH_HEADER_SIZE)
+
+/**
+ * Broadcast address (dst), also means "flood" in via field
+ */
+#define RA02_MESH_BROADCAST 0xFFFF
+
+/**
+ * Duplicate cache size (power of 2)
+ */
+#ifndef RA02_MESH_DUP_CACHE_SIZE
+#define RA02_MESH_DUP_CACHE_SIZE 64
+#endif
+
+/**
+ * Learned routes
+ */
+#ifndef RA02_MESH_MAX_ROUTES
+#define RA02_MESH_MAX_ROUTES 32
+#endif
+
+/**
+ * Relays waiting for their delay to pass
+ */
+#ifndef RA02_MESH_MAX_PENDING
+#define RA02_MESH_MAX_PENDING 4
+#endif
+
+/* Macros =================================================================== */
+/* Enums ==================================================================== */
+/* Types ==================================================================== */
+/**
+ * Received frame handler
+ */
+typedef void (*ra02_mesh_rx_fn_t)(void * ctx, uint16_t origin, const uint8_t * buf, size_t size);
+
+/**
+ * Mesh config
+ */
+typedef struct {
+  ra02_t * ra02;           /** Used for time on air, and for TX/RX in ra02_mesh_send/poll */
+  uint16_t address;
+  uint8_t  ttl;            /** TTL of originated frames, 0 - default */
+  bool     routing;        /** Learn routes and use unicast when route is known */
+  uint32_t window_ms;      /** Flood relay delay window, 0 - derived from time on air of relayed frame */
+  uint32_t dup_expiry_ms;  /** Duplicate cache entry lifetime, 0 - default */
+  uint32_t route_expiry_ms;/** Route lifetime, 0 - default */
+  ra02_mesh_rx_fn_t rx;    /** Optional, handler of frames addressed to this node */
+  void *   rx_ctx;
+} ra02_mesh_cfg_t;
+
+/**
+ * Duplicate cache entry
+ */
+typedef struct {
+  uint32_t key;            /** origin << 16 | seq */
+  uint64_t expiry_ns;      /** 0 - empty */
+} ra02_mesh_dup_t;
+
+/**
+ * Learned route
+ */
+typedef struct {
+  uint16_t dst;
+  uint16_t next_hop;
+  uint8_t  hops;
+  uint64_t expiry_ns;      /** 0 - empty */
+} ra02_mesh_route_t;
+
+/**
+ * Relay waiting for its delay
+ */
+typedef struct {
+  uint64_t due_ns;         /** 0 - empty */
+  uint32_t key;
+  uint8_t  heard;          /** Copies overheard from other relays */
+  uint8_t  size;
+  uint8_t  frame[RA02_MAX_PACKET_SIZE];
+} ra02_mesh_pending_t;
+
+/**
+ * Mesh statistics
+ */
+typedef struct {
+  uint32_t originated;
+  uint32_t delivered;      /** Frames passed to rx handler */
+  uint32_t duplicates;
+  uint32_t relayed;
+  uint32_t suppressed;     /** Flood relays cancelled after overhearing */
+  uint32_t deferred;       /** Relays postponed because channel was busy */
+  uint32_t expired;        /** Frames dropped because of TTL */
+} ra02_mesh_stats_t;
+
+/**
+ * Mesh context
+ */
+typedef struct {
+  ra02_mesh_cfg_t     cfg;
+  uint16_t            seq;
+  unsigned int        seed;
+  ra02_mesh_dup_t     dups[RA02_MESH_DUP_CACHE_SIZE];
+  ra02_mesh_route_t   routes[RA02_MESH_MAX_ROUTES];
+  ra02_mesh_pending_t pending[RA02_MESH_MAX_PENDING];
+  ra02_mesh_stats_t   stats;
+} ra02_mesh_t;
+
+/**
+ * Mesh simulation parameters
+ */
+typedef struct {
+  uint16_t nodes;          /** Node 0 is gateway in the center, others are placed randomly */
+  uint32_t side_m;         /** Side of square area */
+  uint32_t messages;       /** Messages from random nodes to gateway */
+  uint32_t interval_ms;    /** Mean interval between messages (Poisson) */
+  uint32_t hello_ms;       /** Interval of gateway broadcasts (route discovery), 0 - none */
+  uint8_t  payload_size;
+  uint8_t  ttl;
+  bool     routing;
+  uint32_t seed;
+} ra02_mesh_sim_cfg_t;
+
+/**
+ * Mesh simulation results
+ */
+typedef struct {
+  uint32_t sent;           /** Messages originated */
+  uint32_t delivered;      /** Messages received by gateway */
+  uint32_t transmissions;  /** All transmissions incl. relays & hellos */
+  uint64_t airtime_us;     /** Total airtime of all transmissions */
+  uint32_t max_hops;       /** Max hops of delivered message */
+  double   delivery_ratio;
+  double   airtime_per_delivered_ms;
+} ra02_mesh_sim_result_t;
+
+/* Variables ================================================================ */
+/* Shared functions ========================================================= */
+/**
+ * Initialize mesh
+ *
+ * @param mesh Mesh Handle
+ * @param cfg Config
+ */
+error_t ra02_mesh_init(ra02_mesh_t * mesh, const ra02_mesh_cfg_t * cfg);
+
+/**
+ * Build frame originated by this node
+ *
+ * @param mesh Mesh Handle
+ * @param dst Destination address or RA02_MESH_BROADCAST
+ * @param buf Payload
+ * @param size Payload size, up to RA02_MESH_MAX_PAYLOAD
+ * @param frame Output, at least RA02_MESH_HEADER_SIZE + size bytes
+ * @param now_ns Current time
+ */
+error_t ra02_mesh_encode(ra02_mesh_t * mesh, uint16_t dst, const uint8_t * buf, size_t size,
+                         uint8_t * frame, uint64_t now_ns);
+
+/**
+ * Process received frame: suppress duplicates, learn routes, deliver and
+ * schedule relay
+ *
+ * @param mesh Mesh Handle
+ * @param frame Received frame
+ * @param size Frame size
+ * @param rssi RSSI of received frame
+ * @param now_ns Current time
+ *
+ * @retval E_INVAL Not a mesh frame
+ */
+error_t ra02_mesh_process(ra02_mesh_t * mesh, const uint8_t * frame, size_t size, int16_t rssi, uint64_t now_ns);
+
+/**
+ * Get time of the earliest pending relay
+ *
+ * @param mesh Mesh Handle
+ *
+ * @return time in ns, UINT64_MAX if nothing is pending
+ */
+uint64_t ra02_mesh_next_due_ns(ra02_mesh_t * mesh);
+
+/**
+ * Take relay, whose delay has passed
+ *
+ * @param mesh Mesh Handle
+ * @param now_ns Current time
+ * @param frame Output, at least RA02_MAX_PACKET_SIZE bytes
+ * @param size Output, frame size
+ *
+ * @retval E_EMPTY Nothing is due
+ */
+error_t ra02_mesh_pop_due(ra02_mesh_t * mesh, uint64_t now_ns, uint8_t * frame, size_t * size);
+
+/**
+ * Postpone due relays by random backoff, when channel is busy
+ *
+ * @param mesh Mesh Handle
+ * @param now_ns Current time
+ */
+void ra02_mesh_defer(ra02_mesh_t * mesh, uint64_t now_ns);
+
+/**
+ * Send frame over mesh
+ *
+ * @param mesh Mesh Handle
+ * @param dst Destination address or RA02_MESH_BROADCAST
+ * @param buf Payload
+ * @param size Payload size
+ */
+error_t ra02_mesh_send(ra02_mesh_t * mesh, uint16_t dst, const uint8_t * buf, size_t size);
+
+/**
+ * Receive and relay frames for given amount of time
+ *
+ * @param mesh Mesh Handle
+ * @param timeout Timeout to run for
+ */
+error_t ra02_mesh_poll(ra02_mesh_t * mesh, timeout_t * timeout);
+
+/**
+ * Simulate mesh of many nodes with log-distance path loss, collisions and
+ * half-duplex radios in virtual time, using the same mesh logic
+ *
+ * @param ra02 RA02 Handle, modem settings are used for time on air
+ * @param cfg Simulation parameters
+ * @param result Output, delivery & airtime
+ */
+error_t ra02_mesh_simulate(ra02_t * ra02, const ra02_mesh_sim_cfg_t * cfg, ra02_mesh_sim_result_t * result);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,261 @@
+/** ========================================================================= *
+ *
+ * @file ra02_mgr.h
+ * @date 17-10-2026
+ * @author Maksym Tkachuk <max.r.tkachuk@gmail.com>
+ *
+ * @brief Multi-radio manager: several radios on one host, each serviced by
+ * its own thread
+ *
+ * Every radio thread can be pinned to a CPU and run with SCHED_FIFO
+ * priority, so that isolated cores keep turnaround stable. Radio thread
+ * receives continuously in short slices and transmits frames from its own
+ * TX queue between slices. Frames received by all radios are merged into
+ * one queue, tagged with index of the radio.
+ *
+ * Config file has one directive per line, '#' starts a comment:
+ *   mlock                       - lock process memory (mlockall)
+ *   slice MS                    - longest RX slice, bounds TX latency
+ *   radio SPIDEV [KEY=VALUE...] - add radio, SPIDEV "emu" is emulated radio
+ *                                 (all emulated radios share one air)
+ * Radio keys: freq (kHz), sf, bw (kHz), power (dBm), cpu, priority
+ * (SCHED_FIFO 1-99), gpiochip, dio0, dio1 (line offsets on gpiochip)
+ *
+ *  ========================================================================= */
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ================================================================= */
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <error.h>
+#include <spi.h>
+#include <gpio.h>
+#include <ra02.h>
+#include <ra02_emu.h>
+
+/* Defines ================================================================== */
+/**
+ * Max radios per manager
+ */
+#ifndef RA02_MGR_MAX_RADIOS
+#define RA02_MGR_MAX_RADIOS 8
+#endif
+
+/**
+ * Received frames of all radios waiting for consumer
+ */
+#ifndef RA02_MGR_RX_QUEUE_SIZE
+#define RA02_MGR_RX_QUEUE_SIZE 64
+#endif
+
+/**
+ * Frames waiting for transmission, per radio
+ */
+#ifndef RA02_MGR_TX_QUEUE_SIZE
+#define RA02_MGR_TX_QUEUE_SIZE 16
+#endif
+
+/**
+ * Max length of device paths in config
+ */
+#define RA02_MGR_PATH_SIZE 64
+
+/* Macros =================================================================== */
+/* Enums ==================================================================== */
+/* Types ==================================================================== */
+/**
+ * Radio config
+ */
+typedef struct {
+  char     spidev[RA02_MGR_PATH_SIZE];   /** "emu" - emulated radio */
+  char     gpiochip[RA02_MGR_PATH_SIZE]; /** Chip of DIO lines, empty - DIOs are not connected */
+  int32_t  dio0;                         /** Line offset, -1 - not connected */
+  int32_t  dio1;                         /** Line offset, -1 - not connected */
+  uint32_t freq_khz;                     /** 0 - default */
+  uint8_t  sf;                           /** 0 - default */
+  uint32_t bandwidth;                    /** Hz, 0 - default */
+  uint8_t  power;                        /** dBm, 0 - default */
+  int32_t  cpu;                          /** CPU to pin radio thread to, -1 - not pinned */
+  uint8_t  priority;                     /** SCHED_FIFO priority, 0 - default scheduling */
+} ra02_mgr_radio_cfg_t;
+
+/**
+ * Manager config
+ */
+typedef struct {
+  ra02_mgr_radio_cfg_t radios[RA02_MGR_MAX_RADIOS];
+  uint8_t              count;
+  bool                 mlock;            /** Lock current & future memory, no page faults on hot path */
+  uint32_t             rx_slice_ms;      /** Longest RX slice between TX queue checks, 0 - default */
+} ra02_mgr_cfg_t;
+
+/**
+ * Received frame, tagged with radio
+ */
+typedef struct {
+  uint8_t  radio;                        /** Index of radio in config */
+  uint64_t rx_ns;                        /** CLOCK_MONOTONIC time of RX_DONE */
+  int8_t   rssi;
+  int8_t   snr;
+  uint8_t  size;
+  uint8_t  data[RA02_MAX_PACKET_SIZE];
+} ra02_mgr_packet_t;
+
+/**
+ * Radio statistics
+ */
+typedef struct {
+  uint32_t rx;
+  uint32_t rx_bad;                       /** Frames with CRC error */
+  uint32_t rx_dropped;                   /** Frames lost because RX queue was full */
+  uint64_t rx_bytes;
+  uint32_t tx;
+  uint32_t tx_failed;
+  uint32_t tx_dropped;                   /** Frames refused because TX queue was full */
+  uint64_t tx_bytes;
+  uint32_t tx_latency_avg_us;            /** From ra02_mgr_send to TX start */
+  uint32_t tx_latency_max_us;
+  double   rx_bps;                       /** Received payload bits per second since start */
+  double   tx_bps;                       /** Transmitted payload bits per second since start */
+} ra02_mgr_stats_t;
+
+/**
+ * Frame waiting for transmission
+ */
+typedef struct {
+  uint64_t queued_ns;
+  uint8_t  size;
+  uint8_t  data[RA02_MAX_PACKET_SIZE];
+} ra02_mgr_txpk_t;
+
+struct ra02_mgr_s;
+
+/**
+ * Radio context
+ */
+typedef struct {
+  struct ra02_mgr_s *  mgr;
+  uint8_t              index;
+  ra02_mgr_radio_cfg_t cfg;
+  spi_t                spi;
+  gpio_t               dio[2];
+  ra02_emu_t           emu;
+  bool                 emulated;
+  ra02_t               ra02;
+  bool                 ready;             /** ra02_init succeeded */
+  pthread_t            thread;
+  bool                 started;
+  ra02_mgr_txpk_t      tx[RA02_MGR_TX_QUEUE_SIZE];
+  uint8_t              tx_head;
+  uint8_t              tx_count;
+  uint64_t             tx_latency_us;     /** Sum, for average */
+  ra02_mgr_stats_t     stats;
+} ra02_mgr_radio_t;
+
+/**
+ * Manager context
+ */
+typedef struct ra02_mgr_s {
+  ra02_mgr_cfg_t    cfg;
+  ra02_mgr_radio_t  radios[RA02_MGR_MAX_RADIOS];
+  ra02_emu_air_t    air;                 /** Shared by emulated radios */
+  bool              air_ready;
+  volatile bool     running;
+  uint64_t          start_ns;
+  pthread_mutex_t   lock;                /** Guards queues & stats */
+  pthread_cond_t    rx_ready;
+  ra02_mgr_packet_t rx[RA02_MGR_RX_QUEUE_SIZE];
+  size_t            rx_head;
+  size_t            rx_count;
+} ra02_mgr_t;
+
+/* Variables ================================================================ */
+/* Shared functions ========================================================= */
+/**
+ * Read config file
+ *
+ * @param path Config file path
+ * @param cfg Output
+ *
+ * @retval E_NOTFOUND File can't be opened
+ * @retval E_CORRUPT Malformed line (logged with line number)
+ */
+error_t ra02_mgr_parse_config(const char * path, ra02_mgr_cfg_t * cfg);
+
+/**
+ * Open & configure all radios
+ *
+ * @note Call ra02_mgr_deinit even if init failed, radios opened so far are released
+ *
+ * @param mgr Manager Handle
+ * @param cfg Config
+ */
+error_t ra02_mgr_init(ra02_mgr_t * mgr, const ra02_mgr_cfg_t * cfg);
+
+/**
+ * Stop radio threads, if running, and release radios
+ *
+ * @param mgr Manager Handle
+ */
+error_t ra02_mgr_deinit(ra02_mgr_t * mgr);
+
+/**
+ * Lock memory, if configured, and start radio threads
+ *
+ * @note Failure to pin thread or set its priority (e.g. without
+ *       CAP_SYS_NICE) is logged, thread keeps running with default scheduling
+ *
+ * @param mgr Manager Handle
+ */
+error_t ra02_mgr_start(ra02_mgr_t * mgr);
+
+/**
+ * Ask radio threads to stop, safe to call from signal handler
+ *
+ * @note Threads notice it after current RX slice or TX, ra02_mgr_deinit waits for them
+ *
+ * @param mgr Manager Handle
+ */
+void ra02_mgr_stop(ra02_mgr_t * mgr);
+
+/**
+ * Queue frame for transmission on given radio
+ *
+ * @param mgr Manager Handle
+ * @param radio Index of radio
+ * @param buf Frame
+ * @param size Frame size
+ *
+ * @retval E_BUSY TX queue of the radio is full
+ */
+error_t ra02_mgr_send(ra02_mgr_t * mgr, uint8_t radio, const uint8_t * buf, size_t size);
+
+/**
+ * Take next frame received by any radio
+ *
+ * @param mgr Manager Handle
+ * @param packet Output
+ * @param timeout_ms Time to wait for frame
+ *
+ * @retval E_TIMEOUT No frame was received in time
+ */
+error_t ra02_mgr_recv(ra02_mgr_t * mgr, ra02_mgr_packet_t * packet, uint32_t timeout_ms);
+
+/**
+ * Copy statistics of every radio and their sum
+ *
+ * @param mgr Manager Handle
+ * @param stats Output, array of cfg.count entries, can be NULL
+ * @param total Output, aggregate of all radios, can be NULL
+ */
+error_t ra02_mgr_get_stats(ra02_mgr_t * mgr, ra02_mgr_stats_t * stats, ra02_mgr_stats_t * total);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,110 @@
+/** ========================================================================= *
+ *
+ * @file ra02_pipe.h
+ * @date 17-10-2026
+ * @author Maksym Tkachuk <max.r.tkachuk@gmail.com>
+ *
+ * @brief Streaming frames between radio and stdio
+ *
+ * TX reads frames from a stream and transmits them back-to-back, RX writes
+ * every received frame with metadata. Radio is used either directly or
+ * through daemon connection. RX output goes through a queue drained by a
+ * writer thread, so slow consumer doesn't stall reception: when queue is
+ * full, frames are dropped and counted instead.
+ *
+ * Formats:
+ *  - binary: TX input [size] [data], frames over RA02_MAX_PACKET_SIZE are
+ *            skipped and counted as errors. RX output [size] [rssi] [snr]
+ *            [rx time in ns, 8 bytes LE] [data]
+ *  - hex:    one frame per line, TX takes "<hex>" or RX output line
+ *            "<rx time in us> <rssi> <snr> <hex>", so RX output can be piped
+ *            back into TX, other lines are errors. Empty lines and lines
+ *            starting with '#' are skipped
+ *  - json:   RX only, one object per line
+ *
+ *  ========================================================================= */
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ================================================================= */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <error.h>
+#include <ra02.h>
+
+/* Defines ================================================================== */
+/**
+ * Frames buffered between radio and writer thread
+ */
+#ifndef RA02_PIPE_QUEUE_SIZE
+#define RA02_PIPE_QUEUE_SIZE 64
+#endif
+
+/* Macros =================================================================== */
+/* Enums ==================================================================== */
+/**
+ * Stream format
+ */
+typedef enum {
+  RA02_PIPE_FORMAT_BINARY = 0,
+  RA02_PIPE_FORMAT_HEX,
+  RA02_PIPE_FORMAT_JSON,
+} ra02_pipe_format_t;
+
+/* Types ==================================================================== */
+/**
+ * Pipe config
+ */
+typedef struct {
+  ra02_t *           ra02;       /** Radio, used when client_fd is -1 */
+  int                client_fd;  /** Daemon connection, -1 - use ra02 directly */
+  FILE *             file;       /** Input for TX, output for RX */
+  ra02_pipe_format_t format;
+  uint32_t           count;      /** RX: stop after count frames, 0 - until stopped */
+} ra02_pipe_cfg_t;
+
+/**
+ * Pipe statistics
+ */
+typedef struct {
+  uint32_t frames;               /** Frames transmitted or written out */
+  uint32_t bytes;                /** Payload bytes of those frames */
+  uint32_t dropped;              /** RX: frames dropped because consumer was too slow */
+  uint32_t errors;               /** TX: malformed or failed frames, RX: corrupt frames */
+} ra02_pipe_stats_t;
+
+/* Variables ================================================================ */
+/* Shared functions ========================================================= */
+/**
+ * Parse format name: "binary", "hex" or "json"
+ *
+ * @param name Format name
+ * @param format Output
+ */
+error_t ra02_pipe_parse_format(const char * name, ra02_pipe_format_t * format);
+
+/**
+ * Transmit frames read from cfg->file until end of file
+ *
+ * @param cfg Pipe config
+ * @param running Stop flag, may be cleared from signal handler, NULL - run until EOF
+ * @param stats Output, may be NULL
+ */
+error_t ra02_pipe_tx(const ra02_pipe_cfg_t * cfg, volatile bool * running, ra02_pipe_stats_t * stats);
+
+/**
+ * Receive continuously and write frames to cfg->file
+ *
+ * @param cfg Pipe config
+ * @param running Stop flag, may be cleared from signal handler, NULL - run until count frames
+ * @param stats Output, may be NULL
+ */
+error_t ra02_pipe_rx(const ra02_pipe_cfg_t * cfg, volatile bool * running, ra02_pipe_stats_t * stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -131,6 +131,7 @@ extern "C" {
 #define RA02_LORA_REG_INVERT_IQ             RA02_REG_NODE_ADDR
 #define RA02_LORA_REG_DETECTION_THRESH      RA02_REG_SEQ_CFG_2
 #define RA02_LORA_REG_SYNC_WORD             RA02_REG_TIMER1_COEF
+#define RA02_LORA_REG_INVERT_IQ_2           RA02_REG_IMAGE_CAL
 
 /* SX 1278 Flags */
 #define RA02_IRQ_FLAGS_1_MODE_READY         (1 << 7)
@@ -160,6 +161,13 @@ extern "C" {
 #define RA02_LORA_IRQ_FLAGS_FHSS_CHANGE_CH  (1 << 1)
 #define RA02_LORA_IRQ_FLAGS_CAD_DETECTED    (1 << 0)
 
+/* SX 1278 LoRa Modem Status */
+#define RA02_LORA_MODEM_STAT_CLEAR          (1 << 4)
+#define RA02_LORA_MODEM_STAT_HEADER_VALID   (1 << 3)
+#define RA02_LORA_MODEM_STAT_RX_ONGOING     (1 << 2)
+#define RA02_LORA_MODEM_STAT_SYNCHRONIZED   (1 << 1)
+#define RA02_LORA_MODEM_STAT_DETECTED       (1 << 0)
+
 /* SX 1278 LoRa DIO Position */
 #define RA02_LORA_MAP_DIO_0(mapping)        ((mapping) << 6)
 #define RA02_LORA_MAP_DIO_1(mapping)        ((mapping) << 4)
@@ -188,9 +196,81 @@ extern "C" {
 #define RA02_LORA_DIO_5_CLK_OUT_1           0b01
 #define RA02_LORA_DIO_5_CLK_OUT_2           0b10
 
+/* SX 1278 FSK DIO Mapping (packet mode) */
+#define RA02_FSK_MAP_DIO_0(mapping)         RA02_LORA_MAP_DIO_0(mapping)
+#define RA02_FSK_MAP_DIO_1(mapping)         RA02_LORA_MAP_DIO_1(mapping)
+#define RA02_FSK_DIO_0_PACKET_SENT          0b00 // TX
+#define RA02_FSK_DIO_0_PAYLOAD_READY        0b00 // RX
+#define RA02_FSK_DIO_0_CRC_OK               0b01 // RX
+#define RA02_FSK_DIO_1_FIFO_LEVEL           0b00
+#define RA02_FSK_DIO_1_FIFO_EMPTY           0b01
+#define RA02_FSK_DIO_1_FIFO_FULL            0b10
+
+/* SX 1278 FSK Rx Config */
+#define RA02_FSK_RX_CFG_RESTART_ON_COLLISION  (1 << 7)
+#define RA02_FSK_RX_CFG_AFC_AUTO              (1 << 4)
+#define RA02_FSK_RX_CFG_AGC_AUTO              (1 << 3)
+#define RA02_FSK_RX_CFG_TRIGGER_PREAMBLE      0x06
+
+/* SX 1278 FSK Rx Bandwidth */
+#define RA02_FSK_RX_BW_MANT(mant)             ((mant) << 3)
+#define RA02_FSK_RX_BW_EXP(exp)               (exp)
+
+/* SX 1278 FSK Preamble Detector */
+#define RA02_FSK_PREAMBLE_DETECT_ON           (1 << 7)
+#define RA02_FSK_PREAMBLE_DETECT_SIZE(bytes)  (((bytes) - 1) << 5)
+#define RA02_FSK_PREAMBLE_DETECT_TOL(chips)   (chips)
+
+/* SX 1278 FSK Sync Config */
+#define RA02_FSK_SYNC_CFG_AUTO_RESTART        (1 << 6)
+#define RA02_FSK_SYNC_CFG_PREAMBLE_POL_55     (1 << 5)
+#define RA02_FSK_SYNC_CFG_SYNC_ON             (1 << 4)
+#define RA02_FSK_SYNC_CFG_SYNC_SIZE(bytes)    (((bytes) - 1) & 0x07)
+
+/* SX 1278 FSK Packet Config 1 */
+#define RA02_FSK_PACKET_CFG_1_VARIABLE_LEN    (1 << 7)
+#define RA02_FSK_PACKET_CFG_1_MANCHESTER      (1 << 5)
+#define RA02_FSK_PACKET_CFG_1_WHITENING       (2 << 5)
+#define RA02_FSK_PACKET_CFG_1_CRC_ON          (1 << 4)
+#define RA02_FSK_PACKET_CFG_1_CRC_AUTOCLR_OFF (1 << 3)
+
+/* SX 1278 FSK Packet Config 2 */
+#define RA02_FSK_PACKET_CFG_2_PACKET_MODE     (1 << 6)
+#define RA02_FSK_PACKET_CFG_2_LEN_MSB(len)    (((len) >> 8) & 0x07)
+
+/* SX 1278 FSK Fifo Threshold */
+#define RA02_FSK_FIFO_THRESH_TX_START_NOT_EMPTY (1 << 7)
+#define RA02_FSK_FIFO_THRESH_LEVEL(level)     ((level) & 0x3F)
+
+/* SX 1278 LoRa Modem Config 1 */
+#define RA02_LORA_MODEM_CFG_1_BW(bw)          ((bw) << 4)
+#define RA02_LORA_MODEM_CFG_1_BW_MASK         0xF0
+#define RA02_LORA_MODEM_CFG_1_CR(cr)          ((cr) << 1)
+#define RA02_LORA_MODEM_CFG_1_CR_MASK         0x0E
+#define RA02_LORA_MODEM_CFG_1_IMPLICIT_HDR    (1 << 0)
+
+/* SX 1278 LoRa Modem Config 2 */
+#define RA02_LORA_MODEM_CFG_2_SF(sf)          ((sf) << 4)
+#define RA02_LORA_MODEM_CFG_2_SF_MASK         0xF0
+#define RA02_LORA_MODEM_CFG_2_TX_CONTINUOUS   (1 << 3)
+#define RA02_LORA_MODEM_CFG_2_RX_CRC_ON       (1 << 2)
+#define RA02_LORA_MODEM_CFG_2_SYMB_TIMEOUT_MASK 0x03
+
+/* SX 1278 LoRa Modem Config 3 */
+#define RA02_LORA_MODEM_CFG_3_LDRO            (1 << 3)
+#define RA02_LORA_MODEM_CFG_3_AGC_AUTO        (1 << 2)
+
+/* SX 1278 LoRa Invert IQ (RegInvertIQ2 must be set accordingly) */
+#define RA02_LORA_INVERT_IQ_RX                (1 << 6)
+#define RA02_LORA_INVERT_IQ_TX                (1 << 0)
+#define RA02_LORA_INVERT_IQ_2_ON              0x19
+#define RA02_LORA_INVERT_IQ_2_OFF             0x1D
+
 /* SX 1278 Other values */
 #define RA02_HW_VERSION           0x12
 #define RA02_OP_MODE_LORA_PREFIX  0x80
+#define RA02_OP_MODE_FSK_PREFIX   0x00
+#define RA02_FXOSC                32000000
 
 
 /* Macros =================================================================== */
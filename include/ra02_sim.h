@@ -0,0 +1,116 @@
+/** ========================================================================= *
+ *
+ * @file ra02_sim.h
+ * @date 17-10-2026
+ * @author Maksym Tkachuk <max.r.tkachuk@gmail.com>
+ *
+ * @brief Discrete-event network simulator: many real driver instances on
+ * emulated SX1278s sharing one emulated air, in virtual time
+ *
+ * Every radio (end node or gateway radio, gateway has one radio per SF) runs
+ * the real driver in its own coroutine with its own virtual clock, installed
+ * as thread clock (see timeout_set_thread_clock). Clock advances on sleeps,
+ * on SPI transfers (fixed cost) and on idle IRQ polls, which skip to the next
+ * known event of the emulated radio or at most poll interval ahead.
+ *
+ * Radios are partitioned over worker threads. Synchronization is
+ * conservative: air has latency L (frames are seen by other radios L after
+ * TX start, RX_DONE comes L after frame end), and a radio only runs while
+ * its clock is less than L ahead of the slowest radio of all workers, so
+ * every frame it can observe has already been put on air.
+ *
+ * Air model: log-distance path loss, SNR floor per SF, capture effect on
+ * the same SF and imperfect SF orthogonality (see ra02_emu.h). Uplink:
+ * [node, 4 bytes] [seq, 4 bytes] [created, 8 bytes, virtual ns] [padding],
+ * little endian
+ *
+ *  ========================================================================= */
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ================================================================= */
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <error.h>
+#include <ra02.h>
+#include <ra02_mac.h>
+
+/* Defines ================================================================== */
+/**
+ * Uplink header size, smallest payload
+ */
+#define RA02_SIM_HEADER_SIZE 16
+
+/* Macros =================================================================== */
+/* Enums ==================================================================== */
+/* Types ==================================================================== */
+/**
+ * Network simulation parameters
+ */
+typedef struct {
+  ra02_mac_proto_t proto;        /** ALOHA or LBT (TDMA is not supported) */
+  uint32_t nodes;                /** End nodes, placed randomly */
+  uint32_t gateways;             /** Placed on a grid, 0 - one in the center */
+  uint32_t threads;              /** Worker threads, 0 - online CPUs */
+  uint32_t side_m;               /** Side of square area, 0 - default */
+  uint32_t interval_ms;          /** Mean uplink interval per node (Poisson), 0 - default */
+  uint32_t duration_ms;          /** Simulated (virtual) time */
+  uint8_t  payload_size;         /** At least RA02_SIM_HEADER_SIZE, 0 - default */
+  uint8_t  sf;                   /** 0 - per node, lowest SF that closes link to nearest gateway */
+  uint32_t bandwidth;            /** Hz, 0 - default */
+  int8_t   power;                /** TX power in dBm, 0 - default */
+  uint32_t lookahead_us;         /** Air latency, sync window of workers, 0 - default */
+  uint32_t poll_us;              /** Max virtual time skipped by idle IRQ poll, 0 - default */
+  uint32_t spi_us;               /** Virtual time of SPI transfer, 0 - default */
+  uint32_t seed;
+} ra02_sim_cfg_t;
+
+/**
+ * Network simulation results, per SF arrays are indexed by (sf - RA02_SCAN_SF_MIN)
+ */
+typedef struct {
+  uint32_t offered;              /** Uplinks generated */
+  uint32_t sent;                 /** Transmissions */
+  uint32_t deferred;             /** LBT: CAD found channel busy */
+  uint32_t dropped;              /** LBT: channel stayed busy, uplink given up */
+  uint32_t delivered;            /** Uplinks received by at least one gateway */
+  uint32_t corrupt;              /** Frames received with CRC error, counted per gateway radio */
+  uint32_t sent_sf[RA02_SCAN_SF_COUNT];
+  uint32_t delivered_sf[RA02_SCAN_SF_COUNT];
+  double   delivery_ratio;       /** Delivered per offered */
+  double   utilization;          /** Airtime of all transmissions per simulated time, per channel (SF) */
+  double   goodput_bps;          /** Delivered payload bits per second */
+  uint32_t latency_avg_us;       /** Uplink generated to first RX_DONE */
+  uint32_t latency_p50_us;
+  uint32_t latency_p99_us;
+  uint32_t latency_max_us;
+  uint64_t transfers;            /** Emulated SPI transfers */
+  uint32_t wall_ms;              /** Real time spent */
+  double   speedup;              /** Simulated time per real time */
+} ra02_sim_result_t;
+
+/* Variables ================================================================ */
+/* Shared functions ========================================================= */
+/**
+ * Parse channel access protocol name: "aloha" or "lbt"
+ *
+ * @param name Protocol name
+ * @param proto Output
+ */
+error_t ra02_sim_parse_proto(const char * name, ra02_mac_proto_t * proto);
+
+/**
+ * Run network simulation until simulated duration passes
+ *
+ * @param cfg Simulation parameters
+ * @param result Output
+ */
+error_t ra02_sim_run(const ra02_sim_cfg_t * cfg, ra02_sim_result_t * result);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,133 @@
+/** ========================================================================= *
+ *
+ * @file ra02_survey.h
+ * @date 17-10-2026
+ * @author Maksym Tkachuk <max.r.tkachuk@gmail.com>
+ *
+ * @brief Channel RSSI survey: sweep over channel plan in continuous RX
+ *
+ * Every channel is tuned with ra02_listen (no sleeps, PLL relocks on RX
+ * entry), left to settle and then sampled with batched RSSI reads for dwell
+ * time. Samples are collected into a histogram, so percentiles come at
+ * constant memory regardless of dwell. Occupancy is the fraction of samples
+ * above threshold
+ *
+ *  ========================================================================= */
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ================================================================= */
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <error.h>
+#include <ra02.h>
+
+/* Defines ================================================================== */
+/**
+ * Default channel plan: whole RA-02 band
+ */
+#define RA02_SURVEY_DEFAULT_START_KHZ 410000
+#define RA02_SURVEY_DEFAULT_STOP_KHZ  525000
+#define RA02_SURVEY_DEFAULT_STEP_KHZ  125
+
+/**
+ * Default time spent on each channel
+ */
+#define RA02_SURVEY_DEFAULT_DWELL_MS  5
+
+/* Macros =================================================================== */
+/* Enums ==================================================================== */
+/**
+ * Output format
+ */
+typedef enum {
+  RA02_SURVEY_FORMAT_CSV = 0,
+  RA02_SURVEY_FORMAT_JSON,
+} ra02_survey_format_t;
+
+/* Types ==================================================================== */
+/**
+ * Survey config
+ */
+typedef struct {
+  ra02_t * ra02;                 /** LoRa modem, bandwidth sets measurement bandwidth */
+  uint32_t start_khz;            /** First channel, 0 - default */
+  uint32_t stop_khz;             /** Last channel (inclusive), 0 - default */
+  uint32_t step_khz;             /** Channel spacing, 0 - default */
+  uint32_t dwell_ms;             /** Sampling time per channel, 0 - default */
+  uint16_t interval_us;          /** Delay between samples, 0 - default */
+  uint16_t settle_us;            /** Delay after retune before first sample, 0 - default */
+  int8_t   threshold;            /** dBm, sample above it counts as occupied, 0 - default */
+} ra02_survey_cfg_t;
+
+/**
+ * Channel statistics, RSSI in dBm
+ */
+typedef struct {
+  uint32_t freq_khz;
+  uint32_t samples;
+  int8_t   min;
+  int8_t   max;
+  float    avg;
+  int8_t   p50;
+  int8_t   p90;
+  int8_t   p99;
+  float    occupancy;            /** 0..1 */
+} ra02_survey_channel_t;
+
+/* Variables ================================================================ */
+/* Shared functions ========================================================= */
+/**
+ * Parse format name: "csv" or "json"
+ *
+ * @param name Format name
+ * @param format Output
+ */
+error_t ra02_survey_parse_format(const char * name, ra02_survey_format_t * format);
+
+/**
+ * Get number of channels in plan
+ *
+ * @param cfg Survey config
+ * @param count Output
+ */
+error_t ra02_survey_channel_count(const ra02_survey_cfg_t * cfg, size_t * count);
+
+/**
+ * Sweep over channel plan once, leaves RA-02 in sleep mode, tuned to last
+ * surveyed channel
+ *
+ * @param cfg Survey config
+ * @param channels Output, statistics per channel
+ * @param count On input - capacity of channels. On output - channels surveyed
+ * @param running Stop flag, may be cleared from signal handler, NULL - whole plan
+ *
+ * @retval E_OVERFLOW Plan doesn't fit into channels
+ */
+error_t ra02_survey_run(
+  const ra02_survey_cfg_t * cfg,
+  ra02_survey_channel_t * channels,
+  size_t * count,
+  volatile bool * running
+);
+
+/**
+ * Write survey results
+ *
+ * @param file Output
+ * @param format Output format
+ * @param channels Statistics per channel
+ * @param count Number of channels
+ *
+ * @note Output is flushed before return
+ */
+error_t ra02_survey_write(FILE * file, ra02_survey_format_t format, const ra02_survey_channel_t * channels, size_t count);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,202 @@
+/** ========================================================================= *
+ *
+ * @file ra02_timesync.h
+ * @date 17-10-2026
+ * @author Maksym Tkachuk <max.r.tkachuk@gmail.com>
+ *
+ * @brief Beacon based network time synchronization
+ *
+ * Coordinator transmits beacons at precise instants with its own timestamp
+ * of TX start. Followers take RX_DONE timestamp, correct it for time on air
+ * and discipline local clock model (offset + rate) with a PI filter
+ *
+ *  ========================================================================= */
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ================================================================= */
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <error.h>
+#include <timeout.h>
+#include <ra02.h>
+
+/* Defines ================================================================== */
+/**
+ * Beacon layout: [magic] [seq] [timestamp, 8 bytes LE]
+ */
+#define RA02_TIMESYNC_BEACON_MAGIC 0xB5
+#define RA02_TIMESYNC_BEACON_SIZE  10
+
+/**
+ * Constant delay in ns between requested TX instant and actual start of
+ * preamble (SPI write, PA ramp-up), added to beacon timestamp
+ */
+#ifndef RA02_TIMESYNC_TX_DELAY_NS
+#define RA02_TIMESYNC_TX_DELAY_NS 0
+#endif
+
+/**
+ * Constant delay in ns between end of frame and RX_DONE timestamp
+ */
+#ifndef RA02_TIMESYNC_RX_DELAY_NS
+#define RA02_TIMESYNC_RX_DELAY_NS 0
+#endif
+
+/* Macros =================================================================== */
+/* Enums ==================================================================== */
+/* Types ==================================================================== */
+/**
+ * Local clock source, returns local time at given CLOCK_MONOTONIC instant
+ */
+typedef uint64_t (*ra02_clock_fn_t)(void * ctx, uint64_t mono_ns);
+
+/**
+ * Time sync config
+ */
+typedef struct {
+  ra02_t *        ra02;
+  bool            coordinator; /** Transmit beacons, network time is local time */
+  ra02_clock_fn_t clock;       /** Optional, CLOCK_MONOTONIC is used if NULL */
+  void *          clock_ctx;   /** Context passed to clock */
+  float           kp;          /** Phase correction gain, 0 - default */
+  float           ki;          /** Frequency correction gain, 0 - default */
+  uint32_t        step_ns;     /** Error above which clock is stepped instead of slewed, 0 - default */
+} ra02_timesync_cfg_t;
+
+/**
+ * Time sync context
+ */
+typedef struct {
+  ra02_timesync_cfg_t cfg;
+  bool     synced;        /** At least one beacon was received */
+  uint8_t  seq;           /** Coordinator: next beacon seq, follower: last received */
+  uint64_t ref_local_ns;  /** Local time of last correction */
+  uint64_t ref_net_ns;    /** Network time at ref_local_ns */
+  double   rate;          /** Frequency correction, network clock runs (1 + rate) times local */
+  int64_t  last_error_ns; /** Offset error measured by last beacon */
+  uint32_t beacons;       /** Beacons processed */
+} ra02_timesync_t;
+
+/**
+ * Time sync simulation parameters (2 emulated radios)
+ */
+typedef struct {
+  int32_t  skew_ppb;      /** Follower clock skew relative to coordinator in ppb */
+  int64_t  offset_ns;     /** Initial follower clock offset */
+  uint32_t period_ms;     /** Beacon period */
+  uint32_t beacons;       /** Beacons to send */
+  uint32_t settle;        /** Beacons to skip before measuring accuracy */
+  uint8_t  sf;            /** Spreading factor of beacons */
+  float    kp;            /** PI filter gains, 0 - default */
+  float    ki;
+} ra02_timesync_sim_cfg_t;
+
+/**
+ * Time sync simulation results
+ */
+typedef struct {
+  uint32_t received;      /** Beacons received by follower */
+  uint32_t measured;      /** Samples after settling */
+  uint64_t mean_abs_ns;   /** Mean absolute network time error */
+  uint64_t max_abs_ns;    /** Max absolute network time error */
+  double   rate_ppb;      /** Final frequency correction in ppb */
+} ra02_timesync_sim_result_t;
+
+/* Variables ================================================================ */
+/* Shared functions ========================================================= */
+/**
+ * Initialize time sync
+ *
+ * @param ts Time sync Handle
+ * @param cfg Config
+ */
+error_t ra02_timesync_init(ra02_timesync_t * ts, const ra02_timesync_cfg_t * cfg);
+
+/**
+ * Get local time at CLOCK_MONOTONIC instant
+ *
+ * @param ts Time sync Handle
+ * @param mono_ns CLOCK_MONOTONIC time
+ */
+uint64_t ra02_timesync_local_ns(ra02_timesync_t * ts, uint64_t mono_ns);
+
+/**
+ * Get network time at local time
+ *
+ * @param ts Time sync Handle
+ * @param local_ns Local time
+ */
+uint64_t ra02_timesync_net_at(ra02_timesync_t * ts, uint64_t local_ns);
+
+/**
+ * Get current network time
+ *
+ * @note Before first beacon is received, follower returns its local time
+ *
+ * @param ts Time sync Handle
+ */
+uint64_t ra02_net_time_ns(ra02_timesync_t * ts);
+
+/**
+ * Encode beacon, that will be transmitted at given instant
+ *
+ * @note Coordinator only. Payload can be extended after the beacon (e.g. MAC fields)
+ *
+ * @param ts Time sync Handle
+ * @param at_ns CLOCK_MONOTONIC time of TX start
+ * @param buf Output, at least RA02_TIMESYNC_BEACON_SIZE bytes
+ */
+error_t ra02_timesync_encode(ra02_timesync_t * ts, uint64_t at_ns, uint8_t * buf);
+
+/**
+ * Transmit beacon at precise instant
+ *
+ * If the instant is missed, beacon is restamped & sent a few ms later (up to
+ * 3 times), actual TX start is stored in ra02->last_tx_ns
+ *
+ * @note Coordinator only
+ *
+ * @param ts Time sync Handle
+ * @param at_ns CLOCK_MONOTONIC time of TX start
+ */
+error_t ra02_timesync_send_beacon(ra02_timesync_t * ts, uint64_t at_ns);
+
+/**
+ * Process received beacon and discipline local clock model
+ *
+ * @param ts Time sync Handle
+ * @param buf Received frame, starting with beacon
+ * @param size Frame size (used for time on air)
+ * @param rx_ns CLOCK_MONOTONIC time of RX_DONE (ra02->last_rx_ns)
+ *
+ * @retval E_INVAL Frame is not a beacon
+ */
+error_t ra02_timesync_process(ra02_timesync_t * ts, const uint8_t * buf, size_t size, uint64_t rx_ns);
+
+/**
+ * Receive and process a beacon
+ *
+ * @note Follower only
+ *
+ * @param ts Time sync Handle
+ * @param timeout Timeout to wait for
+ */
+error_t ra02_timesync_recv_beacon(ra02_timesync_t * ts, timeout_t * timeout);
+
+/**
+ * Measure synchronization accuracy with 2 emulated radios, where follower
+ * clock has injected skew and offset. Runs in real time
+ *
+ * @param cfg Simulation parameters
+ * @param result Output, accuracy
+ */
+error_t ra02_timesync_simulate(const ra02_timesync_sim_cfg_t * cfg, ra02_timesync_sim_result_t * result);
+
+#ifdef __cplusplus
+}
+#endif
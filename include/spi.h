@@ -18,6 +18,13 @@ extern "C" {
 #include <error.h>
 
 /* Defines ================================================================== */
+/**
+ * Max transfers submitted to spidev in one ioctl by spi_transcieve_batch
+ */
+#ifndef SPI_BATCH_MAX
+#define SPI_BATCH_MAX 64
+#endif
+
 /* Macros =================================================================== */
 /* Enums ==================================================================== */
 /* Types ==================================================================== */
@@ -30,12 +37,29 @@ typedef struct {
   uint8_t  bits_per_word;
 } spi_cfg_t;
 
+/**
+ * Single transfer of a batch, see spi_transcieve_batch
+ */
+typedef struct {
+  uint8_t * tx_buf;
+  uint8_t * rx_buf;   /** Can be NULL */
+  size_t    size;
+  uint16_t  delay_us; /** Delay after transfer, before chip select is released */
+} spi_xfer_t;
+
+/**
+ * SPI transfer override, see spi_t
+ */
+typedef error_t (*spi_transfer_fn_t)(void * ctx, uint8_t * tx_buf, uint8_t * rx_buf, size_t size);
+
 /**
  * SPI Context
  */
 typedef struct {
   spi_cfg_t cfg;
   int fd;
+  spi_transfer_fn_t transfer; /** Optional, replaces spidev (e.g. emulated device) */
+  void * ctx;                 /** Context passed to transfer */
 } spi_t;
 
 /* Variables ================================================================ */
@@ -78,6 +102,16 @@ error_t spi_transcieve(
   size_t size
 );
 
+/**
+ * Run several transfers with chip select released between them, submitted
+ * to the kernel together (one syscall per SPI_BATCH_MAX transfers)
+ *
+ * @param spi SPI Handle
+ * @param xfers Transfers
+ * @param count Number of transfers
+ */
+error_t spi_transcieve_batch(spi_t * spi, spi_xfer_t * xfers, size_t count);
+
 #ifdef __cplusplus
 }
 #endif
@@ -39,6 +39,32 @@ typedef struct {
   uint64_t duration;
 } timeout_t;
 
+/**
+ * Time source, replaces CLOCK_MONOTONIC (e.g. virtual time of a simulator)
+ *
+ * @note GPIO edge waits follow it by polling around its sleep, but edge
+ *       timestamps of real GPIO lines stay kernel CLOCK_MONOTONIC, so
+ *       ra02_t last_rx_ns of hardware radio isn't translated into it.
+ *       Emulated DIO lines are stamped in time of the emulator
+ */
+typedef struct {
+  uint64_t (*now_ns)(void * ctx);                     /** Current time in nanoseconds */
+  void     (*sleep_until_ns)(void * ctx, uint64_t ns); /** Block until given time */
+  void *   ctx;
+} timeout_clock_t;
+
+/**
+ * Virtual time, that only moves forward: sleeps return immediately, setting
+ * the time, and every read advances it by a tick, so polling loops (e.g.
+ * ra02_recv without DIOs on emulated radio) make progress.
+ * Not synchronized, for use by one thread at a time
+ */
+typedef struct {
+  uint64_t        now_ns;
+  uint64_t        tick_ns;
+  timeout_clock_t clock;
+} timeout_virtual_clock_t;
+
 /* Variables ================================================================ */
 /* Shared functions ========================================================= */
 /**
@@ -62,6 +88,78 @@ bool timeout_is_expired(const timeout_t * timeout);
  */
 void timeout_expire(timeout_t * timeout);
 
+/**
+ * Returns milliseconds left until timeout expires, 0 if expired
+ */
+uint64_t timeout_remaining_ms(const timeout_t * timeout);
+
+/**
+ * Returns monotonic time in microseconds, for measuring intervals
+ *
+ * @note This & all other functions use time source of calling thread, if it
+ *       is set, or else time source of the process (CLOCK_MONOTONIC by default)
+ */
+uint64_t timeout_now_us(void);
+
+/**
+ * Returns monotonic time in nanoseconds (CLOCK_MONOTONIC)
+ */
+uint64_t timeout_now_ns(void);
+
+/**
+ * Sleeps until monotonic time in nanoseconds
+ *
+ * @param ns Absolute CLOCK_MONOTONIC time in nanoseconds
+ */
+void timeout_sleep_until_ns(uint64_t ns);
+
+/**
+ * Sleeps until monotonic time in nanoseconds, spinning for the last part
+ * to hit the instant precisely. Burns CPU, meant for timed TX only
+ *
+ * @param ns Absolute CLOCK_MONOTONIC time in nanoseconds
+ */
+void timeout_sleep_until_precise_ns(uint64_t ns);
+
+/**
+ * Sleeps for given time, used by the driver instead of usleep
+ *
+ * @param us Time to sleep in microseconds
+ */
+void timeout_sleep_us(uint64_t us);
+
+/**
+ * Checks if calling thread uses CLOCK_MONOTONIC, i.e. kernel waits with
+ * timeout (GPIO edges, poll) are in its time
+ */
+bool timeout_clock_is_monotonic(void);
+
+/**
+ * Set time source of the process, should be done before other threads start
+ *
+ * @param clock Time source, must outlive its use, NULL - CLOCK_MONOTONIC
+ */
+void timeout_set_clock(const timeout_clock_t * clock);
+
+/**
+ * Set time source of calling thread, overrides time source of the process
+ *
+ * @param clock Time source, must outlive its use, NULL - time source of the process
+ */
+void timeout_set_thread_clock(const timeout_clock_t * clock);
+
+/**
+ * Initialize virtual time source
+ *
+ * @param vclock Virtual clock
+ * @param start_ns Initial time
+ * @param tick_ns Time added on every read, 0 - default (1 us)
+ *
+ * @return Time source for timeout_set_clock/timeout_set_thread_clock
+ */
+const timeout_clock_t * timeout_virtual_clock_init(timeout_virtual_clock_t * vclock, uint64_t start_ns,
+                                                   uint64_t tick_ns);
+
 #ifdef __cplusplus
 }
 #endif
\ No newline at end of file
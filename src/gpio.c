@@ -0,0 +1,211 @@
+/** ========================================================================= *
+ *
+ * @file gpio.c
+ * @date 17-10-2026
+ * @author Maksym Tkachuk <max.r.tkachuk@gmail.com>
+ *
+ *  ========================================================================= */
+
+/* Includes ================================================================= */
+#define _GNU_SOURCE /* ppoll */
+#include <gpio.h>
+#include <assertion.h>
+#include <timeout.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <linux/gpio.h>
+
+/* Defines ================================================================== */
+#define GPIO_CONSUMER "linux-ra02"
+
+/** Max lines that can be waited on simultaneously */
+#define GPIO_WAIT_MAX_LINES 8
+
+/* Macros =================================================================== */
+/* Exposed macros =========================================================== */
+/* Enums ==================================================================== */
+/* Types ==================================================================== */
+/* Variables ================================================================ */
+/* Private functions ======================================================== */
+/**
+ * ppoll with timeout in time of calling thread. Other time sources than
+ * CLOCK_MONOTONIC can't be waited on by the kernel, so descriptors are polled
+ * before & after sleeping for whole timeout on the time source
+ */
+static int gpio_poll(struct pollfd * pfd, size_t nfds, uint32_t timeout_us) {
+  struct timespec ts = {0};
+
+  if (!timeout_clock_is_monotonic()) {
+    int res = ppoll(pfd, nfds, &ts, NULL);
+
+    if (res || !timeout_us) {
+      return res;
+    }
+
+    timeout_sleep_us(timeout_us);
+
+    return ppoll(pfd, nfds, &ts, NULL);
+  }
+
+  ts.tv_sec = timeout_us / 1000000;
+  ts.tv_nsec = (timeout_us % 1000000) * 1000;
+
+  return ppoll(pfd, nfds, &ts, NULL);
+}
+
+/* Shared functions ========================================================= */
+error_t gpio_init(gpio_t * gpio, const char * chip, uint32_t line, gpio_edge_t edge) {
+  ASSERT_RETURN(gpio && chip, E_NULL);
+
+  int chip_fd = open(chip, O_RDWR);
+
+  if (chip_fd < 0) {
+    return E_FAILED;
+  }
+
+  struct gpio_v2_line_request req = {0};
+
+  req.offsets[0] = line;
+  req.num_lines = 1;
+  req.config.flags = GPIO_V2_LINE_FLAG_INPUT
+      | (edge & GPIO_EDGE_RISING ? GPIO_V2_LINE_FLAG_EDGE_RISING : 0)
+      | (edge & GPIO_EDGE_FALLING ? GPIO_V2_LINE_FLAG_EDGE_FALLING : 0);
+  strncpy(req.consumer, GPIO_CONSUMER, sizeof(req.consumer) - 1);
+
+  int res = ioctl(chip_fd, GPIO_V2_GET_LINE_IOCTL, &req);
+
+  close(chip_fd);
+
+  if (res < 0) {
+    return E_FAILED;
+  }
+
+  gpio->fd = req.fd;
+  gpio->line = line;
+
+  return E_OK;
+}
+
+error_t gpio_deinit(gpio_t * gpio) {
+  ASSERT_RETURN(gpio, E_NULL);
+
+  close(gpio->fd);
+
+  return E_OK;
+}
+
+error_t gpio_get(gpio_t * gpio, bool * value) {
+  ASSERT_RETURN(gpio && value, E_NULL);
+
+  struct gpio_v2_line_values values = {.mask = 1};
+
+  if (ioctl(gpio->fd, GPIO_V2_LINE_GET_VALUES_IOCTL, &values) < 0) {
+    return E_FAILED;
+  }
+
+  *value = values.bits & 1;
+
+  return E_OK;
+}
+
+error_t gpio_wait_edge(gpio_t * gpio, uint32_t timeout_us, uint64_t * timestamp_ns) {
+  ASSERT_RETURN(gpio, E_NULL);
+
+  struct pollfd pfd = {.fd = gpio->fd, .events = POLLIN};
+
+  int res = gpio_poll(&pfd, 1, timeout_us);
+
+  if (res < 0) {
+    return E_FAILED;
+  }
+
+  if (res == 0) {
+    return E_TIMEOUT;
+  }
+
+  struct gpio_v2_line_event event;
+
+  if (read(gpio->fd, &event, sizeof(event)) != sizeof(event)) {
+    return E_FAILED;
+  }
+
+  if (timestamp_ns) {
+    *timestamp_ns = event.timestamp_ns;
+  }
+
+  return E_OK;
+}
+
+error_t gpio_wait_edge_any(
+  gpio_t ** gpios,
+  size_t count,
+  uint32_t timeout_us,
+  size_t * index,
+  uint64_t * timestamp_ns
+) {
+  return gpio_wait_edge_any_fd(gpios, count, -1, timeout_us, index, timestamp_ns);
+}
+
+error_t gpio_wait_edge_any_fd(
+  gpio_t ** gpios,
+  size_t count,
+  int fd,
+  uint32_t timeout_us,
+  size_t * index,
+  uint64_t * timestamp_ns
+) {
+  ASSERT_RETURN(gpios, E_NULL);
+  ASSERT_RETURN(count <= GPIO_WAIT_MAX_LINES, E_INVAL);
+
+  struct pollfd pfd[GPIO_WAIT_MAX_LINES + 1];
+  size_t map[GPIO_WAIT_MAX_LINES];
+  size_t nfds = 0;
+
+  for (size_t i = 0; i < count; ++i) {
+    if (gpios[i]) {
+      pfd[nfds] = (struct pollfd) {.fd = gpios[i]->fd, .events = POLLIN};
+      map[nfds++] = i;
+    }
+  }
+
+  ASSERT_RETURN(nfds, E_INVAL);
+
+  /* Negative fd is ignored by ppoll */
+  pfd[nfds] = (struct pollfd) {.fd = fd, .events = POLLIN};
+
+  int res = gpio_poll(pfd, nfds + 1, timeout_us);
+
+  if (res < 0) {
+    return E_FAILED;
+  }
+
+  if (res == 0) {
+    return E_TIMEOUT;
+  }
+
+  for (size_t i = 0; i < nfds; ++i) {
+    if (pfd[i].revents & POLLIN) {
+      struct gpio_v2_line_event event;
+
+      if (read(pfd[i].fd, &event, sizeof(event)) != sizeof(event)) {
+        return E_FAILED;
+      }
+
+      if (index) {
+        *index = map[i];
+      }
+
+      if (timestamp_ns) {
+        *timestamp_ns = event.timestamp_ns;
+      }
+
+      return E_OK;
+    }
+  }
+
+  /* fd is not read, so that its owner sees why the wait ended */
+  return pfd[nfds].revents & POLLIN ? E_CANCELLED : E_FAILED;
+}
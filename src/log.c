@@ -23,6 +23,14 @@
 /* Variables ================================================================ */
 
 /* Private functions ======================================================== */
+/**
+ * Length of formatted output, that actually fits into buffer of buf_size
+ * (snprintf returns untruncated length)
+ */
+static size_t log_fit(size_t size, size_t buf_size) {
+  return size < buf_size - 1 ? size : buf_size - 1;
+}
+
 static void log_write(const uint8_t * buffer, size_t size) {
   fwrite(buffer, 1, size, LOG_OUTPUT_FILE);
 }
@@ -75,12 +83,12 @@ void vlog_fmt(log_level_t level, const char * fmt, va_list args) {
   char buf[LOG_LINE_SIZE];
   size_t size = 0;
 
-  size += snprintf(buf + size, sizeof(buf) - size - 1, "[%s%s%s] ",
-                   log_get_level_color(level),
-                   log_get_level_string(level),
-                   USE_COLOR_LOG ? COLOR_RESET : "");
-  size += vsnprintf(buf + size, sizeof(buf) - size - 1, fmt, args);
-  size += snprintf(buf + size, sizeof(buf) - size - 1, LINE_ENDING);
+  size = log_fit(size + snprintf(buf + size, sizeof(buf) - size - 1, "[%s%s%s] ",
+                                 log_get_level_color(level),
+                                 log_get_level_string(level),
+                                 USE_COLOR_LOG ? COLOR_RESET : ""), sizeof(buf));
+  size = log_fit(size + vsnprintf(buf + size, sizeof(buf) - size - 1, fmt, args), sizeof(buf));
+  size = log_fit(size + snprintf(buf + size, sizeof(buf) - size - 1, LINE_ENDING), sizeof(buf));
 
   buf[size] = 0;
 
@@ -91,15 +99,15 @@ void vlog_module_fmt(log_level_t level, const char * tag, const char * fmt, va_l
   char buf[LOG_LINE_SIZE];
   size_t size = 0;
 
-  size += snprintf(buf + size, sizeof(buf) - size - 1, "[%s%s%s] [%s%s%s] ",
-                   log_get_level_color(level),
-                   log_get_level_string(level),
-                   USE_COLOR_LOG ? COLOR_RESET : "",
-                   USE_COLOR_LOG ? COLOR_MAGENTA : "",
-                   tag,
-                   USE_COLOR_LOG ? COLOR_RESET : "");
-  size += vsnprintf(buf + size, sizeof(buf) - size - 1, fmt, args);
-  size += snprintf(buf + size, sizeof(buf) - size - 1, LINE_ENDING);
+  size = log_fit(size + snprintf(buf + size, sizeof(buf) - size - 1, "[%s%s%s] [%s%s%s] ",
+                                 log_get_level_color(level),
+                                 log_get_level_string(level),
+                                 USE_COLOR_LOG ? COLOR_RESET : "",
+                                 USE_COLOR_LOG ? COLOR_MAGENTA : "",
+                                 tag,
+                                 USE_COLOR_LOG ? COLOR_RESET : ""), sizeof(buf));
+  size = log_fit(size + vsnprintf(buf + size, sizeof(buf) - size - 1, fmt, args), sizeof(buf));
+  size = log_fit(size + snprintf(buf + size, sizeof(buf) - size - 1, LINE_ENDING), sizeof(buf));
 
   buf[size] = 0;
 
@@ -125,7 +133,7 @@ void log_printf(const char * fmt, ...) {
 
   va_list args;
   va_start(args, fmt);
-  size_t size = vsnprintf(buf, sizeof(buf) - 1, fmt, args);
+  size_t size = log_fit(vsnprintf(buf, sizeof(buf) - 1, fmt, args), sizeof(buf));
   va_end(args);
 
   buf[size] = 0;
@@ -8,10 +8,24 @@
 
 /* Includes ================================================================= */
 #include <ra02.h>
+#include <ra02_timesync.h>
+#include <ra02_mac.h>
+#include <ra02_mesh.h>
+#include <ra02_fwd.h>
+#include <ra02_daemon.h>
+#include <ra02_pipe.h>
+#include <ra02_survey.h>
+#include <ra02_bench.h>
+#include <ra02_sim.h>
+#include <ra02_mgr.h>
+#include <timeout.h>
 #include <spi.h>
+#include <util.h>
 #include <log.h>
 #include <stdlib.h>
 #include <string.h>
+#include <signal.h>
+#include <poll.h>
 
 /* Defines ================================================================== */
 #define LOG_TAG MAIN
@@ -31,6 +45,13 @@ enum __ra02_action {
 /* Variables ================================================================ */
 const char ld_interp[] __attribute__((section(".interp"))) = LD_LOADER_PATH;
 
+static ra02_fwd_t fwd;
+static ra02_daemon_t daemon;
+static ra02_mgr_t mgr;
+static volatile bool pipe_running = true;
+static volatile bool survey_running = true;
+static volatile bool bench_running = true;
+
 /* Private functions ======================================================== */
 static void __ra02_static_action(int action, ...) {
   static ra02_t ra02;
@@ -82,16 +103,151 @@ static void __ra02_deinit_static(ra02_t ** ra02) {
   *ra02 = NULL;
 }
 
+static void __fwd_signal_handler(int sig) {
+  ra02_fwd_stop(&fwd);
+}
+
+static void __daemon_signal_handler(int sig) {
+  ra02_daemon_stop(&daemon);
+}
+
+static void __pipe_signal_handler(int sig) {
+  pipe_running = false;
+}
+
+static void __survey_signal_handler(int sig) {
+  survey_running = false;
+}
+
+static void __bench_signal_handler(int sig) {
+  bench_running = false;
+}
+
+static void __mgr_signal_handler(int sig) {
+  ra02_mgr_stop(&mgr);
+}
+
+static void __print_packet(const uint8_t * buf, size_t size) {
+  log_printf("[%d]: ", size);
+  for (size_t i = 0; i < size; ++i) {
+    log_printf("%02x ", buf[i]);
+  }
+  log_printf("\n");
+}
+
+static void __print_mgr_stats(const char * name, const ra02_mgr_stats_t * stats) {
+  log_printf("%s: rx %u (bad %u, dropped %u) %.1f bps, tx %u (failed %u, dropped %u) %.1f bps, "
+             "tx latency avg %u us, max %u us\n", name, stats->rx, stats->rx_bad, stats->rx_dropped, stats->rx_bps,
+             stats->tx, stats->tx_failed, stats->tx_dropped, stats->tx_bps, stats->tx_latency_avg_us,
+             stats->tx_latency_max_us);
+}
+
+static void __mgr_report(void) {
+  ra02_mgr_stats_t stats[RA02_MGR_MAX_RADIOS];
+  ra02_mgr_stats_t total;
+  char name[16];
+
+  ra02_mgr_get_stats(&mgr, stats, &total);
+
+  for (uint8_t i = 0; i < mgr.cfg.count; ++i) {
+    snprintf(name, sizeof(name), "radio %d", i);
+    __print_mgr_stats(name, &stats[i]);
+  }
+
+  __print_mgr_stats("total", &total);
+}
+
+/**
+ * Queue frame from "RADIO BYTE..." line, bytes are decimal or 0x prefixed hex
+ */
+static void __mgr_send_line(char * line) {
+  char * save = NULL;
+  char * token = strtok_r(line, " \t\r\n", &save);
+  uint8_t buf[RA02_MAX_PACKET_SIZE];
+  size_t size = 0;
+
+  if (!token) {
+    return;
+  }
+
+  uint8_t radio = strtoul(token, NULL, 0);
+
+  while ((token = strtok_r(NULL, " \t\r\n", &save)) && size < sizeof(buf)) {
+    buf[size++] = strtoul(token, NULL, 0);
+  }
+
+  error_t err = ra02_mgr_send(&mgr, radio, buf, size);
+
+  if (err != E_OK) {
+    log_error("radio %d: send: %s", radio, error2str(err));
+  }
+}
+
 static void usage(const char * argv0) {
-  log_printf(
-    "Usage: %s SPIDEV help|spitest|init|send|recv [TIMEOUT|BYTES]\n"
-    "  help    - Shows this message\n"
-    "  spitest - Tests SPI connection to ra02 module\n"
-    "  init    - Initializes ra02 module\n"
-    "  send    - Sends bytes via ra02 module\n"
+  /* One entry per command, each must fit into LOG_LINE_SIZE */
+  static const char * commands[] = {
+    "  help    - Shows this message\n",
+    "  spitest - Tests SPI connection to ra02 module\n",
+    "  init    - Initializes ra02 module\n",
+    "  send    - Sends bytes via ra02 module\n",
     "  recv    - Received a packet via a ra02 module\n",
+    "  scansim - Simulates SF7-SF12 scanning receiver against random traffic\n"
+    "            with given preamble (default - computed per SF) and reports detection\n"
+    "            probability per SF. Doesn't access SPIDEV\n",
+    "  syncsim - Runs beacon time sync between 2 emulated radios, where follower\n"
+    "            clock is skewed by SKEW_PPB (default 50000), and reports accuracy.\n"
+    "            Doesn't access SPIDEV\n",
+    "  macsim  - Compares goodput of ALOHA, LBT & TDMA with NODES (default 60)\n"
+    "            nodes on a shared channel over a range of offered load.\n"
+    "            Doesn't access SPIDEV\n",
+    "  meshsim - Compares flooding & learned routes on a random mesh of NODES\n"
+    "            (default 100) nodes sending to central gateway.\n"
+    "            Doesn't access SPIDEV\n",
+    "  netsim  - Runs real driver on NODES (default 1000) emulated end nodes with\n"
+    "            PROTO aloha (default) or lbt, uplinking to a gateway, in virtual\n"
+    "            time for DURATION_S (default 3600) on THREADS (default - CPUs).\n"
+    "            Reports delivery, utilization & latency. Doesn't access SPIDEV\n",
+    "  forward - Runs as gateway packet forwarder, talking Semtech UDP protocol\n"
+    "            to network server at HOST:PORT as gateway EUI (hex, default 0)\n"
+    "            until interrupted\n",
+    "  daemon  - Owns ra02 module and serves clients on Unix socket (RA02_SOCKET\n"
+    "            environment variable or " RA02_DAEMON_DEFAULT_SOCKET ") until\n"
+    "            interrupted. While it runs, send & recv go through it\n",
+    "  stats   - Shows daemon statistics\n",
+    "  subscribe - Prints every packet received by daemon until interrupted\n",
+    "  tx-stream - Transmits frames from stdin back-to-back until EOF. FORMAT is\n"
+    "            hex (default, frame per line, optionally prefixed by rx-stream\n"
+    "            \"<time> <rssi> <snr>\") or binary (length-prefixed)\n",
+    "  rx-stream - Receives continuously and writes frames with metadata to stdout\n"
+    "            as hex (default), binary or json lines, until interrupted or\n"
+    "            COUNT frames are received\n",
+    "  scan    - Surveys channel RSSI from START to STOP kHz (default 410000-525000,\n"
+    "            STEP 125), DWELL_MS per channel (default 5). Prints min/avg/max,\n"
+    "            percentiles & occupancy per channel as csv (default) or json\n",
+    "  bench   - Link benchmark, MODE is tx, rx, ping or pong (run rx/pong on the\n"
+    "            other side with the same SF & BW). Sends COUNT frames (default 100)\n"
+    "            of SIZE bytes (default 32), INTERVAL_MS apart (default back-to-back)\n"
+    "            and prints goodput, PER, RSSI/SNR, jitter & round trip as json\n",
+    "  benchsim - Runs bench between 2 emulated radios, MODE is tx (default) or\n"
+    "            ping, peer runs rx or pong. Prints json of both sides, SF & BW\n"
+    "            default to 7 & 125. Doesn't access SPIDEV\n",
+    "  multi   - Runs radios from CONFIG file, each in its own (pinned, real-time)\n"
+    "            thread, prints frames received by any of them, transmits\n"
+    "            \"RADIO BYTE...\" lines from stdin and prints per-radio & total\n"
+    "            throughput every STATS_S (default 10, 0 - only at exit), until\n"
+    "            interrupted. Doesn't access SPIDEV\n",
+  };
+
+  log_printf(
+    "Usage: %s SPIDEV help|spitest|init|send|recv|scansim|syncsim|macsim|meshsim|netsim|forward|daemon|stats|subscribe|tx-stream|rx-stream|scan|bench|benchsim|multi\n"
+    "       [TIMEOUT|BYTES|PREAMBLE|SKEW_PPB|NODES|HOST:PORT [EUI]|FORMAT [COUNT]|DWELL_MS [FORMAT [START STOP [STEP]]]\n"
+    "       |MODE [COUNT [SIZE [INTERVAL_MS [SF [BW_KHZ]]]]]|NODES [PROTO [THREADS [DURATION_S]]]|CONFIG [STATS_S]]\n",
     argv0
   );
+
+  for (size_t i = 0; i < UTIL_ARR_SIZE(commands); ++i) {
+    log_printf("%s", commands[i]);
+  }
 }
 
 /* Shared functions ========================================================= */
@@ -133,6 +289,20 @@ int main(int argc, char ** argv) {
     }
 
     error_t err = E_OK;
+    int fd;
+
+    if (ra02_client_connect(ra02_daemon_socket_path(), &fd) == E_OK) {
+      err = ra02_client_send(fd, packet, size);
+      ra02_client_disconnect(fd);
+
+      if (err == E_OK) {
+        log_info("Packet sent");
+      } else {
+        log_error("Failed to send packet: %s", error2str(err));
+      }
+
+      return err == E_OK ? 0 : 1;
+    }
 
     WITH_RA02(ra02, spidev) {
       err = ra02_send(ra02, packet, size);
@@ -157,20 +327,524 @@ int main(int argc, char ** argv) {
     uint8_t packet[RA02_MAX_PACKET_SIZE] = {0};
     size_t size = sizeof(packet);
     error_t err = E_OK;
+    int fd;
+
+    if (ra02_client_connect(ra02_daemon_socket_path(), &fd) == E_OK) {
+      ra02_daemon_packet_t rx;
+
+      err = ra02_client_recv(fd, &rx, atoi(argv[3]));
+      ra02_client_disconnect(fd);
+
+      if (err == E_OK) {
+        __print_packet(rx.data, rx.size);
+      } else {
+        log_error("ra02_client_recv: %s", error2str(err));
+      }
+
+      return err == E_OK ? 0 : 1;
+    }
 
     WITH_RA02(ra02, spidev) {
       err = ra02_recv(ra02, packet, &size, &t);
       if (err == E_OK) {
-        log_printf("[%d]: ", size);
-        for (size_t i = 0; i < size; ++i) {
-          log_printf("%02x ", packet[i]);
-        }
-        log_printf("\n");
+        __print_packet(packet, size);
       } else {
         log_error("ra02_recv: %s", error2str(err));
       }
     }
 
+    return err == E_OK ? 0 : 1;
+  } else if (!strcmp(argv[2], "scansim")) {
+    ra02_t model = {
+      .modem = RA02_MODEM_LORA,
+      .bandwidth = 125000,
+      .frame = {.crc_rate = RA02_CRC_RATE_4_7, .crc = true},
+    };
+
+    ra02_scan_sim_cfg_t cfg = {
+      .sf_mask = RA02_SF_MASK_ALL,
+      .preamble = argc > 3 ? atoi(argv[3]) : 0,
+      .payload_size = 16,
+      .interval_ms = 10000,
+      .duration_ms = 3600 * 1000,
+      .switch_us = 200,
+      .seed = 1,
+    };
+
+    ra02_scan_sim_result_t result;
+    error_t err = ra02_scan_simulate(&model, &cfg, &result);
+
+    if (err != E_OK) {
+      log_error("ra02_scan_simulate: %s", error2str(err));
+      return 1;
+    }
+
+    log_printf("cycle %d us\n", result.cycle_us);
+
+    for (size_t i = 0; i < RA02_SCAN_SF_COUNT; ++i) {
+      log_printf("SF%d: %d/%d detected (%.1f%%)\n", RA02_SCAN_SF_MIN + i, result.detected[i], result.sent[i],
+                 result.sent[i] ? 100.0 * result.detected[i] / result.sent[i] : 0.0);
+    }
+  } else if (!strcmp(argv[2], "syncsim")) {
+    ra02_timesync_sim_cfg_t cfg = {
+      .skew_ppb = argc > 3 ? atoi(argv[3]) : 50000,
+      .offset_ns = 123456789,
+      .period_ms = 500,
+      .beacons = 40,
+      .settle = 10,
+      .sf = 7,
+    };
+
+    ra02_timesync_sim_result_t result;
+    error_t err = ra02_timesync_simulate(&cfg, &result);
+
+    if (err != E_OK) {
+      log_error("ra02_timesync_simulate: %s", error2str(err));
+      return 1;
+    }
+
+    log_printf("skew %d ppb: %d/%d beacons, error mean %llu ns, max %llu ns, rate %.0f ppb\n",
+               cfg.skew_ppb, result.received, cfg.beacons,
+               (unsigned long long) result.mean_abs_ns, (unsigned long long) result.max_abs_ns, result.rate_ppb);
+  } else if (!strcmp(argv[2], "macsim")) {
+    ra02_t model = {
+      .modem = RA02_MODEM_LORA,
+      .sf = 7,
+      .bandwidth = 125000,
+      .preamble = 8,
+      .frame = {.crc_rate = RA02_CRC_RATE_4_5, .crc = true},
+    };
+
+    static const char * protos[] = {"ALOHA", "LBT", "TDMA"};
+    static const float loads[] = {0.1f, 0.25f, 0.5f, 1.0f, 2.0f, 4.0f};
+
+    log_printf("%-6s %6s %10s %12s %6s\n", "proto", "load", "delivered", "goodput bps", "util");
+
+    for (size_t proto = 0; proto < UTIL_ARR_SIZE(protos); ++proto) {
+      for (size_t i = 0; i < UTIL_ARR_SIZE(loads); ++i) {
+        ra02_mac_sim_cfg_t cfg = {
+          .proto = proto,
+          .nodes = argc > 3 ? atoi(argv[3]) : 60,
+          .payload_size = 16,
+          .join_slots = 2,
+          .load = loads[i],
+          .drift_ppm = 20,
+          .jitter_us = 1000,
+          .duration_ms = 3600 * 1000,
+          .seed = 1,
+        };
+
+        ra02_mac_sim_result_t result;
+        error_t err = ra02_mac_simulate(&model, &cfg, &result);
+
+        if (err != E_OK) {
+          log_error("ra02_mac_simulate: %s", error2str(err));
+          return 1;
+        }
+
+        log_printf("%-6s %6.2f %10d %12.1f %5.1f%%\n", protos[proto], cfg.load, result.delivered,
+                   result.goodput_bps, result.utilization * 100);
+      }
+    }
+  } else if (!strcmp(argv[2], "meshsim")) {
+    ra02_t model = {
+      .modem = RA02_MODEM_LORA,
+      .sf = 7,
+      .bandwidth = 125000,
+      .preamble = 8,
+      .frame = {.crc_rate = RA02_CRC_RATE_4_5, .crc = true},
+    };
+
+    log_printf("%-8s %10s %8s %6s %16s\n", "mode", "delivered", "tx", "hops", "airtime/msg ms");
+
+    for (size_t routing = 0; routing < 2; ++routing) {
+      ra02_mesh_sim_cfg_t cfg = {
+        .nodes = argc > 3 ? atoi(argv[3]) : 100,
+        .side_m = 12000,
+        .messages = 1000,
+        .interval_ms = 5000,
+        .hello_ms = 60000,
+        .payload_size = 16,
+        .ttl = 6,
+        .routing = routing,
+        .seed = 1,
+      };
+
+      ra02_mesh_sim_result_t result;
+      error_t err = ra02_mesh_simulate(&model, &cfg, &result);
+
+      if (err != E_OK) {
+        log_error("ra02_mesh_simulate: %s", error2str(err));
+        return 1;
+      }
+
+      log_printf("%-8s %9.1f%% %8d %6d %16.1f\n", routing ? "routing" : "flood", result.delivery_ratio * 100,
+                 result.transmissions, result.max_hops, result.airtime_per_delivered_ms);
+    }
+  } else if (!strcmp(argv[2], "netsim")) {
+    ra02_sim_cfg_t cfg = {
+      .proto = RA02_MAC_PROTO_ALOHA,
+      .nodes = argc > 3 ? atoi(argv[3]) : 1000,
+      .threads = argc > 5 ? atoi(argv[5]) : 0,
+      .duration_ms = (argc > 6 ? atoi(argv[6]) : 3600) * 1000,
+      .seed = 1,
+    };
+
+    if (argc > 4 && ra02_sim_parse_proto(argv[4], &cfg.proto) != E_OK) {
+      log_error("Unknown protocol '%s'", argv[4]);
+      usage(argv[0]);
+      return 1;
+    }
+
+    ra02_sim_result_t result;
+    error_t err = ra02_sim_run(&cfg, &result);
+
+    if (err != E_OK) {
+      log_error("ra02_sim_run: %s", error2str(err));
+      return 1;
+    }
+
+    log_printf("offered %d, sent %d, deferred %d, dropped %d, delivered %d (%.1f%%), corrupt %d\n",
+               result.offered, result.sent, result.deferred, result.dropped, result.delivered,
+               result.delivery_ratio * 100, result.corrupt);
+
+    for (size_t i = 0; i < RA02_SCAN_SF_COUNT; ++i) {
+      if (result.sent_sf[i]) {
+        log_printf("SF%-2d sent %8d, delivered %8d\n", (int) (RA02_SCAN_SF_MIN + i), result.sent_sf[i],
+                   result.delivered_sf[i]);
+      }
+    }
+
+    log_printf("utilization %.1f%%, goodput %.1f bps, latency avg %d us, p50 %d us, p99 %d us, max %d us\n",
+               result.utilization * 100, result.goodput_bps, result.latency_avg_us, result.latency_p50_us,
+               result.latency_p99_us, result.latency_max_us);
+    log_printf("%llu SPI transfers, %d ms wall time, %.1fx real time\n",
+               (unsigned long long) result.transfers, result.wall_ms, result.speedup);
+  } else if (!strcmp(argv[2], "forward")) {
+    char * port = argc > 3 ? strrchr(argv[3], ':') : NULL;
+
+    if (!port) {
+      log_error("Expected HOST:PORT");
+      usage(argv[0]);
+      return 1;
+    }
+
+    *port++ = '\0';
+
+    ra02_fwd_cfg_t cfg = {
+      .host = argv[3],
+      .port_up = atoi(port),
+      .gateway_eui = argc > 4 ? strtoull(argv[4], NULL, 16) : 0,
+      .freq_khz = 433000,
+    };
+
+    error_t err = E_OK;
+
+    WITH_RA02(ra02, spidev) {
+      cfg.ra02 = ra02;
+
+      err = ra02_fwd_init(&fwd, &cfg);
+
+      if (err != E_OK) {
+        log_error("ra02_fwd_init: %s", error2str(err));
+        continue;
+      }
+
+      signal(SIGINT, __fwd_signal_handler);
+      signal(SIGTERM, __fwd_signal_handler);
+
+      err = ra02_fwd_run(&fwd, NULL);
+
+      ra02_fwd_stats_t stats;
+      ra02_fwd_get_stats(&fwd, &stats);
+      ra02_fwd_deinit(&fwd);
+
+      log_info("rx %d (bad %d, forwarded %d), tx %d (late %d, failed %d, rejected %d), acks %d/%d push, %d/%d pull",
+               stats.rx_ok, stats.rx_bad, stats.rx_forwarded, stats.tx_sent, stats.tx_late, stats.tx_failed, stats.tx_rejected,
+               stats.push_acked, stats.push_sent, stats.pull_acked, stats.pull_sent);
+    }
+
+    return err == E_OK ? 0 : 1;
+  } else if (!strcmp(argv[2], "daemon")) {
+    error_t err = E_OK;
+
+    WITH_RA02(ra02, spidev) {
+      err = ra02_daemon_init(&daemon, ra02, ra02_daemon_socket_path());
+
+      if (err != E_OK) {
+        log_error("ra02_daemon_init: %s", error2str(err));
+        continue;
+      }
+
+      signal(SIGINT, __daemon_signal_handler);
+      signal(SIGTERM, __daemon_signal_handler);
+
+      err = ra02_daemon_run(&daemon);
+      ra02_daemon_deinit(&daemon);
+    }
+
+    return err == E_OK ? 0 : 1;
+  } else if (!strcmp(argv[2], "stats") || !strcmp(argv[2], "subscribe")) {
+    int fd;
+    error_t err = ra02_client_connect(ra02_daemon_socket_path(), &fd);
+
+    if (err != E_OK) {
+      log_error("Daemon is not running");
+      return 1;
+    }
+
+    if (!strcmp(argv[2], "stats")) {
+      ra02_daemon_stats_t stats;
+
+      err = ra02_client_stats(fd, &stats);
+
+      if (err == E_OK) {
+        log_printf("uptime %llu ms, clients %u, requests %u\n"
+                   "rx %u (bad %u, dropped %u), tx %u (failed %u)\n",
+                   (unsigned long long) stats.uptime_ms, stats.clients, stats.requests,
+                   stats.rx, stats.rx_bad, stats.rx_dropped, stats.tx, stats.tx_failed);
+      }
+    } else {
+      err = ra02_client_subscribe(fd);
+
+      ra02_daemon_packet_t rx;
+
+      while (err == E_OK && (err = ra02_client_next(fd, &rx, -1)) == E_OK) {
+        log_printf("rssi %d snr %d ", rx.rssi, rx.snr);
+        __print_packet(rx.data, rx.size);
+      }
+    }
+
+    ra02_client_disconnect(fd);
+
+    if (err != E_OK) {
+      log_error("%s: %s", argv[2], error2str(err));
+    }
+
+    return err == E_OK ? 0 : 1;
+  } else if (!strcmp(argv[2], "tx-stream") || !strcmp(argv[2], "rx-stream")) {
+    bool tx = !strcmp(argv[2], "tx-stream");
+    ra02_pipe_cfg_t cfg = {
+      .client_fd = -1,
+      .file = tx ? stdin : stdout,
+      .format = RA02_PIPE_FORMAT_HEX,
+      .count = argc > 4 ? atoi(argv[4]) : 0,
+    };
+
+    if (argc > 3 && ra02_pipe_parse_format(argv[3], &cfg.format) != E_OK) {
+      log_error("Unknown format '%s'", argv[3]);
+      usage(argv[0]);
+      return 1;
+    }
+
+    /* Large buffers let the stream run at line rate through pipes */
+    setvbuf(cfg.file, NULL, _IOFBF, 1 << 16);
+
+    signal(SIGINT, __pipe_signal_handler);
+    signal(SIGTERM, __pipe_signal_handler);
+
+    ra02_pipe_stats_t stats = {0};
+    error_t err = E_OK;
+
+    if (ra02_client_connect(ra02_daemon_socket_path(), &cfg.client_fd) == E_OK) {
+      err = tx ? ra02_pipe_tx(&cfg, &pipe_running, &stats) : ra02_pipe_rx(&cfg, &pipe_running, &stats);
+      ra02_client_disconnect(cfg.client_fd);
+    } else {
+      WITH_RA02(ra02, spidev) {
+        cfg.ra02 = ra02;
+        err = tx ? ra02_pipe_tx(&cfg, &pipe_running, &stats) : ra02_pipe_rx(&cfg, &pipe_running, &stats);
+      }
+    }
+
+    /* stdout may carry binary frames, so summary goes to stderr */
+    fprintf(stderr, "%s: %u frames, %u bytes, %u dropped, %u errors\n", argv[2],
+            stats.frames, stats.bytes, stats.dropped, stats.errors);
+
+    if (err != E_OK) {
+      log_error("%s: %s", argv[2], error2str(err));
+    }
+
+    return err == E_OK ? 0 : 1;
+  } else if (!strcmp(argv[2], "scan")) {
+    ra02_survey_format_t format = RA02_SURVEY_FORMAT_CSV;
+    ra02_survey_cfg_t cfg = {
+      .dwell_ms = argc > 3 ? atoi(argv[3]) : 0,
+      .start_khz = argc > 6 ? atoi(argv[5]) : 0,
+      .stop_khz = argc > 6 ? atoi(argv[6]) : 0,
+      .step_khz = argc > 7 ? atoi(argv[7]) : 0,
+    };
+
+    if (argc > 4 && ra02_survey_parse_format(argv[4], &format) != E_OK) {
+      log_error("Unknown format '%s'", argv[4]);
+      usage(argv[0]);
+      return 1;
+    }
+
+    size_t count = 0;
+    error_t err = ra02_survey_channel_count(&cfg, &count);
+
+    if (err != E_OK) {
+      log_error("Invalid channel plan: %s", error2str(err));
+      usage(argv[0]);
+      return 1;
+    }
+
+    ra02_survey_channel_t * channels = calloc(count, sizeof(ra02_survey_channel_t));
+
+    if (!channels) {
+      log_error("Out of memory");
+      return 1;
+    }
+
+    WITH_RA02(ra02, spidev) {
+      cfg.ra02 = ra02;
+
+      signal(SIGINT, __survey_signal_handler);
+      signal(SIGTERM, __survey_signal_handler);
+
+      /* Interrupted sweep still reports channels surveyed so far */
+      err = ra02_survey_run(&cfg, channels, &count, &survey_running);
+      ra02_survey_write(stdout, format, channels, count);
+    }
+
+    free(channels);
+
+    if (err != E_OK) {
+      log_error("scan: %s", error2str(err));
+    }
+
+    return err == E_OK ? 0 : 1;
+  } else if (!strcmp(argv[2], "bench")) {
+    ra02_bench_mode_t mode;
+
+    if (argc < 4 || ra02_bench_parse_mode(argv[3], &mode) != E_OK) {
+      log_error("Expected bench mode: tx, rx, ping or pong");
+      usage(argv[0]);
+      return 1;
+    }
+
+    ra02_bench_cfg_t cfg = {
+      .count = argc > 4 ? atoi(argv[4]) : 0,
+      .size = argc > 5 ? atoi(argv[5]) : 0,
+      .interval_ms = argc > 6 ? atoi(argv[6]) : 0,
+      .sf = argc > 7 ? atoi(argv[7]) : 0,
+      .bandwidth = argc > 8 ? atoi(argv[8]) * 1000 : 0,
+    };
+
+    ra02_bench_result_t result;
+    error_t err = E_OK;
+
+    WITH_RA02(ra02, spidev) {
+      cfg.ra02 = ra02;
+
+      signal(SIGINT, __bench_signal_handler);
+      signal(SIGTERM, __bench_signal_handler);
+
+      err = ra02_bench_run(&cfg, mode, &bench_running, &result);
+
+      if (err == E_OK) {
+        ra02_bench_write_json(stdout, &cfg, &result);
+      }
+    }
+
+    if (err != E_OK) {
+      log_error("bench: %s", error2str(err));
+    }
+
+    return err == E_OK ? 0 : 1;
+  } else if (!strcmp(argv[2], "benchsim")) {
+    ra02_bench_mode_t mode = RA02_BENCH_MODE_TX;
+
+    if (argc > 3 && (ra02_bench_parse_mode(argv[3], &mode) != E_OK ||
+                     (mode != RA02_BENCH_MODE_TX && mode != RA02_BENCH_MODE_PING))) {
+      log_error("Expected benchsim mode: tx or ping");
+      usage(argv[0]);
+      return 1;
+    }
+
+    ra02_bench_cfg_t cfg = {
+      .count = argc > 4 ? atoi(argv[4]) : 0,
+      .size = argc > 5 ? atoi(argv[5]) : 0,
+      .interval_ms = argc > 6 ? atoi(argv[6]) : 0,
+      .sf = argc > 7 ? atoi(argv[7]) : 7,
+      .bandwidth = (argc > 8 ? atoi(argv[8]) : 125) * 1000,
+    };
+
+    ra02_bench_result_t result;
+    ra02_bench_result_t peer_result;
+    error_t err = ra02_bench_simulate(&cfg, mode, &result, &peer_result);
+
+    if (err != E_OK) {
+      log_error("ra02_bench_simulate: %s", error2str(err));
+      return 1;
+    }
+
+    /* Only profile of the radio is written, which both emulated radios share */
+    ra02_t model = {.sf = cfg.sf, .bandwidth = cfg.bandwidth};
+    cfg.ra02 = &model;
+
+    ra02_bench_write_json(stdout, &cfg, &result);
+    ra02_bench_write_json(stdout, &cfg, &peer_result);
+  } else if (!strcmp(argv[2], "multi")) {
+    if (argc < 4) {
+      log_error("Expected config file");
+      usage(argv[0]);
+      return 1;
+    }
+
+    ra02_mgr_cfg_t cfg;
+    error_t err = ra02_mgr_parse_config(argv[3], &cfg);
+
+    if (err != E_OK) {
+      log_error("%s: %s", argv[3], error2str(err));
+      return 1;
+    }
+
+    uint64_t stats_ns = (uint64_t) (argc > 4 ? atoi(argv[4]) : 10) * 1000000000ULL;
+    uint64_t report_ns = timeout_now_ns() + stats_ns;
+
+    err = ra02_mgr_init(&mgr, &cfg);
+    err = err == E_OK ? ra02_mgr_start(&mgr) : err;
+
+    signal(SIGINT, __mgr_signal_handler);
+    signal(SIGTERM, __mgr_signal_handler);
+
+    /* Unbuffered, so that poll sees every line, that wasn't read yet */
+    setvbuf(stdin, NULL, _IONBF, 0);
+
+    struct pollfd input = {.fd = fileno(stdin), .events = POLLIN};
+    char line[4 * RA02_MAX_PACKET_SIZE + 16];
+
+    while (err == E_OK && mgr.running) {
+      ra02_mgr_packet_t packet;
+
+      if (ra02_mgr_recv(&mgr, &packet, 100) == E_OK) {
+        log_printf("radio %d rssi %d snr %d ", packet.radio, packet.rssi, packet.snr);
+        __print_packet(packet.data, packet.size);
+      }
+
+      if (input.fd >= 0 && poll(&input, 1, 0) > 0) {
+        if (fgets(line, sizeof(line), stdin)) {
+          __mgr_send_line(line);
+        } else {
+          input.fd = -1;
+        }
+      }
+
+      if (stats_ns && timeout_now_ns() >= report_ns) {
+        __mgr_report();
+        report_ns += stats_ns;
+      }
+    }
+
+    if (err == E_OK) {
+      __mgr_report();
+    } else {
+      log_error("multi: %s", error2str(err));
+    }
+
+    ra02_mgr_deinit(&mgr);
+
     return err == E_OK ? 0 : 1;
   } else {
     log_error("Unknown argument '%s'", argv[2]);
@@ -17,6 +17,10 @@
 #include <string.h>
 #include <unistd.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <pthread.h>
+#include <sys/eventfd.h>
 
 /* Defines ================================================================== */
 #define LOG_TAG RA02
@@ -34,11 +38,15 @@
 
 /** Internal constants */
 #define RA02_MAX_PA           20
+#define RA02_LORA_RSSI_OFFSET 164               /* LoRa RSSI register offset for LF port, dBm */
+#define RA02_FXOSC_KHZ        32000             /* Crystal oscillator frequency */
+#define RA02_RSSI_BATCH       32                /* RSSI samples read per SPI batch */
 
 /** Default internal ra02 configuration parameters */
 #define RA02_DEFAULT_CRC_RATE RA02_CRC_RATE_4_7 /* CRC Rate */
 #define RA02_DEFAULT_SF       8                 /* Spreading Factor */
 #define RA02_DEFAULT_OCP_MA   120               /* OverCurrentProtection is mA */
+#define RA02_DEFAULT_LNA      0x23              /* LNA: max gain, HF boost on */
 
 /** Initial ra02 configuration parameters */
 #define RA02_INIT_FREQ        433000            /* Initial frequency */
@@ -46,8 +54,72 @@
 #define RA02_INIT_BANDWIDTH   125000            /* Initial bandwidth */
 #define RA02_INIT_PREAMBLE    10                /* Initial preamble size */
 
+/** RX symbol timeout range (10 bits, datasheet recommends at least 4) */
+#define RA02_MIN_SYMB_TIMEOUT     4
+#define RA02_MAX_SYMB_TIMEOUT     0x3FF
+
+/** Channel activity detection duration in symbols */
+#define RA02_CAD_SYMBOLS          2
+
+/** Extra preamble symbols for wake-on-radio, so that receiver can lock after CAD */
+#define RA02_WOR_PREAMBLE_MARGIN  8
+
+/** Preamble symbols, that must be left after CAD for receiver to lock */
+#define RA02_SCAN_LOCK_SYMBOLS    4
+
+/** Host overhead in us of single scan step (SF switch, DIO mapping, CAD start) */
+#define RA02_SCAN_SWITCH_US       200
+
+/** Initial ra02 FSK configuration parameters */
+#define RA02_FSK_INIT_BITRATE   50000           /* Initial bitrate */
+#define RA02_FSK_INIT_FDEV      25000           /* Initial frequency deviation */
+#define RA02_FSK_INIT_BANDWIDTH 83300           /* Initial RX bandwidth */
+#define RA02_FSK_INIT_PREAMBLE  5               /* Initial preamble size in bytes */
+#define RA02_FSK_INIT_SYNC_WORD 0x2DD4          /* Initial sync word */
+#define RA02_FSK_INIT_SYNC_SIZE 2               /* Initial sync word size */
+
+/** FSK limits */
+#define RA02_FSK_MIN_BITRATE  1200
+#define RA02_FSK_MAX_BITRATE  300000
+#define RA02_FSK_MAX_FDEV     200000
+#define RA02_FSK_FIFO_SIZE    64
+#define RA02_FSK_STREAM_MARGIN 4                /* Extra FIFO headroom in bytes for streaming */
+
 /* Macros =================================================================== */
+/**
+ * Own the handle until the end of scope, waiting while other thread owns it
+ */
+#define RA02_OWN(__ra02) \
+    ra02_t * __ra02_owned __attribute__((cleanup(ra02_release))) = ra02_acquire(__ra02, false)
+
+/**
+ * Own the handle until the end of scope, or if other thread owns it, queue
+ * the setting to be applied at the next safe point and return
+ */
+#define RA02_OWN_OR_DEFER(__ra02, __bit, __field, __value)                                   \
+    ra02_t * __ra02_owned __attribute__((cleanup(ra02_release))) = ra02_acquire(__ra02, true); \
+    if (!__ra02_owned && (__ra02)->sync) {                                                     \
+      (__ra02)->sync->pending.__field = (__value);                                             \
+      (__ra02)->sync->pending.mask |= (__bit);                                                 \
+      pthread_mutex_unlock(&(__ra02)->sync->lock);                                             \
+      log_debug("%s: deferred", __func__);                                                     \
+      return E_OK;                                                                             \
+    }
+
 /* Enums ==================================================================== */
+/**
+ * Settings, that can be queued while other thread owns the handle
+ */
+typedef enum {
+  RA02_PENDING_FREQ      = (1 << 0),
+  RA02_PENDING_POWER     = (1 << 1),
+  RA02_PENDING_SYNC_WORD = (1 << 2),
+  RA02_PENDING_BANDWIDTH = (1 << 3),
+  RA02_PENDING_SF        = (1 << 4),
+  RA02_PENDING_PREAMBLE  = (1 << 5),
+  RA02_PENDING_FRAME     = (1 << 6),
+} ra02_pending_bit_t;
+
 /**
  * RA-02 OpModes
  */
@@ -57,18 +129,9 @@ typedef enum {
   RA02_OP_MODE_TX            = 3,
   RA02_OP_MODE_RX_CONTINUOUS = 5,
   RA02_OP_MODE_RX_SINGLE     = 6,
+  RA02_OP_MODE_CAD           = 7,
 } ra02_op_mode_t;
 
-/**
- * RA-02 CRC Rate values
- */
-typedef enum {
-  RA02_CRC_RATE_4_5 = 1,
-  RA02_CRC_RATE_4_6 = 2,
-  RA02_CRC_RATE_4_7 = 3,
-  RA02_CRC_RATE_4_8 = 4,
-} ra02_crc_rate_t;
-
 /**
  * RA-02 Power conversion table
  */
@@ -96,6 +159,33 @@ typedef enum {
 } ra02_bandwidth_t;
 
 /* Types ==================================================================== */
+/**
+ * Settings queued while other thread owned the handle
+ */
+typedef struct {
+  uint32_t         mask;      /* ra02_pending_bit_t */
+  uint32_t         khz;
+  uint8_t          power;
+  uint32_t         sync_word;
+  uint32_t         bandwidth;
+  uint8_t          sf;
+  uint32_t         preamble;
+  ra02_frame_cfg_t frame;
+} ra02_pending_t;
+
+/**
+ * Synchronization of concurrent callers
+ */
+struct ra02_sync_s {
+  pthread_mutex_t lock;       /* Guards ownership & pending settings, never held over SPI transfers */
+  pthread_cond_t  released;
+  pthread_t       owner;
+  uint32_t        depth;      /* Nesting of calls made by owner, 0 - not owned */
+  ra02_pending_t  pending;
+  int             cancel;     /* Set by ra02_cancel, accessed atomically */
+  int             cancel_fd;  /* eventfd, that wakes DIO waits, -1 if no DIO is connected */
+};
+
 /* Variables ================================================================ */
 /**
  * RA-02 Power mapping table
@@ -129,7 +219,148 @@ static util_map_range_table_entry_t ra02_bandwidth_mapping_hz[] = {
     {.from = 0, .to = 0, .value = 0}
 };
 
+/**
+ * RA-02 Bandwidth values in Hz, indexed by ra02_bandwidth_t
+ */
+static const uint32_t ra02_bandwidth_hz[] = {
+    7800, 10400, 15600, 20800, 31250, 41700, 62500, 125000, 250000, 500000,
+};
+
 /* Private functions ======================================================== */
+/**
+ * Take ownership of the handle, nested calls of the owner just count depth
+ *
+ * @param defer Don't wait if other thread owns the handle, return NULL with lock held instead
+ *
+ * @return Handle to release at the end of scope, NULL if there is nothing to release
+ */
+static ra02_t * ra02_acquire(ra02_t * ra02, bool defer) {
+  struct ra02_sync_s * sync = ra02->sync;
+
+  if (!sync) {
+    return NULL;
+  }
+
+  pthread_mutex_lock(&sync->lock);
+
+  while (sync->depth && !pthread_equal(sync->owner, pthread_self())) {
+    if (defer) {
+      return NULL;
+    }
+
+    pthread_cond_wait(&sync->released, &sync->lock);
+  }
+
+  sync->owner = pthread_self();
+  sync->depth++;
+
+  pthread_mutex_unlock(&sync->lock);
+
+  return ra02;
+}
+
+/**
+ * Apply settings queued while other thread owned the handle, called by the owner at safe points
+ */
+static error_t ra02_apply_pending(ra02_t * ra02) {
+  struct ra02_sync_s * sync = ra02->sync;
+  error_t err = E_OK;
+
+  if (!sync) {
+    return E_OK;
+  }
+
+  pthread_mutex_lock(&sync->lock);
+  ra02_pending_t pending = sync->pending;
+  sync->pending.mask = 0;
+  pthread_mutex_unlock(&sync->lock);
+
+  if (pending.mask & RA02_PENDING_FREQ) {
+    err = ra02_set_freq(ra02, pending.khz);
+  }
+
+  if ((pending.mask & RA02_PENDING_POWER) && err == E_OK) {
+    err = ra02_set_power(ra02, pending.power);
+  }
+
+  if ((pending.mask & RA02_PENDING_SYNC_WORD) && err == E_OK) {
+    err = ra02_set_sync_word(ra02, pending.sync_word);
+  }
+
+  if ((pending.mask & RA02_PENDING_BANDWIDTH) && err == E_OK) {
+    err = ra02_set_bandwidth(ra02, pending.bandwidth);
+  }
+
+  if ((pending.mask & RA02_PENDING_SF) && err == E_OK) {
+    err = ra02_set_sf(ra02, pending.sf);
+  }
+
+  if ((pending.mask & RA02_PENDING_PREAMBLE) && err == E_OK) {
+    err = ra02_set_preamble(ra02, pending.preamble);
+  }
+
+  if ((pending.mask & RA02_PENDING_FRAME) && err == E_OK) {
+    err = ra02_set_frame_cfg(ra02, &pending.frame);
+  }
+
+  if (err != E_OK) {
+    log_error("ra02: deferred settings 0x%02x failed: %s", pending.mask, error2str(err));
+  }
+
+  return err;
+}
+
+/**
+ * Leave the call, outermost one applies settings queued meanwhile before giving up ownership
+ */
+static void ra02_release(ra02_t ** owned) {
+  ra02_t * ra02 = *owned;
+
+  if (!ra02) {
+    return;
+  }
+
+  struct ra02_sync_s * sync = ra02->sync;
+
+  pthread_mutex_lock(&sync->lock);
+
+  while (sync->depth == 1 && sync->pending.mask) {
+    pthread_mutex_unlock(&sync->lock);
+    ra02_apply_pending(ra02);
+    pthread_mutex_lock(&sync->lock);
+  }
+
+  if (!--sync->depth) {
+    pthread_cond_broadcast(&sync->released);
+  }
+
+  pthread_mutex_unlock(&sync->lock);
+}
+
+/**
+ * Check and consume cancellation request
+ */
+static bool ra02_cancelled(ra02_t * ra02) {
+  struct ra02_sync_s * sync = ra02->sync;
+
+  if (!sync) {
+    return false;
+  }
+
+  bool cancelled = __atomic_exchange_n(&sync->cancel, 0, __ATOMIC_ACQ_REL);
+
+  if (cancelled && sync->cancel_fd >= 0) {
+    uint64_t value;
+    UTIL_UNUSED(read(sync->cancel_fd, &value, sizeof(value)));
+  }
+
+  if (cancelled) {
+    log_debug("ra02: cancelled");
+  }
+
+  return cancelled;
+}
+
 /**
  * Write value to register using SPI bus
  */
@@ -168,11 +399,35 @@ static error_t ra02_read_reg(ra02_t * ra02, uint8_t reg, uint8_t * value) {
   return err;
 }
 
+/**
+ * Read buffer from register using SPI bus
+ */
+static error_t ra02_read_burst(ra02_t * ra02, uint8_t addr, uint8_t * buf, size_t size) {
+  uint8_t tx_buffer[RA02_MAX_PACKET_SIZE + 1] = {addr & 0x7F};
+  uint8_t rx_buffer[RA02_MAX_PACKET_SIZE + 1] = {0};
+
+  ASSERT_RETURN(size <= RA02_MAX_PACKET_SIZE, E_OVERFLOW);
+
+  ERROR_CHECK_RETURN(spi_transcieve(ra02->spi, tx_buffer, rx_buffer, size + 1));
+  memcpy(buf, &rx_buffer[1], size);
+
+  return E_OK;
+}
+
+/**
+ * Read-modify-write of masked bits in register
+ */
+static error_t ra02_update_reg(ra02_t * ra02, uint8_t reg, uint8_t mask, uint8_t value) {
+  uint8_t data;
+  ERROR_CHECK_RETURN(ra02_read_reg(ra02, reg, &data));
+  return ra02_write_reg(ra02, reg, (data & ~mask) | (value & mask));
+}
+
 /**
  * Write buffer to register using SPI bus
  */
 static error_t ra02_write_burst(ra02_t * ra02, uint8_t addr, uint8_t * buf, size_t size) {
-  uint8_t buffer[64] = {addr | 0x80};
+  uint8_t buffer[RA02_MAX_PACKET_SIZE + 1] = {addr | 0x80};
   memcpy(&buffer[1], buf, size);
 
   return spi_transcieve(ra02->spi, buffer, NULL, size + 1);
@@ -188,20 +443,18 @@ static error_t ra02_goto_op_mode(ra02_t * ra02, ra02_op_mode_t mode) {
     mode == RA02_OP_MODE_TX ? "TX" :
     mode == RA02_OP_MODE_RX_SINGLE ? "RX_S" :
     mode == RA02_OP_MODE_RX_CONTINUOUS ? "RX_C" :
+    mode == RA02_OP_MODE_CAD ? "CAD" :
     "?"
   );
 
-  return ra02_write_reg(ra02, RA02_REG_OP_MODE, RA02_OP_MODE_LORA_PREFIX | mode);
+  return ra02_write_reg(ra02, RA02_REG_OP_MODE, mode |
+      (ra02->modem == RA02_MODEM_LORA ? RA02_OP_MODE_LORA_PREFIX : RA02_OP_MODE_FSK_PREFIX));
 }
 
 /**
- * Set OverCurrent protection
- *
- * @param[in] current Current threshold in mA
+ * Calculate RegOcp value (protection on) for current threshold in mA
  */
-static error_t ra02_set_ocp(ra02_t * ra02, uint8_t current) {
-  log_debug("ra02_set_ocp: %d", current);
-
+static uint8_t ra02_ocp_reg(uint8_t current) {
   current = UTIL_CAP(current, 45, 240);
 
   if (current <= 120) {
@@ -210,7 +463,18 @@ static error_t ra02_set_ocp(ra02_t * ra02, uint8_t current) {
     current = (current - 30) / 10;
   }
 
-  return ra02_write_reg(ra02, RA02_REG_OCP, current + (1 << 5));
+  return current + (1 << 5);
+}
+
+/**
+ * Set OverCurrent protection
+ *
+ * @param[in] current Current threshold in mA
+ */
+static error_t ra02_set_ocp(ra02_t * ra02, uint8_t current) {
+  log_debug("ra02_set_ocp: %d", current);
+
+  return ra02_write_reg(ra02, RA02_REG_OCP, ra02_ocp_reg(current));
 }
 
 /**
@@ -219,10 +483,8 @@ static error_t ra02_set_ocp(ra02_t * ra02, uint8_t current) {
 static error_t ra02_set_crc(ra02_t * ra02, bool on) {
   log_debug("ra02_set_crc: %d", on);
 
-  uint8_t data;
-  ERROR_CHECK_RETURN(ra02_read_reg(ra02, RA02_LORA_REG_MODEM_CFG_2, &data));
-  // TODO: define modem cfg configuration values
-  return ra02_write_reg(ra02, RA02_LORA_REG_MODEM_CFG_2, (on << 2) | data);
+  return ra02_update_reg(ra02, RA02_LORA_REG_MODEM_CFG_2, RA02_LORA_MODEM_CFG_2_RX_CRC_ON,
+                         on ? RA02_LORA_MODEM_CFG_2_RX_CRC_ON : 0);
 }
 
 /**
@@ -231,9 +493,32 @@ static error_t ra02_set_crc(ra02_t * ra02, bool on) {
 static error_t ra02_set_implicit_header_mode(ra02_t * ra02, bool on) {
   log_debug("ra02_set_implicit_header_mode: %d", on);
 
-  uint8_t data;
-  ERROR_CHECK_RETURN(ra02_read_reg(ra02, RA02_LORA_REG_MODEM_CFG_1, &data));
-  return ra02_write_reg(ra02, RA02_LORA_REG_MODEM_CFG_1, on ? (data | 1) : (data & ~(1)));
+  return ra02_update_reg(ra02, RA02_LORA_REG_MODEM_CFG_1, RA02_LORA_MODEM_CFG_1_IMPLICIT_HDR,
+                         on ? RA02_LORA_MODEM_CFG_1_IMPLICIT_HDR : 0);
+}
+
+/**
+ * Set coding rate
+ */
+static error_t ra02_set_crc_rate(ra02_t * ra02, ra02_crc_rate_t crc_rate) {
+  log_debug("ra02_set_crc_rate: 4/%d", crc_rate + 4);
+
+  return ra02_update_reg(ra02, RA02_LORA_REG_MODEM_CFG_1, RA02_LORA_MODEM_CFG_1_CR_MASK,
+                         RA02_LORA_MODEM_CFG_1_CR(crc_rate));
+}
+
+/**
+ * Set LowDataRateOptimize according to current symbol duration
+ */
+static error_t ra02_update_ldro(ra02_t * ra02) {
+  if (!ra02->bandwidth) {
+    return E_OK;
+  }
+
+  uint64_t symbol_us = ((uint64_t) 1000000 << ra02->sf) / ra02->bandwidth;
+
+  return ra02_update_reg(ra02, RA02_LORA_REG_MODEL_CFG_3, RA02_LORA_MODEM_CFG_3_LDRO,
+                         symbol_us > RA02_LDRO_SYMBOL_US ? RA02_LORA_MODEM_CFG_3_LDRO : 0);
 }
 
 /**
@@ -242,210 +527,495 @@ static error_t ra02_set_implicit_header_mode(ra02_t * ra02, bool on) {
 static error_t ra02_set_rx_symbol_timeout(ra02_t * ra02, uint16_t value) {
   log_debug("ra02_set_rx_symbol_timeout: %d", value);
 
-  uint8_t data;
-  ERROR_CHECK_RETURN(ra02_read_reg(ra02, RA02_LORA_REG_MODEM_CFG_2, &data));
-  ERROR_CHECK_RETURN(ra02_write_reg(ra02, RA02_LORA_REG_MODEM_CFG_2, data | ((value >> 8) & 0x3)));
-  return ra02_write_reg(ra02, RA02_LORA_REG_SYMB_TIMEOUT_LSB, value & 0xFF); /* Set timeout to max */
+  ERROR_CHECK_RETURN(ra02_update_reg(ra02, RA02_LORA_REG_MODEM_CFG_2,
+                                     RA02_LORA_MODEM_CFG_2_SYMB_TIMEOUT_MASK, value >> 8));
+  return ra02_write_reg(ra02, RA02_LORA_REG_SYMB_TIMEOUT_LSB, value & 0xFF);
 }
 
-/* Shared functions ========================================================= */
-error_t ra02_init(ra02_t * ra02, ra02_cfg_t * cfg) {
-  ASSERT_RETURN(ra02 && cfg && cfg->spi, E_NULL);
-
-  ra02->spi         = cfg->spi;
-  // ra02->reset       = cfg->ra02->reset;
-  ra02->irq_flags   = 0;
-
-  ra02_reset(ra02);
+/**
+ * Set FSK receiver channel filter bandwidth (closest not lower than requested)
+ */
+static error_t ra02_fsk_set_rx_bandwidth(ra02_t * ra02, uint32_t bandwidth) {
+  /* RxBwMant: 0b00 - 16, 0b01 - 20, 0b10 - 24 */
+  static const uint8_t mantissas[] = {24, 20, 16};
+
+  uint8_t reg = RA02_FSK_RX_BW_MANT(0) | RA02_FSK_RX_BW_EXP(1);
+  uint32_t actual = RA02_FXOSC / (16 << 3);
+
+  /* Walk from narrowest to widest filter */
+  for (int exp = 7; exp >= 1; --exp) {
+    for (size_t i = 0; i < UTIL_ARR_SIZE(mantissas); ++i) {
+      uint32_t bw = RA02_FXOSC / (mantissas[i] << (exp + 2));
+      if (bw >= bandwidth) {
+        reg = RA02_FSK_RX_BW_MANT(2 - i) | RA02_FSK_RX_BW_EXP(exp);
+        actual = bw;
+        goto found;
+      }
+    }
+  }
 
-  uint8_t version;
-  ERROR_CHECK_RETURN(ra02_read_reg(ra02, RA02_REG_VERSION, &version));
+found:
+  log_debug("ra02_fsk_set_rx_bandwidth: %d (%d) Hz", bandwidth, actual);
 
-  log_debug("ra02_init: version=0x%02x", version);
+  ERROR_CHECK_RETURN(ra02_write_reg(ra02, RA02_REG_RX_BW, reg));
+  ERROR_CHECK_RETURN(ra02_write_reg(ra02, RA02_REG_AFC_BW, reg));
 
-  ASSERT_RETURN(version == RA02_HW_VERSION, E_NORESP);
+  ra02->bandwidth = actual;
 
-  ERROR_CHECK_RETURN(ra02_write_reg(ra02, RA02_REG_OP_MODE, RA02_OP_MODE_SLEEP));
+  return E_OK;
+}
 
-  /** Configure ra02 */
-  ERROR_CHECK_RETURN(ra02_goto_op_mode(ra02, RA02_OP_MODE_SLEEP)); /* Transition RA02 to LoRa mode */
-  ERROR_CHECK_RETURN(ra02_set_freq(ra02, RA02_INIT_FREQ)); /* Set init frequency */
-  ERROR_CHECK_RETURN(ra02_set_power(ra02, RA02_INIT_POWER)); /* Set init output power */
-  ERROR_CHECK_RETURN(ra02_set_ocp(ra02, RA02_DEFAULT_OCP_MA)); /* Set OverCurrentProtection */
-  ERROR_CHECK_RETURN(ra02_write_reg(ra02, RA02_REG_LNA, 0x23)); /* Set LNA */
+/**
+ * Configure LoRa modem with defaults
+ */
+static error_t ra02_lora_init(ra02_t * ra02) {
   ERROR_CHECK_RETURN(ra02_write_reg(ra02, RA02_LORA_REG_MODEM_CFG_2, 0)); /* Reset Modem Cfg 2 */
-  ERROR_CHECK_RETURN(ra02_set_implicit_header_mode(ra02, false)); /* Set implicit header mode */
-  ERROR_CHECK_RETURN(ra02_set_rx_symbol_timeout(ra02, 0x2FF)); /* Set RX Symbol Timeout */
+  ERROR_CHECK_RETURN(ra02_set_frame_cfg(ra02, &(ra02_frame_cfg_t){
+    .implicit_header = false,
+    .crc_rate = RA02_DEFAULT_CRC_RATE,
+  })); /* Set explicit header frame format */
+  ERROR_CHECK_RETURN(ra02_set_rx_symbol_timeout(ra02, RA02_DEFAULT_SYMB_TIMEOUT)); /* Set RX Symbol Timeout */
   ERROR_CHECK_RETURN(ra02_set_sf(ra02, RA02_DEFAULT_SF)); /* Set Spreading Factor */
   ERROR_CHECK_RETURN(ra02_set_bandwidth(ra02, RA02_INIT_BANDWIDTH)); /* Set init bandwidth */
   ERROR_CHECK_RETURN(ra02_set_preamble(ra02, RA02_INIT_PREAMBLE)); /* Set init preamble */
 
-  return ra02_goto_op_mode(ra02, RA02_OP_MODE_STANDBY);
-}
-
-error_t ra02_deinit(ra02_t * ra02) {
-  ASSERT_RETURN(ra02, E_NULL);
-
-  log_debug("ra02_deinit");
-
   return E_OK;
 }
 
-error_t ra02_reset(ra02_t * ra02) {
-  ASSERT_RETURN(ra02, E_NULL);
-
-  log_debug("ra02_reset");
+/**
+ * Configure FSK modem with defaults (packet mode, variable length packets)
+ */
+static error_t ra02_fsk_init(ra02_t * ra02) {
+  ERROR_CHECK_RETURN(ra02_write_reg(ra02, RA02_REG_RX_CFG,
+      RA02_FSK_RX_CFG_AFC_AUTO | RA02_FSK_RX_CFG_AGC_AUTO | RA02_FSK_RX_CFG_TRIGGER_PREAMBLE));
+  ERROR_CHECK_RETURN(ra02_write_reg(ra02, RA02_REG_PREAMBLE_DETECT,
+      RA02_FSK_PREAMBLE_DETECT_ON | RA02_FSK_PREAMBLE_DETECT_SIZE(2) | RA02_FSK_PREAMBLE_DETECT_TOL(10)));
+  ERROR_CHECK_RETURN(ra02_write_reg(ra02, RA02_REG_PACKET_CFG_2, RA02_FSK_PACKET_CFG_2_PACKET_MODE));
+  ERROR_CHECK_RETURN(ra02_write_reg(ra02, RA02_REG_PAYLOAD_LEN, RA02_FSK_MAX_PACKET_SIZE)); /* Max RX length */
+  ERROR_CHECK_RETURN(ra02_write_reg(ra02, RA02_REG_FIFO_THRESH,
+      RA02_FSK_FIFO_THRESH_TX_START_NOT_EMPTY | RA02_FSK_FIFO_THRESH_LEVEL(RA02_FSK_FIFO_SIZE / 4)));
+  ERROR_CHECK_RETURN(ra02_set_baudrate(ra02, RA02_FSK_INIT_BITRATE)); /* Set init bitrate */
+  ERROR_CHECK_RETURN(ra02_set_fdev(ra02, RA02_FSK_INIT_FDEV)); /* Set init frequency deviation */
+  ERROR_CHECK_RETURN(ra02_set_bandwidth(ra02, RA02_FSK_INIT_BANDWIDTH)); /* Set init RX bandwidth */
+  ERROR_CHECK_RETURN(ra02_set_preamble(ra02, RA02_FSK_INIT_PREAMBLE)); /* Set init preamble */
+  ERROR_CHECK_RETURN(ra02_set_fsk_packet_cfg(ra02, &(ra02_fsk_packet_cfg_t){
+    .sync_word = RA02_FSK_INIT_SYNC_WORD,
+    .sync_size = RA02_FSK_INIT_SYNC_SIZE,
+    .whitening = true,
+    .crc = true,
+  })); /* Set init packet format */
 
-  // TODO: Fix reset
-  // gpio_clear(ra02->reset);
-  // sleep_ms(10);
-  // gpio_set(ra02->reset);
-  // sleep_ms(5);
   return E_OK;
 }
 
-error_t ra02_sleep(ra02_t * ra02) {
-  ASSERT_RETURN(ra02, E_NULL);
+/**
+ * Read & clear IRQ flags into ra02->irq_flags, used by polling loops of the owner
+ */
+static error_t ra02_read_irq_flags(ra02_t * ra02) {
+  uint8_t flags[2] = {0};
 
-  log_debug("ra02_sleep");
+  if (ra02->modem == RA02_MODEM_FSK) {
+    /* RegIrqFlags1 & RegIrqFlags2 are adjacent, mostly status flags, only overrun needs clearing */
+    ERROR_CHECK_RETURN(ra02_read_burst(ra02, RA02_REG_IRQ_FLAGS_1, flags, sizeof(flags)));
 
-  return ra02_goto_op_mode(ra02, RA02_OP_MODE_SLEEP);
-}
+    if (flags[1] & RA02_IRQ_FLAGS_2_OVERRUN) {
+      ERROR_CHECK_RETURN(ra02_write_reg(ra02, RA02_REG_IRQ_FLAGS_2, RA02_IRQ_FLAGS_2_OVERRUN));
+    }
 
-error_t ra02_set_freq(ra02_t * ra02, uint32_t khz) {
-  ASSERT_RETURN(ra02, E_NULL);
+    ra02->irq_flags = (flags[0] << 8) | flags[1];
 
-  log_debug("ra02_set_freq: %d kHz", khz);
+    return E_OK;
+  }
+
+  ra02_read_reg(ra02, RA02_LORA_REG_IRQ_FLAGS, &flags[0]);
+  ra02_write_reg(ra02, RA02_LORA_REG_IRQ_FLAGS, flags[0]);
 
-  uint32_t freq = ((khz/1000) * 524288) >> 5;
+  ra02->irq_flags = flags[0];
 
-  ERROR_CHECK_RETURN(ra02_write_reg(ra02, RA02_REG_FRF_MSB, freq >> 16));
-  usleep(5000);
-  ERROR_CHECK_RETURN(ra02_write_reg(ra02, RA02_REG_FRF_MID, freq >> 8));
-  usleep(5000);
-  ERROR_CHECK_RETURN(ra02_write_reg(ra02, RA02_REG_FRF_LSB, freq));
-  usleep(5000);
+  // log_debug("IRQ: 0x%02x", ra02->irq_flags);
 
   return E_OK;
 }
 
-error_t ra02_get_power(ra02_t * ra02, uint8_t * db) {
-  ASSERT_RETURN(ra02 && db, E_NULL);
-
-  ERROR_CHECK_RETURN(ra02_read_reg(ra02, RA02_REG_PA_CFG, db));
+/**
+ * Discard stale edge events on DIO lines, so that they aren't mistaken for
+ * events of the operation that is about to start
+ */
+static void ra02_drain_dio(ra02_t * ra02) {
+  gpio_t * dios[] = {ra02->dio0, ra02->dio1};
 
-  UTIL_MAP_RANGE_TABLE_REV(ra02_power_mapping_db, *db, *db);
+  for (size_t i = 0; i < UTIL_ARR_SIZE(dios); ++i) {
+    while (dios[i] && gpio_wait_edge(dios[i], 0, NULL) == E_OK) {}
+  }
+}
 
-  return E_OK;
+/**
+ * Wait for edge on DIO line, if it's connected, otherwise return immediately,
+ * so that caller falls back to polling IRQ flags over SPI. Wakes up early on
+ * ra02_cancel, cancellation itself is checked by the caller
+ */
+static void ra02_wait_dio(ra02_t * ra02, gpio_t * dio, uint32_t timeout_us) {
+  if (dio) {
+    gpio_wait_edge_any_fd(&dio, 1, ra02->sync ? ra02->sync->cancel_fd : -1, timeout_us, NULL, NULL);
+  }
 }
 
-error_t ra02_set_power(ra02_t * ra02, uint8_t db) {
-  ASSERT_RETURN(ra02, E_NULL);
+/**
+ * Prepare FSK modem for transmission (standby, DIO mapping, FIFO), so that
+ * only switch to TX mode is left
+ */
+static error_t ra02_fsk_tx_prepare(ra02_t * ra02, uint8_t * buf, size_t size) {
+  ASSERT_RETURN(size <= RA02_FSK_MAX_PACKET_SIZE, E_OVERFLOW);
 
-  if (db < 0 || db > RA02_MAX_PA) {
-    return E_INVAL;
-  }
+  uint8_t fifo[RA02_FSK_FIFO_SIZE] = {size};
 
-  log_debug("ra02_set_power: %d db", db);
+  memcpy(&fifo[1], buf, size);
 
-  UTIL_MAP_RANGE_TABLE(ra02_power_mapping_db, db, db);
-  ERROR_CHECK_RETURN(ra02_write_reg(ra02, RA02_REG_PA_CFG, db));
-  usleep(10000);
-  return E_OK;
-}
+  ra02->irq_flags = 0;
 
-error_t ra02_set_sync_word(ra02_t * ra02, uint32_t sync_word) {
-  ASSERT_RETURN(ra02, E_NULL);
+  ERROR_CHECK_RETURN(ra02_goto_op_mode(ra02, RA02_OP_MODE_STANDBY));
 
-  log_debug("ra02_set_sync_word: %x", sync_word);
+  ERROR_CHECK_RETURN(ra02_write_reg(ra02, RA02_REG_DIO_MAP_1,
+                                    RA02_FSK_MAP_DIO_0(RA02_FSK_DIO_0_PACKET_SENT)));
+  ra02_drain_dio(ra02);
 
-  ERROR_CHECK_RETURN(ra02_write_reg(ra02, RA02_LORA_REG_SYNC_WORD, sync_word));
-  usleep(10000);
-  return E_OK;
+  /* Length byte goes first in variable length packet format */
+  return ra02_write_burst(ra02, RA02_REG_FIFO, fifo, size + 1);
 }
 
-error_t ra02_set_baudrate(ra02_t * ra02, uint32_t baudrate) {
-  ASSERT_RETURN(ra02, E_NULL);
+/**
+ * Send data over radio using FSK modem
+ */
+static error_t ra02_fsk_send(ra02_t * ra02, uint8_t * buf, size_t size) {
+  error_t err = E_OK;
+  uint32_t airtime_us = 0;
 
-  log_debug("ra02_set_baudrate: %d", baudrate);
+  ERROR_CHECK_RETURN(ra02_fsk_tx_prepare(ra02, buf, size));
 
-  return E_NOTIMPL;
-}
+  /* Low bitrates may take longer than IRQ timeout alone */
+  ra02_get_time_on_air(ra02, size, &airtime_us);
 
-error_t ra02_set_bandwidth(ra02_t * ra02, uint32_t bandwidth) {
-  ASSERT_RETURN(ra02, E_NULL);
+  ERROR_CHECK_RETURN(ra02_goto_op_mode(ra02, RA02_OP_MODE_TX));
 
-  log_debug("ra02_set_bandwidth: %d", bandwidth);
+  TIMEOUT_CREATE(t, airtime_us / 1000 + RA02_SEND_IRQ_TIMEOUT);
 
-  UTIL_MAP_RANGE_TABLE(ra02_bandwidth_mapping_hz, bandwidth, bandwidth);
+  while (1) {
+    if (timeout_is_expired(&t)) {
+      err = E_TIMEOUT;
+      break;
+    }
 
-  uint8_t data;
-  ra02_read_reg(ra02, RA02_LORA_REG_MODEM_CFG_1, &data);
+    ra02_wait_dio(ra02, ra02->dio0, RA02_FSK_STREAM_LATENCY_US);
 
-  data = (bandwidth << 4) | (RA02_DEFAULT_CRC_RATE << 1) | data;
-  return ra02_write_reg(ra02, RA02_LORA_REG_MODEM_CFG_1, data);
-}
+    if (ra02_cancelled(ra02)) {
+      err = E_CANCELLED;
+      break;
+    }
 
-error_t ra02_set_preamble(ra02_t * ra02, uint32_t preamble) {
-  ASSERT_RETURN(ra02, E_NULL);
+    ra02_read_irq_flags(ra02);
 
-  log_debug("ra02_set_preamble: %d", preamble);
+    if (ra02->irq_flags & RA02_IRQ_FLAGS_2_PACKET_SENT) {
+      break;
+    }
+  }
 
-  ERROR_CHECK_RETURN(ra02_write_reg(ra02, RA02_LORA_REG_PREAMBLE_MSB, preamble >> 8));
-  ERROR_CHECK_RETURN(ra02_write_reg(ra02, RA02_LORA_REG_PREAMBLE_LSB, preamble));
+  ERROR_CHECK_RETURN(ra02_goto_op_mode(ra02, RA02_OP_MODE_SLEEP));
 
-  return E_OK;
+  return err;
 }
 
-error_t ra02_set_sf(ra02_t * ra02, uint8_t sf) {
-  ASSERT_RETURN(ra02, E_NULL);
+/**
+ * Calculate FIFO threshold for FSK streaming
+ *
+ * TX refills FIFO when it drops to threshold, so threshold is the amount of
+ * bytes that must cover host reaction time. RX mirrors it with free space.
+ */
+static uint8_t ra02_fsk_stream_threshold(ra02_t * ra02) {
+  uint32_t headroom = ((uint64_t) ra02->bitrate * RA02_FSK_STREAM_LATENCY_US) / 8000000
+                      + RA02_FSK_STREAM_MARGIN;
 
-  log_debug("ra02_set_sf: %d", sf);
+  return UTIL_CAP(headroom, RA02_FSK_FIFO_SIZE / 4, RA02_FSK_FIFO_SIZE * 3 / 4);
+}
+
+/**
+ * Switch FSK packet handler to fixed length packets, used for streaming
+ */
+static error_t ra02_fsk_set_fixed_len(ra02_t * ra02, size_t size) {
+  /* Keep payload with bad CRC in FIFO, as part of it was already drained */
+  ERROR_CHECK_RETURN(ra02_update_reg(ra02, RA02_REG_PACKET_CFG_1,
+      RA02_FSK_PACKET_CFG_1_VARIABLE_LEN | RA02_FSK_PACKET_CFG_1_CRC_AUTOCLR_OFF,
+      RA02_FSK_PACKET_CFG_1_CRC_AUTOCLR_OFF));
+  ERROR_CHECK_RETURN(ra02_write_reg(ra02, RA02_REG_PACKET_CFG_2,
+      RA02_FSK_PACKET_CFG_2_PACKET_MODE | RA02_FSK_PACKET_CFG_2_LEN_MSB(size)));
+  return ra02_write_reg(ra02, RA02_REG_PAYLOAD_LEN, size & 0xFF);
+}
+
+/**
+ * Restore FSK packet handler to variable length packets
+ */
+static error_t ra02_fsk_set_variable_len(ra02_t * ra02) {
+  ERROR_CHECK_RETURN(ra02_write_reg(ra02, RA02_REG_PACKET_CFG_2, RA02_FSK_PACKET_CFG_2_PACKET_MODE));
+  ERROR_CHECK_RETURN(ra02_write_reg(ra02, RA02_REG_PAYLOAD_LEN, RA02_FSK_MAX_PACKET_SIZE));
+  ERROR_CHECK_RETURN(ra02_write_reg(ra02, RA02_REG_FIFO_THRESH,
+      RA02_FSK_FIFO_THRESH_TX_START_NOT_EMPTY | RA02_FSK_FIFO_THRESH_LEVEL(RA02_FSK_FIFO_SIZE / 4)));
+  return ra02_set_fsk_packet_cfg(ra02, &ra02->fsk_packet);
+}
+
+/**
+ * Stream packet, that is longer than FIFO, refilling FIFO at threshold.
+ * Leaves fixed length packets set, caller restores them
+ */
+static error_t ra02_fsk_stream_tx(ra02_t * ra02, uint8_t * buf, size_t size, uint8_t level) {
+  size_t sent = UTIL_MIN(size, RA02_FSK_FIFO_SIZE);
+  uint32_t toa_us = 0;
+  error_t err = E_OK;
+
+  ra02->irq_flags = 0;
+
+  ERROR_CHECK_RETURN(ra02_goto_op_mode(ra02, RA02_OP_MODE_STANDBY));
+
+  ERROR_CHECK_RETURN(ra02_write_reg(ra02, RA02_REG_DIO_MAP_1,
+                                    RA02_FSK_MAP_DIO_0(RA02_FSK_DIO_0_PACKET_SENT)
+                                    | RA02_FSK_MAP_DIO_1(RA02_FSK_DIO_1_FIFO_LEVEL)));
+  ERROR_CHECK_RETURN(ra02_write_reg(ra02, RA02_REG_FIFO_THRESH,
+      RA02_FSK_FIFO_THRESH_TX_START_NOT_EMPTY | RA02_FSK_FIFO_THRESH_LEVEL(level)));
+  ERROR_CHECK_RETURN(ra02_fsk_set_fixed_len(ra02, size));
+
+  /* Fill whole FIFO before starting transmission */
+  ERROR_CHECK_RETURN(ra02_write_burst(ra02, RA02_REG_FIFO, buf, sent));
+  ERROR_CHECK_RETURN(ra02_goto_op_mode(ra02, RA02_OP_MODE_TX));
+
+  ra02_get_time_on_air(ra02, size, &toa_us);
+
+  TIMEOUT_CREATE(t, toa_us / 1000 + RA02_SEND_IRQ_TIMEOUT);
+
+  while (sent < size) {
+    if (timeout_is_expired(&t)) {
+      err = E_TIMEOUT;
+      break;
+    }
+
+    if (ra02_cancelled(ra02)) {
+      err = E_CANCELLED;
+      break;
+    }
+
+    ERROR_CHECK_RETURN(ra02_read_irq_flags(ra02));
+
+    if (ra02->irq_flags & RA02_IRQ_FLAGS_2_FIFO_EMPTY) {
+      /* Modem ran out of data mid-packet, receiver will get garbage */
+      err = E_UNDERFLOW;
+      break;
+    }
+
+    if (ra02->irq_flags & RA02_IRQ_FLAGS_2_LEVEL) {
+      ra02_wait_dio(ra02, ra02->dio1, RA02_FSK_STREAM_LATENCY_US);
+      continue;
+    }
+
+    /* At most 'level' bytes are left in FIFO */
+    size_t chunk = UTIL_MIN(size - sent, (size_t) (RA02_FSK_FIFO_SIZE - level));
+    ERROR_CHECK_RETURN(ra02_write_burst(ra02, RA02_REG_FIFO, buf + sent, chunk));
+    sent += chunk;
+  }
+
+  while (err == E_OK) {
+    if (timeout_is_expired(&t)) {
+      err = E_TIMEOUT;
+      break;
+    }
+
+    if (ra02_cancelled(ra02)) {
+      err = E_CANCELLED;
+      break;
+    }
+
+    ERROR_CHECK_RETURN(ra02_read_irq_flags(ra02));
 
+    if (ra02->irq_flags & RA02_IRQ_FLAGS_2_PACKET_SENT) {
+      break;
+    }
+
+    ra02_wait_dio(ra02, ra02->dio0, RA02_FSK_STREAM_LATENCY_US);
+  }
+
+  return err;
+}
+
+/**
+ * Receive packet, that is longer than FIFO, draining FIFO at threshold.
+ * Leaves fixed length packets set, caller restores them
+ */
+static error_t ra02_fsk_stream_rx(ra02_t * ra02, uint8_t * buf, size_t size, uint8_t level, timeout_t * timeout) {
+  size_t received = 0;
+  error_t err = E_OK;
   uint8_t data;
-  sf = UTIL_CAP(sf, 6, 12);
-  ERROR_CHECK_RETURN(ra02_read_reg(ra02, RA02_LORA_REG_MODEM_CFG_2, &data));
-  // TODO: define modem cfg configuration values
-  return ra02_write_reg(ra02, RA02_LORA_REG_MODEM_CFG_2, (sf << 4) | data);
+
+  ra02->irq_flags = 0;
+
+  ERROR_CHECK_RETURN(ra02_goto_op_mode(ra02, RA02_OP_MODE_STANDBY));
+
+  ERROR_CHECK_RETURN(ra02_write_reg(ra02, RA02_REG_DIO_MAP_1,
+                                    RA02_FSK_MAP_DIO_0(RA02_FSK_DIO_0_PAYLOAD_READY)
+                                    | RA02_FSK_MAP_DIO_1(RA02_FSK_DIO_1_FIFO_LEVEL)));
+  ERROR_CHECK_RETURN(ra02_write_reg(ra02, RA02_REG_FIFO_THRESH, RA02_FSK_FIFO_THRESH_LEVEL(level)));
+  ERROR_CHECK_RETURN(ra02_fsk_set_fixed_len(ra02, size));
+
+  ERROR_CHECK_RETURN(ra02_goto_op_mode(ra02, RA02_OP_MODE_RX_CONTINUOUS));
+
+  while (received < size) {
+    if (timeout_is_expired(timeout)) {
+      err = E_TIMEOUT;
+      break;
+    }
+
+    if (ra02_cancelled(ra02)) {
+      err = E_CANCELLED;
+      break;
+    }
+
+    ERROR_CHECK_RETURN(ra02_read_irq_flags(ra02));
+
+    if (!received && (ra02->irq_flags & (RA02_IRQ_FLAGS_1_SYNC_ADDR_MATCH << 8))) {
+      ERROR_CHECK_RETURN(ra02_read_reg(ra02, RA02_REG_RSSI_VALUE, &data));
+      ra02->last_rssi = -(data / 2);
+    }
+
+    if (ra02->irq_flags & RA02_IRQ_FLAGS_2_OVERRUN) {
+      err = E_OVERFLOW;
+      break;
+    }
+
+    if (ra02->irq_flags & RA02_IRQ_FLAGS_2_PAYLOAD_READY) {
+      /* Whole rest of the packet is in FIFO */
+      while (received < size) {
+        size_t chunk = UTIL_MIN(size - received, (size_t) RA02_FSK_FIFO_SIZE);
+        ERROR_CHECK_RETURN(ra02_read_burst(ra02, RA02_REG_FIFO, buf + received, chunk));
+        received += chunk;
+      }
+
+      if (ra02->fsk_packet.crc && !(ra02->irq_flags & RA02_IRQ_FLAGS_2_CRC_OK)) {
+        err = E_CORRUPT;
+      }
+      break;
+    }
+
+    if (!(ra02->irq_flags & RA02_IRQ_FLAGS_2_LEVEL)) {
+      ra02_wait_dio(ra02, ra02->dio1, RA02_FSK_STREAM_LATENCY_US);
+      continue;
+    }
+
+    /* At least 'level + 1' bytes are in FIFO */
+    size_t chunk = UTIL_MIN(size - received, (size_t) level + 1);
+    ERROR_CHECK_RETURN(ra02_read_burst(ra02, RA02_REG_FIFO, buf + received, chunk));
+    received += chunk;
+  }
+
+  return err;
 }
 
-error_t ra02_get_rssi(ra02_t * ra02, int8_t * rssi) {
-  ASSERT_RETURN(ra02 && rssi, E_NULL);
+/**
+ * Calculate LoRa symbol duration in microseconds for given spreading factor
+ */
+static uint32_t ra02_lora_sf_symbol_us(ra02_t * ra02, uint8_t sf) {
+  return ((uint64_t) 1000000 << sf) / ra02->bandwidth;
+}
 
-  *rssi = ra02->last_rssi;
+/**
+ * Calculate LoRa symbol duration in microseconds
+ */
+static uint32_t ra02_lora_symbol_us(ra02_t * ra02) {
+  return ra02_lora_sf_symbol_us(ra02, ra02->sf);
+}
+
+/**
+ * Prepare FSK modem for reception (standby, DIO mapping), so that only switch
+ * to RX mode is left
+ */
+static error_t ra02_fsk_rx_prepare(ra02_t * ra02) {
+  ra02->irq_flags = 0;
+
+  ERROR_CHECK_RETURN(ra02_goto_op_mode(ra02, RA02_OP_MODE_STANDBY));
+
+  ERROR_CHECK_RETURN(ra02_write_reg(ra02, RA02_REG_DIO_MAP_1,
+                                    RA02_FSK_MAP_DIO_0(RA02_FSK_DIO_0_PAYLOAD_READY)));
+  ra02_drain_dio(ra02);
 
   return E_OK;
 }
 
-error_t ra02_poll_irq_flags(ra02_t * ra02) {
-  ASSERT_RETURN(ra02, E_NULL);
+/**
+ * Handle FSK RX IRQ flags: sample RSSI on sync word match, read packet from
+ * FIFO on PAYLOAD_READY, leaving RA-02 in sleep mode
+ *
+ * @retval E_AGAIN Packet isn't ready yet
+ */
+static error_t ra02_fsk_rx_handle_irq(ra02_t * ra02, uint8_t * buf, size_t * size) {
+  uint8_t data;
+
+  if (ra02->irq_flags & (RA02_IRQ_FLAGS_1_SYNC_ADDR_MATCH << 8)) {
+    ERROR_CHECK_RETURN(ra02_read_reg(ra02, RA02_REG_RSSI_VALUE, &data));
+    ra02->last_rssi = -(data / 2);
+  }
 
-  ra02_read_reg(ra02, RA02_LORA_REG_IRQ_FLAGS, &ra02->irq_flags);
-  ra02_write_reg(ra02, RA02_LORA_REG_IRQ_FLAGS, ra02->irq_flags);
+  if (!(ra02->irq_flags & RA02_IRQ_FLAGS_2_PAYLOAD_READY)) {
+    return E_AGAIN;
+  }
 
-  // log_debug("IRQ: 0x%02x", ra02->irq_flags);
+  ERROR_CHECK_RETURN(ra02_goto_op_mode(ra02, RA02_OP_MODE_STANDBY));
+
+  /* FIFO content is kept in standby, length byte comes first */
+  ERROR_CHECK_RETURN(ra02_read_reg(ra02, RA02_REG_FIFO, &data));
+
+  *size = data > *size ? *size : data;
+
+  ERROR_CHECK_RETURN(ra02_read_burst(ra02, RA02_REG_FIFO, buf, *size));
+
+  /* Sleep also clears the rest of FIFO, if packet was truncated */
+  ERROR_CHECK_RETURN(ra02_goto_op_mode(ra02, RA02_OP_MODE_SLEEP));
+
+  log_debug("ra02_recv: %d bytes (FSK)", *size);
 
   return E_OK;
 }
 
-error_t ra02_send(ra02_t * ra02, uint8_t * buf, size_t size) {
-  ASSERT_RETURN(ra02 && buf, E_NULL);
-  ASSERT_RETURN(size, E_INVAL);
+/**
+ * Receive data over radio using FSK modem
+ */
+static error_t ra02_fsk_recv(ra02_t * ra02, uint8_t * buf, size_t * size, timeout_t * timeout) {
+  ERROR_CHECK_RETURN(ra02_fsk_rx_prepare(ra02));
 
-#if USE_RA02_EXT_LOG_SEND_RECV
-  char payload[256] = {0};
-  size_t ofs = 0;
+  ERROR_CHECK_RETURN(ra02_goto_op_mode(ra02, RA02_OP_MODE_RX_CONTINUOUS));
 
-  for (size_t i = 0; i < size; ++i) {
-    ofs += snprintf(payload + ofs, sizeof(payload) - ofs, "%02x ", buf[i]);
-  }
+  while (1) {
+    if (timeout_is_expired(timeout)) {
+      ERROR_CHECK_RETURN(ra02_goto_op_mode(ra02, RA02_OP_MODE_SLEEP));
+      return E_TIMEOUT;
+    }
 
-  log_debug("ra02_send: [%d]: %s", size, payload);
-#else
-  log_debug("ra02_send: %d bytes", size);
-#endif
+    /* PAYLOAD_READY wakes up right away, sync match (RSSI) is caught on next poll */
+    ra02_wait_dio(ra02, ra02->dio0, RA02_FSK_STREAM_LATENCY_US);
 
-  error_t err = E_OK;
+    if (ra02_cancelled(ra02)) {
+      ERROR_CHECK_RETURN(ra02_goto_op_mode(ra02, RA02_OP_MODE_SLEEP));
+      return E_CANCELLED;
+    }
+
+    ra02_read_irq_flags(ra02);
+
+    error_t err = ra02_fsk_rx_handle_irq(ra02, buf, size);
+
+    if (err != E_AGAIN) {
+      return err;
+    }
+  }
+}
+
+/**
+ * Prepare LoRa modem for transmission (standby, DIO mapping, FIFO), so that
+ * only switch to TX mode is left
+ */
+static error_t ra02_lora_tx_prepare(ra02_t * ra02, uint8_t * buf, size_t size) {
   uint8_t data;
 
   ra02->irq_flags = 0;
@@ -454,15 +1024,26 @@ error_t ra02_send(ra02_t * ra02, uint8_t * buf, size_t size) {
 
   ERROR_CHECK_RETURN(ra02_write_reg(ra02, RA02_REG_DIO_MAP_1,
                                     RA02_LORA_MAP_DIO_0(RA02_LORA_DIO_0_TX_DONE)));
+  ra02_drain_dio(ra02);
 
   ERROR_CHECK_RETURN(ra02_read_reg(ra02, RA02_LORA_REG_FIFO_TX_BASE_ADDR, &data));
   ERROR_CHECK_RETURN(ra02_write_reg(ra02, RA02_LORA_REG_FIFO_ADDR_PTR, data));
   ERROR_CHECK_RETURN(ra02_write_reg(ra02, RA02_LORA_REG_PAYLOAD_LEN, size));
-  ERROR_CHECK_RETURN(ra02_write_burst(ra02, RA02_REG_FIFO, buf, size));
 
-  ERROR_CHECK_RETURN(ra02_goto_op_mode(ra02, RA02_OP_MODE_TX));
+  return ra02_write_burst(ra02, RA02_REG_FIFO, buf, size);
+}
+
+/**
+ * Wait for TX_DONE after LoRa transmission was started, leaves RA-02 in sleep mode
+ */
+static error_t ra02_lora_tx_wait(ra02_t * ra02, size_t size) {
+  error_t err = E_OK;
+  uint32_t airtime_us = 0;
+
+  /* Long preambles (e.g. wake-on-radio) may take longer than IRQ timeout alone */
+  ra02_get_time_on_air(ra02, size, &airtime_us);
 
-  TIMEOUT_CREATE(t, RA02_SEND_IRQ_TIMEOUT);
+  TIMEOUT_CREATE(t, airtime_us / 1000 + RA02_SEND_IRQ_TIMEOUT);
 
   while (1) {
     if (timeout_is_expired(&t)) {
@@ -470,7 +1051,14 @@ error_t ra02_send(ra02_t * ra02, uint8_t * buf, size_t size) {
       break;
     }
 
-    ra02_poll_irq_flags(ra02);
+    ra02_wait_dio(ra02, ra02->dio0, ra02_lora_symbol_us(ra02));
+
+    if (ra02_cancelled(ra02)) {
+      err = E_CANCELLED;
+      break;
+    }
+
+    ra02_read_irq_flags(ra02);
 
     if (ra02->irq_flags & RA02_LORA_IRQ_FLAGS_TX_DONE) {
       break;
@@ -482,66 +1070,1567 @@ error_t ra02_send(ra02_t * ra02, uint8_t * buf, size_t size) {
   return err;
 }
 
-error_t ra02_recv(ra02_t * ra02, uint8_t * buf, size_t * size, timeout_t * timeout) {
-  ASSERT_RETURN(ra02 && buf && size && timeout, E_NULL);
-  ASSERT_RETURN(*size, E_INVAL);
+/**
+ * Prepare LoRa modem for reception (standby, payload length, DIO mapping)
+ */
+static error_t ra02_lora_rx_prepare(ra02_t * ra02) {
+  ERROR_CHECK_RETURN(ra02_goto_op_mode(ra02, RA02_OP_MODE_STANDBY));
 
-  log_debug("ra02_recv: %d ticks", timeout->duration);
+  if (ra02->frame.implicit_header) {
+    /* Payload length may have been overwritten by ra02_send */
+    ERROR_CHECK_RETURN(ra02_write_reg(ra02, RA02_LORA_REG_PAYLOAD_LEN, ra02->frame.payload_len));
+  }
 
-  uint8_t data;
+  ERROR_CHECK_RETURN(ra02_write_reg(ra02, RA02_REG_DIO_MAP_1,
+                                    RA02_LORA_MAP_DIO_0(RA02_LORA_DIO_0_RX_DONE)
+                                    | RA02_LORA_MAP_DIO_1(RA02_LORA_DIO_1_RX_TIMEOUT)));
+  ra02_drain_dio(ra02);
 
-  ra02->irq_flags = 0;
+  return E_OK;
+}
+
+/**
+ * Read received LoRa packet from FIFO after RX_DONE, leaves RA-02 in sleep mode
+ */
+static error_t ra02_lora_read_packet(ra02_t * ra02, uint8_t * buf, size_t * size) {
+  uint8_t data;
 
   ERROR_CHECK_RETURN(ra02_goto_op_mode(ra02, RA02_OP_MODE_STANDBY));
 
-  ERROR_CHECK_RETURN(ra02_write_reg(ra02, RA02_REG_DIO_MAP_1,
-                                    RA02_LORA_MAP_DIO_0(RA02_LORA_DIO_0_RX_DONE)));
+  /* Read received size */
+  ERROR_CHECK_RETURN(ra02_read_reg(ra02, RA02_LORA_REG_RX_NB_BYTES, &data));
 
-  ERROR_CHECK_RETURN(ra02_goto_op_mode(ra02, RA02_OP_MODE_RX_SINGLE));
+  if ((ra02->irq_flags & RA02_LORA_IRQ_FLAGS_PAYLOAD_CRC_ERR)
+      || (ra02->frame.implicit_header && data != ra02->frame.payload_len)) {
+    log_debug("ra02_recv: corrupt frame (irq=0x%02x len=%d)", ra02->irq_flags, data);
+    ERROR_CHECK_RETURN(ra02_goto_op_mode(ra02, RA02_OP_MODE_SLEEP));
+    return E_CORRUPT;
+  }
 
-  while (1) {
-    if (timeout && timeout_is_expired(timeout)) {
-      ERROR_CHECK_RETURN(ra02_goto_op_mode(ra02, RA02_OP_MODE_SLEEP));
-      return E_TIMEOUT;
-    }
+  *size = data > *size ? *size : data;
 
-    ra02_poll_irq_flags(ra02);
+  /* SNR is signed, in 0.25 dB steps */
+  ERROR_CHECK_RETURN(ra02_read_reg(ra02, RA02_LORA_REG_LAST_PKT_SNR, &data));
+  ra02->last_snr = (int8_t) data / 4;
 
-    if (ra02->irq_flags & RA02_LORA_IRQ_FLAGS_VALID_HDR) {
-        ra02_read_reg(ra02, RA02_LORA_REG_RSSI_VAL, &ra02->last_rssi);
-    }
+  /* Packet RSSI is averaged over the whole packet, below noise floor it's corrected by SNR */
+  ERROR_CHECK_RETURN(ra02_read_reg(ra02, RA02_LORA_REG_LAST_PKT_RSSI_VAL, &data));
+  ra02->last_rssi = UTIL_MAX(data - RA02_LORA_RSSI_OFFSET + UTIL_MIN(ra02->last_snr, 0), INT8_MIN);
 
-    if (ra02->irq_flags & RA02_LORA_IRQ_FLAGS_RX_DONE) {
-      ERROR_CHECK_RETURN(ra02_goto_op_mode(ra02, RA02_OP_MODE_STANDBY));
+  ERROR_CHECK_RETURN(ra02_read_reg(ra02, RA02_LORA_REG_FIFO_RX_CURRENT_ADDR, &data));
+  ERROR_CHECK_RETURN(ra02_write_reg(ra02, RA02_LORA_REG_FIFO_ADDR_PTR, data));
 
-      /* Read received size */
-      ERROR_CHECK_RETURN(ra02_read_reg(ra02, RA02_LORA_REG_RX_NB_BYTES, &data));
+  for (size_t i = 0; i < *size; ++i) {
+    ERROR_CHECK_RETURN(ra02_read_reg(ra02, RA02_REG_FIFO, &buf[i]));
+  }
 
-      *size = data > *size ? *size : data;
+  ERROR_CHECK_RETURN(ra02_goto_op_mode(ra02, RA02_OP_MODE_SLEEP));
 
-      ERROR_CHECK_RETURN(ra02_read_reg(ra02, RA02_LORA_REG_FIFO_RX_CURRENT_ADDR, &data));
-      ERROR_CHECK_RETURN(ra02_write_reg(ra02, RA02_LORA_REG_FIFO_ADDR_PTR, data));
+#if USE_RA02_EXT_LOG_SEND_RECV
+  char payload[256] = {0};
+  size_t ofs = 0;
 
-      for (size_t i = 0; i < *size; ++i) {
-        ERROR_CHECK_RETURN(ra02_read_reg(ra02, RA02_REG_FIFO, &buf[i]));
-      }
+  for (size_t i = 0; i < *size; ++i) {
+    ofs += snprintf(payload + ofs, sizeof(payload) - ofs, "%02x ", buf[i]);
+  }
 
-      ERROR_CHECK_RETURN(ra02_goto_op_mode(ra02, RA02_OP_MODE_SLEEP));
+  log_debug("ra02_recv: [%d]: %s", *size, payload);
+#else
+  log_debug("ra02_recv: %d bytes", *size);
+#endif
 
-#if USE_RA02_EXT_LOG_SEND_RECV
-      char payload[256] = {0};
-      size_t ofs = 0;
+  return E_OK;
+}
+
+/**
+ * Record RX_DONE time & RSSI after LoRa RX IRQ flags were read
+ *
+ * @param edge_ns Time of DIO0 edge, that came with RX_DONE, 0 - no edge
+ */
+static error_t ra02_lora_rx_update(ra02_t * ra02, uint64_t edge_ns) {
+  if (ra02->irq_flags & RA02_LORA_IRQ_FLAGS_RX_DONE) {
+    /* DIO0 edge timestamp is taken by kernel, otherwise it's as good as polling interval */
+    ra02->last_rx_ns = edge_ns ? edge_ns : timeout_now_ns();
+  }
+
+  /* There is no header in implicit mode, so sample RSSI at RX_DONE instead */
+  if (ra02->irq_flags & (ra02->frame.implicit_header
+                           ? RA02_LORA_IRQ_FLAGS_RX_DONE : RA02_LORA_IRQ_FLAGS_VALID_HDR)) {
+    uint8_t data;
+    ERROR_CHECK_RETURN(ra02_read_reg(ra02, RA02_LORA_REG_RSSI_VAL, &data));
+    ra02->last_rssi = UTIL_MAX(data - RA02_LORA_RSSI_OFFSET, INT8_MIN);
+  }
+
+  return E_OK;
+}
+
+/**
+ * Wait until single LoRa reception ends with RX_DONE or RX_TIMEOUT (symbol
+ * timeout), or host timeout expires. Sleeps on DIO0/DIO1 edges when they are
+ * connected. Result is left in ra02->irq_flags. Frame, whose preamble was
+ * already detected, is not cut by host timeout, so callers can receive
+ * continuously in short slices without losing frames on slice boundary.
+ * On ra02_cancel returns E_CANCELLED, leaving RA-02 in sleep mode
+ */
+static error_t ra02_lora_wait_rx(ra02_t * ra02, timeout_t * timeout) {
+  gpio_t * dios[] = {ra02->dio0, ra02->dio1};
+
+  while (!(ra02->irq_flags & (RA02_LORA_IRQ_FLAGS_RX_DONE | RA02_LORA_IRQ_FLAGS_RX_TIMEOUT))) {
+    if (timeout_is_expired(timeout) && !(ra02->irq_flags & RA02_LORA_IRQ_FLAGS_VALID_HDR)) {
+      uint8_t stat;
+      ERROR_CHECK_RETURN(ra02_read_reg(ra02, RA02_LORA_REG_MODEM_STAT, &stat));
 
-      for (size_t i = 0; i < *size; ++i) {
-        ofs += snprintf(payload + ofs, sizeof(payload) - ofs, "%02x ", buf[i]);
+      if (!(stat & RA02_LORA_MODEM_STAT_DETECTED)) {
+        return E_OK;
       }
+    }
 
-      log_debug("ra02_recv: [%d]: %s", *size, payload);
-#else
-      log_debug("ra02_recv: %d bytes", *size);
-#endif
+    size_t dio = UTIL_ARR_SIZE(dios);
+    uint64_t edge_ns = 0;
 
-      return E_OK;
+    if (ra02->dio0 || ra02->dio1) {
+      gpio_wait_edge_any_fd(dios, UTIL_ARR_SIZE(dios), ra02->sync ? ra02->sync->cancel_fd : -1,
+                            ra02_lora_symbol_us(ra02), &dio, &edge_ns);
+    }
+
+    if (ra02_cancelled(ra02)) {
+      ERROR_CHECK_RETURN(ra02_goto_op_mode(ra02, RA02_OP_MODE_SLEEP));
+      return E_CANCELLED;
+    }
+
+    ERROR_CHECK_RETURN(ra02_read_irq_flags(ra02));
+
+    /* Edge may have come after wait timed out, but before flags were read */
+    if ((ra02->irq_flags & RA02_LORA_IRQ_FLAGS_RX_DONE)
+        && dio != 0 && ra02->dio0 && gpio_wait_edge(ra02->dio0, 0, &edge_ns) == E_OK) {
+      dio = 0;
     }
+
+    ERROR_CHECK_RETURN(ra02_lora_rx_update(ra02, dio == 0 ? edge_ns : 0));
   }
+
+  return E_OK;
+}
+
+/**
+ * Check whether DIO lines, that signal events of current split-phase
+ * operation, are connected, so that caller can wait for their edges
+ */
+static bool ra02_async_has_dio(ra02_t * ra02) {
+  if (!ra02->dio0) {
+    return false;
+  }
+
+  /* LoRa single reception also ends with RX_TIMEOUT on DIO1, then it's restarted */
+  return ra02->async.state == RA02_STATE_TX || ra02->modem == RA02_MODEM_FSK || ra02->dio1;
+}
+
+/**
+ * Calculate time of next split-phase step: operation timeout, if DIO lines
+ * wake the caller, otherwise next IRQ poll (LoRa symbol or FSK byte later)
+ */
+static uint64_t ra02_async_wake_ns(ra02_t * ra02) {
+  if (ra02_async_has_dio(ra02)) {
+    return ra02->async.deadline_ns;
+  }
+
+  uint64_t poll_us = ra02->modem == RA02_MODEM_FSK
+                   ? 8000000 / UTIL_MAX(ra02->bitrate, 1)
+                   : ra02_lora_symbol_us(ra02);
+
+  return UTIL_MIN(ra02->async.deadline_ns, timeout_now_ns() + poll_us * 1000);
+}
+
+/**
+ * Advance split-phase operation by reading IRQ flags once, RA-02 is left in
+ * sleep mode when operation completes
+ *
+ * @retval E_AGAIN Operation is in progress
+ */
+static error_t ra02_async_step(ra02_t * ra02) {
+  ra02_async_t * op = &ra02->async;
+  uint64_t edge_ns = 0;
+  uint64_t ns;
+
+  if (ra02_cancelled(ra02)) {
+    ERROR_CHECK_RETURN(ra02_goto_op_mode(ra02, RA02_OP_MODE_SLEEP));
+    return E_CANCELLED;
+  }
+
+  /* Consume edges, so that DIO fds don't stay readable, first DIO0 edge is the RX_DONE time */
+  while (ra02->dio0 && gpio_wait_edge(ra02->dio0, 0, &ns) == E_OK) {
+    edge_ns = edge_ns ? edge_ns : ns;
+  }
+
+  while (ra02->dio1 && gpio_wait_edge(ra02->dio1, 0, NULL) == E_OK) {}
+
+  ERROR_CHECK_RETURN(ra02_read_irq_flags(ra02));
+
+  bool expired = timeout_now_ns() >= op->deadline_ns;
+
+  if (op->state == RA02_STATE_TX) {
+    if (ra02->irq_flags & (ra02->modem == RA02_MODEM_FSK
+                             ? RA02_IRQ_FLAGS_2_PACKET_SENT : RA02_LORA_IRQ_FLAGS_TX_DONE)) {
+      ERROR_CHECK_RETURN(ra02_goto_op_mode(ra02, RA02_OP_MODE_SLEEP));
+      return E_OK;
+    }
+  } else if (ra02->modem == RA02_MODEM_FSK) {
+    error_t err = ra02_fsk_rx_handle_irq(ra02, op->buf, op->size);
+
+    if (err == E_OK) {
+      ra02->last_rx_ns = edge_ns ? edge_ns : timeout_now_ns();
+    }
+
+    if (err != E_AGAIN) {
+      return err;
+    }
+  } else {
+    ERROR_CHECK_RETURN(ra02_lora_rx_update(ra02, edge_ns));
+
+    if (ra02->irq_flags & RA02_LORA_IRQ_FLAGS_RX_DONE) {
+      return ra02_lora_read_packet(ra02, op->buf, op->size);
+    }
+
+    /* Symbol timeout expired without preamble and modem went to standby, so restart reception */
+    if ((ra02->irq_flags & RA02_LORA_IRQ_FLAGS_RX_TIMEOUT) && !expired) {
+      ERROR_CHECK_RETURN(ra02_goto_op_mode(ra02, RA02_OP_MODE_RX_SINGLE));
+      return E_AGAIN;
+    }
+
+    /* As in ra02_recv, frame, whose preamble was already detected, is not cut by timeout */
+    if (expired && !(ra02->irq_flags & (RA02_LORA_IRQ_FLAGS_RX_TIMEOUT | RA02_LORA_IRQ_FLAGS_VALID_HDR))) {
+      uint8_t stat;
+      ERROR_CHECK_RETURN(ra02_read_reg(ra02, RA02_LORA_REG_MODEM_STAT, &stat));
+      expired = !(stat & RA02_LORA_MODEM_STAT_DETECTED);
+    } else if (ra02->irq_flags & RA02_LORA_IRQ_FLAGS_VALID_HDR) {
+      expired = false;
+    }
+  }
+
+  if (expired) {
+    ERROR_CHECK_RETURN(ra02_goto_op_mode(ra02, RA02_OP_MODE_SLEEP));
+    return E_TIMEOUT;
+  }
+
+  return E_AGAIN;
+}
+
+/**
+ * Calculate preamble length in symbols, that spans whole wake-on-radio period
+ */
+static uint32_t ra02_wor_preamble_symbols(ra02_t * ra02, uint32_t period_ms) {
+  uint32_t symbol_us = ra02_lora_symbol_us(ra02);
+  uint32_t symbols = ((uint64_t) period_ms * 1000 + symbol_us - 1) / symbol_us
+                     + RA02_CAD_SYMBOLS + RA02_WOR_PREAMBLE_MARGIN;
+
+  return UTIL_MIN(symbols, UINT16_MAX);
+}
+
+/**
+ * Run wake-on-radio CAD cycles with WOR preamble & symbol timeout already set,
+ * returns on first received packet, timeout or error
+ */
+static error_t ra02_wor_listen(
+  ra02_t * ra02,
+  uint32_t period_ms,
+  uint8_t * buf,
+  size_t * size,
+  timeout_t * timeout,
+  ra02_wor_stats_t * stats
+) {
+  while (!timeout_is_expired(timeout)) {
+    uint64_t cycle_start = timeout_now_us();
+    bool detected = false;
+
+    ERROR_CHECK_RETURN(ra02_cad(ra02, &detected));
+    stats->cad_runs++;
+
+    if (detected) {
+      uint64_t detected_at = timeout_now_us();
+      size_t rx_size = *size;
+
+      stats->cad_detected++;
+
+      ra02->irq_flags = 0;
+
+      ERROR_CHECK_RETURN(ra02_lora_rx_prepare(ra02));
+      ERROR_CHECK_RETURN(ra02_goto_op_mode(ra02, RA02_OP_MODE_RX_SINGLE));
+      ERROR_CHECK_RETURN(ra02_lora_wait_rx(ra02, timeout));
+
+      if (ra02->irq_flags & RA02_LORA_IRQ_FLAGS_RX_DONE) {
+        error_t err = ra02_lora_read_packet(ra02, buf, &rx_size);
+
+        if (err == E_OK) {
+          stats->rx_ok++;
+          stats->last_latency_us = timeout_now_us() - detected_at;
+          stats->latency_us += stats->last_latency_us;
+          *size = rx_size;
+          return E_OK;
+        }
+      }
+
+      stats->rx_missed++;
+    }
+
+    ERROR_CHECK_RETURN(ra02_goto_op_mode(ra02, RA02_OP_MODE_SLEEP));
+
+    uint64_t elapsed_us = timeout_now_us() - cycle_start;
+
+    if (elapsed_us < period_ms * 1000ULL) {
+      timeout_sleep_us(period_ms * 1000ULL - elapsed_us);
+    }
+  }
+
+  return E_TIMEOUT;
+}
+
+/**
+ * Leave RA-02 in sleep mode with default RX symbol timeout and given preamble
+ * length after special receive modes. Every step is attempted even if one
+ * fails, first error is returned
+ */
+static error_t ra02_lora_rx_restore(ra02_t * ra02, uint16_t preamble) {
+  error_t err = ra02_goto_op_mode(ra02, RA02_OP_MODE_SLEEP);
+  error_t symb_err = ra02_set_rx_symbol_timeout(ra02, RA02_DEFAULT_SYMB_TIMEOUT);
+  error_t preamble_err = ra02_set_preamble(ra02, preamble);
+
+  return err != E_OK ? err : symb_err != E_OK ? symb_err : preamble_err;
+}
+
+/**
+ * Calculate duration of one scan cycle over all SFs in mask
+ */
+static uint32_t ra02_scan_cycle_us(ra02_t * ra02, uint16_t sf_mask, uint32_t switch_us) {
+  uint32_t us = 0;
+
+  for (uint8_t sf = RA02_SCAN_SF_MIN; sf <= RA02_SCAN_SF_MAX; ++sf) {
+    if (sf_mask & RA02_SF_BIT(sf)) {
+      us += RA02_CAD_SYMBOLS * ra02_lora_sf_symbol_us(ra02, sf) + switch_us;
+    }
+  }
+
+  return us;
+}
+
+/**
+ * Switch SF with minimal SPI traffic, using cached MODEM_CFG_2 and MODEM_CFG_3
+ */
+static error_t ra02_lora_switch_sf(ra02_t * ra02, uint8_t sf, uint8_t cfg_2, uint8_t cfg_3) {
+  ra02->sf = sf;
+
+  ERROR_CHECK_RETURN(ra02_write_reg(ra02, RA02_LORA_REG_MODEM_CFG_2,
+                                    (cfg_2 & ~RA02_LORA_MODEM_CFG_2_SF_MASK) | RA02_LORA_MODEM_CFG_2_SF(sf)));
+
+  return ra02_write_reg(ra02, RA02_LORA_REG_MODEL_CFG_3,
+                        (cfg_3 & ~RA02_LORA_MODEM_CFG_3_LDRO)
+                        | (ra02_lora_sf_symbol_us(ra02, sf) > RA02_LDRO_SYMBOL_US ? RA02_LORA_MODEM_CFG_3_LDRO : 0));
+}
+
+/**
+ * Cycle CAD over SFs of the mask with scan symbol timeout already set, until
+ * packet is received on one of them, timeout or error. Leaves SF switched
+ */
+static error_t ra02_scan_listen(
+  ra02_t * ra02,
+  uint16_t sf_mask,
+  uint8_t cfg_2,
+  uint8_t cfg_3,
+  uint8_t * buf,
+  size_t * size,
+  uint8_t * sf,
+  timeout_t * timeout,
+  ra02_scan_stats_t * stats
+) {
+  error_t err = E_TIMEOUT;
+
+  while (err == E_TIMEOUT && !timeout_is_expired(timeout)) {
+    for (uint8_t cur = RA02_SCAN_SF_MIN; cur <= RA02_SCAN_SF_MAX && err == E_TIMEOUT; ++cur) {
+      if (!(sf_mask & RA02_SF_BIT(cur))) {
+        continue;
+      }
+
+      uint8_t idx = cur - RA02_SCAN_SF_MIN;
+      bool detected = false;
+
+      ERROR_CHECK_RETURN(ra02_lora_switch_sf(ra02, cur, cfg_2, cfg_3));
+      ERROR_CHECK_RETURN(ra02_cad(ra02, &detected));
+      stats->cad_runs[idx]++;
+
+      if (!detected) {
+        continue;
+      }
+
+      stats->cad_detected[idx]++;
+
+      size_t rx_size = *size;
+
+      ra02->irq_flags = 0;
+
+      ERROR_CHECK_RETURN(ra02_lora_rx_prepare(ra02));
+      ERROR_CHECK_RETURN(ra02_goto_op_mode(ra02, RA02_OP_MODE_RX_SINGLE));
+      ERROR_CHECK_RETURN(ra02_lora_wait_rx(ra02, timeout));
+
+      if ((ra02->irq_flags & RA02_LORA_IRQ_FLAGS_RX_DONE)
+          && ra02_lora_read_packet(ra02, buf, &rx_size) == E_OK) {
+        stats->rx_ok[idx]++;
+        *size = rx_size;
+        *sf = cur;
+        err = E_OK;
+      } else {
+        stats->rx_missed[idx]++;
+        ERROR_CHECK_RETURN(ra02_goto_op_mode(ra02, RA02_OP_MODE_STANDBY));
+      }
+    }
+  }
+
+  return err;
+}
+
+/**
+ * Set up handle & synchronization state, first part of init
+ */
+static error_t ra02_init_handle(ra02_t * ra02, ra02_cfg_t * cfg) {
+  ra02->spi         = cfg->spi;
+  ra02->dio0        = cfg->dio0;
+  ra02->dio1        = cfg->dio1;
+  // ra02->reset       = cfg->ra02->reset;
+  ra02->irq_flags   = 0;
+  ra02->sf          = 0;
+  ra02->bandwidth   = 0;
+  ra02->preamble    = 0;
+  ra02->modem       = RA02_MODEM_LORA;
+  ra02->bitrate     = 0;
+  ra02->fdev        = 0;
+  ra02->last_rx_ns  = 0;
+  ra02->last_tx_ns  = 0;
+  ra02->last_snr    = 0;
+  ra02->async       = (ra02_async_t) {.state = RA02_STATE_IDLE};
+  ra02->sync        = calloc(1, sizeof(*ra02->sync));
+
+  ASSERT_RETURN(ra02->sync, E_NOMEM);
+
+  pthread_mutex_init(&ra02->sync->lock, NULL);
+  pthread_cond_init(&ra02->sync->released, NULL);
+
+  /* Without DIOs waits are polling loops, that check cancellation flag anyway */
+  ra02->sync->cancel_fd = ra02->dio0 || ra02->dio1 ? eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC) : -1;
+
+  return E_OK;
+}
+
+/**
+ * Reset RA-02 and check that it responds, second part of init
+ */
+static error_t ra02_probe(ra02_t * ra02) {
+  ra02_reset(ra02);
+
+  uint8_t version;
+  ERROR_CHECK_RETURN(ra02_read_reg(ra02, RA02_REG_VERSION, &version));
+
+  log_debug("ra02_init: version=0x%02x", version);
+
+  ASSERT_RETURN(version == RA02_HW_VERSION, E_NORESP);
+
+  return E_OK;
+}
+
+/**
+ * Configure RA-02 with defaults, last part of ra02_init
+ */
+static error_t ra02_init_defaults(ra02_t * ra02) {
+  RA02_OWN(ra02);
+
+  ERROR_CHECK_RETURN(ra02_probe(ra02));
+
+  ERROR_CHECK_RETURN(ra02_write_reg(ra02, RA02_REG_OP_MODE, RA02_OP_MODE_SLEEP));
+
+  /** Configure ra02 */
+  ERROR_CHECK_RETURN(ra02_goto_op_mode(ra02, RA02_OP_MODE_SLEEP)); /* Transition RA02 to LoRa mode */
+  ERROR_CHECK_RETURN(ra02_set_freq(ra02, RA02_INIT_FREQ)); /* Set init frequency */
+  ERROR_CHECK_RETURN(ra02_set_power(ra02, RA02_INIT_POWER)); /* Set init output power */
+  ERROR_CHECK_RETURN(ra02_set_ocp(ra02, RA02_DEFAULT_OCP_MA)); /* Set OverCurrentProtection */
+  ERROR_CHECK_RETURN(ra02_write_reg(ra02, RA02_REG_LNA, RA02_DEFAULT_LNA)); /* Set LNA */
+  ERROR_CHECK_RETURN(ra02_lora_init(ra02)); /* Configure LoRa modem */
+
+  return ra02_goto_op_mode(ra02, RA02_OP_MODE_STANDBY);
+}
+
+/**
+ * Configure RA-02 from register image, last part of ra02_init_image
+ */
+static error_t ra02_init_from_image(ra02_t * ra02, const ra02_lora_image_t * image) {
+  RA02_OWN(ra02);
+
+  ERROR_CHECK_RETURN(ra02_probe(ra02));
+
+  /* Address with write bit, then data. LongRangeMode bit can be changed only in sleep mode */
+  uint8_t sleep[]   = {RA02_REG_OP_MODE | 0x80, RA02_OP_MODE_SLEEP};
+  uint8_t lora[]    = {RA02_REG_OP_MODE | 0x80, RA02_OP_MODE_SLEEP | RA02_OP_MODE_LORA_PREFIX};
+  uint8_t rf[]      = {RA02_REG_FRF_MSB | 0x80, image->rf[0], image->rf[1], image->rf[2], image->rf[3]};
+  uint8_t ocp_lna[] = {RA02_REG_OCP | 0x80, ra02_ocp_reg(RA02_DEFAULT_OCP_MA), RA02_DEFAULT_LNA};
+  uint8_t modem[]   = {RA02_LORA_REG_MODEM_CFG_1 | 0x80,
+                       image->modem[0], image->modem[1], image->modem[2], image->modem[3], image->modem[4],
+                       image->frame.payload_len};
+  uint8_t cfg_3[]   = {RA02_LORA_REG_MODEL_CFG_3 | 0x80, image->modem_cfg_3};
+  uint8_t sync[]    = {RA02_LORA_REG_SYNC_WORD | 0x80, image->sync_word};
+  uint8_t standby[] = {RA02_REG_OP_MODE | 0x80, RA02_OP_MODE_STANDBY | RA02_OP_MODE_LORA_PREFIX};
+
+  spi_xfer_t xfers[] = {
+    {.tx_buf = sleep,   .size = sizeof(sleep)},
+    {.tx_buf = lora,    .size = sizeof(lora)},
+    {.tx_buf = rf,      .size = sizeof(rf)},
+    {.tx_buf = ocp_lna, .size = sizeof(ocp_lna)},
+    /* Payload length only matters in implicit header mode, ra02_send sets it otherwise */
+    {.tx_buf = modem,   .size = sizeof(modem) - !image->frame.implicit_header},
+    {.tx_buf = cfg_3,   .size = sizeof(cfg_3)},
+    {.tx_buf = sync,    .size = sizeof(sync)},
+    {.tx_buf = standby, .size = sizeof(standby)},
+  };
+
+  log_debug("ra02_init_image: sf=%d bw=%d preamble=%d", image->sf, image->bandwidth, image->preamble);
+
+  ERROR_CHECK_RETURN(spi_transcieve_batch(ra02->spi, xfers, UTIL_ARR_SIZE(xfers)));
+
+  ra02->sf        = image->sf;
+  ra02->bandwidth = image->bandwidth;
+  ra02->preamble  = image->preamble;
+  ra02->frame     = image->frame;
+
+  return E_OK;
+}
+
+/* Shared functions ========================================================= */
+error_t ra02_init(ra02_t * ra02, ra02_cfg_t * cfg) {
+  ASSERT_RETURN(ra02 && cfg && cfg->spi, E_NULL);
+
+  ERROR_CHECK_RETURN(ra02_init_handle(ra02, cfg));
+
+  error_t err = ra02_init_defaults(ra02);
+
+  if (err != E_OK) {
+    ra02_deinit(ra02);
+  }
+
+  return err;
+}
+
+error_t ra02_init_image(ra02_t * ra02, ra02_cfg_t * cfg, const ra02_lora_image_t * image) {
+  ASSERT_RETURN(ra02 && cfg && cfg->spi && image, E_NULL);
+  ASSERT_RETURN(!image->frame.implicit_header || image->frame.payload_len, E_INVAL);
+
+  ERROR_CHECK_RETURN(ra02_init_handle(ra02, cfg));
+
+  error_t err = ra02_init_from_image(ra02, image);
+
+  if (err != E_OK) {
+    ra02_deinit(ra02);
+  }
+
+  return err;
+}
+
+error_t ra02_deinit(ra02_t * ra02) {
+  ASSERT_RETURN(ra02, E_NULL);
+
+  log_debug("ra02_deinit");
+
+  if (ra02->sync) {
+    if (ra02->sync->cancel_fd >= 0) {
+      close(ra02->sync->cancel_fd);
+    }
+
+    pthread_cond_destroy(&ra02->sync->released);
+    pthread_mutex_destroy(&ra02->sync->lock);
+    free(ra02->sync);
+    ra02->sync = NULL;
+  }
+
+  return E_OK;
+}
+
+error_t ra02_reset(ra02_t * ra02) {
+  ASSERT_RETURN(ra02, E_NULL);
+
+  RA02_OWN(ra02);
+
+  log_debug("ra02_reset");
+
+  // TODO: Fix reset
+  // gpio_clear(ra02->reset);
+  // sleep_ms(10);
+  // gpio_set(ra02->reset);
+  // sleep_ms(5);
+  return E_OK;
+}
+
+error_t ra02_sleep(ra02_t * ra02) {
+  ASSERT_RETURN(ra02, E_NULL);
+
+  RA02_OWN(ra02);
+
+  log_debug("ra02_sleep");
+
+  return ra02_goto_op_mode(ra02, RA02_OP_MODE_SLEEP);
+}
+
+error_t ra02_set_modem(ra02_t * ra02, ra02_modem_t modem) {
+  ASSERT_RETURN(ra02, E_NULL);
+  ASSERT_RETURN(modem == RA02_MODEM_LORA || modem == RA02_MODEM_FSK, E_INVAL);
+
+  RA02_OWN(ra02);
+
+  log_debug("ra02_set_modem: %s", modem == RA02_MODEM_LORA ? "LoRa" : "FSK");
+
+  /* LongRangeMode bit can be changed only in sleep mode */
+  ERROR_CHECK_RETURN(ra02_goto_op_mode(ra02, RA02_OP_MODE_SLEEP));
+
+  ra02->modem = modem;
+
+  ERROR_CHECK_RETURN(ra02_goto_op_mode(ra02, RA02_OP_MODE_SLEEP));
+  ERROR_CHECK_RETURN(modem == RA02_MODEM_LORA ? ra02_lora_init(ra02) : ra02_fsk_init(ra02));
+
+  return ra02_goto_op_mode(ra02, RA02_OP_MODE_STANDBY);
+}
+
+error_t ra02_set_freq(ra02_t * ra02, uint32_t khz) {
+  ASSERT_RETURN(ra02, E_NULL);
+
+  RA02_OWN_OR_DEFER(ra02, RA02_PENDING_FREQ, khz, khz);
+
+  log_debug("ra02_set_freq: %d kHz", khz);
+
+  /* Frf = f * 2^19 / Fxosc, new frequency is applied when LSB is written, so single burst is enough */
+  uint32_t frf = (((uint64_t) khz << 19) + RA02_FXOSC_KHZ / 2) / RA02_FXOSC_KHZ;
+  uint8_t data[3] = {frf >> 16, frf >> 8, frf};
+
+  return ra02_write_burst(ra02, RA02_REG_FRF_MSB, data, sizeof(data));
+}
+
+error_t ra02_get_power(ra02_t * ra02, uint8_t * db) {
+  ASSERT_RETURN(ra02 && db, E_NULL);
+
+  RA02_OWN(ra02);
+
+  ERROR_CHECK_RETURN(ra02_read_reg(ra02, RA02_REG_PA_CFG, db));
+
+  UTIL_MAP_RANGE_TABLE_REV(ra02_power_mapping_db, *db, *db);
+
+  return E_OK;
+}
+
+error_t ra02_set_power(ra02_t * ra02, uint8_t db) {
+  ASSERT_RETURN(ra02, E_NULL);
+
+  if (db < 0 || db > RA02_MAX_PA) {
+    return E_INVAL;
+  }
+
+  RA02_OWN_OR_DEFER(ra02, RA02_PENDING_POWER, power, db);
+
+  log_debug("ra02_set_power: %d db", db);
+
+  UTIL_MAP_RANGE_TABLE(ra02_power_mapping_db, db, db);
+  ERROR_CHECK_RETURN(ra02_write_reg(ra02, RA02_REG_PA_CFG, db));
+  timeout_sleep_us(10000);
+  return E_OK;
+}
+
+error_t ra02_set_sync_word(ra02_t * ra02, uint32_t sync_word) {
+  ASSERT_RETURN(ra02, E_NULL);
+  ASSERT_RETURN(ra02->modem == RA02_MODEM_FSK || sync_word <= UINT8_MAX, E_INVAL);
+
+  RA02_OWN_OR_DEFER(ra02, RA02_PENDING_SYNC_WORD, sync_word, sync_word);
+
+  log_debug("ra02_set_sync_word: %x", sync_word);
+
+  if (ra02->modem == RA02_MODEM_FSK) {
+    ra02_fsk_packet_cfg_t cfg = ra02->fsk_packet;
+    cfg.sync_word = sync_word;
+    return ra02_set_fsk_packet_cfg(ra02, &cfg);
+  }
+
+  ERROR_CHECK_RETURN(ra02_write_reg(ra02, RA02_LORA_REG_SYNC_WORD, sync_word));
+  timeout_sleep_us(10000);
+  return E_OK;
+}
+
+error_t ra02_set_invert_iq(ra02_t * ra02, bool on) {
+  ASSERT_RETURN(ra02, E_NULL);
+  ASSERT_RETURN(ra02->modem == RA02_MODEM_LORA, E_INVAL);
+
+  RA02_OWN(ra02);
+
+  log_debug("ra02_set_invert_iq: %d", on);
+
+  ERROR_CHECK_RETURN(ra02_update_reg(ra02, RA02_LORA_REG_INVERT_IQ,
+      RA02_LORA_INVERT_IQ_RX | RA02_LORA_INVERT_IQ_TX,
+      on ? RA02_LORA_INVERT_IQ_RX | RA02_LORA_INVERT_IQ_TX : 0));
+
+  return ra02_write_reg(ra02, RA02_LORA_REG_INVERT_IQ_2, on ? RA02_LORA_INVERT_IQ_2_ON : RA02_LORA_INVERT_IQ_2_OFF);
+}
+
+error_t ra02_set_baudrate(ra02_t * ra02, uint32_t baudrate) {
+  ASSERT_RETURN(ra02, E_NULL);
+
+  RA02_OWN(ra02);
+
+  log_debug("ra02_set_baudrate: %d", baudrate);
+
+  /* LoRa data rate is defined by SF, bandwidth & coding rate */
+  ASSERT_RETURN(ra02->modem == RA02_MODEM_FSK, E_NOTIMPL);
+  ASSERT_RETURN(baudrate >= RA02_FSK_MIN_BITRATE && baudrate <= RA02_FSK_MAX_BITRATE, E_INVAL);
+
+  /* BitRate = FXOSC / (BitRate(15:0) + BitRateFrac / 16) */
+  uint32_t value = (RA02_FXOSC * 16ULL) / baudrate;
+
+  ERROR_CHECK_RETURN(ra02_write_reg(ra02, RA02_REG_BITRATE_MSB, value >> 12));
+  ERROR_CHECK_RETURN(ra02_write_reg(ra02, RA02_REG_BITRATE_LSB, value >> 4));
+  ERROR_CHECK_RETURN(ra02_write_reg(ra02, RA02_REG_BIT_RATE_FRAC, value & 0x0F));
+
+  ra02->bitrate = baudrate;
+
+  return E_OK;
+}
+
+error_t ra02_set_fdev(ra02_t * ra02, uint32_t hz) {
+  ASSERT_RETURN(ra02, E_NULL);
+  ASSERT_RETURN(ra02->modem == RA02_MODEM_FSK, E_INVAL);
+  ASSERT_RETURN(hz <= RA02_FSK_MAX_FDEV, E_INVAL);
+
+  RA02_OWN(ra02);
+
+  log_debug("ra02_set_fdev: %d", hz);
+
+  /* Fdev = Fstep * Fdev(13:0), Fstep = FXOSC / 2^19 */
+  uint32_t value = (((uint64_t) hz << 19) + RA02_FXOSC / 2) / RA02_FXOSC;
+
+  ERROR_CHECK_RETURN(ra02_write_reg(ra02, RA02_REG_FDEV_MSB, (value >> 8) & 0x3F));
+  ERROR_CHECK_RETURN(ra02_write_reg(ra02, RA02_REG_FDEV_LSB, value));
+
+  ra02->fdev = hz;
+
+  return E_OK;
+}
+
+error_t ra02_set_fsk_packet_cfg(ra02_t * ra02, const ra02_fsk_packet_cfg_t * cfg) {
+  ASSERT_RETURN(ra02 && cfg, E_NULL);
+  ASSERT_RETURN(ra02->modem == RA02_MODEM_FSK, E_INVAL);
+  ASSERT_RETURN(cfg->sync_size <= sizeof(cfg->sync_word), E_INVAL);
+
+  RA02_OWN(ra02);
+
+  log_debug("ra02_set_fsk_packet_cfg: sync=%x/%d whitening=%d crc=%d",
+            cfg->sync_word, cfg->sync_size, cfg->whitening, cfg->crc);
+
+  for (uint8_t i = 0; i < cfg->sync_size; ++i) {
+    ERROR_CHECK_RETURN(ra02_write_reg(ra02, RA02_REG_SYNC_VALUE_1 + i,
+                                      cfg->sync_word >> (8 * (cfg->sync_size - i - 1))));
+  }
+
+  ERROR_CHECK_RETURN(ra02_write_reg(ra02, RA02_REG_SYNC_CFG, RA02_FSK_SYNC_CFG_AUTO_RESTART |
+      (cfg->sync_size ? RA02_FSK_SYNC_CFG_SYNC_ON | RA02_FSK_SYNC_CFG_SYNC_SIZE(cfg->sync_size) : 0)));
+
+  ERROR_CHECK_RETURN(ra02_write_reg(ra02, RA02_REG_PACKET_CFG_1, RA02_FSK_PACKET_CFG_1_VARIABLE_LEN
+      | (cfg->whitening ? RA02_FSK_PACKET_CFG_1_WHITENING : 0)
+      | (cfg->crc ? RA02_FSK_PACKET_CFG_1_CRC_ON : 0)));
+
+  ra02->fsk_packet = *cfg;
+
+  return E_OK;
+}
+
+error_t ra02_set_bandwidth(ra02_t * ra02, uint32_t bandwidth) {
+  ASSERT_RETURN(ra02, E_NULL);
+
+  uint32_t index = bandwidth;
+
+  if (ra02->modem == RA02_MODEM_LORA) {
+    UTIL_MAP_RANGE_TABLE(ra02_bandwidth_mapping_hz, bandwidth, index);
+    ASSERT_RETURN(index < UTIL_ARR_SIZE(ra02_bandwidth_hz), E_INVAL);
+  }
+
+  RA02_OWN_OR_DEFER(ra02, RA02_PENDING_BANDWIDTH, bandwidth, bandwidth);
+
+  log_debug("ra02_set_bandwidth: %d", bandwidth);
+
+  if (ra02->modem == RA02_MODEM_FSK) {
+    return ra02_fsk_set_rx_bandwidth(ra02, bandwidth);
+  }
+
+  ERROR_CHECK_RETURN(ra02_update_reg(ra02, RA02_LORA_REG_MODEM_CFG_1, RA02_LORA_MODEM_CFG_1_BW_MASK,
+                                     RA02_LORA_MODEM_CFG_1_BW(index)));
+
+  ra02->bandwidth = ra02_bandwidth_hz[index];
+
+  return ra02_update_ldro(ra02);
+}
+
+error_t ra02_set_preamble(ra02_t * ra02, uint32_t preamble) {
+  ASSERT_RETURN(ra02, E_NULL);
+  ASSERT_RETURN(preamble <= UINT16_MAX, E_INVAL);
+
+  RA02_OWN_OR_DEFER(ra02, RA02_PENDING_PREAMBLE, preamble, preamble);
+
+  log_debug("ra02_set_preamble: %d", preamble);
+
+  if (ra02->modem == RA02_MODEM_FSK) {
+    ERROR_CHECK_RETURN(ra02_write_reg(ra02, RA02_REG_PREAMBLE_MSB, preamble >> 8));
+    ERROR_CHECK_RETURN(ra02_write_reg(ra02, RA02_REG_PREAMBLE_LSB, preamble));
+  } else {
+    ERROR_CHECK_RETURN(ra02_write_reg(ra02, RA02_LORA_REG_PREAMBLE_MSB, preamble >> 8));
+    ERROR_CHECK_RETURN(ra02_write_reg(ra02, RA02_LORA_REG_PREAMBLE_LSB, preamble));
+  }
+
+  ra02->preamble = preamble;
+
+  return E_OK;
+}
+
+error_t ra02_set_sf(ra02_t * ra02, uint8_t sf) {
+  ASSERT_RETURN(ra02, E_NULL);
+  ASSERT_RETURN(ra02->modem == RA02_MODEM_LORA, E_INVAL);
+
+  RA02_OWN_OR_DEFER(ra02, RA02_PENDING_SF, sf, sf);
+
+  log_debug("ra02_set_sf: %d", sf);
+
+  sf = UTIL_CAP(sf, 6, 12);
+  ERROR_CHECK_RETURN(ra02_update_reg(ra02, RA02_LORA_REG_MODEM_CFG_2, RA02_LORA_MODEM_CFG_2_SF_MASK,
+                                     RA02_LORA_MODEM_CFG_2_SF(sf)));
+
+  ra02->sf = sf;
+
+  return ra02_update_ldro(ra02);
+}
+
+error_t ra02_set_frame_cfg(ra02_t * ra02, const ra02_frame_cfg_t * cfg) {
+  ASSERT_RETURN(ra02 && cfg, E_NULL);
+  ASSERT_RETURN(ra02->modem == RA02_MODEM_LORA, E_INVAL);
+  ASSERT_RETURN(cfg->crc_rate >= RA02_CRC_RATE_4_5 && cfg->crc_rate <= RA02_CRC_RATE_4_8, E_INVAL);
+  ASSERT_RETURN(!cfg->implicit_header
+                || (cfg->payload_len && cfg->payload_len <= RA02_MAX_PACKET_SIZE), E_INVAL);
+
+  RA02_OWN_OR_DEFER(ra02, RA02_PENDING_FRAME, frame, *cfg);
+
+  log_debug("ra02_set_frame_cfg: implicit=%d len=%d cr=4/%d crc=%d",
+            cfg->implicit_header, cfg->payload_len, cfg->crc_rate + 4, cfg->crc);
+
+  ERROR_CHECK_RETURN(ra02_set_implicit_header_mode(ra02, cfg->implicit_header));
+  ERROR_CHECK_RETURN(ra02_set_crc_rate(ra02, cfg->crc_rate));
+  ERROR_CHECK_RETURN(ra02_set_crc(ra02, cfg->crc));
+
+  if (cfg->implicit_header) {
+    ERROR_CHECK_RETURN(ra02_write_reg(ra02, RA02_LORA_REG_PAYLOAD_LEN, cfg->payload_len));
+  }
+
+  ra02->frame = *cfg;
+
+  return E_OK;
+}
+
+error_t ra02_get_time_on_air(ra02_t * ra02, size_t size, uint32_t * us) {
+  ASSERT_RETURN(ra02 && us, E_NULL);
+
+  if (ra02->modem == RA02_MODEM_FSK) {
+    ASSERT_RETURN(ra02->bitrate, E_INVAL);
+
+    /* Preamble, sync word, length byte, payload & CRC */
+    uint64_t bits = 8 * (ra02->preamble + ra02->fsk_packet.sync_size + 1 + size
+                         + (ra02->fsk_packet.crc ? 2 : 0));
+
+    *us = (bits * 1000000) / ra02->bitrate;
+
+    return E_OK;
+  }
+
+  ASSERT_RETURN(ra02->sf && ra02->bandwidth, E_INVAL);
+
+  /* See SX1276/77/78 datasheet, 4.1.1.7 "Time on air" */
+  int32_t sf  = ra02->sf;
+  int32_t de  = (((uint64_t) 1000000 << sf) / ra02->bandwidth) > RA02_LDRO_SYMBOL_US;
+  int32_t ih  = ra02->frame.implicit_header;
+  int32_t crc = ra02->frame.crc;
+
+  int32_t num = 8 * (int32_t) size - 4 * sf + 28 + 16 * crc - 20 * ih;
+  int32_t den = 4 * (sf - 2 * de);
+  int32_t payload_symbols = 8 + UTIL_MAX(((num + den - 1) / den) * (ra02->frame.crc_rate + 4), 0);
+
+  /* Preamble is (preamble + 4.25) symbols long, so count in quarters of symbol */
+  uint64_t quarters = (ra02->preamble + payload_symbols) * 4 + 17;
+
+  *us = (quarters * ((uint64_t) 1000000 << sf)) / (4 * (uint64_t) ra02->bandwidth);
+
+  return E_OK;
+}
+
+error_t ra02_get_rssi(ra02_t * ra02, int8_t * rssi) {
+  ASSERT_RETURN(ra02 && rssi, E_NULL);
+
+  *rssi = ra02->last_rssi;
+
+  return E_OK;
+}
+
+error_t ra02_poll_irq_flags(ra02_t * ra02) {
+  ASSERT_RETURN(ra02, E_NULL);
+
+  RA02_OWN(ra02);
+
+  return ra02_read_irq_flags(ra02);
+}
+
+error_t ra02_send(ra02_t * ra02, uint8_t * buf, size_t size) {
+  ASSERT_RETURN(ra02 && buf, E_NULL);
+  ASSERT_RETURN(size, E_INVAL);
+  ASSERT_RETURN(size <= RA02_MAX_PACKET_SIZE, E_OVERFLOW);
+
+  RA02_OWN(ra02);
+
+#if USE_RA02_EXT_LOG_SEND_RECV
+  char payload[256] = {0};
+  size_t ofs = 0;
+
+  for (size_t i = 0; i < size; ++i) {
+    ofs += snprintf(payload + ofs, sizeof(payload) - ofs, "%02x ", buf[i]);
+  }
+
+  log_debug("ra02_send: [%d]: %s", size, payload);
+#else
+  log_debug("ra02_send: %d bytes", size);
+#endif
+
+  if (ra02->modem == RA02_MODEM_FSK) {
+    return ra02_fsk_send(ra02, buf, size);
+  }
+
+  ASSERT_RETURN(!ra02->frame.implicit_header || size == ra02->frame.payload_len, E_INVAL);
+
+  ERROR_CHECK_RETURN(ra02_lora_tx_prepare(ra02, buf, size));
+  ERROR_CHECK_RETURN(ra02_goto_op_mode(ra02, RA02_OP_MODE_TX));
+
+  ra02->last_tx_ns = timeout_now_ns();
+
+  return ra02_lora_tx_wait(ra02, size);
+}
+
+error_t ra02_send_at(ra02_t * ra02, uint8_t * buf, size_t size, uint64_t at_ns, uint64_t max_late_ns) {
+  ASSERT_RETURN(ra02 && buf, E_NULL);
+  ASSERT_RETURN(ra02->modem == RA02_MODEM_LORA && size, E_INVAL);
+  ASSERT_RETURN(size <= RA02_MAX_PACKET_SIZE, E_OVERFLOW);
+  ASSERT_RETURN(!ra02->frame.implicit_header || size == ra02->frame.payload_len, E_INVAL);
+
+  RA02_OWN(ra02);
+
+  ERROR_CHECK_RETURN(ra02_lora_tx_prepare(ra02, buf, size));
+
+  timeout_sleep_until_precise_ns(at_ns);
+
+  uint64_t late_ns = timeout_now_ns() - at_ns;
+
+  if (late_ns > max_late_ns) {
+    log_warn("ra02_send_at: missed TX instant by %lld ns", (long long) late_ns);
+    ERROR_CHECK_RETURN(ra02_goto_op_mode(ra02, RA02_OP_MODE_SLEEP));
+    return E_TIMEOUT;
+  }
+
+  ERROR_CHECK_RETURN(ra02_goto_op_mode(ra02, RA02_OP_MODE_TX));
+
+  ra02->last_tx_ns = timeout_now_ns();
+
+  return ra02_lora_tx_wait(ra02, size);
+}
+
+error_t ra02_recv(ra02_t * ra02, uint8_t * buf, size_t * size, timeout_t * timeout) {
+  ASSERT_RETURN(ra02 && buf && size && timeout, E_NULL);
+  ASSERT_RETURN(*size, E_INVAL);
+
+  RA02_OWN(ra02);
+
+  log_debug("ra02_recv: %d ticks", timeout->duration);
+
+  if (ra02->modem == RA02_MODEM_FSK) {
+    return ra02_fsk_recv(ra02, buf, size, timeout);
+  }
+
+  ASSERT_RETURN(!ra02->frame.implicit_header || *size >= ra02->frame.payload_len, E_INVAL);
+
+  ra02->irq_flags = 0;
+
+  ERROR_CHECK_RETURN(ra02_lora_rx_prepare(ra02));
+  ERROR_CHECK_RETURN(ra02_goto_op_mode(ra02, RA02_OP_MODE_RX_SINGLE));
+
+  while (1) {
+    ERROR_CHECK_RETURN(ra02_lora_wait_rx(ra02, timeout));
+
+    if (ra02->irq_flags & RA02_LORA_IRQ_FLAGS_RX_DONE) {
+      return ra02_lora_read_packet(ra02, buf, size);
+    }
+
+    if (timeout_is_expired(timeout)) {
+      ERROR_CHECK_RETURN(ra02_goto_op_mode(ra02, RA02_OP_MODE_SLEEP));
+      return E_TIMEOUT;
+    }
+
+    /* Symbol timeout expired without preamble and modem went to standby, so restart reception */
+    ra02->irq_flags = 0;
+
+    /* No frame is in flight, so settings queued by other threads can be applied */
+    if (ra02->sync && __atomic_load_n(&ra02->sync->pending.mask, __ATOMIC_ACQUIRE)) {
+      ERROR_CHECK_RETURN(ra02_apply_pending(ra02));
+      ERROR_CHECK_RETURN(ra02_lora_rx_prepare(ra02));
+    }
+
+    ERROR_CHECK_RETURN(ra02_goto_op_mode(ra02, RA02_OP_MODE_RX_SINGLE));
+  }
+}
+
+error_t ra02_send_start(ra02_t * ra02, uint8_t * buf, size_t size) {
+  ASSERT_RETURN(ra02 && buf, E_NULL);
+  ASSERT_RETURN(size, E_INVAL);
+  ASSERT_RETURN(size <= RA02_MAX_PACKET_SIZE, E_OVERFLOW);
+
+  RA02_OWN(ra02);
+
+  ASSERT_RETURN(ra02->async.state == RA02_STATE_IDLE, E_BUSY);
+
+  log_debug("ra02_send_start: %d bytes", size);
+
+  if (ra02->modem == RA02_MODEM_FSK) {
+    ERROR_CHECK_RETURN(ra02_fsk_tx_prepare(ra02, buf, size));
+  } else {
+    ASSERT_RETURN(!ra02->frame.implicit_header || size == ra02->frame.payload_len, E_INVAL);
+    ERROR_CHECK_RETURN(ra02_lora_tx_prepare(ra02, buf, size));
+  }
+
+  ERROR_CHECK_RETURN(ra02_goto_op_mode(ra02, RA02_OP_MODE_TX));
+
+  ra02->last_tx_ns = timeout_now_ns();
+
+  /* Long preambles (e.g. wake-on-radio) may take longer than IRQ timeout alone */
+  uint32_t airtime_us = 0;
+  ra02_get_time_on_air(ra02, size, &airtime_us);
+
+  ra02->async = (ra02_async_t) {
+    .state = RA02_STATE_TX,
+    .deadline_ns = ra02->last_tx_ns + ((uint64_t) airtime_us / 1000 + RA02_SEND_IRQ_TIMEOUT) * 1000000,
+  };
+
+  return E_OK;
+}
+
+error_t ra02_recv_start(ra02_t * ra02, uint8_t * buf, size_t * size, uint32_t timeout_ms) {
+  ASSERT_RETURN(ra02 && buf && size, E_NULL);
+  ASSERT_RETURN(*size, E_INVAL);
+
+  RA02_OWN(ra02);
+
+  ASSERT_RETURN(ra02->async.state == RA02_STATE_IDLE, E_BUSY);
+
+  log_debug("ra02_recv_start: %d ms", timeout_ms);
+
+  if (ra02->modem == RA02_MODEM_FSK) {
+    ERROR_CHECK_RETURN(ra02_fsk_rx_prepare(ra02));
+    ERROR_CHECK_RETURN(ra02_goto_op_mode(ra02, RA02_OP_MODE_RX_CONTINUOUS));
+  } else {
+    ASSERT_RETURN(!ra02->frame.implicit_header || *size >= ra02->frame.payload_len, E_INVAL);
+
+    ra02->irq_flags = 0;
+
+    ERROR_CHECK_RETURN(ra02_lora_rx_prepare(ra02));
+    ERROR_CHECK_RETURN(ra02_goto_op_mode(ra02, RA02_OP_MODE_RX_SINGLE));
+  }
+
+  ra02->async = (ra02_async_t) {
+    .state = RA02_STATE_RX,
+    .buf = buf,
+    .size = size,
+    .deadline_ns = timeout_ms ? timeout_now_ns() + (uint64_t) timeout_ms * 1000000 : UINT64_MAX,
+  };
+
+  return E_OK;
+}
+
+error_t ra02_step(ra02_t * ra02, uint64_t * wake_ns) {
+  ASSERT_RETURN(ra02 && wake_ns, E_NULL);
+
+  RA02_OWN(ra02);
+
+  *wake_ns = UINT64_MAX;
+
+  ASSERT_RETURN(ra02->async.state != RA02_STATE_IDLE, E_EMPTY);
+
+  error_t err = ra02_async_step(ra02);
+
+  if (err == E_AGAIN) {
+    *wake_ns = ra02_async_wake_ns(ra02);
+    return E_AGAIN;
+  }
+
+  ra02->async.state = RA02_STATE_IDLE;
+
+  log_debug("ra02_step: %s", error2str(err));
+
+  return err;
+}
+
+error_t ra02_send_stream(ra02_t * ra02, uint8_t * buf, size_t size) {
+  ASSERT_RETURN(ra02 && buf, E_NULL);
+  ASSERT_RETURN(ra02->modem == RA02_MODEM_FSK, E_INVAL);
+  ASSERT_RETURN(size && size <= RA02_FSK_MAX_STREAM_SIZE, E_INVAL);
+
+  RA02_OWN(ra02);
+
+  uint8_t level = ra02_fsk_stream_threshold(ra02);
+
+  log_debug("ra02_send_stream: %d bytes, threshold %d", size, level);
+
+  error_t err = ra02_fsk_stream_tx(ra02, buf, size, level);
+
+  /* Variable length packets & sleep are restored on every exit, first error is reported */
+  error_t sleep_err = ra02_goto_op_mode(ra02, RA02_OP_MODE_SLEEP);
+  error_t len_err = ra02_fsk_set_variable_len(ra02);
+
+  err = err != E_OK ? err : sleep_err != E_OK ? sleep_err : len_err;
+
+  log_debug("ra02_send_stream: %s", error2str(err));
+
+  return err;
+}
+
+error_t ra02_recv_stream(ra02_t * ra02, uint8_t * buf, size_t size, timeout_t * timeout) {
+  ASSERT_RETURN(ra02 && buf && timeout, E_NULL);
+  ASSERT_RETURN(ra02->modem == RA02_MODEM_FSK, E_INVAL);
+  ASSERT_RETURN(size && size <= RA02_FSK_MAX_STREAM_SIZE, E_INVAL);
+
+  RA02_OWN(ra02);
+
+  uint8_t level = RA02_FSK_FIFO_SIZE - 1 - ra02_fsk_stream_threshold(ra02);
+
+  log_debug("ra02_recv_stream: %d bytes, threshold %d", size, level);
+
+  error_t err = ra02_fsk_stream_rx(ra02, buf, size, level, timeout);
+
+  /* Variable length packets & sleep are restored on every exit, first error is reported */
+  error_t sleep_err = ra02_goto_op_mode(ra02, RA02_OP_MODE_SLEEP);
+  error_t len_err = ra02_fsk_set_variable_len(ra02);
+
+  err = err != E_OK ? err : sleep_err != E_OK ? sleep_err : len_err;
+
+  log_debug("ra02_recv_stream: %s", error2str(err));
+
+  return err;
+}
+
+error_t ra02_cancel(ra02_t * ra02) {
+  ASSERT_RETURN(ra02 && ra02->sync, E_NULL);
+
+  log_debug("ra02_cancel");
+
+  /* Wake up first, so that the flag is never consumed before the event it wakes with */
+  if (ra02->sync->cancel_fd >= 0) {
+    uint64_t value = 1;
+    UTIL_UNUSED(write(ra02->sync->cancel_fd, &value, sizeof(value)));
+  }
+
+  __atomic_store_n(&ra02->sync->cancel, 1, __ATOMIC_RELEASE);
+
+  return E_OK;
+}
+
+error_t ra02_cad(ra02_t * ra02, bool * detected) {
+  ASSERT_RETURN(ra02 && detected, E_NULL);
+  ASSERT_RETURN(ra02->modem == RA02_MODEM_LORA, E_INVAL);
+
+  RA02_OWN(ra02);
+
+  ra02->irq_flags = 0;
+
+  ERROR_CHECK_RETURN(ra02_goto_op_mode(ra02, RA02_OP_MODE_STANDBY));
+  ERROR_CHECK_RETURN(ra02_write_reg(ra02, RA02_REG_DIO_MAP_1,
+                                    RA02_LORA_MAP_DIO_0(RA02_LORA_DIO_0_CAD_DONE)
+                                    | RA02_LORA_MAP_DIO_1(RA02_LORA_DIO_1_CAD_DETECTED)));
+  ra02_drain_dio(ra02);
+  ERROR_CHECK_RETURN(ra02_goto_op_mode(ra02, RA02_OP_MODE_CAD));
+
+  TIMEOUT_CREATE(t, (RA02_CAD_SYMBOLS * 2 * ra02_lora_symbol_us(ra02)) / 1000 + RA02_SEND_IRQ_TIMEOUT);
+
+  while (!(ra02->irq_flags & RA02_LORA_IRQ_FLAGS_CAD_DONE)) {
+    if (timeout_is_expired(&t)) {
+      ERROR_CHECK_RETURN(ra02_goto_op_mode(ra02, RA02_OP_MODE_STANDBY));
+      return E_TIMEOUT;
+    }
+
+    ra02_wait_dio(ra02, ra02->dio0, ra02_lora_symbol_us(ra02));
+
+    if (ra02_cancelled(ra02)) {
+      ERROR_CHECK_RETURN(ra02_goto_op_mode(ra02, RA02_OP_MODE_STANDBY));
+      return E_CANCELLED;
+    }
+
+    ERROR_CHECK_RETURN(ra02_read_irq_flags(ra02));
+  }
+
+  /* Modem returns to standby by itself after CAD */
+  *detected = ra02->irq_flags & RA02_LORA_IRQ_FLAGS_CAD_DETECTED;
+
+  return E_OK;
+}
+
+error_t ra02_listen(ra02_t * ra02, uint32_t khz) {
+  ASSERT_RETURN(ra02, E_NULL);
+  ASSERT_RETURN(ra02->modem == RA02_MODEM_LORA, E_INVAL);
+
+  RA02_OWN(ra02);
+
+  /* PLL relocks on RX entry, so retuning costs 3 SPI transactions and no sleeps */
+  ERROR_CHECK_RETURN(ra02_goto_op_mode(ra02, RA02_OP_MODE_STANDBY));
+  ERROR_CHECK_RETURN(ra02_set_freq(ra02, khz));
+
+  return ra02_goto_op_mode(ra02, RA02_OP_MODE_RX_CONTINUOUS);
+}
+
+error_t ra02_sample_rssi(ra02_t * ra02, int8_t * rssi, uint8_t * wideband, size_t count, uint16_t interval_us) {
+  ASSERT_RETURN(ra02 && rssi, E_NULL);
+  ASSERT_RETURN(ra02->modem == RA02_MODEM_LORA, E_INVAL);
+
+  RA02_OWN(ra02);
+
+  uint8_t tx[RA02_RSSI_BATCH][2][2];
+  uint8_t rx[RA02_RSSI_BATCH][2][2];
+  spi_xfer_t xfers[RA02_RSSI_BATCH * 2];
+
+  for (size_t done = 0; done < count;) {
+    size_t batch = UTIL_MIN(count - done, RA02_RSSI_BATCH);
+    size_t n = 0;
+
+    /* Batch itself is one ioctl, so cancellation is noticed between batches */
+    if (ra02_cancelled(ra02)) {
+      return E_CANCELLED;
+    }
+
+    for (size_t i = 0; i < batch; ++i) {
+      tx[i][0][0] = RA02_LORA_REG_RSSI_VAL & 0x7F;
+      tx[i][1][0] = RA02_LORA_REG_RSSI_WIDEBAND & 0x7F;
+
+      xfers[n++] = (spi_xfer_t) {.tx_buf = tx[i][0], .rx_buf = rx[i][0], .size = 2, .delay_us = interval_us};
+
+      if (wideband) {
+        xfers[n - 1].delay_us = 0;
+        xfers[n++] = (spi_xfer_t) {.tx_buf = tx[i][1], .rx_buf = rx[i][1], .size = 2, .delay_us = interval_us};
+      }
+    }
+
+    ERROR_CHECK_RETURN(spi_transcieve_batch(ra02->spi, xfers, n));
+
+    for (size_t i = 0; i < batch; ++i) {
+      rssi[done + i] = UTIL_MAX(rx[i][0][1] - RA02_LORA_RSSI_OFFSET, INT8_MIN);
+
+      if (wideband) {
+        wideband[done + i] = rx[i][1][1];
+      }
+    }
+
+    done += batch;
+  }
+
+  return E_OK;
+}
+
+error_t ra02_send_wor(ra02_t * ra02, uint32_t period_ms, uint8_t * buf, size_t size) {
+  ASSERT_RETURN(ra02 && buf, E_NULL);
+  ASSERT_RETURN(ra02->modem == RA02_MODEM_LORA && period_ms, E_INVAL);
+
+  RA02_OWN(ra02);
+
+  uint16_t preamble = ra02->preamble;
+
+  ERROR_CHECK_RETURN(ra02_set_preamble(ra02, ra02_wor_preamble_symbols(ra02, period_ms)));
+
+  error_t err = ra02_send(ra02, buf, size);
+
+  ERROR_CHECK_RETURN(ra02_set_preamble(ra02, preamble));
+
+  return err;
+}
+
+error_t ra02_recv_wor(
+  ra02_t * ra02,
+  uint32_t period_ms,
+  uint8_t * buf,
+  size_t * size,
+  timeout_t * timeout,
+  ra02_wor_stats_t * stats
+) {
+  ASSERT_RETURN(ra02 && buf && size && timeout && stats, E_NULL);
+  ASSERT_RETURN(ra02->modem == RA02_MODEM_LORA && period_ms && *size, E_INVAL);
+  ASSERT_RETURN(!ra02->frame.implicit_header || *size >= ra02->frame.payload_len, E_INVAL);
+
+  RA02_OWN(ra02);
+
+  uint16_t preamble = ra02->preamble;
+  uint32_t wor_preamble = ra02_wor_preamble_symbols(ra02, period_ms);
+
+  /* After detection at most whole preamble (minus CAD) + header is left to wait for,
+   * symbol timeout register is 10-bit, so longer remainders are cut */
+  uint32_t symb_timeout = UTIL_MIN(wor_preamble - RA02_CAD_SYMBOLS + RA02_WOR_PREAMBLE_MARGIN,
+                                   RA02_MAX_SYMB_TIMEOUT);
+
+  log_debug("ra02_recv_wor: period %d ms, preamble %d, symb timeout %d",
+            period_ms, wor_preamble, symb_timeout);
+
+  error_t err = ra02_set_preamble(ra02, wor_preamble);
+
+  if (err == E_OK) {
+    err = ra02_set_rx_symbol_timeout(ra02, symb_timeout);
+  }
+
+  if (err == E_OK) {
+    err = ra02_wor_listen(ra02, period_ms, buf, size, timeout, stats);
+  }
+
+  /* Regular RX settings are restored however listening ended */
+  error_t restore_err = ra02_lora_rx_restore(ra02, preamble);
+
+  if (restore_err != E_OK) {
+    err = restore_err;
+  }
+
+  log_debug("ra02_recv_wor: %s (cad %d/%d, rx %d, missed %d)", error2str(err),
+            stats->cad_detected, stats->cad_runs, stats->rx_ok, stats->rx_missed);
+
+  return err;
+}
+
+error_t ra02_get_scan_preamble(ra02_t * ra02, uint16_t sf_mask, uint8_t sf, uint16_t * symbols) {
+  ASSERT_RETURN(ra02 && symbols, E_NULL);
+  ASSERT_RETURN(ra02->modem == RA02_MODEM_LORA && ra02->bandwidth, E_INVAL);
+  ASSERT_RETURN(sf >= RA02_SCAN_SF_MIN && sf <= RA02_SCAN_SF_MAX && (sf_mask & RA02_SF_BIT(sf)), E_INVAL);
+
+  /* Preamble must span whole cycle, CAD itself and leave enough symbols to lock */
+  uint32_t symbol_us = ra02_lora_sf_symbol_us(ra02, sf);
+  uint32_t cycle_us = ra02_scan_cycle_us(ra02, sf_mask, RA02_SCAN_SWITCH_US);
+
+  *symbols = UTIL_MIN((cycle_us + symbol_us - 1) / symbol_us + RA02_CAD_SYMBOLS + RA02_SCAN_LOCK_SYMBOLS,
+                      UINT16_MAX);
+
+  return E_OK;
+}
+
+error_t ra02_recv_scan(
+  ra02_t * ra02,
+  uint16_t sf_mask,
+  uint8_t * buf,
+  size_t * size,
+  uint8_t * sf,
+  timeout_t * timeout,
+  ra02_scan_stats_t * stats
+) {
+  ASSERT_RETURN(ra02 && buf && size && sf && timeout && stats, E_NULL);
+  ASSERT_RETURN(ra02->modem == RA02_MODEM_LORA && *size, E_INVAL);
+  ASSERT_RETURN(sf_mask && !(sf_mask & ~RA02_SF_MASK_ALL), E_INVAL);
+  ASSERT_RETURN(!ra02->frame.implicit_header || *size >= ra02->frame.payload_len, E_INVAL);
+
+  RA02_OWN(ra02);
+
+  uint8_t initial_sf = ra02->sf;
+  uint8_t cfg_2;
+  uint8_t cfg_3;
+
+  /* Detection happens somewhere in preamble, so don't wait longer than that */
+  error_t err = ra02_set_rx_symbol_timeout(ra02,
+      UTIL_MIN(ra02->preamble + RA02_WOR_PREAMBLE_MARGIN, RA02_MAX_SYMB_TIMEOUT));
+
+  if (err == E_OK) {
+    err = ra02_goto_op_mode(ra02, RA02_OP_MODE_STANDBY);
+  }
+
+  if (err == E_OK) {
+    err = ra02_read_reg(ra02, RA02_LORA_REG_MODEM_CFG_2, &cfg_2);
+  }
+
+  if (err == E_OK) {
+    err = ra02_read_reg(ra02, RA02_LORA_REG_MODEL_CFG_3, &cfg_3);
+  }
+
+  /* SF is switched only after cached registers were read */
+  bool switched = err == E_OK;
+
+  if (err == E_OK) {
+    log_debug("ra02_recv_scan: mask 0x%04x, cycle %d us", sf_mask,
+              ra02_scan_cycle_us(ra02, sf_mask, RA02_SCAN_SWITCH_US));
+
+    err = ra02_scan_listen(ra02, sf_mask, cfg_2, cfg_3, buf, size, sf, timeout, stats);
+  }
+
+  /* Initial SF & symbol timeout are restored on every exit, first error is reported */
+  error_t sleep_err = ra02_goto_op_mode(ra02, RA02_OP_MODE_SLEEP);
+  error_t sf_err = switched ? ra02_lora_switch_sf(ra02, initial_sf, cfg_2, cfg_3) : E_OK;
+  error_t symb_err = ra02_set_rx_symbol_timeout(ra02, RA02_DEFAULT_SYMB_TIMEOUT);
+
+  err = err != E_OK ? err : sleep_err != E_OK ? sleep_err : sf_err != E_OK ? sf_err : symb_err;
+
+  log_debug("ra02_recv_scan: %s (sf %d)", error2str(err), err == E_OK ? *sf : 0);
+
+  return err;
+}
+
+error_t ra02_scan_simulate(ra02_t * ra02, const ra02_scan_sim_cfg_t * cfg, ra02_scan_sim_result_t * result) {
+  ASSERT_RETURN(ra02 && cfg && result, E_NULL);
+  ASSERT_RETURN(ra02->modem == RA02_MODEM_LORA && ra02->bandwidth, E_INVAL);
+  ASSERT_RETURN(cfg->sf_mask && !(cfg->sf_mask & ~RA02_SF_MASK_ALL), E_INVAL);
+  ASSERT_RETURN(cfg->interval_ms && cfg->duration_ms, E_INVAL);
+
+  /* Per SF preamble schedule: start of every packet in us */
+  uint64_t * schedule[RA02_SCAN_SF_COUNT] = {0};
+  uint16_t preamble[RA02_SCAN_SF_COUNT] = {0};
+  uint32_t next[RA02_SCAN_SF_COUNT] = {0};
+  uint32_t airtime_us[RA02_SCAN_SF_COUNT] = {0};
+  uint64_t duration_us = (uint64_t) cfg->duration_ms * 1000;
+  uint32_t capacity = cfg->duration_ms / cfg->interval_ms * 2 + 16;
+  unsigned int seed = cfg->seed;
+  error_t err = E_OK;
+
+  memset(result, 0, sizeof(*result));
+  result->cycle_us = ra02_scan_cycle_us(ra02, cfg->sf_mask, cfg->switch_us);
+
+  for (uint8_t sf = RA02_SCAN_SF_MIN; sf <= RA02_SCAN_SF_MAX; ++sf) {
+    uint8_t idx = sf - RA02_SCAN_SF_MIN;
+
+    if (!(cfg->sf_mask & RA02_SF_BIT(sf))) {
+      continue;
+    }
+
+    preamble[idx] = cfg->preamble;
+
+    if (!preamble[idx]) {
+      ra02_get_scan_preamble(ra02, cfg->sf_mask, sf, &preamble[idx]);
+    }
+
+    /* Time on air with sender's configuration */
+    ra02_t sender = *ra02;
+    sender.sf = sf;
+    sender.preamble = preamble[idx];
+    ra02_get_time_on_air(&sender, cfg->payload_size, &airtime_us[idx]);
+
+    schedule[idx] = malloc(capacity * sizeof(uint64_t));
+
+    if (!schedule[idx]) {
+      err = E_NOMEM;
+      goto cleanup;
+    }
+
+    /* Exponential inter-arrival times, packets of single SF don't overlap */
+    uint64_t t = 0;
+
+    while (result->sent[idx] < capacity) {
+      double u = (rand_r(&seed) + 1.0) / ((double) RAND_MAX + 2.0);
+      t += (uint64_t) (-log(u) * cfg->interval_ms * 1000) + airtime_us[idx];
+
+      if (t >= duration_us) {
+        break;
+      }
+
+      schedule[idx][result->sent[idx]++] = t;
+    }
+  }
+
+  /* Scanner: cycle CAD over SFs, lock onto detected packet until it ends */
+  for (uint64_t now = 0; now < duration_us;) {
+    for (uint8_t sf = RA02_SCAN_SF_MIN; sf <= RA02_SCAN_SF_MAX && now < duration_us; ++sf) {
+      uint8_t idx = sf - RA02_SCAN_SF_MIN;
+
+      if (!(cfg->sf_mask & RA02_SF_BIT(sf))) {
+        continue;
+      }
+
+      uint32_t symbol_us = ra02_lora_sf_symbol_us(ra02, sf);
+      uint64_t cad_start = now + cfg->switch_us;
+      uint64_t cad_end = cad_start + RA02_CAD_SYMBOLS * symbol_us;
+      uint64_t lock_us = (uint64_t) RA02_SCAN_LOCK_SYMBOLS * symbol_us;
+
+      /* Skip packets, whose preamble is already over */
+      while (next[idx] < result->sent[idx]
+             && schedule[idx][next[idx]] + (uint64_t) preamble[idx] * symbol_us < cad_end + lock_us) {
+        next[idx]++;
+      }
+
+      now = cad_end;
+
+      if (next[idx] < result->sent[idx] && schedule[idx][next[idx]] <= cad_start) {
+        /* Whole CAD window is within preamble and receiver can still lock */
+        now = schedule[idx][next[idx]] + airtime_us[idx];
+        result->detected[idx]++;
+        next[idx]++;
+      }
+    }
+  }
+
+cleanup:
+  for (size_t i = 0; i < RA02_SCAN_SF_COUNT; ++i) {
+    free(schedule[i]);
+  }
+
+  return err;
+}
+
+error_t ra02_get_window_symbols(ra02_t * ra02, uint32_t ms, uint16_t * symbols) {
+  ASSERT_RETURN(ra02 && symbols, E_NULL);
+  ASSERT_RETURN(ra02->modem == RA02_MODEM_LORA && ra02->bandwidth, E_INVAL);
+
+  uint32_t symbol_us = ra02_lora_symbol_us(ra02);
+
+  *symbols = UTIL_CAP(((uint64_t) ms * 1000 + symbol_us - 1) / symbol_us,
+                      RA02_MIN_SYMB_TIMEOUT, RA02_MAX_SYMB_TIMEOUT);
+
+  return E_OK;
+}
+
+error_t ra02_recv_window(ra02_t * ra02, uint8_t * buf, size_t * size, uint16_t symbols) {
+  ASSERT_RETURN(ra02 && buf && size, E_NULL);
+  ASSERT_RETURN(ra02->modem == RA02_MODEM_LORA && *size, E_INVAL);
+  ASSERT_RETURN(symbols >= RA02_MIN_SYMB_TIMEOUT && symbols <= RA02_MAX_SYMB_TIMEOUT, E_INVAL);
+  ASSERT_RETURN(!ra02->frame.implicit_header || *size >= ra02->frame.payload_len, E_INVAL);
+
+  RA02_OWN(ra02);
+
+  uint32_t airtime_us;
+
+  /* Host timeout is only a safety net in case IRQ is lost: window itself + longest packet */
+  ERROR_CHECK_RETURN(ra02_get_time_on_air(ra02, RA02_MAX_PACKET_SIZE, &airtime_us));
+  TIMEOUT_CREATE(t, ((uint64_t) symbols * ra02_lora_symbol_us(ra02) + airtime_us) / 1000 + RA02_SEND_IRQ_TIMEOUT);
+
+  ra02->irq_flags = 0;
+
+  error_t err = ra02_lora_rx_prepare(ra02);
+
+  if (err == E_OK) {
+    err = ra02_set_rx_symbol_timeout(ra02, symbols);
+  }
+
+  if (err == E_OK) {
+    err = ra02_goto_op_mode(ra02, RA02_OP_MODE_RX_SINGLE);
+  }
+
+  if (err == E_OK) {
+    err = ra02_lora_wait_rx(ra02, &t);
+  }
+
+  if (err != E_OK) {
+    /* Cancelled or failed, symbol timeout is restored below */
+  } else if (ra02->irq_flags & RA02_LORA_IRQ_FLAGS_RX_DONE) {
+    err = ra02_lora_read_packet(ra02, buf, size);
+  } else {
+    err = E_TIMEOUT;
+    log_debug("ra02_recv_window: %s after %d symbols",
+              ra02->irq_flags & RA02_LORA_IRQ_FLAGS_RX_TIMEOUT ? "RX_TIMEOUT" : "host timeout", symbols);
+  }
+
+  /* Window's symbol timeout must not leak into later receptions */
+  error_t restore_err = ra02_lora_rx_restore(ra02, ra02->preamble);
+
+  if (restore_err != E_OK) {
+    err = restore_err;
+  }
+
+  return err;
 }
@@ -0,0 +1,603 @@
+/** ========================================================================= *
+ *
+ * @file ra02_bench.c
+ * @date 17-10-2026
+ * @author Maksym Tkachuk <max.r.tkachuk@gmail.com>
+ *
+ *  ========================================================================= */
+
+/* Includes ================================================================= */
+#include <ra02_bench.h>
+#include <ra02_emu.h>
+#include <timeout.h>
+#include <assertion.h>
+#include <util.h>
+#include <log.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include <pthread.h>
+
+/* Defines ================================================================== */
+#define LOG_TAG BENCH
+
+/** Frame layout */
+#define RA02_BENCH_MAGIC          0xB7
+#define RA02_BENCH_OFFSET_MAGIC   0
+#define RA02_BENCH_OFFSET_TYPE    1
+#define RA02_BENCH_OFFSET_SEQ     2
+#define RA02_BENCH_OFFSET_COUNT   6
+#define RA02_BENCH_OFFSET_TIME    10
+
+/** Frame types */
+#define RA02_BENCH_TYPE_DATA      0
+#define RA02_BENCH_TYPE_PING      1
+#define RA02_BENCH_TYPE_PONG      2
+
+/** Defaults */
+#define RA02_BENCH_DEFAULT_COUNT      100
+#define RA02_BENCH_DEFAULT_SIZE       32
+#define RA02_BENCH_DEFAULT_TIMEOUT_MS 3000
+
+/** RX slice, stop flag and idle timeout are checked between slices */
+#define RA02_BENCH_RX_SLICE_MS    100
+
+/** Simulation: time for emulated peer to enter RX before first frame */
+#define RA02_BENCH_SIM_SETTLE_MS  50
+
+/* Macros =================================================================== */
+#define RA02_BENCH_RUNNING(running) (!(running) || *(running))
+
+/* Exposed macros =========================================================== */
+/* Enums ==================================================================== */
+/* Types ==================================================================== */
+/**
+ * Decoded frame header
+ */
+typedef struct {
+  uint8_t  type;
+  uint32_t seq;
+  uint32_t count;
+  uint64_t time_ns;
+} ra02_bench_header_t;
+
+/**
+ * Emulated peer thread arguments
+ */
+typedef struct {
+  const ra02_bench_cfg_t * cfg;
+  ra02_bench_mode_t        mode;
+  volatile bool            running;
+  ra02_bench_result_t *    result;
+  error_t                  err;
+} ra02_bench_sim_peer_t;
+
+/* Variables ================================================================ */
+static const char * ra02_bench_mode_names[] = {
+  [RA02_BENCH_MODE_TX]   = "tx",
+  [RA02_BENCH_MODE_RX]   = "rx",
+  [RA02_BENCH_MODE_PING] = "ping",
+  [RA02_BENCH_MODE_PONG] = "pong",
+};
+
+/* Private functions ======================================================== */
+static void ra02_bench_put_u32(uint8_t * buf, uint32_t value) {
+  for (size_t i = 0; i < 4; ++i) {
+    buf[i] = value >> (8 * i);
+  }
+}
+
+static uint32_t ra02_bench_get_u32(const uint8_t * buf) {
+  return buf[0] | (buf[1] << 8) | (buf[2] << 16) | ((uint32_t) buf[3] << 24);
+}
+
+static void ra02_bench_put_u64(uint8_t * buf, uint64_t value) {
+  ra02_bench_put_u32(buf, value);
+  ra02_bench_put_u32(buf + 4, value >> 32);
+}
+
+static uint64_t ra02_bench_get_u64(const uint8_t * buf) {
+  return ra02_bench_get_u32(buf) | ((uint64_t) ra02_bench_get_u32(buf + 4) << 32);
+}
+
+static void ra02_bench_encode(uint8_t * frame, size_t size, const ra02_bench_header_t * header) {
+  /* Padding is a fixed pattern, so receiver side can be checked with a scope or sniffer */
+  for (size_t i = RA02_BENCH_HEADER_SIZE; i < size; ++i) {
+    frame[i] = i;
+  }
+
+  frame[RA02_BENCH_OFFSET_MAGIC] = RA02_BENCH_MAGIC;
+  frame[RA02_BENCH_OFFSET_TYPE] = header->type;
+  ra02_bench_put_u32(&frame[RA02_BENCH_OFFSET_SEQ], header->seq);
+  ra02_bench_put_u32(&frame[RA02_BENCH_OFFSET_COUNT], header->count);
+  ra02_bench_put_u64(&frame[RA02_BENCH_OFFSET_TIME], header->time_ns);
+}
+
+/**
+ * @retval E_INVAL Not a benchmark frame
+ */
+static error_t ra02_bench_decode(const uint8_t * frame, size_t size, ra02_bench_header_t * header) {
+  ASSERT_RETURN(size >= RA02_BENCH_HEADER_SIZE && frame[RA02_BENCH_OFFSET_MAGIC] == RA02_BENCH_MAGIC, E_INVAL);
+
+  header->type = frame[RA02_BENCH_OFFSET_TYPE];
+  header->seq = ra02_bench_get_u32(&frame[RA02_BENCH_OFFSET_SEQ]);
+  header->count = ra02_bench_get_u32(&frame[RA02_BENCH_OFFSET_COUNT]);
+  header->time_ns = ra02_bench_get_u64(&frame[RA02_BENCH_OFFSET_TIME]);
+
+  return E_OK;
+}
+
+static void ra02_bench_stat_add(ra02_bench_stat_t * stat, int64_t value) {
+  stat->min = stat->count ? UTIL_MIN(stat->min, value) : value;
+  stat->max = stat->count ? UTIL_MAX(stat->max, value) : value;
+  stat->sum += value;
+  stat->sum_sq += (double) value * value;
+  stat->count++;
+}
+
+static void ra02_bench_stat_write(FILE * file, const char * name, const ra02_bench_stat_t * stat) {
+  if (!stat->count) {
+    fprintf(file, "\"%s\":null", name);
+    return;
+  }
+
+  double avg = stat->sum / stat->count;
+  double var = stat->sum_sq / stat->count - avg * avg;
+
+  fprintf(file, "\"%s\":{\"min\":%lld,\"avg\":%.1f,\"max\":%lld,\"stddev\":%.1f}",
+          name, (long long) stat->min, avg, (long long) stat->max, sqrt(UTIL_MAX(var, 0.0)));
+}
+
+static void ra02_bench_rx_metadata(ra02_t * ra02, ra02_bench_result_t * result) {
+  ra02_bench_stat_add(&result->rssi, ra02->last_rssi);
+  ra02_bench_stat_add(&result->snr, ra02->last_snr);
+}
+
+/**
+ * Receive single frame within a slice
+ *
+ * @retval E_TIMEOUT Nothing in this slice
+ * @retval E_CORRUPT Frame with CRC error
+ * @retval E_INVAL Foreign frame
+ */
+static error_t ra02_bench_recv(ra02_t * ra02, uint32_t slice_ms, ra02_bench_header_t * header, size_t * size) {
+  uint8_t frame[RA02_MAX_PACKET_SIZE];
+  TIMEOUT_CREATE(t, slice_ms);
+
+  *size = sizeof(frame);
+  ERROR_CHECK_RETURN(ra02_recv(ra02, frame, size, &t));
+
+  return ra02_bench_decode(frame, *size, header);
+}
+
+static error_t ra02_bench_tx(const ra02_bench_cfg_t * cfg, uint32_t count, uint8_t size,
+                             volatile bool * running, ra02_bench_result_t * result) {
+  uint8_t frame[RA02_MAX_PACKET_SIZE];
+  uint64_t start_ns = timeout_now_ns();
+  uint64_t first_ns = 0;
+
+  for (uint32_t seq = 0; seq < count && RA02_BENCH_RUNNING(running); ++seq) {
+    if (cfg->interval_ms) {
+      timeout_sleep_until_ns(start_ns + seq * cfg->interval_ms * 1000000ULL);
+    }
+
+    ra02_bench_encode(frame, size, &(ra02_bench_header_t) {
+      .type = RA02_BENCH_TYPE_DATA, .seq = seq, .count = count, .time_ns = timeout_now_ns(),
+    });
+
+    error_t err = ra02_send(cfg->ra02, frame, size);
+
+    if (err != E_OK) {
+      log_warn("Frame %d: %s", seq, error2str(err));
+      result->failed++;
+      continue;
+    }
+
+    first_ns = result->sent++ ? first_ns : cfg->ra02->last_tx_ns;
+    result->duration_us = (cfg->ra02->last_tx_ns - first_ns) / 1000;
+  }
+
+  return E_OK;
+}
+
+static error_t ra02_bench_rx(const ra02_bench_cfg_t * cfg, uint32_t timeout_ms, volatile bool * running,
+                             ra02_bench_result_t * result) {
+  ra02_t * ra02 = cfg->ra02;
+  uint8_t * seen = NULL;
+  uint64_t first_ns = 0;
+  uint64_t prev_ns = 0;
+  uint32_t prev_seq = 0;
+  uint64_t bytes = 0;
+  error_t err = E_OK;
+  TIMEOUT_CREATE(idle, timeout_ms);
+
+  while (RA02_BENCH_RUNNING(running) && !timeout_is_expired(&idle)) {
+    ra02_bench_header_t header;
+    size_t size;
+
+    err = ra02_bench_recv(ra02, RA02_BENCH_RX_SLICE_MS, &header, &size);
+
+    if (err == E_TIMEOUT || err == E_INVAL) {
+      err = E_OK;
+      continue;
+    }
+
+    if (err == E_CORRUPT) {
+      result->corrupt++;
+      timeout_restart(&idle);
+      err = E_OK;
+      continue;
+    }
+
+    if (err != E_OK) {
+      break;
+    }
+
+    if (header.type != RA02_BENCH_TYPE_DATA || !header.count || header.count > RA02_BENCH_MAX_COUNT ||
+        header.seq >= header.count) {
+      continue;
+    }
+
+    timeout_restart(&idle);
+
+    /* Sequence numbers are tracked in a bitmap sized by first frame */
+    if (!seen) {
+      seen = calloc((header.count + 7) / 8, 1);
+      ASSERT_RETURN(seen, E_NOMEM);
+      result->expected = header.count;
+    }
+
+    if (header.seq >= result->expected) {
+      continue;
+    }
+
+    if (seen[header.seq / 8] & (1 << (header.seq % 8))) {
+      result->duplicates++;
+      continue;
+    }
+
+    seen[header.seq / 8] |= 1 << (header.seq % 8);
+
+    ra02_bench_rx_metadata(ra02, result);
+
+    if (!result->received++) {
+      first_ns = ra02->last_rx_ns;
+    } else if (header.seq < prev_seq) {
+      result->out_of_order++;
+    } else {
+      ra02_bench_stat_add(&result->interarrival_us, (ra02->last_rx_ns - prev_ns) / 1000 / (header.seq - prev_seq));
+      /* First frame only starts the clock */
+      bytes += size;
+    }
+
+    prev_ns = ra02->last_rx_ns;
+    prev_seq = header.seq;
+    result->duration_us = (ra02->last_rx_ns - first_ns) / 1000;
+
+    if (header.seq == result->expected - 1) {
+      break;
+    }
+  }
+
+  free(seen);
+
+  if (result->duration_us) {
+    result->goodput_bps = bytes * 8 * 1e6 / result->duration_us;
+  }
+
+  return err;
+}
+
+static error_t ra02_bench_ping(const ra02_bench_cfg_t * cfg, uint32_t count, uint8_t size, uint32_t timeout_ms,
+                               volatile bool * running, ra02_bench_result_t * result) {
+  ra02_t * ra02 = cfg->ra02;
+  uint8_t frame[RA02_MAX_PACKET_SIZE];
+  uint64_t start_ns = timeout_now_ns();
+
+  for (uint32_t seq = 0; seq < count && RA02_BENCH_RUNNING(running); ++seq) {
+    if (cfg->interval_ms) {
+      timeout_sleep_until_ns(start_ns + seq * cfg->interval_ms * 1000000ULL);
+    }
+
+    ra02_bench_encode(frame, size, &(ra02_bench_header_t) {
+      .type = RA02_BENCH_TYPE_PING, .seq = seq, .count = count, .time_ns = timeout_now_ns(),
+    });
+
+    error_t err = ra02_send(ra02, frame, size);
+
+    if (err != E_OK) {
+      log_warn("Ping %d: %s", seq, error2str(err));
+      result->failed++;
+      continue;
+    }
+
+    uint64_t tx_ns = ra02->last_tx_ns;
+    result->sent++;
+    result->expected++;
+
+    TIMEOUT_CREATE(reply, timeout_ms);
+
+    while (RA02_BENCH_RUNNING(running) && !timeout_is_expired(&reply)) {
+      ra02_bench_header_t header;
+
+      size_t reply_size;
+
+      err = ra02_bench_recv(ra02, UTIL_MIN(timeout_remaining_ms(&reply), RA02_BENCH_RX_SLICE_MS) + 1, &header, &reply_size);
+
+      if (err == E_CORRUPT) {
+        result->corrupt++;
+        continue;
+      }
+
+      if (err == E_TIMEOUT || err == E_INVAL) {
+        continue;
+      }
+
+      ERROR_CHECK_RETURN(err);
+
+      /* Late pong of earlier ping is ignored */
+      if (header.type == RA02_BENCH_TYPE_PONG && header.seq == seq) {
+        ra02_bench_rx_metadata(ra02, result);
+        ra02_bench_stat_add(&result->rtt_us, (ra02->last_rx_ns - tx_ns) / 1000);
+        ra02_bench_stat_add(&result->turnaround_us, header.time_ns / 1000);
+        result->received++;
+        break;
+      }
+    }
+  }
+
+  result->duration_us = (timeout_now_ns() - start_ns) / 1000;
+
+  return E_OK;
+}
+
+static error_t ra02_bench_pong(const ra02_bench_cfg_t * cfg, uint8_t size, uint32_t timeout_ms,
+                               volatile bool * running, ra02_bench_result_t * result) {
+  ra02_t * ra02 = cfg->ra02;
+  uint8_t frame[RA02_MAX_PACKET_SIZE];
+  TIMEOUT_CREATE(idle, timeout_ms);
+
+  while (RA02_BENCH_RUNNING(running) && !timeout_is_expired(&idle)) {
+    ra02_bench_header_t header;
+    size_t ping_size;
+
+    error_t err = ra02_bench_recv(ra02, RA02_BENCH_RX_SLICE_MS, &header, &ping_size);
+
+    if (err == E_CORRUPT) {
+      result->corrupt++;
+      continue;
+    }
+
+    if (err == E_TIMEOUT || err == E_INVAL) {
+      continue;
+    }
+
+    ERROR_CHECK_RETURN(err);
+
+    if (header.type != RA02_BENCH_TYPE_PING) {
+      continue;
+    }
+
+    timeout_restart(&idle);
+    ra02_bench_rx_metadata(ra02, result);
+    result->received++;
+
+    uint64_t rx_ns = ra02->last_rx_ns;
+
+    /* Reported turnaround ends before FIFO is filled, measured one ends at TX start */
+    header.type = RA02_BENCH_TYPE_PONG;
+    header.time_ns = timeout_now_ns() - rx_ns;
+    ra02_bench_encode(frame, size, &header);
+
+    err = ra02_send(ra02, frame, size);
+
+    if (err != E_OK) {
+      log_warn("Pong %d: %s", header.seq, error2str(err));
+      result->failed++;
+      continue;
+    }
+
+    result->sent++;
+    ra02_bench_stat_add(&result->turnaround_us, (ra02->last_tx_ns - rx_ns) / 1000);
+
+    if (header.seq + 1 >= header.count) {
+      break;
+    }
+  }
+
+  return E_OK;
+}
+
+static void * ra02_bench_sim_peer(void * arg) {
+  ra02_bench_sim_peer_t * peer = arg;
+
+  peer->err = ra02_bench_run(peer->cfg, peer->mode, &peer->running, peer->result);
+
+  return NULL;
+}
+
+static error_t ra02_bench_sim_node_init(ra02_emu_t * emu, spi_t * spi, gpio_t dio[2], ra02_t * ra02) {
+  ERROR_CHECK_RETURN(ra02_emu_dio_init(emu, 0, &dio[0]));
+  ERROR_CHECK_RETURN(ra02_emu_dio_init(emu, 1, &dio[1]));
+
+  return ra02_init(ra02, &(ra02_cfg_t){.spi = spi, .dio0 = &dio[0], .dio1 = &dio[1]});
+}
+
+/* Shared functions ========================================================= */
+error_t ra02_bench_parse_mode(const char * name, ra02_bench_mode_t * mode) {
+  ASSERT_RETURN(name && mode, E_NULL);
+
+  for (size_t i = 0; i < UTIL_ARR_SIZE(ra02_bench_mode_names); ++i) {
+    if (!strcmp(name, ra02_bench_mode_names[i])) {
+      *mode = i;
+      return E_OK;
+    }
+  }
+
+  return E_NOTFOUND;
+}
+
+error_t ra02_bench_run(
+  const ra02_bench_cfg_t * cfg,
+  ra02_bench_mode_t mode,
+  volatile bool * running,
+  ra02_bench_result_t * result
+) {
+  ASSERT_RETURN(cfg && cfg->ra02 && result, E_NULL);
+  ASSERT_RETURN(mode < UTIL_ARR_SIZE(ra02_bench_mode_names), E_INVAL);
+
+  uint32_t count = cfg->count ? cfg->count : RA02_BENCH_DEFAULT_COUNT;
+  uint8_t size = cfg->size ? cfg->size : RA02_BENCH_DEFAULT_SIZE;
+  uint32_t timeout_ms = cfg->timeout_ms ? cfg->timeout_ms : RA02_BENCH_DEFAULT_TIMEOUT_MS;
+
+  ASSERT_RETURN(size >= RA02_BENCH_HEADER_SIZE && size <= RA02_MAX_PACKET_SIZE, E_INVAL);
+  ASSERT_RETURN(count <= RA02_BENCH_MAX_COUNT, E_INVAL);
+
+  memset(result, 0, sizeof(*result));
+  result->mode = mode;
+
+  if (cfg->sf) {
+    ERROR_CHECK_RETURN(ra02_set_sf(cfg->ra02, cfg->sf));
+  }
+
+  if (cfg->bandwidth) {
+    ERROR_CHECK_RETURN(ra02_set_bandwidth(cfg->ra02, cfg->bandwidth));
+  }
+
+  ERROR_CHECK_RETURN(ra02_get_time_on_air(cfg->ra02, size, &result->airtime_us));
+
+  error_t err = E_OK;
+
+  switch (mode) {
+    case RA02_BENCH_MODE_TX:
+      err = ra02_bench_tx(cfg, count, size, running, result);
+      break;
+
+    case RA02_BENCH_MODE_RX:
+      err = ra02_bench_rx(cfg, timeout_ms, running, result);
+      break;
+
+    case RA02_BENCH_MODE_PING:
+      err = ra02_bench_ping(cfg, count, size, timeout_ms, running, result);
+      break;
+
+    case RA02_BENCH_MODE_PONG:
+      err = ra02_bench_pong(cfg, size, timeout_ms, running, result);
+      break;
+  }
+
+  if (result->expected) {
+    result->per = 1.0 - (double) result->received / result->expected;
+  }
+
+  return err;
+}
+
+error_t ra02_bench_write_json(FILE * file, const ra02_bench_cfg_t * cfg, const ra02_bench_result_t * result) {
+  ASSERT_RETURN(file && cfg && cfg->ra02 && result, E_NULL);
+
+  fprintf(file, "{\"mode\":\"%s\",\"sf\":%d,\"bandwidth\":%u,\"size\":%d,\"interval_ms\":%u,\"airtime_us\":%u,"
+                "\"duration_us\":%llu,\"sent\":%u,\"failed\":%u,\"expected\":%u,\"received\":%u,\"corrupt\":%u,"
+                "\"duplicates\":%u,\"out_of_order\":%u,\"per\":%.4f,\"goodput_bps\":%.1f,",
+          ra02_bench_mode_names[result->mode], cfg->ra02->sf, cfg->ra02->bandwidth,
+          cfg->size ? cfg->size : RA02_BENCH_DEFAULT_SIZE, cfg->interval_ms, result->airtime_us,
+          (unsigned long long) result->duration_us, result->sent, result->failed, result->expected,
+          result->received, result->corrupt, result->duplicates, result->out_of_order, result->per,
+          result->goodput_bps);
+
+  ra02_bench_stat_write(file, "rssi", &result->rssi);
+  fputc(',', file);
+  ra02_bench_stat_write(file, "snr", &result->snr);
+  fputc(',', file);
+  ra02_bench_stat_write(file, "interarrival_us", &result->interarrival_us);
+  fputc(',', file);
+  ra02_bench_stat_write(file, "rtt_us", &result->rtt_us);
+  fputc(',', file);
+  ra02_bench_stat_write(file, "turnaround_us", &result->turnaround_us);
+  fprintf(file, "}\n");
+
+  /* Flushed here, as process exits without running stdio cleanup */
+  return fflush(file) || ferror(file) ? E_FAILED : E_OK;
+}
+
+error_t ra02_bench_simulate(
+  const ra02_bench_cfg_t * cfg,
+  ra02_bench_mode_t mode,
+  ra02_bench_result_t * result,
+  ra02_bench_result_t * peer_result
+) {
+  ASSERT_RETURN(cfg && result && peer_result, E_NULL);
+  ASSERT_RETURN(mode == RA02_BENCH_MODE_TX || mode == RA02_BENCH_MODE_PING, E_INVAL);
+
+  ra02_emu_air_t air;
+  ra02_emu_t emu[2];
+  spi_t spi[2];
+  gpio_t dio[2][2];
+  ra02_t ra02[2] = {0};
+  ra02_bench_cfg_t side[2] = {*cfg, *cfg};
+  error_t err = E_OK;
+
+  /* Number of nodes, that need cleanup */
+  size_t nodes = 0;
+
+  ERROR_CHECK_RETURN(ra02_emu_air_init(&air));
+
+  for (size_t i = 0; i < 2; ++i) {
+    err = ra02_emu_init(&emu[i], &air, &spi[i]);
+
+    if (err != E_OK) {
+      goto cleanup;
+    }
+
+    dio[i][0].fd = -1;
+    dio[i][1].fd = -1;
+    nodes++;
+
+    err = ra02_bench_sim_node_init(&emu[i], &spi[i], dio[i], &ra02[i]);
+
+    if (err != E_OK) {
+      goto cleanup;
+    }
+
+    side[i].ra02 = &ra02[i];
+  }
+
+  ra02_bench_sim_peer_t peer = {
+    .cfg = &side[1],
+    .mode = mode == RA02_BENCH_MODE_TX ? RA02_BENCH_MODE_RX : RA02_BENCH_MODE_PONG,
+    .running = true,
+    .result = peer_result,
+  };
+
+  pthread_t thread;
+
+  if (pthread_create(&thread, NULL, ra02_bench_sim_peer, &peer)) {
+    err = E_FAILED;
+    goto cleanup;
+  }
+
+  timeout_sleep_us(RA02_BENCH_SIM_SETTLE_MS * 1000);
+
+  err = ra02_bench_run(&side[0], mode, NULL, result);
+
+  /* Receiver stops by itself after last frame, responder only by idle timeout */
+  if (mode == RA02_BENCH_MODE_PING) {
+    peer.running = false;
+  }
+
+  pthread_join(thread, NULL);
+
+  err = err != E_OK ? err : peer.err;
+
+cleanup:
+  for (size_t i = 0; i < nodes; ++i) {
+    ra02_deinit(&ra02[i]);
+    gpio_deinit(&dio[i][0]);
+    gpio_deinit(&dio[i][1]);
+    ra02_emu_deinit(&emu[i]);
+  }
+
+  ra02_emu_air_deinit(&air);
+
+  return err;
+}
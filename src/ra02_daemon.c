@@ -0,0 +1,511 @@
+/** ========================================================================= *
+ *
+ * @file ra02_daemon.c
+ * @date 17-10-2026
+ * @author Maksym Tkachuk <max.r.tkachuk@gmail.com>
+ *
+ *  ========================================================================= */
+
+/* Includes ================================================================= */
+#include <ra02_daemon.h>
+#include <timeout.h>
+#include <assertion.h>
+#include <util.h>
+#include <log.h>
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <limits.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+/* Defines ================================================================== */
+#define LOG_TAG DAEMON
+
+/** Longest RX slice between serving clients */
+#define RA02_DAEMON_RX_SLICE_MS 20
+
+/** Client waits for recv response a bit longer, than daemon waits for frame */
+#define RA02_DAEMON_RECV_MARGIN_MS 1000
+
+/** Pending connections */
+#define RA02_DAEMON_LISTEN_BACKLOG 4
+
+/* Macros =================================================================== */
+/* Exposed macros =========================================================== */
+/* Enums ==================================================================== */
+/* Types ==================================================================== */
+/* Variables ================================================================ */
+/* Private functions ======================================================== */
+static error_t ra02_daemon_address(const char * path, struct sockaddr_un * addr) {
+  ASSERT_RETURN(strlen(path) < sizeof(addr->sun_path), E_OVERFLOW);
+
+  memset(addr, 0, sizeof(*addr));
+  addr->sun_family = AF_UNIX;
+  strcpy(addr->sun_path, path);
+
+  return E_OK;
+}
+
+static error_t ra02_daemon_write(int fd, uint8_t type, error_t status, const void * payload, size_t size) {
+  uint8_t buf[RA02_DAEMON_MAX_MESSAGE];
+
+  ASSERT_RETURN(size <= sizeof(buf) - RA02_DAEMON_HEADER_SIZE, E_OVERFLOW);
+
+  buf[0] = type;
+  buf[1] = status;
+  memcpy(&buf[2], &(uint16_t) {size}, sizeof(uint16_t));
+
+  if (size) {
+    memcpy(&buf[RA02_DAEMON_HEADER_SIZE], payload, size);
+  }
+
+  /* Never block the radio on a slow client */
+  if (send(fd, buf, RA02_DAEMON_HEADER_SIZE + size, MSG_DONTWAIT | MSG_NOSIGNAL) < 0) {
+    return errno == EAGAIN ? E_BUSY : E_FAILED;
+  }
+
+  return E_OK;
+}
+
+/**
+ * Read single message, returns payload size in size
+ */
+static error_t ra02_daemon_read(int fd, uint8_t * type, error_t * status, void * payload, size_t * size, int timeout_ms) {
+  uint8_t buf[RA02_DAEMON_MAX_MESSAGE];
+  struct pollfd pfd = {.fd = fd, .events = POLLIN};
+
+  int res = poll(&pfd, 1, timeout_ms);
+  ASSERT_RETURN(res >= 0, E_FAILED);
+  ASSERT_RETURN(res, E_TIMEOUT);
+
+  ssize_t len = recv(fd, buf, sizeof(buf), 0);
+  ASSERT_RETURN(len, E_CANCELLED);
+  ASSERT_RETURN(len >= RA02_DAEMON_HEADER_SIZE, E_CORRUPT);
+
+  uint16_t payload_size;
+  memcpy(&payload_size, &buf[2], sizeof(payload_size));
+  ASSERT_RETURN(payload_size == len - RA02_DAEMON_HEADER_SIZE && payload_size <= *size, E_CORRUPT);
+
+  *type = buf[0];
+  *status = buf[1];
+  *size = payload_size;
+  memcpy(payload, &buf[RA02_DAEMON_HEADER_SIZE], payload_size);
+
+  return E_OK;
+}
+
+static size_t ra02_daemon_packet_size(const ra02_daemon_packet_t * packet) {
+  return offsetof(ra02_daemon_packet_t, data) + packet->size;
+}
+
+static void ra02_daemon_close_client(ra02_daemon_t * daemon, ra02_daemon_client_t * client) {
+  log_debug("client %d disconnected", client->fd);
+
+  close(client->fd);
+  client->fd = -1;
+  daemon->stats.clients--;
+}
+
+static void ra02_daemon_accept(ra02_daemon_t * daemon) {
+  int fd = accept(daemon->fd, NULL, NULL);
+
+  if (fd < 0) {
+    return;
+  }
+
+  for (size_t i = 0; i < RA02_DAEMON_MAX_CLIENTS; ++i) {
+    if (daemon->clients[i].fd < 0) {
+      daemon->clients[i] = (ra02_daemon_client_t) {.fd = fd};
+      daemon->stats.clients++;
+      log_debug("client %d connected", fd);
+      return;
+    }
+  }
+
+  log_warn("Too many clients");
+  close(fd);
+}
+
+/**
+ * Answer pending recv request from backlog
+ */
+static void ra02_daemon_serve_recv(ra02_daemon_t * daemon, ra02_daemon_client_t * client) {
+  if (!daemon->backlog_count) {
+    return;
+  }
+
+  ra02_daemon_packet_t * packet = &daemon->backlog[daemon->backlog_head];
+
+  daemon->backlog_head = (daemon->backlog_head + 1) % RA02_DAEMON_BACKLOG_SIZE;
+  daemon->backlog_count--;
+  client->recv_deadline_ns = 0;
+
+  ra02_daemon_write(client->fd, RA02_DAEMON_MSG_RECV, E_OK, packet, ra02_daemon_packet_size(packet));
+}
+
+static error_t ra02_daemon_config(ra02_t * ra02, const ra02_daemon_config_t * cfg) {
+  switch (cfg->param) {
+    case RA02_DAEMON_PARAM_FREQ:      return ra02_set_freq(ra02, cfg->value);
+    case RA02_DAEMON_PARAM_POWER:     return ra02_set_power(ra02, cfg->value);
+    case RA02_DAEMON_PARAM_SF:        return ra02_set_sf(ra02, cfg->value);
+    case RA02_DAEMON_PARAM_BANDWIDTH: return ra02_set_bandwidth(ra02, cfg->value);
+    case RA02_DAEMON_PARAM_PREAMBLE:  return ra02_set_preamble(ra02, cfg->value);
+    case RA02_DAEMON_PARAM_SYNC_WORD: return ra02_set_sync_word(ra02, cfg->value);
+
+    case RA02_DAEMON_PARAM_CRC_RATE: {
+      ra02_frame_cfg_t frame = ra02->frame;
+      frame.crc_rate = cfg->value;
+      return ra02_set_frame_cfg(ra02, &frame);
+    }
+
+    default:
+      return E_INVAL;
+  }
+}
+
+static void ra02_daemon_handle_request(ra02_daemon_t * daemon, ra02_daemon_client_t * client) {
+  uint8_t payload[RA02_DAEMON_MAX_MESSAGE];
+  size_t size = sizeof(payload);
+  uint8_t type;
+  error_t status;
+
+  if (ra02_daemon_read(client->fd, &type, &status, payload, &size, 0) != E_OK) {
+    ra02_daemon_close_client(daemon, client);
+    return;
+  }
+
+  daemon->stats.requests++;
+
+  switch (type) {
+    case RA02_DAEMON_MSG_SEND:
+      status = size ? ra02_send(daemon->ra02, payload, size) : E_INVAL;
+
+      if (status == E_OK) {
+        daemon->stats.tx++;
+      } else {
+        daemon->stats.tx_failed++;
+      }
+
+      ra02_daemon_write(client->fd, type, status, NULL, 0);
+      break;
+
+    case RA02_DAEMON_MSG_RECV: {
+      uint32_t timeout_ms = 0;
+
+      if (size != sizeof(timeout_ms)) {
+        ra02_daemon_write(client->fd, type, E_INVAL, NULL, 0);
+        break;
+      }
+
+      memcpy(&timeout_ms, payload, sizeof(timeout_ms));
+      client->recv_deadline_ns = timeout_now_ns() + (uint64_t) timeout_ms * 1000000;
+      ra02_daemon_serve_recv(daemon, client);
+      break;
+    }
+
+    case RA02_DAEMON_MSG_SUBSCRIBE:
+      client->subscribed = true;
+      ra02_daemon_write(client->fd, type, E_OK, NULL, 0);
+      break;
+
+    case RA02_DAEMON_MSG_CONFIG: {
+      ra02_daemon_config_t cfg;
+
+      if (size == sizeof(cfg)) {
+        memcpy(&cfg, payload, sizeof(cfg));
+        status = ra02_daemon_config(daemon->ra02, &cfg);
+      } else {
+        status = E_INVAL;
+      }
+
+      ra02_daemon_write(client->fd, type, status, NULL, 0);
+      break;
+    }
+
+    case RA02_DAEMON_MSG_STATS:
+      daemon->stats.uptime_ms = (timeout_now_ns() - daemon->start_ns) / 1000000;
+      ra02_daemon_write(client->fd, type, E_OK, &daemon->stats, sizeof(daemon->stats));
+      break;
+
+    default:
+      ra02_daemon_write(client->fd, type, E_NOTIMPL, NULL, 0);
+      break;
+  }
+}
+
+/**
+ * Accept connections & handle requests, that are already waiting
+ */
+static void ra02_daemon_serve(ra02_daemon_t * daemon) {
+  struct pollfd fds[RA02_DAEMON_MAX_CLIENTS + 1];
+  uint64_t now_ns = timeout_now_ns();
+
+  fds[0] = (struct pollfd) {.fd = daemon->fd, .events = POLLIN};
+
+  for (size_t i = 0; i < RA02_DAEMON_MAX_CLIENTS; ++i) {
+    fds[i + 1] = (struct pollfd) {.fd = daemon->clients[i].fd, .events = POLLIN};
+  }
+
+  if (poll(fds, UTIL_ARR_SIZE(fds), 0) > 0) {
+    for (size_t i = 0; i < RA02_DAEMON_MAX_CLIENTS; ++i) {
+      if (fds[i + 1].revents & (POLLIN | POLLHUP | POLLERR)) {
+        ra02_daemon_handle_request(daemon, &daemon->clients[i]);
+      }
+    }
+
+    if (fds[0].revents & POLLIN) {
+      ra02_daemon_accept(daemon);
+    }
+  }
+
+  for (size_t i = 0; i < RA02_DAEMON_MAX_CLIENTS; ++i) {
+    ra02_daemon_client_t * client = &daemon->clients[i];
+
+    if (client->fd >= 0 && client->recv_deadline_ns && now_ns >= client->recv_deadline_ns) {
+      client->recv_deadline_ns = 0;
+      ra02_daemon_write(client->fd, RA02_DAEMON_MSG_RECV, E_TIMEOUT, NULL, 0);
+    }
+  }
+}
+
+/**
+ * Pass received frame to subscribers and to backlog
+ */
+static void ra02_daemon_dispatch(ra02_daemon_t * daemon, const ra02_daemon_packet_t * packet) {
+  if (daemon->backlog_count == RA02_DAEMON_BACKLOG_SIZE) {
+    /* Oldest frame is overwritten */
+    daemon->backlog_head = (daemon->backlog_head + 1) % RA02_DAEMON_BACKLOG_SIZE;
+    daemon->backlog_count--;
+    daemon->stats.rx_dropped++;
+  }
+
+  daemon->backlog[(daemon->backlog_head + daemon->backlog_count++) % RA02_DAEMON_BACKLOG_SIZE] = *packet;
+
+  for (size_t i = 0; i < RA02_DAEMON_MAX_CLIENTS; ++i) {
+    ra02_daemon_client_t * client = &daemon->clients[i];
+
+    if (client->fd < 0) {
+      continue;
+    }
+
+    if (client->subscribed) {
+      ra02_daemon_write(client->fd, RA02_DAEMON_MSG_PACKET, E_OK, packet, ra02_daemon_packet_size(packet));
+    }
+
+    if (client->recv_deadline_ns) {
+      ra02_daemon_serve_recv(daemon, client);
+    }
+  }
+}
+
+/**
+ * Client side request/response, frames pushed to subscription are skipped
+ */
+static error_t ra02_client_transact(int fd, uint8_t type, const void * req, size_t req_size,
+                                    void * resp, size_t * resp_size, int timeout_ms) {
+  uint8_t buf[RA02_DAEMON_MAX_MESSAGE];
+  size_t size = 0;
+  uint8_t resp_type = 0;
+  error_t status = E_OK;
+
+  ERROR_CHECK_RETURN(ra02_daemon_write(fd, type, E_OK, req, req_size));
+
+  while (resp_type != type) {
+    size = sizeof(buf);
+    ERROR_CHECK_RETURN(ra02_daemon_read(fd, &resp_type, &status, buf, &size, timeout_ms));
+  }
+
+  if (resp) {
+    ASSERT_RETURN(status != E_OK || size <= *resp_size, E_CORRUPT);
+    memcpy(resp, buf, size);
+    *resp_size = size;
+  }
+
+  return status;
+}
+
+/* Shared functions ========================================================= */
+const char * ra02_daemon_socket_path(void) {
+  const char * path = getenv("RA02_SOCKET");
+
+  return path ? path : RA02_DAEMON_DEFAULT_SOCKET;
+}
+
+error_t ra02_daemon_init(ra02_daemon_t * daemon, ra02_t * ra02, const char * path) {
+  ASSERT_RETURN(daemon && ra02 && path, E_NULL);
+
+  struct sockaddr_un addr;
+  ERROR_CHECK_RETURN(ra02_daemon_address(path, &addr));
+
+  memset(daemon, 0, sizeof(*daemon));
+
+  daemon->ra02 = ra02;
+  daemon->path = path;
+  daemon->start_ns = timeout_now_ns();
+
+  for (size_t i = 0; i < RA02_DAEMON_MAX_CLIENTS; ++i) {
+    daemon->clients[i].fd = -1;
+  }
+
+  /* Socket left by a crashed daemon is removed, live one is not touched */
+  int fd;
+
+  if (ra02_client_connect(path, &fd) == E_OK) {
+    ra02_client_disconnect(fd);
+    log_error("Daemon is already running on %s", path);
+    return E_BUSY;
+  }
+
+  unlink(path);
+
+  daemon->fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+  ASSERT_RETURN(daemon->fd >= 0, E_FAILED);
+
+  if (bind(daemon->fd, (struct sockaddr *) &addr, sizeof(addr))
+      || listen(daemon->fd, RA02_DAEMON_LISTEN_BACKLOG)) {
+    log_error("Can't listen on %s", path);
+    close(daemon->fd);
+    return E_FAILED;
+  }
+
+  log_debug("ra02_daemon_init: %s", path);
+
+  return E_OK;
+}
+
+error_t ra02_daemon_deinit(ra02_daemon_t * daemon) {
+  ASSERT_RETURN(daemon, E_NULL);
+
+  for (size_t i = 0; i < RA02_DAEMON_MAX_CLIENTS; ++i) {
+    if (daemon->clients[i].fd >= 0) {
+      ra02_daemon_close_client(daemon, &daemon->clients[i]);
+    }
+  }
+
+  close(daemon->fd);
+  unlink(daemon->path);
+
+  return E_OK;
+}
+
+error_t ra02_daemon_run(ra02_daemon_t * daemon) {
+  ASSERT_RETURN(daemon, E_NULL);
+
+  daemon->running = true;
+
+  while (daemon->running) {
+    ra02_daemon_serve(daemon);
+
+    TIMEOUT_CREATE(t, RA02_DAEMON_RX_SLICE_MS);
+
+    ra02_daemon_packet_t packet;
+    size_t size = sizeof(packet.data);
+    error_t err = ra02_recv(daemon->ra02, packet.data, &size, &t);
+
+    if (err == E_TIMEOUT) {
+      continue;
+    }
+
+    if (err == E_CORRUPT) {
+      daemon->stats.rx_bad++;
+      continue;
+    }
+
+    if (err != E_OK) {
+      log_error("ra02_recv: %s", error2str(err));
+      return err;
+    }
+
+    packet.rx_ns = daemon->ra02->last_rx_ns;
+    packet.rssi  = daemon->ra02->last_rssi;
+    packet.snr   = daemon->ra02->last_snr;
+    packet.size  = size;
+
+    daemon->stats.rx++;
+
+    ra02_daemon_dispatch(daemon, &packet);
+  }
+
+  return ra02_sleep(daemon->ra02);
+}
+
+void ra02_daemon_stop(ra02_daemon_t * daemon) {
+  daemon->running = false;
+}
+
+error_t ra02_client_connect(const char * path, int * fd) {
+  ASSERT_RETURN(path && fd, E_NULL);
+
+  struct sockaddr_un addr;
+  ERROR_CHECK_RETURN(ra02_daemon_address(path, &addr));
+
+  *fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+  ASSERT_RETURN(*fd >= 0, E_FAILED);
+
+  if (connect(*fd, (struct sockaddr *) &addr, sizeof(addr))) {
+    close(*fd);
+    *fd = -1;
+    return E_NOTFOUND;
+  }
+
+  return E_OK;
+}
+
+error_t ra02_client_disconnect(int fd) {
+  close(fd);
+
+  return E_OK;
+}
+
+error_t ra02_client_send(int fd, const uint8_t * buf, size_t size) {
+  ASSERT_RETURN(buf, E_NULL);
+  ASSERT_RETURN(size && size <= RA02_MAX_PACKET_SIZE, E_INVAL);
+
+  return ra02_client_transact(fd, RA02_DAEMON_MSG_SEND, buf, size, NULL, NULL, -1);
+}
+
+error_t ra02_client_recv(int fd, ra02_daemon_packet_t * packet, uint32_t timeout_ms) {
+  ASSERT_RETURN(packet, E_NULL);
+
+  size_t size = sizeof(*packet);
+
+  /* poll takes int, long timeouts are capped (~24 days) instead of wrapping negative */
+  int poll_ms = UTIL_MIN((uint64_t) timeout_ms + RA02_DAEMON_RECV_MARGIN_MS, INT_MAX);
+
+  return ra02_client_transact(fd, RA02_DAEMON_MSG_RECV, &timeout_ms, sizeof(timeout_ms), packet, &size, poll_ms);
+}
+
+error_t ra02_client_subscribe(int fd) {
+  return ra02_client_transact(fd, RA02_DAEMON_MSG_SUBSCRIBE, NULL, 0, NULL, NULL, -1);
+}
+
+error_t ra02_client_next(int fd, ra02_daemon_packet_t * packet, int timeout_ms) {
+  ASSERT_RETURN(packet, E_NULL);
+
+  uint8_t type = 0;
+  error_t status = E_OK;
+
+  while (type != RA02_DAEMON_MSG_PACKET) {
+    size_t size = sizeof(*packet);
+    ERROR_CHECK_RETURN(ra02_daemon_read(fd, &type, &status, packet, &size, timeout_ms));
+  }
+
+  return status;
+}
+
+error_t ra02_client_config(int fd, ra02_daemon_param_t param, uint32_t value) {
+  ra02_daemon_config_t cfg = {.param = param, .value = value};
+
+  return ra02_client_transact(fd, RA02_DAEMON_MSG_CONFIG, &cfg, sizeof(cfg), NULL, NULL, -1);
+}
+
+error_t ra02_client_stats(int fd, ra02_daemon_stats_t * stats) {
+  ASSERT_RETURN(stats, E_NULL);
+
+  size_t size = sizeof(*stats);
+
+  return ra02_client_transact(fd, RA02_DAEMON_MSG_STATS, NULL, 0, stats, &size, -1);
+}
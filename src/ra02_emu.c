@@ -0,0 +1,650 @@
+/** ========================================================================= *
+ *
+ * @file ra02_emu.c
+ * @date 17-10-2026
+ * @author Maksym Tkachuk <max.r.tkachuk@gmail.com>
+ *
+ *  ========================================================================= */
+
+/* Includes ================================================================= */
+#define _GNU_SOURCE /* pipe2 */
+#include <ra02_emu.h>
+#include <ra02.h>
+#include <ra02_regs.h>
+#include <timeout.h>
+#include <assertion.h>
+#include <util.h>
+#include <log.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <math.h>
+#include <linux/gpio.h>
+
+/* Defines ================================================================== */
+#define LOG_TAG EMU
+
+/** SX1278 silicon revision */
+#define RA02_EMU_VERSION        0x12
+
+/** Op mode bits in RegOpMode */
+#define RA02_EMU_OP_MODE_MASK   0x07
+
+/** Preamble symbols, that must be left for receiver to lock onto a frame */
+#define RA02_EMU_LOCK_SYMBOLS   4
+
+/** Explicit header length in symbols, after preamble */
+#define RA02_EMU_HEADER_SYMBOLS 8
+
+/** CAD duration in symbols */
+#define RA02_EMU_CAD_SYMBOLS    2
+
+/** Default simulated link quality */
+#define RA02_EMU_DEFAULT_RSSI   -60
+#define RA02_EMU_DEFAULT_SNR    10
+#define RA02_EMU_DEFAULT_NOISE  -120
+#define RA02_EMU_DEFAULT_POWER  17
+
+/** Same SF interferer weaker by this much doesn't corrupt frame (capture effect) */
+#define RA02_EMU_CAPTURE_DB     6
+
+/** Other SF interferer must be stronger by this much to corrupt frame */
+#define RA02_EMU_SF_REJECTION_DB 16
+
+/** RSSI register offset (LF port) */
+#define RA02_EMU_RSSI_OFFSET    164
+
+/* Macros =================================================================== */
+/* Exposed macros =========================================================== */
+/* Enums ==================================================================== */
+/**
+ * SX1278 op modes, as in RegOpMode
+ */
+typedef enum {
+  RA02_EMU_MODE_SLEEP         = 0,
+  RA02_EMU_MODE_STANDBY       = 1,
+  RA02_EMU_MODE_TX            = 3,
+  RA02_EMU_MODE_RX_CONTINUOUS = 5,
+  RA02_EMU_MODE_RX_SINGLE     = 6,
+  RA02_EMU_MODE_CAD           = 7,
+} ra02_emu_mode_t;
+
+/* Types ==================================================================== */
+/* Variables ================================================================ */
+/**
+ * LoRa bandwidth values in Hz, indexed by MODEM_CFG_1 BW bits
+ */
+static const uint32_t ra02_emu_bandwidth_hz[] = {
+    7800, 10400, 15600, 20800, 31250, 41700, 62500, 125000, 250000, 500000,
+};
+
+/* Private functions ======================================================== */
+static uint8_t ra02_emu_mode(ra02_emu_t * emu) {
+  return emu->regs[RA02_REG_OP_MODE] & RA02_EMU_OP_MODE_MASK;
+}
+
+static void ra02_emu_set_mode(ra02_emu_t * emu, ra02_emu_mode_t mode) {
+  emu->regs[RA02_REG_OP_MODE] = (emu->regs[RA02_REG_OP_MODE] & ~RA02_EMU_OP_MODE_MASK) | mode;
+}
+
+static uint8_t ra02_emu_sf(ra02_emu_t * emu) {
+  return emu->regs[RA02_LORA_REG_MODEM_CFG_2] >> 4;
+}
+
+static uint8_t ra02_emu_bw(ra02_emu_t * emu) {
+  return emu->regs[RA02_LORA_REG_MODEM_CFG_1] >> 4;
+}
+
+static uint32_t ra02_emu_frf(ra02_emu_t * emu) {
+  return (emu->regs[RA02_REG_FRF_MSB] << 16) | (emu->regs[RA02_REG_FRF_MID] << 8) | emu->regs[RA02_REG_FRF_LSB];
+}
+
+static uint32_t ra02_emu_bandwidth_hz_of(uint8_t bw) {
+  return ra02_emu_bandwidth_hz[UTIL_MIN(bw, UTIL_ARR_SIZE(ra02_emu_bandwidth_hz) - 1)];
+}
+
+static uint64_t ra02_emu_symbol_ns(uint8_t sf, uint8_t bw) {
+  return (1000000000ULL << sf) / ra02_emu_bandwidth_hz_of(bw);
+}
+
+/**
+ * Whether frame is on the channel emulated radio is tuned to
+ */
+static bool ra02_emu_matches(ra02_emu_t * emu, const ra02_emu_frame_t * frame) {
+  return frame->sender != emu
+      && frame->frf == ra02_emu_frf(emu)
+      && frame->sf == ra02_emu_sf(emu)
+      && frame->bw == ra02_emu_bw(emu)
+      && frame->sync_word == emu->regs[RA02_LORA_REG_SYNC_WORD];
+}
+
+/**
+ * Power of frame at emulated radio in dBm
+ */
+static int16_t ra02_emu_frame_rssi(ra02_emu_t * emu, const ra02_emu_frame_t * frame) {
+  if (!emu->air->path_loss) {
+    return emu->rssi;
+  }
+
+  return frame->power - lroundf(emu->air->path_loss(emu->air->ctx, frame->sender, emu));
+}
+
+/**
+ * Whether frame is strong enough to be demodulated: SNR floor is -7.5 dB
+ * at SF7 and 2.5 dB lower per SF step
+ */
+static bool ra02_emu_audible(ra02_emu_t * emu, const ra02_emu_frame_t * frame) {
+  return ra02_emu_frame_rssi(emu, frame) - emu->noise >= -5.0f - 2.5f * (frame->sf - 6);
+}
+
+/**
+ * Set IRQ flags and emit edges on DIO lines they are mapped to
+ */
+static void ra02_emu_raise(ra02_emu_t * emu, uint8_t flags, uint64_t at_ns) {
+  /* DIO0: 00 - RX_DONE, 01 - TX_DONE, 10 - CAD_DONE; DIO1: 00 - RX_TIMEOUT, 10 - CAD_DETECTED */
+  static const uint8_t dio_flags[RA02_EMU_DIO_COUNT][4] = {
+    {RA02_LORA_IRQ_FLAGS_RX_DONE, RA02_LORA_IRQ_FLAGS_TX_DONE, RA02_LORA_IRQ_FLAGS_CAD_DONE, 0},
+    {RA02_LORA_IRQ_FLAGS_RX_TIMEOUT, RA02_LORA_IRQ_FLAGS_FHSS_CHANGE_CH, RA02_LORA_IRQ_FLAGS_CAD_DETECTED, 0},
+  };
+
+  uint8_t mapping = emu->regs[RA02_REG_DIO_MAP_1];
+
+  emu->regs[RA02_LORA_REG_IRQ_FLAGS] |= flags;
+
+  for (size_t i = 0; i < RA02_EMU_DIO_COUNT; ++i) {
+    uint8_t mapped = dio_flags[i][(mapping >> (6 - 2 * i)) & 0x03];
+
+    if (emu->dio_fd[i] >= 0 && (flags & mapped)) {
+      struct gpio_v2_line_event event = {
+        .timestamp_ns = at_ns,
+        .id = GPIO_V2_LINE_EVENT_RISING_EDGE,
+        .offset = i,
+      };
+
+      if (write(emu->dio_fd[i], &event, sizeof(event)) != sizeof(event)) {
+        log_warn("dio%d: event dropped", i);
+      }
+    }
+  }
+}
+
+/**
+ * Put frame from FIFO on air, returns TX end time
+ */
+static uint64_t ra02_emu_transmit(ra02_emu_t * emu, uint64_t now) {
+  uint8_t cfg_1 = emu->regs[RA02_LORA_REG_MODEM_CFG_1];
+
+  /* Reuse driver's time on air calculation with emulated configuration */
+  ra02_t model = {
+    .modem = RA02_MODEM_LORA,
+    .sf = ra02_emu_sf(emu),
+    .bandwidth = ra02_emu_bandwidth_hz_of(ra02_emu_bw(emu)),
+    .preamble = (emu->regs[RA02_LORA_REG_PREAMBLE_MSB] << 8) | emu->regs[RA02_LORA_REG_PREAMBLE_LSB],
+    .frame = {
+      .implicit_header = cfg_1 & RA02_LORA_MODEM_CFG_1_IMPLICIT_HDR,
+      .crc_rate = (cfg_1 & RA02_LORA_MODEM_CFG_1_CR_MASK) >> 1,
+      .crc = emu->regs[RA02_LORA_REG_MODEM_CFG_2] & RA02_LORA_MODEM_CFG_2_RX_CRC_ON,
+    },
+  };
+
+  uint32_t airtime_us = 0;
+  ra02_get_time_on_air(&model, emu->regs[RA02_LORA_REG_PAYLOAD_LEN], &airtime_us);
+
+  uint64_t symbol_ns = ra02_emu_symbol_ns(model.sf, ra02_emu_bw(emu));
+
+  pthread_mutex_lock(&emu->air->lock);
+
+  ra02_emu_frame_t * frame = &emu->air->frames[emu->air->count % RA02_EMU_MAX_FRAMES];
+
+  frame->start_ns = now;
+  frame->preamble_ns = now + (model.preamble * 4 + 17) * symbol_ns / 4;
+  frame->end_ns = now + airtime_us * 1000ULL;
+  frame->frf = ra02_emu_frf(emu);
+  frame->sf = model.sf;
+  frame->bw = ra02_emu_bw(emu);
+  frame->sync_word = emu->regs[RA02_LORA_REG_SYNC_WORD];
+  frame->size = emu->regs[RA02_LORA_REG_PAYLOAD_LEN];
+  frame->power = emu->power;
+  frame->sender = emu;
+
+  for (size_t i = 0; i < frame->size; ++i) {
+    frame->data[i] = emu->fifo[(uint8_t) (emu->regs[RA02_LORA_REG_FIFO_TX_BASE_ADDR] + i)];
+  }
+
+  emu->air->count++;
+
+  pthread_mutex_unlock(&emu->air->lock);
+
+  log_debug("tx: %d bytes, sf %d, %d us", frame->size, frame->sf, airtime_us);
+
+  return frame->end_ns;
+}
+
+/**
+ * Find frame, that receiver can lock onto, returns index + 1 or 0
+ * Air must be locked
+ */
+static uint64_t ra02_emu_find_frame(ra02_emu_t * emu, uint64_t now, uint64_t deadline) {
+  uint64_t first = emu->air->count > RA02_EMU_MAX_FRAMES ? emu->air->count - RA02_EMU_MAX_FRAMES : 0;
+  uint64_t lock_ns = RA02_EMU_LOCK_SYMBOLS * ra02_emu_symbol_ns(ra02_emu_sf(emu), ra02_emu_bw(emu));
+  uint64_t found = 0;
+
+  for (uint64_t i = first; i < emu->air->count; ++i) {
+    ra02_emu_frame_t * frame = &emu->air->frames[i % RA02_EMU_MAX_FRAMES];
+
+    if (ra02_emu_matches(emu, frame)
+        && frame->start_ns <= UTIL_MIN(now, deadline)
+        && frame->preamble_ns >= emu->mode_start_ns + lock_ns
+        && ra02_emu_audible(emu, frame)
+        && (!found || frame->start_ns < emu->air->frames[(found - 1) % RA02_EMU_MAX_FRAMES].start_ns)) {
+      found = i + 1;
+    }
+  }
+
+  return found;
+}
+
+/**
+ * Whether frame is corrupted by other frames overlapping with it on the same
+ * channel: same SF ones must be weaker by capture threshold, other SF ones
+ * are rejected unless much stronger
+ * Air must be locked
+ */
+static bool ra02_emu_collides(ra02_emu_t * emu, uint64_t index) {
+  uint64_t first = emu->air->count > RA02_EMU_MAX_FRAMES ? emu->air->count - RA02_EMU_MAX_FRAMES : 0;
+  ra02_emu_frame_t * frame = &emu->air->frames[index % RA02_EMU_MAX_FRAMES];
+  int16_t power = ra02_emu_frame_rssi(emu, frame);
+
+  for (uint64_t i = first; i < emu->air->count; ++i) {
+    ra02_emu_frame_t * other = &emu->air->frames[i % RA02_EMU_MAX_FRAMES];
+
+    if (i == index || other->sender == emu || other->frf != frame->frf || other->bw != frame->bw
+        || other->start_ns >= frame->end_ns || other->end_ns <= frame->start_ns) {
+      continue;
+    }
+
+    int16_t interference = ra02_emu_frame_rssi(emu, other);
+
+    if (other->sf == frame->sf ? interference > power - RA02_EMU_CAPTURE_DB
+                               : interference > power + RA02_EMU_SF_REJECTION_DB) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/**
+ * Whether there is a preamble on channel during whole CAD window
+ * Air must be locked
+ */
+static bool ra02_emu_cad(ra02_emu_t * emu) {
+  uint64_t first = emu->air->count > RA02_EMU_MAX_FRAMES ? emu->air->count - RA02_EMU_MAX_FRAMES : 0;
+
+  for (uint64_t i = first; i < emu->air->count; ++i) {
+    ra02_emu_frame_t * frame = &emu->air->frames[i % RA02_EMU_MAX_FRAMES];
+
+    if (ra02_emu_matches(emu, frame) && ra02_emu_audible(emu, frame)
+        && frame->start_ns <= emu->mode_start_ns && frame->preamble_ns >= emu->mode_end_ns) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/**
+ * Current RSSI at tuned frequency: power of the strongest frame on air, noise floor if it's idle
+ * Air must be locked
+ */
+static int8_t ra02_emu_channel_rssi(ra02_emu_t * emu, uint64_t now) {
+  uint64_t first = emu->air->count > RA02_EMU_MAX_FRAMES ? emu->air->count - RA02_EMU_MAX_FRAMES : 0;
+  int16_t rssi = emu->noise;
+
+  for (uint64_t i = first; i < emu->air->count; ++i) {
+    ra02_emu_frame_t * frame = &emu->air->frames[i % RA02_EMU_MAX_FRAMES];
+
+    if (frame->sender != emu && frame->frf == ra02_emu_frf(emu) && frame->start_ns <= now && now < frame->end_ns) {
+      rssi = UTIL_MAX(rssi, ra02_emu_frame_rssi(emu, frame));
+    }
+  }
+
+  return UTIL_CAP(rssi, INT8_MIN, INT8_MAX);
+}
+
+/**
+ * Deliver received frame into FIFO and set IRQ flags
+ * Air must be locked
+ */
+static void ra02_emu_deliver(ra02_emu_t * emu, uint64_t index) {
+  ra02_emu_frame_t * frame = &emu->air->frames[index % RA02_EMU_MAX_FRAMES];
+  uint8_t base = emu->regs[RA02_LORA_REG_FIFO_RX_BASE_ADDR];
+  int16_t rssi = UTIL_CAP(ra02_emu_frame_rssi(emu, frame), -RA02_EMU_RSSI_OFFSET, INT8_MAX);
+  int8_t snr = emu->air->path_loss ? UTIL_CAP(rssi - emu->noise, -32, 31) : emu->snr;
+
+  for (size_t i = 0; i < frame->size; ++i) {
+    emu->fifo[(uint8_t) (base + i)] = frame->data[i];
+  }
+
+  emu->regs[RA02_LORA_REG_FIFO_RX_CURRENT_ADDR] = base;
+  emu->regs[RA02_LORA_REG_RX_NB_BYTES] = frame->size;
+  emu->regs[RA02_LORA_REG_LAST_PKT_RSSI_VAL] = rssi + RA02_EMU_RSSI_OFFSET;
+  emu->regs[RA02_LORA_REG_RSSI_VAL] = rssi + RA02_EMU_RSSI_OFFSET;
+  emu->regs[RA02_LORA_REG_LAST_PKT_SNR] = (uint8_t) (snr * 4);
+  ra02_emu_raise(emu, RA02_LORA_IRQ_FLAGS_VALID_HDR | RA02_LORA_IRQ_FLAGS_RX_DONE
+                 | (ra02_emu_collides(emu, index) ? RA02_LORA_IRQ_FLAGS_PAYLOAD_CRC_ERR : 0), frame->end_ns);
+
+  log_debug("rx: %d bytes, sf %d", frame->size, frame->sf);
+}
+
+/**
+ * Advance emulated modem state up to current time, air is observed with
+ * its latency
+ */
+static void ra02_emu_update(ra02_emu_t * emu, uint64_t now) {
+  if (!(emu->regs[RA02_REG_OP_MODE] & RA02_OP_MODE_LORA_PREFIX)) {
+    return;
+  }
+
+  uint64_t at = now > emu->air->latency_ns ? now - emu->air->latency_ns : 0;
+
+  emu->regs[RA02_LORA_REG_MODEM_STAT] = RA02_LORA_MODEM_STAT_CLEAR;
+
+  switch (ra02_emu_mode(emu)) {
+    case RA02_EMU_MODE_TX:
+      if (now >= emu->mode_end_ns) {
+        ra02_emu_raise(emu, RA02_LORA_IRQ_FLAGS_TX_DONE, emu->mode_end_ns);
+        ra02_emu_set_mode(emu, RA02_EMU_MODE_STANDBY);
+      }
+      break;
+
+    case RA02_EMU_MODE_CAD:
+      if (at >= emu->mode_end_ns) {
+        pthread_mutex_lock(&emu->air->lock);
+        bool detected = ra02_emu_cad(emu);
+        pthread_mutex_unlock(&emu->air->lock);
+
+        ra02_emu_raise(emu, RA02_LORA_IRQ_FLAGS_CAD_DONE | (detected ? RA02_LORA_IRQ_FLAGS_CAD_DETECTED : 0),
+                       emu->mode_end_ns);
+        ra02_emu_set_mode(emu, RA02_EMU_MODE_STANDBY);
+      }
+      break;
+
+    case RA02_EMU_MODE_RX_SINGLE:
+    case RA02_EMU_MODE_RX_CONTINUOUS: {
+      bool single = ra02_emu_mode(emu) == RA02_EMU_MODE_RX_SINGLE;
+
+      pthread_mutex_lock(&emu->air->lock);
+
+      emu->regs[RA02_LORA_REG_RSSI_VAL] = ra02_emu_channel_rssi(emu, at) + RA02_EMU_RSSI_OFFSET;
+      /* Wideband RSSI is noise, that is only good as random source */
+      emu->regs[RA02_LORA_REG_RSSI_WIDEBAND] = (uint8_t) (now ^ (now >> 8) ^ (now >> 16));
+
+      if (!emu->rx_frame) {
+        emu->rx_frame = ra02_emu_find_frame(emu, at, single ? emu->mode_end_ns : UINT64_MAX);
+        emu->rx_header = false;
+      }
+
+      if (emu->rx_frame) {
+        ra02_emu_frame_t * frame = &emu->air->frames[(emu->rx_frame - 1) % RA02_EMU_MAX_FRAMES];
+        uint64_t header_ns = frame->preamble_ns
+                           + RA02_EMU_HEADER_SYMBOLS * ra02_emu_symbol_ns(frame->sf, frame->bw);
+
+        /* Header is received well before frame end, so VALID_HDR is raised separately, once per frame */
+        if (at >= header_ns && at < frame->end_ns && !emu->rx_header
+            && !(emu->regs[RA02_LORA_REG_MODEM_CFG_1] & RA02_LORA_MODEM_CFG_1_IMPLICIT_HDR)) {
+          ra02_emu_raise(emu, RA02_LORA_IRQ_FLAGS_VALID_HDR, header_ns);
+          emu->rx_header = true;
+        }
+
+        emu->regs[RA02_LORA_REG_MODEM_STAT] = RA02_LORA_MODEM_STAT_DETECTED
+            | (at >= frame->preamble_ns ? RA02_LORA_MODEM_STAT_SYNCHRONIZED | RA02_LORA_MODEM_STAT_RX_ONGOING : 0)
+            | (at >= header_ns ? RA02_LORA_MODEM_STAT_HEADER_VALID : 0);
+
+        if (at >= frame->end_ns) {
+          emu->regs[RA02_LORA_REG_MODEM_STAT] = RA02_LORA_MODEM_STAT_CLEAR;
+          ra02_emu_deliver(emu, emu->rx_frame - 1);
+          emu->rx_frame = 0;
+          emu->mode_start_ns = at;
+
+          if (single) {
+            ra02_emu_set_mode(emu, RA02_EMU_MODE_STANDBY);
+          }
+        }
+      } else if (single && at >= emu->mode_end_ns) {
+        ra02_emu_raise(emu, RA02_LORA_IRQ_FLAGS_RX_TIMEOUT, emu->mode_end_ns);
+        ra02_emu_set_mode(emu, RA02_EMU_MODE_STANDBY);
+      }
+
+      pthread_mutex_unlock(&emu->air->lock);
+      break;
+    }
+
+    default:
+      break;
+  }
+}
+
+/**
+ * Handle write to RegOpMode
+ */
+static void ra02_emu_enter_mode(ra02_emu_t * emu, uint8_t value, uint64_t now) {
+  emu->regs[RA02_REG_OP_MODE] = value;
+  emu->mode_start_ns = now;
+  emu->rx_frame = 0;
+
+  if (!(value & RA02_OP_MODE_LORA_PREFIX)) {
+    return;
+  }
+
+  uint64_t symbol_ns = ra02_emu_symbol_ns(ra02_emu_sf(emu), ra02_emu_bw(emu));
+
+  switch (ra02_emu_mode(emu)) {
+    case RA02_EMU_MODE_TX:
+      emu->mode_end_ns = ra02_emu_transmit(emu, now);
+      break;
+
+    case RA02_EMU_MODE_CAD:
+      emu->mode_end_ns = now + RA02_EMU_CAD_SYMBOLS * symbol_ns;
+      break;
+
+    case RA02_EMU_MODE_RX_SINGLE: {
+      uint16_t symbols = ((emu->regs[RA02_LORA_REG_MODEM_CFG_2] & RA02_LORA_MODEM_CFG_2_SYMB_TIMEOUT_MASK) << 8)
+                         | emu->regs[RA02_LORA_REG_SYMB_TIMEOUT_LSB];
+      emu->mode_end_ns = now + symbols * symbol_ns;
+      break;
+    }
+
+    default:
+      emu->mode_end_ns = UINT64_MAX;
+      break;
+  }
+}
+
+static uint8_t ra02_emu_read(ra02_emu_t * emu, uint8_t addr) {
+  if (addr == RA02_REG_FIFO) {
+    return emu->fifo[emu->regs[RA02_LORA_REG_FIFO_ADDR_PTR]++];
+  }
+
+  return emu->regs[addr];
+}
+
+static void ra02_emu_write(ra02_emu_t * emu, uint8_t addr, uint8_t value, uint64_t now) {
+  switch (addr) {
+    case RA02_REG_FIFO:
+      emu->fifo[emu->regs[RA02_LORA_REG_FIFO_ADDR_PTR]++] = value;
+      break;
+
+    case RA02_REG_OP_MODE:
+      ra02_emu_enter_mode(emu, value, now);
+      break;
+
+    case RA02_LORA_REG_IRQ_FLAGS:
+      /* Flags are cleared by writing 1 */
+      emu->regs[addr] &= ~value;
+      break;
+
+    case RA02_REG_VERSION:
+      break;
+
+    default:
+      emu->regs[addr] = value;
+      break;
+  }
+}
+
+/* Shared functions ========================================================= */
+error_t ra02_emu_air_init(ra02_emu_air_t * air) {
+  ASSERT_RETURN(air, E_NULL);
+
+  memset(air, 0, sizeof(*air));
+
+  return pthread_mutex_init(&air->lock, NULL) ? E_FAILED : E_OK;
+}
+
+error_t ra02_emu_air_deinit(ra02_emu_air_t * air) {
+  ASSERT_RETURN(air, E_NULL);
+
+  pthread_mutex_destroy(&air->lock);
+
+  return E_OK;
+}
+
+error_t ra02_emu_init(ra02_emu_t * emu, ra02_emu_air_t * air, spi_t * spi) {
+  ASSERT_RETURN(emu && air && spi, E_NULL);
+
+  memset(emu, 0, sizeof(*emu));
+
+  emu->air = air;
+  emu->rssi = RA02_EMU_DEFAULT_RSSI;
+  emu->snr = RA02_EMU_DEFAULT_SNR;
+  emu->noise = RA02_EMU_DEFAULT_NOISE;
+  emu->power = RA02_EMU_DEFAULT_POWER;
+  emu->mode_end_ns = UINT64_MAX;
+
+  for (size_t i = 0; i < RA02_EMU_DIO_COUNT; ++i) {
+    emu->dio_fd[i] = -1;
+  }
+
+  /* Reset values from datasheet */
+  emu->regs[RA02_REG_OP_MODE] = RA02_EMU_MODE_STANDBY;
+  emu->regs[RA02_REG_VERSION] = RA02_EMU_VERSION;
+  emu->regs[RA02_LORA_REG_FIFO_TX_BASE_ADDR] = 0x80;
+  emu->regs[RA02_LORA_REG_FIFO_RX_BASE_ADDR] = 0x00;
+  emu->regs[RA02_LORA_REG_MODEM_CFG_1] = 0x72;
+  emu->regs[RA02_LORA_REG_MODEM_CFG_2] = 0x70;
+  emu->regs[RA02_LORA_REG_SYMB_TIMEOUT_LSB] = 0x64;
+  emu->regs[RA02_LORA_REG_PREAMBLE_LSB] = 0x08;
+  emu->regs[RA02_LORA_REG_PAYLOAD_LEN] = 0x01;
+  emu->regs[RA02_LORA_REG_SYNC_WORD] = 0x12;
+
+  memset(spi, 0, sizeof(*spi));
+  spi->fd = -1;
+  spi->transfer = ra02_emu_transfer;
+  spi->ctx = emu;
+
+  return E_OK;
+}
+
+error_t ra02_emu_deinit(ra02_emu_t * emu) {
+  ASSERT_RETURN(emu, E_NULL);
+
+  for (size_t i = 0; i < RA02_EMU_DIO_COUNT; ++i) {
+    if (emu->dio_fd[i] >= 0) {
+      close(emu->dio_fd[i]);
+      emu->dio_fd[i] = -1;
+    }
+  }
+
+  return E_OK;
+}
+
+error_t ra02_emu_dio_init(ra02_emu_t * emu, uint8_t dio, gpio_t * gpio) {
+  ASSERT_RETURN(emu && gpio, E_NULL);
+  ASSERT_RETURN(dio < RA02_EMU_DIO_COUNT && emu->dio_fd[dio] < 0, E_INVAL);
+
+  int fds[2];
+
+  if (pipe2(fds, O_NONBLOCK | O_CLOEXEC) < 0) {
+    return E_FAILED;
+  }
+
+  gpio->fd = fds[0];
+  gpio->line = dio;
+  emu->dio_fd[dio] = fds[1];
+
+  return E_OK;
+}
+
+uint64_t ra02_emu_next_event_ns(ra02_emu_t * emu) {
+  ASSERT_RETURN(emu, UINT64_MAX);
+
+  if (!(emu->regs[RA02_REG_OP_MODE] & RA02_OP_MODE_LORA_PREFIX)) {
+    return UINT64_MAX;
+  }
+
+  uint64_t next = UINT64_MAX;
+
+  switch (ra02_emu_mode(emu)) {
+    case RA02_EMU_MODE_TX:
+      return emu->mode_end_ns;
+
+    case RA02_EMU_MODE_CAD:
+      next = emu->mode_end_ns;
+      break;
+
+    case RA02_EMU_MODE_RX_SINGLE:
+    case RA02_EMU_MODE_RX_CONTINUOUS:
+      pthread_mutex_lock(&emu->air->lock);
+
+      if (emu->rx_frame) {
+        ra02_emu_frame_t * frame = &emu->air->frames[(emu->rx_frame - 1) % RA02_EMU_MAX_FRAMES];
+        uint64_t header_ns = frame->preamble_ns + RA02_EMU_HEADER_SYMBOLS * ra02_emu_symbol_ns(frame->sf, frame->bw);
+
+        next = header_ns + emu->air->latency_ns > timeout_now_ns() ? header_ns : frame->end_ns;
+      } else if (ra02_emu_mode(emu) == RA02_EMU_MODE_RX_SINGLE) {
+        next = emu->mode_end_ns;
+      }
+
+      pthread_mutex_unlock(&emu->air->lock);
+      break;
+
+    default:
+      return UINT64_MAX;
+  }
+
+  /* Air dependent events are observed with latency */
+  return next < UINT64_MAX - emu->air->latency_ns ? next + emu->air->latency_ns : UINT64_MAX;
+}
+
+error_t ra02_emu_transfer(void * ctx, uint8_t * tx_buf, uint8_t * rx_buf, size_t size) {
+  ra02_emu_t * emu = ctx;
+
+  ASSERT_RETURN(emu && tx_buf, E_NULL);
+  ASSERT_RETURN(size, E_INVAL);
+
+  uint64_t now = timeout_now_ns();
+  uint8_t addr = tx_buf[0] & 0x7F;
+  bool write = tx_buf[0] & 0x80;
+
+  ra02_emu_update(emu, now);
+
+  if (rx_buf) {
+    rx_buf[0] = 0;
+  }
+
+  for (size_t i = 1; i < size; ++i) {
+    if (write) {
+      ra02_emu_write(emu, addr, tx_buf[i], now);
+    } else if (rx_buf) {
+      rx_buf[i] = ra02_emu_read(emu, addr);
+    }
+
+    /* Burst access auto-increments address, except for FIFO */
+    if (addr != RA02_REG_FIFO) {
+      addr = (addr + 1) % RA02_EMU_REG_COUNT;
+    }
+  }
+
+  return E_OK;
+}
@@ -0,0 +1,897 @@
+/** ========================================================================= *
+ *
+ * @file ra02_fwd.c
+ * @date 17-10-2026
+ * @author Maksym Tkachuk <max.r.tkachuk@gmail.com>
+ *
+ *  ========================================================================= */
+
+/* Includes ================================================================= */
+#include <ra02_fwd.h>
+#include <assertion.h>
+#include <util.h>
+#include <log.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <time.h>
+#include <poll.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/eventfd.h>
+
+/* Defines ================================================================== */
+#define LOG_TAG FWD
+
+/** Defaults */
+#define RA02_FWD_DEFAULT_KEEPALIVE_MS 10000
+#define RA02_FWD_DEFAULT_STAT_MS      30000
+#define RA02_FWD_DEFAULT_RX_SLICE_MS  50
+#define RA02_FWD_DEFAULT_TX_LEAD_MS   30
+
+/** Downlinks scheduled further ahead are refused with TOO_EARLY */
+#define RA02_FWD_TX_MAX_AHEAD_MS      10000
+
+/** Max output power (PA_BOOST) */
+#define RA02_FWD_MAX_POWER            20
+
+/** Downlink frequency range of RA-02 */
+#define RA02_FWD_MIN_FREQ_KHZ         410000
+#define RA02_FWD_MAX_FREQ_KHZ         525000
+
+/** Downlink SF range (SF6 requires implicit header, that txpk can't describe) */
+#define RA02_FWD_MIN_SF               7
+#define RA02_FWD_MAX_SF               12
+
+/** Header sizes: [version] [token, 2 bytes] [type] and gateway EUI on upstream packets */
+#define RA02_FWD_HEADER_SIZE          4
+#define RA02_FWD_EUI_HEADER_SIZE      (RA02_FWD_HEADER_SIZE + 8)
+
+/** Max UDP datagram */
+#define RA02_FWD_DATAGRAM_SIZE        4096
+
+/** Max frames in a single PUSH_DATA, fits datagram with max size frames */
+#define RA02_FWD_MAX_RXPK_PER_PUSH    4
+
+/** Max size of base64 encoded frame */
+#define RA02_FWD_BASE64_SIZE          (4 * ((RA02_MAX_PACKET_SIZE + 2) / 3) + 1)
+
+/* Macros =================================================================== */
+#define RA02_FWD_MS_TO_NS(ms) ((uint64_t) (ms) * 1000000ULL)
+
+/* Exposed macros =========================================================== */
+/* Enums ==================================================================== */
+/* Types ==================================================================== */
+/* Variables ================================================================ */
+static const char ra02_fwd_base64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+/* Private functions ======================================================== */
+static size_t ra02_fwd_base64_encode(const uint8_t * buf, size_t size, char * out) {
+  size_t len = 0;
+
+  for (size_t i = 0; i < size; i += 3) {
+    uint32_t word = (uint32_t) buf[i] << 16
+                  | (i + 1 < size ? (uint32_t) buf[i + 1] << 8 : 0)
+                  | (i + 2 < size ? buf[i + 2] : 0);
+
+    out[len++] = ra02_fwd_base64[(word >> 18) & 0x3F];
+    out[len++] = ra02_fwd_base64[(word >> 12) & 0x3F];
+    out[len++] = i + 1 < size ? ra02_fwd_base64[(word >> 6) & 0x3F] : '=';
+    out[len++] = i + 2 < size ? ra02_fwd_base64[word & 0x3F] : '=';
+  }
+
+  out[len] = '\0';
+
+  return len;
+}
+
+static error_t ra02_fwd_base64_decode(const char * str, uint8_t * buf, size_t * size) {
+  uint32_t word = 0;
+  size_t bits = 0;
+  size_t len = 0;
+
+  for (; *str && *str != '='; ++str) {
+    const char * pos = strchr(ra02_fwd_base64, *str);
+    ASSERT_RETURN(pos, E_CORRUPT);
+
+    word = (word << 6) | (pos - ra02_fwd_base64);
+    bits += 6;
+
+    if (bits >= 8) {
+      bits -= 8;
+      ASSERT_RETURN(len < *size, E_OVERFLOW);
+      buf[len++] = word >> bits;
+    }
+  }
+
+  *size = len;
+
+  return E_OK;
+}
+
+/**
+ * Find value of a key in flat JSON object. Only enough to read txpk
+ */
+static const char * ra02_fwd_json_find(const char * json, const char * key) {
+  size_t key_len = strlen(key);
+
+  for (const char * p = strchr(json, '"'); p; p = strchr(p + 1, '"')) {
+    if (strncmp(p + 1, key, key_len) || p[key_len + 1] != '"') {
+      continue;
+    }
+
+    const char * value = p + key_len + 2;
+    value += strspn(value, " \t\r\n");
+
+    if (*value == ':') {
+      return value + 1 + strspn(value + 1, " \t\r\n");
+    }
+  }
+
+  return NULL;
+}
+
+static error_t ra02_fwd_json_number(const char * json, const char * key, double * value) {
+  const char * str = ra02_fwd_json_find(json, key);
+  ASSERT_RETURN(str, E_NOTFOUND);
+
+  char * end;
+  *value = strtod(str, &end);
+
+  return end == str ? E_INVAL : E_OK;
+}
+
+static bool ra02_fwd_json_bool(const char * json, const char * key) {
+  const char * str = ra02_fwd_json_find(json, key);
+
+  return str && !strncmp(str, "true", 4);
+}
+
+static error_t ra02_fwd_json_string(const char * json, const char * key, char * out, size_t size) {
+  const char * str = ra02_fwd_json_find(json, key);
+  ASSERT_RETURN(str, E_NOTFOUND);
+  ASSERT_RETURN(*str == '"', E_INVAL);
+
+  const char * end = strchr(str + 1, '"');
+  ASSERT_RETURN(end, E_INVAL);
+  ASSERT_RETURN((size_t) (end - str - 1) < size, E_OVERFLOW);
+
+  memcpy(out, str + 1, end - str - 1);
+  out[end - str - 1] = '\0';
+
+  return E_OK;
+}
+
+static size_t ra02_fwd_header(ra02_fwd_t * fwd, uint8_t * buf, uint16_t token, ra02_fwd_packet_type_t type) {
+  buf[0] = RA02_FWD_PROTOCOL_VERSION;
+  buf[1] = token >> 8;
+  buf[2] = token;
+  buf[3] = type;
+
+  if (type == RA02_FWD_PUSH_ACK || type == RA02_FWD_PULL_RESP || type == RA02_FWD_PULL_ACK) {
+    return RA02_FWD_HEADER_SIZE;
+  }
+
+  for (size_t i = 0; i < 8; ++i) {
+    buf[RA02_FWD_HEADER_SIZE + i] = fwd->cfg.gateway_eui >> (56 - 8 * i);
+  }
+
+  return RA02_FWD_EUI_HEADER_SIZE;
+}
+
+static error_t ra02_fwd_open_socket(const char * host, uint16_t port, int * fd) {
+  struct addrinfo hints = {.ai_family = AF_UNSPEC, .ai_socktype = SOCK_DGRAM};
+  struct addrinfo * result;
+  char service[8];
+
+  snprintf(service, sizeof(service), "%u", port);
+
+  if (getaddrinfo(host, service, &hints, &result)) {
+    log_error("Can't resolve %s:%s", host, service);
+    return E_NOTFOUND;
+  }
+
+  *fd = -1;
+
+  for (struct addrinfo * ai = result; ai && *fd < 0; ai = ai->ai_next) {
+    *fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+
+    if (*fd >= 0 && connect(*fd, ai->ai_addr, ai->ai_addrlen)) {
+      close(*fd);
+      *fd = -1;
+    }
+  }
+
+  freeaddrinfo(result);
+
+  return *fd < 0 ? E_FAILED : E_OK;
+}
+
+static void ra02_fwd_wake(ra02_fwd_t * fwd) {
+  uint64_t one = 1;
+
+  /* Counter just can't overflow here, so result doesn't matter */
+  (void) !write(fwd->wake_fd, &one, sizeof(one));
+}
+
+/**
+ * Format UTC time of CLOCK_MONOTONIC instant
+ */
+static void ra02_fwd_format_time(uint64_t mono_ns, const char * fmt, char * out, size_t size) {
+  struct timespec ts;
+  clock_gettime(CLOCK_REALTIME, &ts);
+
+  uint64_t real_ns = (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec - (timeout_now_ns() - mono_ns);
+  time_t sec = real_ns / 1000000000ULL;
+  struct tm tm;
+
+  gmtime_r(&sec, &tm);
+
+  size_t len = strftime(out, size, fmt, &tm);
+
+  /* Microseconds are appended, when format ends with '.' */
+  if (len && out[len - 1] == '.') {
+    snprintf(out + len, size - len, "%06uZ", (unsigned) (real_ns % 1000000000ULL / 1000));
+  }
+}
+
+static size_t ra02_fwd_encode_rxpk(const ra02_fwd_rxpk_t * rxpk, uint32_t freq_khz, char * out, size_t size) {
+  char time[40];
+  char data[RA02_FWD_BASE64_SIZE];
+
+  ra02_fwd_format_time(rxpk->rx_ns, "%Y-%m-%dT%H:%M:%S.", time, sizeof(time));
+  ra02_fwd_base64_encode(rxpk->data, rxpk->size, data);
+
+  int len = snprintf(out, size,
+    "{\"time\":\"%s\",\"tmst\":%u,\"chan\":0,\"rfch\":0,\"freq\":%.4f,\"stat\":1,\"modu\":\"LORA\","
+    "\"datr\":\"SF%uBW%u\",\"codr\":\"4/%u\",\"rssi\":%d,\"lsnr\":%d,\"size\":%u,\"data\":\"%s\"}",
+    time, (uint32_t) (rxpk->rx_ns / 1000), freq_khz / 1000.0, rxpk->sf, rxpk->bandwidth / 1000,
+    rxpk->crc_rate + 4, rxpk->rssi, rxpk->snr, rxpk->size, data);
+
+  return len < 0 || (size_t) len >= size ? 0 : len;
+}
+
+static void ra02_fwd_send(ra02_fwd_t * fwd, int fd, const uint8_t * buf, size_t size) {
+  if (send(fd, buf, size, 0) < 0) {
+    log_warn("UDP send failed");
+  }
+}
+
+/**
+ * Forward queued frames, encoding is done here to keep radio thread free of it
+ */
+static void ra02_fwd_push_rx(ra02_fwd_t * fwd) {
+  while (1) {
+    ra02_fwd_rxpk_t rxpk[RA02_FWD_MAX_RXPK_PER_PUSH];
+    size_t count = 0;
+
+    pthread_mutex_lock(&fwd->lock);
+
+    while (fwd->rx_count && count < RA02_FWD_MAX_RXPK_PER_PUSH) {
+      rxpk[count++] = fwd->rx[fwd->rx_head];
+      fwd->rx_head = (fwd->rx_head + 1) % RA02_FWD_RX_QUEUE_SIZE;
+      fwd->rx_count--;
+    }
+
+    pthread_mutex_unlock(&fwd->lock);
+
+    if (!count) {
+      return;
+    }
+
+    uint8_t buf[RA02_FWD_DATAGRAM_SIZE];
+
+    fwd->push_token = rand_r(&fwd->seed);
+
+    size_t size = ra02_fwd_header(fwd, buf, fwd->push_token, RA02_FWD_PUSH_DATA);
+    size += snprintf((char *) buf + size, sizeof(buf) - size, "{\"rxpk\":[");
+
+    for (size_t i = 0; i < count; ++i) {
+      if (i) {
+        buf[size++] = ',';
+      }
+
+      size += ra02_fwd_encode_rxpk(&rxpk[i], fwd->cfg.freq_khz, (char *) buf + size, sizeof(buf) - size);
+    }
+
+    size += snprintf((char *) buf + size, sizeof(buf) - size, "]}");
+
+    log_debug("PUSH_DATA: %d frames", count);
+
+    ra02_fwd_send(fwd, fwd->sock_up, buf, size);
+
+    pthread_mutex_lock(&fwd->lock);
+    fwd->stats.rx_forwarded += count;
+    fwd->stats.push_sent++;
+    pthread_mutex_unlock(&fwd->lock);
+  }
+}
+
+static void ra02_fwd_push_stat(ra02_fwd_t * fwd) {
+  uint8_t buf[RA02_FWD_DATAGRAM_SIZE];
+  char time[40];
+  ra02_fwd_stats_t stats = {0};
+
+  ra02_fwd_get_stats(fwd, &stats);
+  ra02_fwd_format_time(timeout_now_ns(), "%Y-%m-%d %H:%M:%S GMT", time, sizeof(time));
+
+  fwd->push_token = rand_r(&fwd->seed);
+
+  size_t size = ra02_fwd_header(fwd, buf, fwd->push_token, RA02_FWD_PUSH_DATA);
+  size += snprintf((char *) buf + size, sizeof(buf) - size,
+    "{\"stat\":{\"time\":\"%s\",\"rxnb\":%u,\"rxok\":%u,\"rxfw\":%u,\"ackr\":%.1f,\"dwnb\":%u,\"txnb\":%u}}",
+    time, stats.rx_ok + stats.rx_bad, stats.rx_ok, stats.rx_forwarded,
+    stats.push_sent ? 100.0 * stats.push_acked / stats.push_sent : 0.0, stats.tx_received, stats.tx_sent);
+
+  ra02_fwd_send(fwd, fwd->sock_up, buf, size);
+
+  pthread_mutex_lock(&fwd->lock);
+  fwd->stats.push_sent++;
+  pthread_mutex_unlock(&fwd->lock);
+}
+
+static void ra02_fwd_pull(ra02_fwd_t * fwd) {
+  uint8_t buf[RA02_FWD_EUI_HEADER_SIZE];
+
+  fwd->pull_token = rand_r(&fwd->seed);
+
+  size_t size = ra02_fwd_header(fwd, buf, fwd->pull_token, RA02_FWD_PULL_DATA);
+  ra02_fwd_send(fwd, fwd->sock_down, buf, size);
+
+  pthread_mutex_lock(&fwd->lock);
+  fwd->stats.pull_sent++;
+  pthread_mutex_unlock(&fwd->lock);
+}
+
+/**
+ * Parse txpk object of PULL_RESP
+ *
+ * @retval E_NOTIMPL Only GPS time (tmms) is given
+ * @retval E_OUTOFBOUNDS Data rate isn't supported by RA-02
+ */
+static error_t ra02_fwd_parse_txpk(ra02_fwd_t * fwd, const char * json, ra02_fwd_txpk_t * txpk, uint64_t now_ns) {
+  char str[RA02_FWD_BASE64_SIZE];
+  double value;
+  unsigned int sf = 0, bw = 0, cr = 0;
+
+  json = ra02_fwd_json_find(json, "txpk");
+  ASSERT_RETURN(json && *json == '{', E_INVAL);
+
+  ERROR_CHECK_RETURN(ra02_fwd_json_string(json, "modu", str, sizeof(str)));
+  ASSERT_RETURN(!strcmp(str, "LORA"), E_INVAL);
+
+  if (ra02_fwd_json_bool(json, "imme")) {
+    txpk->at_ns = 0;
+  } else if (ra02_fwd_json_number(json, "tmst", &value) == E_OK) {
+    /* tmst is 32 bit microsecond counter, so take difference from current value, to handle wrap */
+    int32_t delta_us = (uint32_t) value - (uint32_t) (now_ns / 1000);
+    txpk->at_ns = now_ns + (int64_t) delta_us * 1000;
+  } else {
+    return E_NOTIMPL;
+  }
+
+  ERROR_CHECK_RETURN(ra02_fwd_json_number(json, "freq", &value));
+  txpk->freq_khz = lround(value * 1000);
+
+  txpk->power = ra02_fwd_json_number(json, "powe", &value) == E_OK ? (int8_t) value : -1;
+
+  ERROR_CHECK_RETURN(ra02_fwd_json_string(json, "datr", str, sizeof(str)));
+  ASSERT_RETURN(sscanf(str, "SF%uBW%u", &sf, &bw) == 2, E_INVAL);
+
+  if (sf < RA02_FWD_MIN_SF || sf > RA02_FWD_MAX_SF || (bw != 125 && bw != 250 && bw != 500)) {
+    log_warn("txpk: unsupported data rate %s", str);
+    return E_OUTOFBOUNDS;
+  }
+
+  txpk->sf = sf;
+  txpk->bandwidth = bw * 1000;
+
+  ERROR_CHECK_RETURN(ra02_fwd_json_string(json, "codr", str, sizeof(str)));
+  ASSERT_RETURN(sscanf(str, "4/%u", &cr) == 1 && cr >= 5 && cr <= 8, E_INVAL);
+  txpk->crc_rate = cr - 4;
+
+  txpk->crc = !ra02_fwd_json_bool(json, "ncrc");
+  txpk->ipol = ra02_fwd_json_bool(json, "ipol");
+
+  ERROR_CHECK_RETURN(ra02_fwd_json_string(json, "data", str, sizeof(str)));
+
+  size_t size = sizeof(txpk->data);
+  ERROR_CHECK_RETURN(ra02_fwd_base64_decode(str, txpk->data, &size));
+  ASSERT_RETURN(size, E_INVAL);
+  txpk->size = size;
+
+  if (ra02_fwd_json_number(json, "size", &value) == E_OK && (size_t) value != size) {
+    log_warn("txpk: size %d doesn't match data (%d bytes)", (int) value, size);
+    return E_CORRUPT;
+  }
+
+  /* Time on air for collision check, from a model with downlink modulation */
+  ra02_t model = {
+    .modem = RA02_MODEM_LORA,
+    .sf = txpk->sf,
+    .bandwidth = txpk->bandwidth,
+    .preamble = fwd->cfg.ra02->preamble,
+    .frame = {.crc_rate = txpk->crc_rate, .crc = txpk->crc},
+  };
+
+  return ra02_get_time_on_air(&model, txpk->size, &txpk->airtime_us);
+}
+
+/**
+ * Put downlink into TX queue
+ *
+ * @return Semtech TX_ACK error
+ */
+static const char * ra02_fwd_schedule(ra02_fwd_t * fwd, const ra02_fwd_txpk_t * txpk, uint64_t now_ns) {
+  /* Radio picks queued downlink up after current RX slice */
+  uint64_t min_ns = now_ns + RA02_FWD_MS_TO_NS(fwd->cfg.rx_slice_ms + fwd->cfg.tx_lead_ms);
+  uint64_t end_ns = txpk->at_ns + (uint64_t) txpk->airtime_us * 1000;
+  const char * result = "NONE";
+
+  if (txpk->at_ns && txpk->at_ns < min_ns) {
+    return "TOO_LATE";
+  }
+
+  if (txpk->at_ns > now_ns + RA02_FWD_MS_TO_NS(RA02_FWD_TX_MAX_AHEAD_MS)) {
+    return "TOO_EARLY";
+  }
+
+  if (txpk->freq_khz < RA02_FWD_MIN_FREQ_KHZ || txpk->freq_khz > RA02_FWD_MAX_FREQ_KHZ) {
+    return "TX_FREQ";
+  }
+
+  if (txpk->power > RA02_FWD_MAX_POWER) {
+    return "TX_POWER";
+  }
+
+  pthread_mutex_lock(&fwd->lock);
+
+  size_t pos = fwd->tx_count;
+
+  if (fwd->tx_count == RA02_FWD_TX_QUEUE_SIZE) {
+    result = "COLLISION_PACKET";
+  }
+
+  for (size_t i = 0; i < fwd->tx_count; ++i) {
+    const ra02_fwd_txpk_t * queued = &fwd->tx[i];
+
+    if (txpk->at_ns && queued->at_ns && txpk->at_ns < queued->at_ns + (uint64_t) queued->airtime_us * 1000
+        && queued->at_ns < end_ns) {
+      result = "COLLISION_PACKET";
+    }
+
+    if (queued->at_ns > txpk->at_ns && pos == fwd->tx_count) {
+      pos = i;
+    }
+  }
+
+  if (!strcmp(result, "NONE")) {
+    memmove(&fwd->tx[pos + 1], &fwd->tx[pos], (fwd->tx_count - pos) * sizeof(fwd->tx[0]));
+    fwd->tx[pos] = *txpk;
+    fwd->tx_count++;
+  }
+
+  pthread_mutex_unlock(&fwd->lock);
+
+  return result;
+}
+
+static void ra02_fwd_handle_pull_resp(ra02_fwd_t * fwd, uint16_t token, char * json) {
+  uint64_t now_ns = timeout_now_ns();
+  ra02_fwd_txpk_t txpk;
+  const char * result;
+
+  pthread_mutex_lock(&fwd->lock);
+  fwd->stats.tx_received++;
+  pthread_mutex_unlock(&fwd->lock);
+
+  error_t err = ra02_fwd_parse_txpk(fwd, json, &txpk, now_ns);
+
+  if (err == E_NOTIMPL) {
+    result = "GPS_UNLOCKED";
+  } else if (err == E_OUTOFBOUNDS) {
+    result = "DATARATE";
+  } else if (err != E_OK) {
+    log_warn("PULL_RESP: invalid txpk: %s", error2str(err));
+    result = "TX_FREQ";
+  } else {
+    result = ra02_fwd_schedule(fwd, &txpk, now_ns);
+  }
+
+  log_debug("PULL_RESP: %d bytes at %llu: %s", txpk.size, (unsigned long long) txpk.at_ns, result);
+
+  if (strcmp(result, "NONE")) {
+    pthread_mutex_lock(&fwd->lock);
+    fwd->stats.tx_rejected++;
+    pthread_mutex_unlock(&fwd->lock);
+  }
+
+  uint8_t buf[RA02_FWD_EUI_HEADER_SIZE + 64];
+  size_t size = ra02_fwd_header(fwd, buf, token, RA02_FWD_TX_ACK);
+  size += snprintf((char *) buf + size, sizeof(buf) - size, "{\"txpk_ack\":{\"error\":\"%s\"}}", result);
+
+  ra02_fwd_send(fwd, fwd->sock_down, buf, size);
+}
+
+static void ra02_fwd_receive(ra02_fwd_t * fwd, int fd) {
+  uint8_t buf[RA02_FWD_DATAGRAM_SIZE + 1];
+  ssize_t size = recv(fd, buf, sizeof(buf) - 1, MSG_DONTWAIT);
+
+  if (size < RA02_FWD_HEADER_SIZE || buf[0] != RA02_FWD_PROTOCOL_VERSION) {
+    return;
+  }
+
+  uint16_t token = (buf[1] << 8) | buf[2];
+  buf[size] = '\0';
+
+  switch (buf[3]) {
+    case RA02_FWD_PUSH_ACK:
+      if (token == fwd->push_token) {
+        pthread_mutex_lock(&fwd->lock);
+        fwd->stats.push_acked++;
+        pthread_mutex_unlock(&fwd->lock);
+      }
+      break;
+
+    case RA02_FWD_PULL_ACK:
+      if (token == fwd->pull_token) {
+        pthread_mutex_lock(&fwd->lock);
+        fwd->stats.pull_acked++;
+        pthread_mutex_unlock(&fwd->lock);
+      }
+      break;
+
+    case RA02_FWD_PULL_RESP:
+      ra02_fwd_handle_pull_resp(fwd, token, (char *) buf + RA02_FWD_HEADER_SIZE);
+      break;
+
+    default:
+      log_warn("Unexpected packet type 0x%02x", buf[3]);
+      break;
+  }
+}
+
+/**
+ * Network thread: protocol, JSON & timers
+ */
+static void * ra02_fwd_thread(void * arg) {
+  ra02_fwd_t * fwd = arg;
+  uint64_t next_pull_ns = timeout_now_ns();
+  uint64_t next_stat_ns = next_pull_ns + RA02_FWD_MS_TO_NS(fwd->cfg.stat_ms);
+
+  while (fwd->running) {
+    uint64_t now_ns = timeout_now_ns();
+
+    if (now_ns >= next_pull_ns) {
+      ra02_fwd_pull(fwd);
+      next_pull_ns = now_ns + RA02_FWD_MS_TO_NS(fwd->cfg.keepalive_ms);
+    }
+
+    if (now_ns >= next_stat_ns) {
+      ra02_fwd_push_stat(fwd);
+      next_stat_ns = now_ns + RA02_FWD_MS_TO_NS(fwd->cfg.stat_ms);
+    }
+
+    struct pollfd fds[] = {
+      {.fd = fwd->wake_fd,   .events = POLLIN},
+      {.fd = fwd->sock_up,   .events = POLLIN},
+      {.fd = fwd->sock_down, .events = POLLIN},
+    };
+
+    uint64_t wait_ns = UTIL_MIN(next_pull_ns, next_stat_ns) - now_ns;
+
+    if (poll(fds, UTIL_ARR_SIZE(fds), wait_ns / 1000000 + 1) <= 0) {
+      continue;
+    }
+
+    if (fds[0].revents & POLLIN) {
+      uint64_t count;
+      (void) !read(fwd->wake_fd, &count, sizeof(count));
+      ra02_fwd_push_rx(fwd);
+    }
+
+    if (fds[1].revents & POLLIN) {
+      ra02_fwd_receive(fwd, fwd->sock_up);
+    }
+
+    if (fds[2].revents & POLLIN) {
+      ra02_fwd_receive(fwd, fwd->sock_down);
+    }
+  }
+
+  /* Flush frames received before stop */
+  ra02_fwd_push_rx(fwd);
+
+  return NULL;
+}
+
+static error_t ra02_fwd_set_modulation(ra02_t * ra02, uint8_t sf, uint32_t bandwidth, const ra02_frame_cfg_t * frame) {
+  if (ra02->sf != sf) {
+    ERROR_CHECK_RETURN(ra02_set_sf(ra02, sf));
+  }
+
+  if (ra02->bandwidth != bandwidth) {
+    ERROR_CHECK_RETURN(ra02_set_bandwidth(ra02, bandwidth));
+  }
+
+  if (ra02->frame.crc_rate != frame->crc_rate || ra02->frame.crc != frame->crc) {
+    ERROR_CHECK_RETURN(ra02_set_frame_cfg(ra02, frame));
+  }
+
+  return E_OK;
+}
+
+/**
+ * Keep first error of a sequence of steps, that are all attempted
+ */
+static error_t ra02_fwd_first_err(error_t first, error_t next) {
+  return first != E_OK ? first : next;
+}
+
+/**
+ * Transmit downlink and restore RX settings. Failed downlink is only counted,
+ * error is returned if RX settings can't be restored
+ */
+static error_t ra02_fwd_transmit(ra02_fwd_t * fwd, ra02_fwd_txpk_t * txpk) {
+  ra02_t * ra02 = fwd->cfg.ra02;
+  uint8_t sf = ra02->sf;
+  uint32_t bandwidth = ra02->bandwidth;
+  ra02_frame_cfg_t rx_frame = ra02->frame;
+  ra02_frame_cfg_t tx_frame = ra02->frame;
+  uint8_t power = 0;
+  error_t err = E_OK;
+
+  tx_frame.implicit_header = false;
+  tx_frame.crc_rate = txpk->crc_rate;
+  tx_frame.crc = txpk->crc;
+
+  ERROR_CHECK_RETURN(ra02_get_power(ra02, &power));
+
+  if (txpk->freq_khz != fwd->cfg.freq_khz) {
+    err = ra02_set_freq(ra02, txpk->freq_khz);
+  }
+
+  if (err == E_OK && txpk->power >= 0 && txpk->power != power) {
+    err = ra02_set_power(ra02, txpk->power);
+  }
+
+  if (err == E_OK) {
+    err = ra02_fwd_set_modulation(ra02, txpk->sf, txpk->bandwidth, &tx_frame);
+  }
+
+  if (err == E_OK && txpk->ipol) {
+    err = ra02_set_invert_iq(ra02, true);
+  }
+
+  if (err == E_OK) {
+    err = txpk->at_ns
+        ? ra02_send_at(ra02, txpk->data, txpk->size, txpk->at_ns, RA02_SEND_AT_MAX_LATE_NS)
+        : ra02_send(ra02, txpk->data, txpk->size);
+  }
+
+  pthread_mutex_lock(&fwd->lock);
+
+  if (err == E_OK) {
+    fwd->stats.tx_sent++;
+  } else if (err == E_TIMEOUT) {
+    fwd->stats.tx_late++;
+  } else {
+    fwd->stats.tx_failed++;
+  }
+
+  pthread_mutex_unlock(&fwd->lock);
+
+  if (err != E_OK) {
+    log_warn("Downlink failed: %s", error2str(err));
+  }
+
+  /* RX settings are restored however downlink ended */
+  err = E_OK;
+
+  if (txpk->ipol) {
+    err = ra02_fwd_first_err(err, ra02_set_invert_iq(ra02, false));
+  }
+
+  if (txpk->freq_khz != fwd->cfg.freq_khz) {
+    err = ra02_fwd_first_err(err, ra02_set_freq(ra02, fwd->cfg.freq_khz));
+  }
+
+  if (txpk->power >= 0 && txpk->power != power) {
+    err = ra02_fwd_first_err(err, ra02_set_power(ra02, power));
+  }
+
+  return ra02_fwd_first_err(err, ra02_fwd_set_modulation(ra02, sf, bandwidth, &rx_frame));
+}
+
+/**
+ * Single radio thread step: transmit due downlink or receive for one slice
+ */
+static error_t ra02_fwd_radio_step(ra02_fwd_t * fwd) {
+  uint64_t lead_ns = RA02_FWD_MS_TO_NS(fwd->cfg.tx_lead_ms);
+  uint64_t now_ns = timeout_now_ns();
+  uint64_t next_ns = UINT64_MAX;
+  ra02_fwd_txpk_t txpk;
+  bool due = false;
+
+  pthread_mutex_lock(&fwd->lock);
+
+  if (fwd->tx_count) {
+    next_ns = fwd->tx[0].at_ns;
+    due = next_ns <= now_ns + lead_ns;
+
+    if (due) {
+      txpk = fwd->tx[0];
+      memmove(&fwd->tx[0], &fwd->tx[1], --fwd->tx_count * sizeof(fwd->tx[0]));
+    }
+  }
+
+  pthread_mutex_unlock(&fwd->lock);
+
+  if (due) {
+    return ra02_fwd_transmit(fwd, &txpk);
+  }
+
+  uint64_t slice_ms = fwd->cfg.rx_slice_ms;
+
+  if (next_ns != UINT64_MAX) {
+    slice_ms = UTIL_MIN(slice_ms, (next_ns - lead_ns - now_ns) / 1000000 + 1);
+  }
+
+  TIMEOUT_CREATE(t, slice_ms);
+
+  ra02_fwd_rxpk_t rxpk;
+  size_t size = sizeof(rxpk.data);
+  error_t err = ra02_recv(fwd->cfg.ra02, rxpk.data, &size, &t);
+
+  if (err == E_TIMEOUT) {
+    return E_OK;
+  }
+
+  if (err == E_CORRUPT) {
+    pthread_mutex_lock(&fwd->lock);
+    fwd->stats.rx_bad++;
+    pthread_mutex_unlock(&fwd->lock);
+    return E_OK;
+  }
+
+  ERROR_CHECK_RETURN(err);
+
+  rxpk.rx_ns     = fwd->cfg.ra02->last_rx_ns;
+  rxpk.rssi      = fwd->cfg.ra02->last_rssi;
+  rxpk.snr       = fwd->cfg.ra02->last_snr;
+  rxpk.sf        = fwd->cfg.ra02->sf;
+  rxpk.crc_rate  = fwd->cfg.ra02->frame.crc_rate;
+  rxpk.bandwidth = fwd->cfg.ra02->bandwidth;
+  rxpk.size      = size;
+
+  pthread_mutex_lock(&fwd->lock);
+
+  fwd->stats.rx_ok++;
+
+  if (fwd->rx_count == RA02_FWD_RX_QUEUE_SIZE) {
+    fwd->stats.rx_dropped++;
+  } else {
+    fwd->rx[(fwd->rx_head + fwd->rx_count++) % RA02_FWD_RX_QUEUE_SIZE] = rxpk;
+  }
+
+  pthread_mutex_unlock(&fwd->lock);
+
+  ra02_fwd_wake(fwd);
+
+  return E_OK;
+}
+
+/* Shared functions ========================================================= */
+error_t ra02_fwd_init(ra02_fwd_t * fwd, const ra02_fwd_cfg_t * cfg) {
+  ASSERT_RETURN(fwd && cfg && cfg->ra02 && cfg->host, E_NULL);
+  ASSERT_RETURN(cfg->port_up && cfg->freq_khz, E_INVAL);
+  ASSERT_RETURN(cfg->ra02->modem == RA02_MODEM_LORA, E_INVAL);
+
+  memset(fwd, 0, sizeof(*fwd));
+
+  fwd->cfg = *cfg;
+  fwd->cfg.port_down    = cfg->port_down    ? cfg->port_down    : cfg->port_up;
+  fwd->cfg.keepalive_ms = cfg->keepalive_ms ? cfg->keepalive_ms : RA02_FWD_DEFAULT_KEEPALIVE_MS;
+  fwd->cfg.stat_ms      = cfg->stat_ms      ? cfg->stat_ms      : RA02_FWD_DEFAULT_STAT_MS;
+  fwd->cfg.rx_slice_ms  = cfg->rx_slice_ms  ? cfg->rx_slice_ms  : RA02_FWD_DEFAULT_RX_SLICE_MS;
+  fwd->cfg.tx_lead_ms   = cfg->tx_lead_ms   ? cfg->tx_lead_ms   : RA02_FWD_DEFAULT_TX_LEAD_MS;
+  fwd->seed = cfg->gateway_eui ^ timeout_now_ns();
+  fwd->sock_up = -1;
+  fwd->sock_down = -1;
+
+  pthread_mutex_init(&fwd->lock, NULL);
+
+  fwd->wake_fd = eventfd(0, EFD_CLOEXEC);
+
+  if (fwd->wake_fd < 0) {
+    ra02_fwd_deinit(fwd);
+    return E_FAILED;
+  }
+
+  error_t err = ra02_fwd_open_socket(fwd->cfg.host, fwd->cfg.port_up, &fwd->sock_up);
+
+  if (err == E_OK) {
+    err = ra02_fwd_open_socket(fwd->cfg.host, fwd->cfg.port_down, &fwd->sock_down);
+  }
+
+  if (err == E_OK) {
+    err = ra02_set_freq(fwd->cfg.ra02, fwd->cfg.freq_khz);
+  }
+
+  if (err != E_OK) {
+    ra02_fwd_deinit(fwd);
+    return err;
+  }
+
+  log_debug("ra02_fwd_init: %s:%d/%d EUI %016llx", fwd->cfg.host, fwd->cfg.port_up, fwd->cfg.port_down,
+            (unsigned long long) fwd->cfg.gateway_eui);
+
+  return E_OK;
+}
+
+error_t ra02_fwd_deinit(ra02_fwd_t * fwd) {
+  ASSERT_RETURN(fwd, E_NULL);
+
+  if (fwd->sock_up >= 0) {
+    close(fwd->sock_up);
+  }
+
+  if (fwd->sock_down >= 0) {
+    close(fwd->sock_down);
+  }
+
+  if (fwd->wake_fd >= 0) {
+    close(fwd->wake_fd);
+  }
+
+  fwd->sock_up = fwd->sock_down = fwd->wake_fd = -1;
+
+  pthread_mutex_destroy(&fwd->lock);
+
+  return E_OK;
+}
+
+error_t ra02_fwd_run(ra02_fwd_t * fwd, timeout_t * timeout) {
+  ASSERT_RETURN(fwd, E_NULL);
+
+  error_t err = E_OK;
+
+  fwd->running = true;
+
+  if (pthread_create(&fwd->thread, NULL, ra02_fwd_thread, fwd)) {
+    fwd->running = false;
+    return E_FAILED;
+  }
+
+  while (fwd->running && (!timeout || !timeout_is_expired(timeout)) && err == E_OK) {
+    err = ra02_fwd_radio_step(fwd);
+  }
+
+  if (err != E_OK) {
+    log_error("Radio failed: %s", error2str(err));
+  }
+
+  ra02_fwd_stop(fwd);
+  pthread_join(fwd->thread, NULL);
+
+  ERROR_CHECK_RETURN(ra02_sleep(fwd->cfg.ra02));
+
+  return err;
+}
+
+void ra02_fwd_stop(ra02_fwd_t * fwd) {
+  fwd->running = false;
+  ra02_fwd_wake(fwd);
+}
+
+error_t ra02_fwd_get_stats(ra02_fwd_t * fwd, ra02_fwd_stats_t * stats) {
+  ASSERT_RETURN(fwd && stats, E_NULL);
+
+  pthread_mutex_lock(&fwd->lock);
+  *stats = fwd->stats;
+  pthread_mutex_unlock(&fwd->lock);
+
+  return E_OK;
+}
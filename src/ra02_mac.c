@@ -0,0 +1,701 @@
+/** ========================================================================= *
+ *
+ * @file ra02_mac.c
+ * @date 17-10-2026
+ * @author Maksym Tkachuk <max.r.tkachuk@gmail.com>
+ *
+ *  ========================================================================= */
+
+/* Includes ================================================================= */
+#include <ra02_mac.h>
+#include <assertion.h>
+#include <timeout.h>
+#include <util.h>
+#include <log.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+
+/* Defines ================================================================== */
+#define LOG_TAG MAC
+
+/** Frame types */
+#define RA02_MAC_FRAME_DATA       0x01
+#define RA02_MAC_FRAME_JOIN       0x02
+
+/** Beacons, in which a grant is repeated */
+#define RA02_MAC_GRANT_BEACONS    3
+
+/** Consecutive missed beacons, after which node resynchronizes */
+#define RA02_MAC_MAX_MISSED       3
+
+/** Node beacon wait before superframe length is known */
+#define RA02_MAC_SYNC_TIMEOUT_MS  10000
+
+/** LBT: CAD duration in symbols, RX to TX switch and max backoff (in frame airtimes) */
+#define RA02_MAC_CAD_SYMBOLS      2
+#define RA02_MAC_SWITCH_US        200
+#define RA02_MAC_LBT_BACKOFF_MAX  4
+
+/* Macros =================================================================== */
+/* Exposed macros =========================================================== */
+/* Enums ==================================================================== */
+/**
+ * Simulated node state
+ */
+typedef enum {
+  RA02_MAC_SIM_IDLE = 0, /** Nothing queued */
+  RA02_MAC_SIM_SENSE,    /** LBT: CAD at next_us */
+  RA02_MAC_SIM_START,    /** TX start at next_us */
+  RA02_MAC_SIM_TX,       /** TX ends at next_us */
+} ra02_mac_sim_state_t;
+
+/* Types ==================================================================== */
+/**
+ * Simulated node
+ */
+typedef struct {
+  ra02_mac_sim_state_t state;
+  uint64_t next_us;
+  uint64_t arrival_us;
+  uint64_t tx_start_us;
+  uint8_t  queued;
+  bool     collided;
+} ra02_mac_sim_node_t;
+
+/* Variables ================================================================ */
+/* Private functions ======================================================== */
+static void ra02_mac_put_u16(uint8_t * buf, uint16_t value) {
+  buf[0] = value;
+  buf[1] = value >> 8;
+}
+
+static uint16_t ra02_mac_get_u16(const uint8_t * buf) {
+  return buf[0] | (buf[1] << 8);
+}
+
+static void ra02_mac_put_u32(uint8_t * buf, uint32_t value) {
+  ra02_mac_put_u16(&buf[0], value);
+  ra02_mac_put_u16(&buf[2], value >> 16);
+}
+
+static uint32_t ra02_mac_get_u32(const uint8_t * buf) {
+  return ra02_mac_get_u16(&buf[0]) | ((uint32_t) ra02_mac_get_u16(&buf[2]) << 16);
+}
+
+/**
+ * Number of data slots in superframe
+ */
+static uint32_t ra02_mac_slots(const ra02_mac_cfg_t * cfg) {
+  return cfg->join_slots + cfg->uplink_slots + cfg->downlink_slots;
+}
+
+/**
+ * Time on air of the longest beacon and the longest data frame
+ */
+static error_t ra02_mac_airtime(ra02_t * ra02, uint8_t max_payload, uint32_t * beacon_us, uint32_t * data_us) {
+  ERROR_CHECK_RETURN(ra02_get_time_on_air(ra02, RA02_MAC_BEACON_SIZE(RA02_MAC_MAX_GRANTS), beacon_us));
+  ERROR_CHECK_RETURN(ra02_get_time_on_air(ra02, RA02_MAC_HEADER_SIZE + max_payload, data_us));
+
+  return E_OK;
+}
+
+/**
+ * CLOCK_MONOTONIC start of slot in current superframe (0 - beacon)
+ */
+static uint64_t ra02_mac_slot_ns(ra02_mac_t * mac, uint32_t slot) {
+  if (!slot) {
+    return mac->start_ns;
+  }
+
+  return mac->start_ns + (mac->plan.beacon_slot_us + (uint64_t) (slot - 1) * mac->plan.slot_us) * 1000;
+}
+
+static uint32_t ra02_mac_join_slot(uint8_t index) {
+  return 1 + index;
+}
+
+static uint32_t ra02_mac_uplink_slot(ra02_mac_t * mac, uint8_t index) {
+  return 1 + mac->cfg.join_slots + index;
+}
+
+static uint32_t ra02_mac_downlink_slot(ra02_mac_t * mac, uint8_t index) {
+  return 1 + mac->cfg.join_slots + mac->cfg.uplink_slots + index;
+}
+
+/**
+ * Transmit frame in slot, after half of guard time. Data frames may start
+ * late by the other half, beacon carries its TX instant, so it must be exact
+ */
+static error_t ra02_mac_tx(ra02_mac_t * mac, uint32_t slot, uint8_t * buf, size_t size) {
+  uint64_t max_late_ns = slot ? mac->plan.guard_us * 500ULL : RA02_SEND_AT_MAX_LATE_NS;
+  error_t err = ra02_send_at(mac->cfg.ra02, buf, size, ra02_mac_slot_ns(mac, slot) + mac->plan.guard_us * 500ULL,
+                             max_late_ns);
+
+  if (err == E_OK) {
+    mac->stats.tx++;
+  } else {
+    log_warn("slot %d: tx failed: %s", slot, error2str(err));
+  }
+
+  return err;
+}
+
+/**
+ * Listen for a frame within slot
+ */
+static error_t ra02_mac_rx(ra02_mac_t * mac, uint32_t slot, uint8_t * buf, size_t * size) {
+  timeout_sleep_until_ns(ra02_mac_slot_ns(mac, slot));
+
+  TIMEOUT_CREATE(t, ((slot ? mac->plan.slot_us : mac->plan.beacon_slot_us) + 999) / 1000);
+
+  ERROR_CHECK_RETURN(ra02_recv(mac->cfg.ra02, buf, size, &t));
+
+  mac->stats.rx++;
+
+  return E_OK;
+}
+
+/**
+ * Send frame from slot queue, if any
+ */
+static void ra02_mac_tx_queued(ra02_mac_t * mac, uint32_t slot, ra02_mac_queue_t * queue) {
+  if (!queue->count) {
+    return;
+  }
+
+  ra02_mac_frame_t * frame = &queue->frames[queue->head];
+  uint8_t buf[RA02_MAC_HEADER_SIZE + RA02_MAC_MAX_PAYLOAD];
+
+  buf[0] = RA02_MAC_FRAME_DATA;
+  ra02_mac_put_u16(&buf[1], mac->cfg.address);
+  ra02_mac_put_u16(&buf[3], frame->dst);
+  memcpy(&buf[RA02_MAC_HEADER_SIZE], frame->data, frame->size);
+
+  ra02_mac_tx(mac, slot, buf, RA02_MAC_HEADER_SIZE + frame->size);
+
+  queue->head = (queue->head + 1) % RA02_MAC_QUEUE_SIZE;
+  queue->count--;
+}
+
+/**
+ * Pass received data frame addressed to this node to handler
+ */
+static void ra02_mac_deliver(ra02_mac_t * mac, const uint8_t * buf, size_t size) {
+  if (size < RA02_MAC_HEADER_SIZE || buf[0] != RA02_MAC_FRAME_DATA
+      || ra02_mac_get_u16(&buf[3]) != mac->cfg.address) {
+    return;
+  }
+
+  if (mac->cfg.rx) {
+    mac->cfg.rx(mac->cfg.rx_ctx, ra02_mac_get_u16(&buf[1]), &buf[RA02_MAC_HEADER_SIZE], size - RA02_MAC_HEADER_SIZE);
+  }
+}
+
+/**
+ * Coordinator: assign uplink slot to joining node and announce it
+ */
+static void ra02_mac_grant(ra02_mac_t * mac, uint16_t node) {
+  uint8_t slot = RA02_MAC_NO_SLOT;
+
+  for (uint8_t i = 0; i < mac->cfg.uplink_slots; ++i) {
+    if (mac->owners[i] == node) {
+      slot = i;
+      break;
+    }
+
+    if (slot == RA02_MAC_NO_SLOT && mac->owners[i] == RA02_MAC_COORDINATOR) {
+      slot = i;
+    }
+  }
+
+  if (slot == RA02_MAC_NO_SLOT) {
+    log_warn("join from 0x%04x: no free slots", node);
+    return;
+  }
+
+  mac->owners[slot] = node;
+
+  ra02_mac_grant_t * grant = NULL;
+
+  for (size_t i = 0; i < RA02_MAC_MAX_GRANTS; ++i) {
+    if (mac->grants[i].node == node || (!grant && !mac->grants[i].beacons)) {
+      grant = &mac->grants[i];
+    }
+  }
+
+  if (!grant) {
+    log_warn("join from 0x%04x: too many pending grants", node);
+    return;
+  }
+
+  grant->node = node;
+  grant->slot = slot;
+  grant->beacons = RA02_MAC_GRANT_BEACONS;
+
+  mac->stats.joins++;
+
+  log_debug("0x%04x joined, slot %d", node, slot);
+}
+
+static error_t ra02_mac_run_coordinator(ra02_mac_t * mac) {
+  uint8_t buf[RA02_MAX_PACKET_SIZE];
+  size_t size;
+
+  if (!mac->synced) {
+    /* Leave enough time to prepare the first beacon */
+    mac->start_ns = timeout_now_ns() + mac->plan.beacon_slot_us * 1000ULL;
+    mac->synced = true;
+  } else {
+    mac->start_ns += mac->plan.superframe_us * 1000ULL;
+  }
+
+  /* Beacon */
+  uint8_t * fields = &buf[RA02_TIMESYNC_BEACON_SIZE];
+  uint8_t grants = 0;
+  uint64_t beacon_ns = ra02_mac_slot_ns(mac, 0) + mac->plan.guard_us * 500ULL;
+
+  ERROR_CHECK_RETURN(ra02_timesync_encode(&mac->ts, beacon_ns, buf));
+
+  fields[0] = mac->cfg.join_slots;
+  fields[1] = mac->cfg.uplink_slots;
+  fields[2] = mac->cfg.downlink_slots;
+  fields[3] = mac->cfg.max_payload;
+  ra02_mac_put_u32(&fields[4], mac->plan.slot_us);
+
+  for (size_t i = 0; i < RA02_MAC_MAX_GRANTS; ++i) {
+    if (mac->grants[i].beacons) {
+      ra02_mac_put_u16(&fields[9 + grants * 3], mac->grants[i].node);
+      fields[9 + grants * 3 + 2] = mac->grants[i].slot;
+      mac->grants[i].beacons--;
+      grants++;
+    }
+  }
+
+  fields[8] = grants;
+
+  ra02_mac_tx(mac, 0, buf, RA02_MAC_BEACON_SIZE(grants));
+
+  /* Join requests */
+  for (uint8_t i = 0; i < mac->cfg.join_slots; ++i) {
+    size = sizeof(buf);
+
+    if (ra02_mac_rx(mac, ra02_mac_join_slot(i), buf, &size) == E_OK && size >= 3 && buf[0] == RA02_MAC_FRAME_JOIN) {
+      ra02_mac_grant(mac, ra02_mac_get_u16(&buf[1]));
+    }
+  }
+
+  /* Uplink, only owned slots are listened to */
+  for (uint8_t i = 0; i < mac->cfg.uplink_slots; ++i) {
+    size = sizeof(buf);
+
+    if (mac->owners[i] != RA02_MAC_COORDINATOR
+        && ra02_mac_rx(mac, ra02_mac_uplink_slot(mac, i), buf, &size) == E_OK) {
+      ra02_mac_deliver(mac, buf, size);
+    }
+  }
+
+  /* Downlink */
+  for (uint8_t i = 0; i < mac->cfg.downlink_slots; ++i) {
+    ra02_mac_tx_queued(mac, ra02_mac_downlink_slot(mac, i), &mac->queues[mac->cfg.uplink_slots + i]);
+  }
+
+  mac->stats.superframes++;
+
+  return E_OK;
+}
+
+/**
+ * Node: apply received beacon, returns E_INVAL if frame is not a beacon
+ */
+static error_t ra02_mac_process_beacon(ra02_mac_t * mac, const uint8_t * buf, size_t size) {
+  ASSERT_RETURN(size >= RA02_MAC_BEACON_SIZE(0), E_INVAL);
+
+  const uint8_t * fields = &buf[RA02_TIMESYNC_BEACON_SIZE];
+  uint8_t grants = fields[8];
+
+  ASSERT_RETURN(size >= RA02_MAC_BEACON_SIZE(grants), E_INVAL);
+  ASSERT_RETURN(fields[3] <= RA02_MAC_MAX_PAYLOAD && fields[1] + fields[2] <= RA02_MAC_MAX_SLOTS, E_INVAL);
+
+  ERROR_CHECK_RETURN(ra02_timesync_process(&mac->ts, buf, size, mac->cfg.ra02->last_rx_ns));
+
+  mac->cfg.join_slots = fields[0];
+  mac->cfg.uplink_slots = fields[1];
+  mac->cfg.downlink_slots = fields[2];
+  mac->cfg.max_payload = fields[3];
+
+  /* Coordinator decides slot length, guard is what's left after airtime */
+  uint32_t beacon_us, max_beacon_us;
+
+  ERROR_CHECK_RETURN(ra02_mac_airtime(mac->cfg.ra02, mac->cfg.max_payload, &max_beacon_us, &mac->plan.airtime_us));
+  ERROR_CHECK_RETURN(ra02_get_time_on_air(mac->cfg.ra02, size, &beacon_us));
+
+  mac->plan.slot_us = ra02_mac_get_u32(&fields[4]);
+  ASSERT_RETURN(mac->plan.slot_us > mac->plan.airtime_us, E_INVAL);
+
+  mac->plan.guard_us = mac->plan.slot_us - mac->plan.airtime_us;
+  mac->plan.beacon_slot_us = max_beacon_us + mac->plan.guard_us;
+  mac->plan.superframe_us = mac->plan.beacon_slot_us + ra02_mac_slots(&mac->cfg) * mac->plan.slot_us;
+
+  /* RX_DONE is at the end of beacon, which was sent after half of guard */
+  mac->start_ns = mac->cfg.ra02->last_rx_ns - beacon_us * 1000ULL - mac->plan.guard_us * 500ULL;
+
+  for (uint8_t i = 0; i < grants; ++i) {
+    if (ra02_mac_get_u16(&fields[9 + i * 3]) == mac->cfg.address) {
+      uint8_t slot = fields[9 + i * 3 + 2];
+
+      if (slot != mac->slot) {
+        log_debug("joined, slot %d", slot);
+      }
+
+      mac->slot = slot;
+    }
+  }
+
+  return E_OK;
+}
+
+static error_t ra02_mac_run_node(ra02_mac_t * mac) {
+  uint8_t buf[RA02_MAX_PACKET_SIZE];
+  size_t size = sizeof(buf);
+  error_t err;
+
+  if (!mac->synced) {
+    TIMEOUT_CREATE(t, mac->plan.superframe_us ? mac->plan.superframe_us / 500 : RA02_MAC_SYNC_TIMEOUT_MS);
+
+    err = ra02_recv(mac->cfg.ra02, buf, &size, &t);
+  } else {
+    /* Next beacon is expected one superframe later */
+    mac->start_ns += mac->plan.superframe_us * 1000ULL;
+
+    err = ra02_mac_rx(mac, 0, buf, &size);
+  }
+
+  if (err == E_OK) {
+    err = ra02_mac_process_beacon(mac, buf, size);
+  }
+
+  if (err != E_OK) {
+    mac->stats.beacons_missed++;
+
+    if (mac->synced && ++mac->missed >= RA02_MAC_MAX_MISSED) {
+      log_warn("lost beacons, resynchronizing");
+      mac->synced = false;
+    }
+
+    /* Drift is only bounded for a single superframe, so stay silent */
+    return E_TIMEOUT;
+  }
+
+  mac->synced = true;
+  mac->missed = 0;
+
+  if (mac->slot >= mac->cfg.uplink_slots) {
+    mac->slot = RA02_MAC_NO_SLOT;
+  }
+
+  if (mac->slot == RA02_MAC_NO_SLOT) {
+    if (mac->cfg.join_slots) {
+      uint8_t join[3] = {RA02_MAC_FRAME_JOIN};
+
+      ra02_mac_put_u16(&join[1], mac->cfg.address);
+
+      if (ra02_mac_tx(mac, ra02_mac_join_slot(rand_r(&mac->seed) % mac->cfg.join_slots),
+                      join, sizeof(join)) == E_OK) {
+        mac->stats.joins++;
+      }
+    }
+  } else {
+    ra02_mac_tx_queued(mac, ra02_mac_uplink_slot(mac, mac->slot), &mac->queues[mac->slot]);
+
+    if (mac->cfg.downlink_slots) {
+      size = sizeof(buf);
+
+      if (ra02_mac_rx(mac, ra02_mac_downlink_slot(mac, mac->slot % mac->cfg.downlink_slots), buf, &size) == E_OK) {
+        ra02_mac_deliver(mac, buf, size);
+      }
+    }
+  }
+
+  mac->stats.superframes++;
+
+  return E_OK;
+}
+
+/**
+ * Uniform random number in (0, 1)
+ */
+static double ra02_mac_sim_random(unsigned int * seed) {
+  return (rand_r(seed) + 1.0) / ((double) RAND_MAX + 2.0);
+}
+
+/* Shared functions ========================================================= */
+error_t ra02_mac_get_plan(ra02_t * ra02, const ra02_mac_cfg_t * cfg, ra02_mac_plan_t * plan) {
+  ASSERT_RETURN(ra02 && cfg && plan, E_NULL);
+  ASSERT_RETURN(cfg->max_payload <= RA02_MAC_MAX_PAYLOAD, E_INVAL);
+
+  uint32_t beacon_us;
+
+  ERROR_CHECK_RETURN(ra02_mac_airtime(ra02, cfg->max_payload, &beacon_us, &plan->airtime_us));
+
+  /*
+   * guard = 2 * (drift * superframe + jitter), superframe = beacon + guard + slots * (airtime + guard)
+   * => guard = 2 * (drift * (beacon + slots * airtime) + jitter) / (1 - 2 * drift * (slots + 1))
+   */
+  uint32_t slots = ra02_mac_slots(cfg);
+  double drift = cfg->drift_ppm * 1e-6;
+
+  ASSERT_RETURN(2 * drift * (slots + 1) < 1, E_INVAL);
+
+  plan->guard_us = ceil(2 * (drift * ((double) beacon_us + (double) slots * plan->airtime_us) + cfg->jitter_us)
+                        / (1 - 2 * drift * (slots + 1)));
+  plan->slot_us = plan->airtime_us + plan->guard_us;
+  plan->beacon_slot_us = beacon_us + plan->guard_us;
+  plan->superframe_us = plan->beacon_slot_us + slots * plan->slot_us;
+
+  return E_OK;
+}
+
+error_t ra02_mac_init(ra02_mac_t * mac, const ra02_mac_cfg_t * cfg) {
+  ASSERT_RETURN(mac && cfg && cfg->ra02, E_NULL);
+  ASSERT_RETURN(cfg->uplink_slots + cfg->downlink_slots <= RA02_MAC_MAX_SLOTS, E_INVAL);
+
+  memset(mac, 0, sizeof(*mac));
+  memcpy(&mac->cfg, cfg, sizeof(*cfg));
+
+  if (!mac->cfg.max_payload) {
+    mac->cfg.max_payload = RA02_MAC_MAX_PAYLOAD;
+  }
+
+  bool coordinator = cfg->address == RA02_MAC_COORDINATOR;
+
+  /* Node learns slot plan from beacons, own config only bounds first beacon wait */
+  if (coordinator || cfg->uplink_slots) {
+    ERROR_CHECK_RETURN(ra02_mac_get_plan(cfg->ra02, &mac->cfg, &mac->plan));
+  }
+
+  ERROR_CHECK_RETURN(ra02_timesync_init(&mac->ts, &(ra02_timesync_cfg_t){
+    .ra02 = cfg->ra02,
+    .coordinator = coordinator,
+  }));
+
+  mac->slot = RA02_MAC_NO_SLOT;
+  mac->seed = cfg->address ^ timeout_now_ns();
+
+  log_debug("slot %d us (guard %d us), superframe %d us", mac->plan.slot_us, mac->plan.guard_us, mac->plan.superframe_us);
+
+  return E_OK;
+}
+
+error_t ra02_mac_send(ra02_mac_t * mac, uint16_t dst, const uint8_t * buf, size_t size) {
+  ASSERT_RETURN(mac && buf, E_NULL);
+  ASSERT_RETURN(size <= mac->cfg.max_payload, E_INVAL);
+
+  ra02_mac_queue_t * queue = NULL;
+
+  if (mac->cfg.address == RA02_MAC_COORDINATOR) {
+    ASSERT_RETURN(mac->cfg.downlink_slots, E_INVAL);
+
+    for (uint8_t i = 0; i < mac->cfg.uplink_slots; ++i) {
+      if (mac->owners[i] == dst) {
+        queue = &mac->queues[mac->cfg.uplink_slots + i % mac->cfg.downlink_slots];
+        break;
+      }
+    }
+
+    ASSERT_RETURN(queue, E_NOTFOUND);
+  } else {
+    ASSERT_RETURN(dst == RA02_MAC_COORDINATOR, E_INVAL);
+
+    if (mac->slot == RA02_MAC_NO_SLOT) {
+      return E_AGAIN;
+    }
+
+    queue = &mac->queues[mac->slot];
+  }
+
+  if (queue->count == RA02_MAC_QUEUE_SIZE) {
+    mac->stats.dropped++;
+    return E_OVERFLOW;
+  }
+
+  ra02_mac_frame_t * frame = &queue->frames[(queue->head + queue->count) % RA02_MAC_QUEUE_SIZE];
+
+  frame->dst = dst;
+  frame->size = size;
+  memcpy(frame->data, buf, size);
+
+  queue->count++;
+
+  return E_OK;
+}
+
+error_t ra02_mac_run(ra02_mac_t * mac) {
+  ASSERT_RETURN(mac, E_NULL);
+
+  if (mac->cfg.address == RA02_MAC_COORDINATOR) {
+    return ra02_mac_run_coordinator(mac);
+  }
+
+  return ra02_mac_run_node(mac);
+}
+
+error_t ra02_mac_simulate(ra02_t * ra02, const ra02_mac_sim_cfg_t * cfg, ra02_mac_sim_result_t * result) {
+  ASSERT_RETURN(ra02 && cfg && result, E_NULL);
+  ASSERT_RETURN(ra02->modem == RA02_MODEM_LORA && ra02->bandwidth, E_INVAL);
+  ASSERT_RETURN(cfg->nodes && cfg->nodes <= RA02_MAC_MAX_SLOTS && cfg->load > 0 && cfg->duration_ms, E_INVAL);
+  ASSERT_RETURN(cfg->payload_size <= RA02_MAC_MAX_PAYLOAD, E_INVAL);
+
+  ra02_mac_sim_node_t * nodes = calloc(cfg->nodes, sizeof(ra02_mac_sim_node_t));
+
+  if (!nodes) {
+    return E_NOMEM;
+  }
+
+  uint32_t airtime_us;
+  ra02_mac_plan_t plan = {0};
+
+  ERROR_CHECK_RETURN(ra02_get_time_on_air(ra02, RA02_MAC_HEADER_SIZE + cfg->payload_size, &airtime_us), free(nodes));
+
+  if (cfg->proto == RA02_MAC_PROTO_TDMA) {
+    ra02_mac_cfg_t mac_cfg = {
+      .join_slots = cfg->join_slots,
+      .uplink_slots = cfg->nodes,
+      .max_payload = cfg->payload_size,
+      .drift_ppm = cfg->drift_ppm,
+      .jitter_us = cfg->jitter_us,
+    };
+
+    ERROR_CHECK_RETURN(ra02_mac_get_plan(ra02, &mac_cfg, &plan), free(nodes));
+  }
+
+  uint64_t duration_us = (uint64_t) cfg->duration_ms * 1000;
+  uint64_t cad_us = RA02_MAC_CAD_SYMBOLS * (((uint64_t) 1000000 << ra02->sf) / ra02->bandwidth);
+  double interval_us = (double) airtime_us * cfg->nodes / cfg->load;
+  unsigned int seed = cfg->seed;
+
+  memset(result, 0, sizeof(*result));
+
+  for (uint8_t i = 0; i < cfg->nodes; ++i) {
+    nodes[i].arrival_us = -log(ra02_mac_sim_random(&seed)) * interval_us;
+
+    if (cfg->proto == RA02_MAC_PROTO_TDMA) {
+      /* Node owns uplink slot i, transmits after half of guard */
+      nodes[i].state = RA02_MAC_SIM_START;
+      nodes[i].next_us = plan.beacon_slot_us + (uint64_t) (cfg->join_slots + i) * plan.slot_us + plan.guard_us / 2;
+    }
+  }
+
+  while (true) {
+    /* Next event: either frame arrival or state transition of some node */
+    ra02_mac_sim_node_t * node = NULL;
+    uint64_t now = UINT64_MAX;
+    bool arrival = false;
+
+    for (uint8_t i = 0; i < cfg->nodes; ++i) {
+      if (nodes[i].arrival_us < now) {
+        node = &nodes[i];
+        now = nodes[i].arrival_us;
+        arrival = true;
+      }
+
+      if (nodes[i].state != RA02_MAC_SIM_IDLE && nodes[i].next_us < now) {
+        node = &nodes[i];
+        now = nodes[i].next_us;
+        arrival = false;
+      }
+    }
+
+    if (now >= duration_us) {
+      break;
+    }
+
+    if (arrival) {
+      result->offered++;
+      node->arrival_us = now + -log(ra02_mac_sim_random(&seed)) * interval_us;
+
+      if (node->queued == RA02_MAC_QUEUE_SIZE) {
+        result->dropped++;
+        continue;
+      }
+
+      node->queued++;
+
+      if (node->state == RA02_MAC_SIM_IDLE) {
+        node->state = cfg->proto == RA02_MAC_PROTO_LBT ? RA02_MAC_SIM_SENSE : RA02_MAC_SIM_START;
+        node->next_us = now;
+      }
+
+      continue;
+    }
+
+    switch (node->state) {
+      case RA02_MAC_SIM_SENSE: {
+        bool busy = false;
+
+        for (uint8_t i = 0; i < cfg->nodes; ++i) {
+          busy |= nodes[i].state == RA02_MAC_SIM_TX && nodes[i].next_us > now;
+        }
+
+        if (busy) {
+          node->next_us = now + cad_us + ra02_mac_sim_random(&seed) * RA02_MAC_LBT_BACKOFF_MAX * airtime_us;
+        } else {
+          node->state = RA02_MAC_SIM_START;
+          node->next_us = now + cad_us + RA02_MAC_SWITCH_US;
+        }
+        break;
+      }
+
+      case RA02_MAC_SIM_START:
+        if (!node->queued) {
+          /* TDMA: slot unused */
+          node->next_us += plan.superframe_us;
+          break;
+        }
+
+        node->state = RA02_MAC_SIM_TX;
+        node->tx_start_us = now;
+        node->next_us = now + airtime_us;
+        node->collided = false;
+        result->sent++;
+
+        for (uint8_t i = 0; i < cfg->nodes; ++i) {
+          if (&nodes[i] != node && nodes[i].state == RA02_MAC_SIM_TX && nodes[i].next_us > now) {
+            nodes[i].collided = true;
+            node->collided = true;
+          }
+        }
+        break;
+
+      case RA02_MAC_SIM_TX:
+        if (node->collided) {
+          result->collided++;
+        } else {
+          result->delivered++;
+        }
+
+        node->queued--;
+
+        if (cfg->proto == RA02_MAC_PROTO_TDMA) {
+          node->state = RA02_MAC_SIM_START;
+          node->next_us = node->tx_start_us + plan.superframe_us;
+        } else if (node->queued) {
+          node->state = cfg->proto == RA02_MAC_PROTO_LBT ? RA02_MAC_SIM_SENSE : RA02_MAC_SIM_START;
+          node->next_us = now;
+        } else {
+          node->state = RA02_MAC_SIM_IDLE;
+        }
+        break;
+
+      default:
+        break;
+    }
+  }
+
+  free(nodes);
+
+  result->goodput_bps = result->delivered * cfg->payload_size * 8.0 / (duration_us / 1e6);
+  result->utilization = (double) result->delivered * airtime_us / duration_us;
+
+  return E_OK;
+}
@@ -0,0 +1,707 @@
+/** ========================================================================= *
+ *
+ * @file ra02_mesh.c
+ * @date 17-10-2026
+ * @author Maksym Tkachuk <max.r.tkachuk@gmail.com>
+ *
+ *  ========================================================================= */
+
+/* Includes ================================================================= */
+#include <ra02_mesh.h>
+#include <assertion.h>
+#include <util.h>
+#include <log.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+
+/* Defines ================================================================== */
+#define LOG_TAG MESH
+
+/** First byte of mesh frame */
+#define RA02_MESH_FRAME               0x4D
+
+/** Header field offsets */
+#define RA02_MESH_OFFSET_TTL          1
+#define RA02_MESH_OFFSET_HOPS         2
+#define RA02_MESH_OFFSET_ORIGIN       3
+#define RA02_MESH_OFFSET_SEQ          5
+#define RA02_MESH_OFFSET_DST          7
+#define RA02_MESH_OFFSET_PREV         9
+#define RA02_MESH_OFFSET_VIA          11
+
+/** Defaults */
+#define RA02_MESH_DEFAULT_TTL         4
+#define RA02_MESH_DEFAULT_DUP_MS      (60 * 1000)
+#define RA02_MESH_DEFAULT_ROUTE_MS    (10 * 60 * 1000)
+
+/** Duplicate cache slots checked per lookup */
+#define RA02_MESH_DUP_PROBES          8
+
+/** Flood relay delay window in time on air of relayed frame */
+#define RA02_MESH_WINDOW_AIRTIMES     3
+
+/** RSSI range mapped onto delay window: weakest relays first, strongest last */
+#define RA02_MESH_RSSI_FAR            -120
+#define RA02_MESH_RSSI_NEAR           -60
+
+/** Pending relay is cancelled after overhearing this many relays of the same frame */
+#define RA02_MESH_SUPPRESS_COUNT      2
+
+/** Simulated link budget: TX power, path loss at 1 m, path loss exponent, sensitivity, capture threshold */
+#define RA02_MESH_SIM_TX_DBM          14
+#define RA02_MESH_SIM_PL0_DB          40
+#define RA02_MESH_SIM_PL_EXP          2.7
+#define RA02_MESH_SIM_SENSITIVITY_DBM -120
+#define RA02_MESH_SIM_CAPTURE_DB      6
+
+/* Macros =================================================================== */
+#define RA02_MESH_KEY(origin, seq) (((uint32_t) (origin) << 16) | (seq))
+
+/* Exposed macros =========================================================== */
+/* Enums ==================================================================== */
+/* Types ==================================================================== */
+/**
+ * Simulated node
+ */
+typedef struct {
+  double      x;
+  double      y;
+  ra02_mesh_t mesh;
+  bool        tx;          /** Transmitting frame below */
+  uint64_t    tx_end_ns;
+  uint8_t     tx_size;
+  uint8_t     tx_frame[RA02_MAX_PACKET_SIZE];
+  uint16_t    rx_from;     /** Sender being received + 1, 0 if none */
+  int16_t     rx_rssi;
+  bool        rx_corrupt;
+} ra02_mesh_sim_node_t;
+
+/**
+ * Simulation state shared with gateway rx handler
+ */
+typedef struct {
+  const ra02_mesh_sim_cfg_t * cfg;
+  ra02_mesh_sim_result_t *    result;
+  ra02_mesh_sim_node_t *      nodes;
+  int16_t *                   rssi;      /** nodes x nodes link RSSI */
+  bool *                      delivered; /** Per message */
+  ra02_t *                    ra02;
+} ra02_mesh_sim_t;
+
+/* Variables ================================================================ */
+/* Private functions ======================================================== */
+static void ra02_mesh_put_u16(uint8_t * buf, uint16_t value) {
+  buf[0] = value;
+  buf[1] = value >> 8;
+}
+
+static uint16_t ra02_mesh_get_u16(const uint8_t * buf) {
+  return buf[0] | (buf[1] << 8);
+}
+
+/**
+ * Uniform random number in [0, 1)
+ */
+static double ra02_mesh_random(unsigned int * seed) {
+  return rand_r(seed) / ((double) RAND_MAX + 1.0);
+}
+
+static ra02_mesh_dup_t * ra02_mesh_dup_find(ra02_mesh_t * mesh, uint32_t key, uint64_t now_ns, bool insert) {
+  uint32_t hash = key * 2654435761u;
+  ra02_mesh_dup_t * free = NULL;
+
+  for (size_t i = 0; i < RA02_MESH_DUP_PROBES; ++i) {
+    ra02_mesh_dup_t * dup = &mesh->dups[(hash + i) % RA02_MESH_DUP_CACHE_SIZE];
+
+    if (dup->expiry_ns > now_ns && dup->key == key) {
+      return dup;
+    }
+
+    /* Reuse expired entry, or the one that expires first */
+    if (!free || (free->expiry_ns > now_ns && dup->expiry_ns < free->expiry_ns)) {
+      free = dup;
+    }
+  }
+
+  if (!insert) {
+    return NULL;
+  }
+
+  free->key = key;
+  free->expiry_ns = now_ns + mesh->cfg.dup_expiry_ms * 1000000ULL;
+
+  return NULL;
+}
+
+static ra02_mesh_route_t * ra02_mesh_route_find(ra02_mesh_t * mesh, uint16_t dst, uint64_t now_ns) {
+  for (size_t i = 0; i < RA02_MESH_MAX_ROUTES; ++i) {
+    if (mesh->routes[i].expiry_ns > now_ns && mesh->routes[i].dst == dst) {
+      return &mesh->routes[i];
+    }
+  }
+
+  return NULL;
+}
+
+static void ra02_mesh_route_learn(ra02_mesh_t * mesh, uint16_t dst, uint16_t next_hop, uint8_t hops, uint64_t now_ns) {
+  if (dst == mesh->cfg.address) {
+    return;
+  }
+
+  ra02_mesh_route_t * route = ra02_mesh_route_find(mesh, dst, now_ns);
+
+  if (route) {
+    /* Keep shorter route, unless it comes from the same neighbour */
+    if (route->next_hop != next_hop && route->hops < hops) {
+      return;
+    }
+  } else {
+    route = &mesh->routes[0];
+
+    for (size_t i = 1; i < RA02_MESH_MAX_ROUTES; ++i) {
+      if (mesh->routes[i].expiry_ns < route->expiry_ns) {
+        route = &mesh->routes[i];
+      }
+    }
+  }
+
+  route->dst = dst;
+  route->next_hop = next_hop;
+  route->hops = hops;
+  route->expiry_ns = now_ns + mesh->cfg.route_expiry_ms * 1000000ULL;
+}
+
+/**
+ * Next hop towards dst, or RA02_MESH_BROADCAST to flood
+ */
+static uint16_t ra02_mesh_via(ra02_mesh_t * mesh, uint16_t dst, uint64_t now_ns) {
+  if (!mesh->cfg.routing || dst == RA02_MESH_BROADCAST) {
+    return RA02_MESH_BROADCAST;
+  }
+
+  ra02_mesh_route_t * route = ra02_mesh_route_find(mesh, dst, now_ns);
+
+  return route ? route->next_hop : RA02_MESH_BROADCAST;
+}
+
+static ra02_mesh_pending_t * ra02_mesh_pending_find(ra02_mesh_t * mesh, uint32_t key) {
+  for (size_t i = 0; i < RA02_MESH_MAX_PENDING; ++i) {
+    if (mesh->pending[i].due_ns && mesh->pending[i].key == key) {
+      return &mesh->pending[i];
+    }
+  }
+
+  return NULL;
+}
+
+/**
+ * Relay delay: floods are spread over the window by RSSI (weak signal -
+ * far from sender - goes first) with airtime sized jitter, unicast gets jitter only
+ */
+static uint64_t ra02_mesh_delay_ns(ra02_mesh_t * mesh, bool flood, int16_t rssi, size_t size) {
+  uint32_t airtime_us = 0;
+
+  ra02_get_time_on_air(mesh->cfg.ra02, size, &airtime_us);
+
+  double jitter_us = ra02_mesh_random(&mesh->seed) * airtime_us;
+
+  if (!flood) {
+    return jitter_us / 2 * 1000;
+  }
+
+  double window_us = mesh->cfg.window_ms ? mesh->cfg.window_ms * 1000.0 : RA02_MESH_WINDOW_AIRTIMES * airtime_us;
+  double q = UTIL_CAP((double) (rssi - RA02_MESH_RSSI_FAR) / (RA02_MESH_RSSI_NEAR - RA02_MESH_RSSI_FAR), 0.0, 1.0);
+
+  return (q * window_us + jitter_us) * 1000;
+}
+
+/**
+ * Simulation: whether node's CAD would detect a transmission
+ */
+static bool ra02_mesh_sim_busy(ra02_mesh_sim_t * sim, uint16_t node) {
+  for (uint16_t i = 0; i < sim->cfg->nodes; ++i) {
+    if (sim->nodes[i].tx && sim->rssi[i * sim->cfg->nodes + node] >= RA02_MESH_SIM_SENSITIVITY_DBM) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/**
+ * Simulation: start transmission, receivers in range lock onto it or get interference
+ */
+static void ra02_mesh_sim_tx(ra02_mesh_sim_t * sim, uint16_t sender, const uint8_t * frame, size_t size, uint64_t now_ns) {
+  ra02_mesh_sim_node_t * node = &sim->nodes[sender];
+  uint32_t airtime_us = 0;
+
+  ra02_get_time_on_air(sim->ra02, size, &airtime_us);
+
+  node->tx = true;
+  node->tx_end_ns = now_ns + airtime_us * 1000ULL;
+  node->tx_size = size;
+  node->rx_from = 0;
+  memcpy(node->tx_frame, frame, size);
+
+  sim->result->transmissions++;
+  sim->result->airtime_us += airtime_us;
+
+  for (uint16_t i = 0; i < sim->cfg->nodes; ++i) {
+    ra02_mesh_sim_node_t * rx = &sim->nodes[i];
+    int16_t rssi = sim->rssi[sender * sim->cfg->nodes + i];
+
+    if (i == sender || rx->tx || rssi < RA02_MESH_SIM_SENSITIVITY_DBM) {
+      continue;
+    }
+
+    if (!rx->rx_from) {
+      rx->rx_from = sender + 1;
+      rx->rx_rssi = rssi;
+      rx->rx_corrupt = false;
+    } else if (rssi > rx->rx_rssi - RA02_MESH_SIM_CAPTURE_DB) {
+      rx->rx_corrupt = true;
+    }
+  }
+}
+
+/**
+ * Simulation: end transmission, pass frame to receivers that got it intact
+ */
+static void ra02_mesh_sim_tx_end(ra02_mesh_sim_t * sim, uint16_t sender) {
+  ra02_mesh_sim_node_t * node = &sim->nodes[sender];
+
+  node->tx = false;
+
+  for (uint16_t i = 0; i < sim->cfg->nodes; ++i) {
+    ra02_mesh_sim_node_t * rx = &sim->nodes[i];
+
+    if (rx->rx_from != sender + 1) {
+      continue;
+    }
+
+    rx->rx_from = 0;
+
+    if (!rx->rx_corrupt) {
+      uint32_t delivered = rx->mesh.stats.delivered;
+
+      ra02_mesh_process(&rx->mesh, node->tx_frame, node->tx_size, rx->rx_rssi, node->tx_end_ns);
+
+      if (!i && rx->mesh.stats.delivered != delivered) {
+        sim->result->max_hops = UTIL_MAX(sim->result->max_hops, node->tx_frame[RA02_MESH_OFFSET_HOPS] + 1u);
+      }
+    }
+  }
+}
+
+static void ra02_mesh_sim_gateway_rx(void * ctx, uint16_t origin, const uint8_t * buf, size_t size) {
+  ra02_mesh_sim_t * sim = ctx;
+
+  if (size < 4) {
+    return;
+  }
+
+  uint32_t index = buf[0] | (buf[1] << 8) | (buf[2] << 16) | ((uint32_t) buf[3] << 24);
+
+  if (index < sim->cfg->messages && !sim->delivered[index]) {
+    sim->delivered[index] = true;
+    sim->result->delivered++;
+  }
+}
+
+/* Shared functions ========================================================= */
+error_t ra02_mesh_init(ra02_mesh_t * mesh, const ra02_mesh_cfg_t * cfg) {
+  ASSERT_RETURN(mesh && cfg && cfg->ra02, E_NULL);
+  ASSERT_RETURN(cfg->address != RA02_MESH_BROADCAST, E_INVAL);
+
+  memset(mesh, 0, sizeof(*mesh));
+  memcpy(&mesh->cfg, cfg, sizeof(*cfg));
+
+  mesh->cfg.ttl = cfg->ttl ? cfg->ttl : RA02_MESH_DEFAULT_TTL;
+  mesh->cfg.dup_expiry_ms = cfg->dup_expiry_ms ? cfg->dup_expiry_ms : RA02_MESH_DEFAULT_DUP_MS;
+  mesh->cfg.route_expiry_ms = cfg->route_expiry_ms ? cfg->route_expiry_ms : RA02_MESH_DEFAULT_ROUTE_MS;
+  mesh->seed = cfg->address ^ timeout_now_ns();
+
+  return E_OK;
+}
+
+error_t ra02_mesh_encode(ra02_mesh_t * mesh, uint16_t dst, const uint8_t * buf, size_t size,
+                         uint8_t * frame, uint64_t now_ns) {
+  ASSERT_RETURN(mesh && frame && (buf || !size), E_NULL);
+  ASSERT_RETURN(size <= RA02_MESH_MAX_PAYLOAD, E_INVAL);
+
+  uint16_t seq = mesh->seq++;
+
+  frame[0] = RA02_MESH_FRAME;
+  frame[RA02_MESH_OFFSET_TTL] = mesh->cfg.ttl;
+  frame[RA02_MESH_OFFSET_HOPS] = 0;
+  ra02_mesh_put_u16(&frame[RA02_MESH_OFFSET_ORIGIN], mesh->cfg.address);
+  ra02_mesh_put_u16(&frame[RA02_MESH_OFFSET_SEQ], seq);
+  ra02_mesh_put_u16(&frame[RA02_MESH_OFFSET_DST], dst);
+  ra02_mesh_put_u16(&frame[RA02_MESH_OFFSET_PREV], mesh->cfg.address);
+  ra02_mesh_put_u16(&frame[RA02_MESH_OFFSET_VIA], ra02_mesh_via(mesh, dst, now_ns));
+
+  if (size) {
+    memcpy(&frame[RA02_MESH_HEADER_SIZE], buf, size);
+  }
+
+  /* Own frame must not be relayed back */
+  ra02_mesh_dup_find(mesh, RA02_MESH_KEY(mesh->cfg.address, seq), now_ns, true);
+
+  mesh->stats.originated++;
+
+  return E_OK;
+}
+
+error_t ra02_mesh_process(ra02_mesh_t * mesh, const uint8_t * frame, size_t size, int16_t rssi, uint64_t now_ns) {
+  ASSERT_RETURN(mesh && frame, E_NULL);
+  ASSERT_RETURN(size >= RA02_MESH_HEADER_SIZE && frame[0] == RA02_MESH_FRAME, E_INVAL);
+
+  uint8_t ttl = frame[RA02_MESH_OFFSET_TTL];
+  uint8_t hops = frame[RA02_MESH_OFFSET_HOPS];
+  uint16_t origin = ra02_mesh_get_u16(&frame[RA02_MESH_OFFSET_ORIGIN]);
+  uint16_t dst = ra02_mesh_get_u16(&frame[RA02_MESH_OFFSET_DST]);
+  uint16_t prev = ra02_mesh_get_u16(&frame[RA02_MESH_OFFSET_PREV]);
+  uint16_t via = ra02_mesh_get_u16(&frame[RA02_MESH_OFFSET_VIA]);
+  uint32_t key = RA02_MESH_KEY(origin, ra02_mesh_get_u16(&frame[RA02_MESH_OFFSET_SEQ]));
+
+  if (mesh->cfg.routing) {
+    ra02_mesh_route_learn(mesh, origin, prev, hops + 1, now_ns);
+    ra02_mesh_route_learn(mesh, prev, prev, 1, now_ns);
+  }
+
+  if (ra02_mesh_dup_find(mesh, key, now_ns, false)) {
+    mesh->stats.duplicates++;
+
+    ra02_mesh_pending_t * pending = ra02_mesh_pending_find(mesh, key);
+
+    if (pending && ++pending->heard >= RA02_MESH_SUPPRESS_COUNT) {
+      pending->due_ns = 0;
+      mesh->stats.suppressed++;
+    }
+
+    return E_OK;
+  }
+
+  ra02_mesh_dup_find(mesh, key, now_ns, true);
+
+  if (dst == mesh->cfg.address || dst == RA02_MESH_BROADCAST) {
+    mesh->stats.delivered++;
+
+    if (mesh->cfg.rx) {
+      mesh->cfg.rx(mesh->cfg.rx_ctx, origin, &frame[RA02_MESH_HEADER_SIZE], size - RA02_MESH_HEADER_SIZE);
+    }
+
+    if (dst == mesh->cfg.address) {
+      return E_OK;
+    }
+  }
+
+  /* Unicast hop is relayed only by the addressed neighbour */
+  if (via != RA02_MESH_BROADCAST && via != mesh->cfg.address) {
+    return E_OK;
+  }
+
+  if (ttl <= 1) {
+    mesh->stats.expired++;
+    return E_OK;
+  }
+
+  ra02_mesh_pending_t * pending = NULL;
+
+  for (size_t i = 0; i < RA02_MESH_MAX_PENDING && !pending; ++i) {
+    if (!mesh->pending[i].due_ns) {
+      pending = &mesh->pending[i];
+    }
+  }
+
+  if (!pending) {
+    log_warn("relay of %04x:%d dropped, too many pending", origin, key & 0xFFFF);
+    return E_OVERFLOW;
+  }
+
+  memcpy(pending->frame, frame, size);
+  pending->frame[RA02_MESH_OFFSET_TTL] = ttl - 1;
+  pending->frame[RA02_MESH_OFFSET_HOPS] = hops + 1;
+  ra02_mesh_put_u16(&pending->frame[RA02_MESH_OFFSET_PREV], mesh->cfg.address);
+
+  /* Learned route turns flood into unicast from here on */
+  uint16_t next = ra02_mesh_via(mesh, dst, now_ns);
+
+  ra02_mesh_put_u16(&pending->frame[RA02_MESH_OFFSET_VIA], next);
+
+  pending->key = key;
+  pending->heard = 0;
+  pending->size = size;
+  pending->due_ns = now_ns + ra02_mesh_delay_ns(mesh, next == RA02_MESH_BROADCAST, rssi, size) + 1;
+
+  return E_OK;
+}
+
+uint64_t ra02_mesh_next_due_ns(ra02_mesh_t * mesh) {
+  uint64_t due = UINT64_MAX;
+
+  for (size_t i = 0; i < RA02_MESH_MAX_PENDING; ++i) {
+    if (mesh->pending[i].due_ns) {
+      due = UTIL_MIN(due, mesh->pending[i].due_ns);
+    }
+  }
+
+  return due;
+}
+
+error_t ra02_mesh_pop_due(ra02_mesh_t * mesh, uint64_t now_ns, uint8_t * frame, size_t * size) {
+  ASSERT_RETURN(mesh && frame && size, E_NULL);
+
+  ra02_mesh_pending_t * pending = NULL;
+
+  for (size_t i = 0; i < RA02_MESH_MAX_PENDING; ++i) {
+    if (mesh->pending[i].due_ns && mesh->pending[i].due_ns <= now_ns
+        && (!pending || mesh->pending[i].due_ns < pending->due_ns)) {
+      pending = &mesh->pending[i];
+    }
+  }
+
+  if (!pending) {
+    return E_EMPTY;
+  }
+
+  memcpy(frame, pending->frame, pending->size);
+  *size = pending->size;
+  pending->due_ns = 0;
+
+  mesh->stats.relayed++;
+
+  return E_OK;
+}
+
+void ra02_mesh_defer(ra02_mesh_t * mesh, uint64_t now_ns) {
+  for (size_t i = 0; i < RA02_MESH_MAX_PENDING; ++i) {
+    ra02_mesh_pending_t * pending = &mesh->pending[i];
+
+    if (pending->due_ns && pending->due_ns <= now_ns) {
+      uint32_t airtime_us = 0;
+
+      ra02_get_time_on_air(mesh->cfg.ra02, pending->size, &airtime_us);
+
+      pending->due_ns = now_ns + (0.5 + ra02_mesh_random(&mesh->seed)) * airtime_us * 1000;
+      mesh->stats.deferred++;
+    }
+  }
+}
+
+error_t ra02_mesh_send(ra02_mesh_t * mesh, uint16_t dst, const uint8_t * buf, size_t size) {
+  ASSERT_RETURN(mesh, E_NULL);
+
+  uint8_t frame[RA02_MAX_PACKET_SIZE];
+
+  ERROR_CHECK_RETURN(ra02_mesh_encode(mesh, dst, buf, size, frame, timeout_now_ns()));
+
+  return ra02_send(mesh->cfg.ra02, frame, RA02_MESH_HEADER_SIZE + size);
+}
+
+error_t ra02_mesh_poll(ra02_mesh_t * mesh, timeout_t * timeout) {
+  ASSERT_RETURN(mesh && timeout, E_NULL);
+
+  uint8_t frame[RA02_MAX_PACKET_SIZE];
+  size_t size;
+
+  while (!timeout_is_expired(timeout)) {
+    uint64_t now = timeout_now_ns();
+    uint64_t due = ra02_mesh_next_due_ns(mesh);
+    uint64_t wait_ms = timeout_remaining_ms(timeout);
+
+    if (due != UINT64_MAX) {
+      wait_ms = UTIL_MIN(wait_ms, due > now ? (due - now + 999999) / 1000000 : 0);
+    }
+
+    if (wait_ms) {
+      TIMEOUT_CREATE(t, wait_ms);
+      size = sizeof(frame);
+
+      error_t err = ra02_recv(mesh->cfg.ra02, frame, &size, &t);
+
+      if (err == E_OK) {
+        ra02_mesh_process(mesh, frame, size, mesh->cfg.ra02->last_rssi, mesh->cfg.ra02->last_rx_ns);
+      } else if (err != E_TIMEOUT && err != E_CORRUPT) {
+        return err;
+      }
+    }
+
+    if (ra02_mesh_next_due_ns(mesh) > timeout_now_ns()) {
+      continue;
+    }
+
+    bool busy = false;
+
+    ERROR_CHECK_RETURN(ra02_cad(mesh->cfg.ra02, &busy));
+
+    if (busy) {
+      ra02_mesh_defer(mesh, timeout_now_ns());
+      continue;
+    }
+
+    if (ra02_mesh_pop_due(mesh, timeout_now_ns(), frame, &size) == E_OK) {
+      ERROR_CHECK_RETURN(ra02_send(mesh->cfg.ra02, frame, size));
+    }
+  }
+
+  return E_OK;
+}
+
+error_t ra02_mesh_simulate(ra02_t * ra02, const ra02_mesh_sim_cfg_t * cfg, ra02_mesh_sim_result_t * result) {
+  ASSERT_RETURN(ra02 && cfg && result, E_NULL);
+  ASSERT_RETURN(ra02->modem == RA02_MODEM_LORA && ra02->bandwidth, E_INVAL);
+  ASSERT_RETURN(cfg->nodes > 1 && cfg->side_m && cfg->messages && cfg->interval_ms, E_INVAL);
+  ASSERT_RETURN(cfg->payload_size >= 4 && cfg->payload_size <= RA02_MESH_MAX_PAYLOAD, E_INVAL);
+
+  ra02_mesh_sim_t sim = {
+    .cfg = cfg,
+    .result = result,
+    .nodes = calloc(cfg->nodes, sizeof(ra02_mesh_sim_node_t)),
+    .rssi = calloc((size_t) cfg->nodes * cfg->nodes, sizeof(int16_t)),
+    .delivered = calloc(cfg->messages, sizeof(bool)),
+    .ra02 = ra02,
+  };
+
+  unsigned int seed = cfg->seed;
+  error_t err = E_OK;
+
+  memset(result, 0, sizeof(*result));
+
+  if (!sim.nodes || !sim.rssi || !sim.delivered) {
+    err = E_NOMEM;
+    goto cleanup;
+  }
+
+  for (uint16_t i = 0; i < cfg->nodes; ++i) {
+    ra02_mesh_sim_node_t * node = &sim.nodes[i];
+
+    /* Gateway in the center */
+    node->x = i ? ra02_mesh_random(&seed) * cfg->side_m : cfg->side_m / 2.0;
+    node->y = i ? ra02_mesh_random(&seed) * cfg->side_m : cfg->side_m / 2.0;
+
+    err = ra02_mesh_init(&node->mesh, &(ra02_mesh_cfg_t){
+      .ra02 = ra02,
+      .address = i,
+      .ttl = cfg->ttl,
+      .routing = cfg->routing,
+      .rx = i ? NULL : ra02_mesh_sim_gateway_rx,
+      .rx_ctx = &sim,
+    });
+
+    if (err != E_OK) {
+      goto cleanup;
+    }
+
+    node->mesh.seed = cfg->seed + i;
+  }
+
+  /* Log-distance path loss */
+  for (uint16_t i = 0; i < cfg->nodes; ++i) {
+    for (uint16_t j = 0; j < cfg->nodes; ++j) {
+      double d = UTIL_MAX(hypot(sim.nodes[i].x - sim.nodes[j].x, sim.nodes[i].y - sim.nodes[j].y), 1.0);
+
+      sim.rssi[i * cfg->nodes + j] = RA02_MESH_SIM_TX_DBM - RA02_MESH_SIM_PL0_DB - 10 * RA02_MESH_SIM_PL_EXP * log10(d);
+    }
+  }
+
+  uint64_t interval_ns = cfg->interval_ms * 1000000ULL;
+  uint64_t hello_ns = cfg->hello_ms * 1000000ULL;
+  uint64_t next_msg = -log(1 - ra02_mesh_random(&seed)) * interval_ns;
+  uint64_t next_hello = hello_ns ? 0 : UINT64_MAX;
+  uint16_t msg_origin = 1 + rand_r(&seed) % (cfg->nodes - 1);
+
+  /* Run until all messages are sent and every relay has finished */
+  while (true) {
+    uint64_t now = UINT64_MAX;
+    int32_t who = -1;
+    enum { EV_TX_END, EV_RELAY, EV_MSG, EV_HELLO } event = EV_MSG;
+
+    for (uint16_t i = 0; i < cfg->nodes; ++i) {
+      ra02_mesh_sim_node_t * node = &sim.nodes[i];
+
+      if (node->tx && node->tx_end_ns <= now) {
+        now = node->tx_end_ns;
+        who = i;
+        event = EV_TX_END;
+      }
+    }
+
+    for (uint16_t i = 0; i < cfg->nodes; ++i) {
+      ra02_mesh_sim_node_t * node = &sim.nodes[i];
+      uint64_t due = ra02_mesh_next_due_ns(&node->mesh);
+
+      /* Half-duplex: relay waits for own transmission to end */
+      if (!node->tx && due < now) {
+        now = due;
+        who = i;
+        event = EV_RELAY;
+      }
+    }
+
+    if (result->sent < cfg->messages && next_msg < now && !sim.nodes[msg_origin].tx) {
+      now = next_msg;
+      event = EV_MSG;
+    }
+
+    if (next_hello < now && result->sent < cfg->messages && !sim.nodes[0].tx) {
+      now = next_hello;
+      event = EV_HELLO;
+    }
+
+    if (now == UINT64_MAX) {
+      break;
+    }
+
+    uint8_t frame[RA02_MAX_PACKET_SIZE];
+    size_t size;
+
+    switch (event) {
+      case EV_TX_END:
+        ra02_mesh_sim_tx_end(&sim, who);
+        break;
+
+      case EV_RELAY:
+        if (ra02_mesh_sim_busy(&sim, who)) {
+          ra02_mesh_defer(&sim.nodes[who].mesh, now);
+        } else if (ra02_mesh_pop_due(&sim.nodes[who].mesh, now, frame, &size) == E_OK) {
+          ra02_mesh_sim_tx(&sim, who, frame, size, now);
+        }
+        break;
+
+      case EV_MSG: {
+        uint8_t payload[RA02_MESH_MAX_PAYLOAD] = {0};
+
+        payload[0] = result->sent;
+        payload[1] = result->sent >> 8;
+        payload[2] = result->sent >> 16;
+        payload[3] = result->sent >> 24;
+
+        ra02_mesh_encode(&sim.nodes[msg_origin].mesh, 0, payload, cfg->payload_size, frame, now);
+        ra02_mesh_sim_tx(&sim, msg_origin, frame, RA02_MESH_HEADER_SIZE + cfg->payload_size, now);
+
+        result->sent++;
+        next_msg += -log(1 - ra02_mesh_random(&seed)) * interval_ns;
+        msg_origin = 1 + rand_r(&seed) % (cfg->nodes - 1);
+        break;
+      }
+
+      case EV_HELLO:
+        ra02_mesh_encode(&sim.nodes[0].mesh, RA02_MESH_BROADCAST, NULL, 0, frame, now);
+        ra02_mesh_sim_tx(&sim, 0, frame, RA02_MESH_HEADER_SIZE, now);
+        next_hello += hello_ns;
+        break;
+    }
+  }
+
+  result->delivery_ratio = (double) result->delivered / result->sent;
+  result->airtime_per_delivered_ms = result->delivered ? result->airtime_us / 1000.0 / result->delivered : 0;
+
+cleanup:
+  free(sim.nodes);
+  free(sim.rssi);
+  free(sim.delivered);
+
+  return err;
+}
@@ -0,0 +1,605 @@
+/** ========================================================================= *
+ *
+ * @file ra02_mgr.c
+ * @date 17-10-2026
+ * @author Maksym Tkachuk <max.r.tkachuk@gmail.com>
+ *
+ *  ========================================================================= */
+
+/* Includes ================================================================= */
+#define _GNU_SOURCE /* CPU_SET, pthread_setaffinity_np */
+#include <ra02_mgr.h>
+#include <timeout.h>
+#include <assertion.h>
+#include <util.h>
+#include <log.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include <sched.h>
+#include <sys/mman.h>
+
+/* Defines ================================================================== */
+#define LOG_TAG MGR
+
+/** Defaults */
+#define RA02_MGR_DEFAULT_RX_SLICE_MS 10
+
+/** Longest config line */
+#define RA02_MGR_LINE_SIZE           256
+
+/** Emulated radio in config */
+#define RA02_MGR_EMU_SPIDEV          "emu"
+
+/* Macros =================================================================== */
+/* Exposed macros =========================================================== */
+/* Enums ==================================================================== */
+/* Types ==================================================================== */
+/* Variables ================================================================ */
+/* Private functions ======================================================== */
+static error_t ra02_mgr_parse_u32(const char * str, uint32_t * value) {
+  char * end;
+  unsigned long parsed = strtoul(str, &end, 0);
+
+  ASSERT_RETURN(*str && !*end && parsed <= UINT32_MAX, E_INVAL);
+
+  *value = parsed;
+
+  return E_OK;
+}
+
+static error_t ra02_mgr_parse_i32(const char * str, int32_t * value) {
+  char * end;
+  long parsed = strtol(str, &end, 0);
+
+  ASSERT_RETURN(*str && !*end && parsed >= INT32_MIN && parsed <= INT32_MAX, E_INVAL);
+
+  *value = parsed;
+
+  return E_OK;
+}
+
+/**
+ * Parse KEY=VALUE of radio directive
+ */
+static error_t ra02_mgr_parse_radio_key(ra02_mgr_radio_cfg_t * radio, char * token) {
+  char * value = strchr(token, '=');
+  uint32_t number = 0;
+
+  ASSERT_RETURN(value, E_INVAL);
+
+  *value++ = '\0';
+
+  if (!strcmp(token, "gpiochip")) {
+    ASSERT_RETURN(strlen(value) < sizeof(radio->gpiochip), E_OVERFLOW);
+    strcpy(radio->gpiochip, value);
+    return E_OK;
+  }
+
+  if (!strcmp(token, "dio0")) {
+    return ra02_mgr_parse_i32(value, &radio->dio0);
+  }
+
+  if (!strcmp(token, "dio1")) {
+    return ra02_mgr_parse_i32(value, &radio->dio1);
+  }
+
+  if (!strcmp(token, "cpu")) {
+    return ra02_mgr_parse_i32(value, &radio->cpu);
+  }
+
+  ERROR_CHECK_RETURN(ra02_mgr_parse_u32(value, &number));
+
+  if (!strcmp(token, "freq")) {
+    radio->freq_khz = number;
+  } else if (!strcmp(token, "sf")) {
+    ASSERT_RETURN(number >= RA02_SCAN_SF_MIN && number <= RA02_SCAN_SF_MAX, E_INVAL);
+    radio->sf = number;
+  } else if (!strcmp(token, "bw")) {
+    radio->bandwidth = number * 1000;
+  } else if (!strcmp(token, "power")) {
+    ASSERT_RETURN(number <= UINT8_MAX, E_INVAL);
+    radio->power = number;
+  } else if (!strcmp(token, "priority")) {
+    ASSERT_RETURN(number <= (uint32_t) sched_get_priority_max(SCHED_FIFO), E_INVAL);
+    radio->priority = number;
+  } else {
+    return E_NOTFOUND;
+  }
+
+  return E_OK;
+}
+
+/**
+ * Parse single config line, that has comment stripped
+ */
+static error_t ra02_mgr_parse_line(ra02_mgr_cfg_t * cfg, char * line) {
+  char * save = NULL;
+  char * directive = strtok_r(line, " \t\r\n", &save);
+
+  if (!directive) {
+    return E_OK;
+  }
+
+  if (!strcmp(directive, "mlock")) {
+    cfg->mlock = true;
+    return E_OK;
+  }
+
+  if (!strcmp(directive, "slice")) {
+    char * value = strtok_r(NULL, " \t\r\n", &save);
+    ASSERT_RETURN(value, E_INVAL);
+    return ra02_mgr_parse_u32(value, &cfg->rx_slice_ms);
+  }
+
+  ASSERT_RETURN(!strcmp(directive, "radio"), E_NOTFOUND);
+  ASSERT_RETURN(cfg->count < RA02_MGR_MAX_RADIOS, E_OVERFLOW);
+
+  ra02_mgr_radio_cfg_t * radio = &cfg->radios[cfg->count];
+  char * spidev = strtok_r(NULL, " \t\r\n", &save);
+
+  ASSERT_RETURN(spidev && strlen(spidev) < sizeof(radio->spidev), E_INVAL);
+
+  *radio = (ra02_mgr_radio_cfg_t) {.dio0 = -1, .dio1 = -1, .cpu = -1};
+  strcpy(radio->spidev, spidev);
+
+  for (char * token; (token = strtok_r(NULL, " \t\r\n", &save));) {
+    ERROR_CHECK_RETURN(ra02_mgr_parse_radio_key(radio, token));
+  }
+
+  cfg->count++;
+
+  return E_OK;
+}
+
+static void ra02_mgr_radio_deinit(ra02_mgr_radio_t * radio) {
+  if (radio->ready) {
+    ra02_sleep(&radio->ra02);
+  }
+
+  ra02_deinit(&radio->ra02);
+
+  for (size_t i = 0; i < UTIL_ARR_SIZE(radio->dio); ++i) {
+    if (radio->dio[i].fd >= 0) {
+      gpio_deinit(&radio->dio[i]);
+      radio->dio[i].fd = -1;
+    }
+  }
+
+  if (radio->emulated) {
+    ra02_emu_deinit(&radio->emu);
+  } else {
+    spi_deinit(&radio->spi);
+  }
+
+  radio->ready = false;
+}
+
+static error_t ra02_mgr_radio_init(ra02_mgr_t * mgr, ra02_mgr_radio_t * radio) {
+  ra02_mgr_radio_cfg_t * cfg = &radio->cfg;
+  int32_t lines[] = {cfg->dio0, cfg->dio1};
+  ra02_cfg_t ra02_cfg = {.spi = &radio->spi};
+
+  if (!strcmp(cfg->spidev, RA02_MGR_EMU_SPIDEV)) {
+    if (!mgr->air_ready) {
+      ERROR_CHECK_RETURN(ra02_emu_air_init(&mgr->air));
+      mgr->air_ready = true;
+    }
+
+    ERROR_CHECK_RETURN(ra02_emu_init(&radio->emu, &mgr->air, &radio->spi));
+    radio->emulated = true;
+
+    /* Emulated DIOs, so that radio thread sleeps instead of polling */
+    for (size_t i = 0; i < UTIL_ARR_SIZE(radio->dio); ++i) {
+      ERROR_CHECK_RETURN(ra02_emu_dio_init(&radio->emu, i, &radio->dio[i]));
+    }
+  } else {
+    spi_cfg_t spi_cfg;
+
+    spi_cfg_default(&spi_cfg);
+    ERROR_CHECK_RETURN(spi_init(&radio->spi, &spi_cfg, cfg->spidev));
+
+    for (size_t i = 0; i < UTIL_ARR_SIZE(lines); ++i) {
+      if (cfg->gpiochip[0] && lines[i] >= 0) {
+        ERROR_CHECK_RETURN(gpio_init(&radio->dio[i], cfg->gpiochip, lines[i], GPIO_EDGE_RISING));
+      }
+    }
+  }
+
+  ra02_cfg.dio0 = radio->dio[0].fd >= 0 ? &radio->dio[0] : NULL;
+  ra02_cfg.dio1 = radio->dio[1].fd >= 0 ? &radio->dio[1] : NULL;
+
+  ERROR_CHECK_RETURN(ra02_init(&radio->ra02, &ra02_cfg));
+
+  if (cfg->freq_khz) {
+    ERROR_CHECK_RETURN(ra02_set_freq(&radio->ra02, cfg->freq_khz));
+  }
+
+  if (cfg->sf) {
+    ERROR_CHECK_RETURN(ra02_set_sf(&radio->ra02, cfg->sf));
+  }
+
+  if (cfg->bandwidth) {
+    ERROR_CHECK_RETURN(ra02_set_bandwidth(&radio->ra02, cfg->bandwidth));
+  }
+
+  if (cfg->power) {
+    ERROR_CHECK_RETURN(ra02_set_power(&radio->ra02, cfg->power));
+  }
+
+  radio->ready = true;
+
+  log_info("radio %d: %s, %d kHz, SF%d, cpu %d, priority %d", radio->index, cfg->spidev, cfg->freq_khz,
+           radio->ra02.sf, cfg->cpu, cfg->priority);
+
+  return E_OK;
+}
+
+/**
+ * Apply CPU affinity & real-time priority to calling thread
+ */
+static void ra02_mgr_radio_setup_thread(ra02_mgr_radio_t * radio) {
+  if (radio->cfg.cpu >= 0) {
+    cpu_set_t set;
+
+    CPU_ZERO(&set);
+    CPU_SET(radio->cfg.cpu, &set);
+
+    if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set)) {
+      log_warn("radio %d: can't pin to CPU %d", radio->index, radio->cfg.cpu);
+    }
+  }
+
+  if (radio->cfg.priority) {
+    struct sched_param param = {.sched_priority = radio->cfg.priority};
+
+    if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &param)) {
+      log_warn("radio %d: can't set SCHED_FIFO priority %d", radio->index, radio->cfg.priority);
+    }
+  }
+}
+
+/**
+ * Transmit frames queued for the radio
+ */
+static void ra02_mgr_radio_tx(ra02_mgr_t * mgr, ra02_mgr_radio_t * radio) {
+  ra02_mgr_txpk_t txpk;
+
+  while (mgr->running) {
+    pthread_mutex_lock(&mgr->lock);
+
+    if (!radio->tx_count) {
+      pthread_mutex_unlock(&mgr->lock);
+      return;
+    }
+
+    txpk = radio->tx[radio->tx_head];
+    radio->tx_head = (radio->tx_head + 1) % RA02_MGR_TX_QUEUE_SIZE;
+    radio->tx_count--;
+
+    pthread_mutex_unlock(&mgr->lock);
+
+    error_t err = ra02_send(&radio->ra02, txpk.data, txpk.size);
+    uint64_t latency_us = radio->ra02.last_tx_ns > txpk.queued_ns
+                          ? (radio->ra02.last_tx_ns - txpk.queued_ns) / 1000 : 0;
+
+    pthread_mutex_lock(&mgr->lock);
+
+    if (err == E_OK) {
+      radio->stats.tx++;
+      radio->stats.tx_bytes += txpk.size;
+      radio->tx_latency_us += latency_us;
+      radio->stats.tx_latency_max_us = UTIL_MAX(radio->stats.tx_latency_max_us, latency_us);
+    } else {
+      radio->stats.tx_failed++;
+    }
+
+    pthread_mutex_unlock(&mgr->lock);
+
+    if (err != E_OK && err != E_CANCELLED) {
+      log_error("radio %d: ra02_send: %s", radio->index, error2str(err));
+    }
+  }
+}
+
+/**
+ * Receive single slice and pass frame to merged queue
+ */
+static error_t ra02_mgr_radio_rx(ra02_mgr_t * mgr, ra02_mgr_radio_t * radio) {
+  ra02_mgr_packet_t packet;
+  size_t size = sizeof(packet.data);
+
+  TIMEOUT_CREATE(t, mgr->cfg.rx_slice_ms);
+
+  error_t err = ra02_recv(&radio->ra02, packet.data, &size, &t);
+
+  if (err == E_TIMEOUT || err == E_CANCELLED) {
+    return E_OK;
+  }
+
+  if (err == E_CORRUPT) {
+    pthread_mutex_lock(&mgr->lock);
+    radio->stats.rx_bad++;
+    pthread_mutex_unlock(&mgr->lock);
+    return E_OK;
+  }
+
+  ERROR_CHECK_RETURN(err);
+
+  packet.radio = radio->index;
+  packet.rx_ns = radio->ra02.last_rx_ns;
+  packet.rssi  = radio->ra02.last_rssi;
+  packet.snr   = radio->ra02.last_snr;
+  packet.size  = size;
+
+  pthread_mutex_lock(&mgr->lock);
+
+  radio->stats.rx++;
+  radio->stats.rx_bytes += size;
+
+  if (mgr->rx_count < RA02_MGR_RX_QUEUE_SIZE) {
+    mgr->rx[(mgr->rx_head + mgr->rx_count++) % RA02_MGR_RX_QUEUE_SIZE] = packet;
+    pthread_cond_signal(&mgr->rx_ready);
+  } else {
+    radio->stats.rx_dropped++;
+  }
+
+  pthread_mutex_unlock(&mgr->lock);
+
+  return E_OK;
+}
+
+static void * ra02_mgr_radio_thread(void * arg) {
+  ra02_mgr_radio_t * radio = arg;
+  ra02_mgr_t * mgr = radio->mgr;
+
+  ra02_mgr_radio_setup_thread(radio);
+
+  while (mgr->running) {
+    ra02_mgr_radio_tx(mgr, radio);
+
+    error_t err = ra02_mgr_radio_rx(mgr, radio);
+
+    if (err != E_OK) {
+      log_error("radio %d: ra02_recv: %s", radio->index, error2str(err));
+      break;
+    }
+  }
+
+  ra02_sleep(&radio->ra02);
+
+  return NULL;
+}
+
+static double ra02_mgr_bps(uint64_t bytes, uint64_t elapsed_ns) {
+  return elapsed_ns ? bytes * 8 * 1e9 / elapsed_ns : 0;
+}
+
+/* Shared functions ========================================================= */
+error_t ra02_mgr_parse_config(const char * path, ra02_mgr_cfg_t * cfg) {
+  ASSERT_RETURN(path && cfg, E_NULL);
+
+  FILE * file = fopen(path, "r");
+  ASSERT_RETURN(file, E_NOTFOUND);
+
+  char line[RA02_MGR_LINE_SIZE];
+  error_t err = E_OK;
+
+  memset(cfg, 0, sizeof(*cfg));
+
+  for (size_t number = 1; err == E_OK && fgets(line, sizeof(line), file); ++number) {
+    char * comment = strchr(line, '#');
+
+    if (comment) {
+      *comment = '\0';
+    }
+
+    err = ra02_mgr_parse_line(cfg, line);
+
+    if (err != E_OK) {
+      log_error("%s:%d: %s", path, number, error2str(err));
+      err = E_CORRUPT;
+    }
+  }
+
+  fclose(file);
+
+  ERROR_CHECK_RETURN(err);
+  ASSERT_RETURN(cfg->count, E_CORRUPT);
+
+  return E_OK;
+}
+
+error_t ra02_mgr_init(ra02_mgr_t * mgr, const ra02_mgr_cfg_t * cfg) {
+  ASSERT_RETURN(mgr && cfg, E_NULL);
+  ASSERT_RETURN(cfg->count && cfg->count <= RA02_MGR_MAX_RADIOS, E_INVAL);
+
+  memset(mgr, 0, sizeof(*mgr));
+
+  mgr->cfg = *cfg;
+  mgr->cfg.rx_slice_ms = cfg->rx_slice_ms ? cfg->rx_slice_ms : RA02_MGR_DEFAULT_RX_SLICE_MS;
+
+  pthread_mutex_init(&mgr->lock, NULL);
+  pthread_cond_init(&mgr->rx_ready, NULL);
+
+  for (uint8_t i = 0; i < RA02_MGR_MAX_RADIOS; ++i) {
+    mgr->radios[i] = (ra02_mgr_radio_t) {
+      .mgr = mgr,
+      .index = i,
+      .cfg = cfg->radios[i],
+      .spi = {.fd = -1},
+      .dio = {{.fd = -1}, {.fd = -1}},
+    };
+  }
+
+  for (uint8_t i = 0; i < cfg->count; ++i) {
+    error_t err = ra02_mgr_radio_init(mgr, &mgr->radios[i]);
+
+    if (err != E_OK) {
+      log_error("radio %d (%s): %s", i, cfg->radios[i].spidev, error2str(err));
+      return err;
+    }
+  }
+
+  return E_OK;
+}
+
+error_t ra02_mgr_deinit(ra02_mgr_t * mgr) {
+  ASSERT_RETURN(mgr, E_NULL);
+
+  ra02_mgr_stop(mgr);
+
+  for (uint8_t i = 0; i < mgr->cfg.count; ++i) {
+    ra02_mgr_radio_t * radio = &mgr->radios[i];
+
+    if (radio->started) {
+      /* Wake thread from RX slice right away */
+      ra02_cancel(&radio->ra02);
+      pthread_join(radio->thread, NULL);
+      radio->started = false;
+    }
+
+    ra02_mgr_radio_deinit(radio);
+  }
+
+  if (mgr->air_ready) {
+    ra02_emu_air_deinit(&mgr->air);
+    mgr->air_ready = false;
+  }
+
+  pthread_cond_destroy(&mgr->rx_ready);
+  pthread_mutex_destroy(&mgr->lock);
+
+  return E_OK;
+}
+
+error_t ra02_mgr_start(ra02_mgr_t * mgr) {
+  ASSERT_RETURN(mgr, E_NULL);
+  ASSERT_RETURN(!mgr->running, E_BUSY);
+
+  if (mgr->cfg.mlock && mlockall(MCL_CURRENT | MCL_FUTURE)) {
+    log_warn("mlockall failed, pages may fault on hot path");
+  }
+
+  mgr->running = true;
+  mgr->start_ns = timeout_now_ns();
+
+  for (uint8_t i = 0; i < mgr->cfg.count; ++i) {
+    ra02_mgr_radio_t * radio = &mgr->radios[i];
+
+    if (pthread_create(&radio->thread, NULL, ra02_mgr_radio_thread, radio)) {
+      log_error("radio %d: can't start thread", i);
+      ra02_mgr_stop(mgr);
+      return E_FAILED;
+    }
+
+    radio->started = true;
+  }
+
+  return E_OK;
+}
+
+void ra02_mgr_stop(ra02_mgr_t * mgr) {
+  mgr->running = false;
+}
+
+error_t ra02_mgr_send(ra02_mgr_t * mgr, uint8_t radio, const uint8_t * buf, size_t size) {
+  ASSERT_RETURN(mgr && buf, E_NULL);
+  ASSERT_RETURN(radio < mgr->cfg.count, E_OUTOFBOUNDS);
+  ASSERT_RETURN(size && size <= RA02_MAX_PACKET_SIZE, E_INVAL);
+
+  ra02_mgr_radio_t * r = &mgr->radios[radio];
+  error_t err = E_OK;
+
+  pthread_mutex_lock(&mgr->lock);
+
+  if (r->tx_count < RA02_MGR_TX_QUEUE_SIZE) {
+    ra02_mgr_txpk_t * txpk = &r->tx[(r->tx_head + r->tx_count++) % RA02_MGR_TX_QUEUE_SIZE];
+
+    txpk->queued_ns = timeout_now_ns();
+    txpk->size = size;
+    memcpy(txpk->data, buf, size);
+  } else {
+    r->stats.tx_dropped++;
+    err = E_BUSY;
+  }
+
+  pthread_mutex_unlock(&mgr->lock);
+
+  return err;
+}
+
+error_t ra02_mgr_recv(ra02_mgr_t * mgr, ra02_mgr_packet_t * packet, uint32_t timeout_ms) {
+  ASSERT_RETURN(mgr && packet, E_NULL);
+
+  struct timespec deadline;
+  clock_gettime(CLOCK_REALTIME, &deadline);
+
+  uint64_t ns = deadline.tv_nsec + (uint64_t) timeout_ms * 1000000;
+  deadline.tv_sec += ns / 1000000000;
+  deadline.tv_nsec = ns % 1000000000;
+
+  pthread_mutex_lock(&mgr->lock);
+
+  while (!mgr->rx_count) {
+    if (pthread_cond_timedwait(&mgr->rx_ready, &mgr->lock, &deadline)) {
+      pthread_mutex_unlock(&mgr->lock);
+      return E_TIMEOUT;
+    }
+  }
+
+  *packet = mgr->rx[mgr->rx_head];
+  mgr->rx_head = (mgr->rx_head + 1) % RA02_MGR_RX_QUEUE_SIZE;
+  mgr->rx_count--;
+
+  pthread_mutex_unlock(&mgr->lock);
+
+  return E_OK;
+}
+
+error_t ra02_mgr_get_stats(ra02_mgr_t * mgr, ra02_mgr_stats_t * stats, ra02_mgr_stats_t * total) {
+  ASSERT_RETURN(mgr, E_NULL);
+
+  uint64_t elapsed_ns = mgr->start_ns ? timeout_now_ns() - mgr->start_ns : 0;
+  uint64_t latency_us = 0;
+  ra02_mgr_stats_t sum = {0};
+
+  pthread_mutex_lock(&mgr->lock);
+
+  for (uint8_t i = 0; i < mgr->cfg.count; ++i) {
+    ra02_mgr_radio_t * radio = &mgr->radios[i];
+    ra02_mgr_stats_t s = radio->stats;
+
+    s.tx_latency_avg_us = s.tx ? radio->tx_latency_us / s.tx : 0;
+    s.rx_bps = ra02_mgr_bps(s.rx_bytes, elapsed_ns);
+    s.tx_bps = ra02_mgr_bps(s.tx_bytes, elapsed_ns);
+
+    if (stats) {
+      stats[i] = s;
+    }
+
+    sum.rx                += s.rx;
+    sum.rx_bad            += s.rx_bad;
+    sum.rx_dropped        += s.rx_dropped;
+    sum.rx_bytes          += s.rx_bytes;
+    sum.tx                += s.tx;
+    sum.tx_failed         += s.tx_failed;
+    sum.tx_dropped        += s.tx_dropped;
+    sum.tx_bytes          += s.tx_bytes;
+    sum.tx_latency_max_us  = UTIL_MAX(sum.tx_latency_max_us, s.tx_latency_max_us);
+    latency_us            += radio->tx_latency_us;
+  }
+
+  pthread_mutex_unlock(&mgr->lock);
+
+  sum.tx_latency_avg_us = sum.tx ? latency_us / sum.tx : 0;
+  sum.rx_bps = ra02_mgr_bps(sum.rx_bytes, elapsed_ns);
+  sum.tx_bps = ra02_mgr_bps(sum.tx_bytes, elapsed_ns);
+
+  if (total) {
+    *total = sum;
+  }
+
+  return E_OK;
+}
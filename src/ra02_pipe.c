@@ -0,0 +1,424 @@
+/** ========================================================================= *
+ *
+ * @file ra02_pipe.c
+ * @date 17-10-2026
+ * @author Maksym Tkachuk <max.r.tkachuk@gmail.com>
+ *
+ *  ========================================================================= */
+
+/* Includes ================================================================= */
+#include <ra02_pipe.h>
+#include <ra02_daemon.h>
+#include <timeout.h>
+#include <assertion.h>
+#include <util.h>
+#include <log.h>
+#include <string.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include <pthread.h>
+
+/* Defines ================================================================== */
+#define LOG_TAG PIPE
+
+/** RX slice, stop flag is checked between slices */
+#define RA02_PIPE_RX_SLICE_MS 100
+
+/** Longest hex line: timestamp, RSSI, SNR and RA02_MAX_PACKET_SIZE bytes in hex */
+#define RA02_PIPE_LINE_SIZE   (2 * RA02_MAX_PACKET_SIZE + 64)
+
+/** Binary RX record header: [size] [rssi] [snr] [rx_ns, 8 bytes] */
+#define RA02_PIPE_BINARY_HEADER_SIZE 11
+
+/* Macros =================================================================== */
+#define RA02_PIPE_RUNNING(running) (!(running) || *(running))
+
+/* Exposed macros =========================================================== */
+/* Enums ==================================================================== */
+/* Types ==================================================================== */
+/**
+ * Queue between RX loop and writer thread
+ */
+typedef struct {
+  const ra02_pipe_cfg_t * cfg;
+  pthread_mutex_t         lock;
+  pthread_cond_t          cond;
+  ra02_daemon_packet_t    frames[RA02_PIPE_QUEUE_SIZE];
+  size_t                  head;
+  size_t                  count;
+  bool                    done;    /** RX loop finished */
+  bool                    failed;  /** Output can't be written anymore */
+  ra02_pipe_stats_t       stats;
+} ra02_pipe_queue_t;
+
+/* Variables ================================================================ */
+/* Private functions ======================================================== */
+static int ra02_pipe_hex_digit(char c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+
+  c = tolower(c);
+
+  return c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1;
+}
+
+/**
+ * Check that text before frame of hex line is RX output metadata
+ * "<rx time in us> <rssi> <snr>"
+ */
+static bool ra02_pipe_is_rx_prefix(const char * str, const char * end) {
+  for (size_t i = 0; i < 3; ++i) {
+    char * next;
+
+    strtoll(str, &next, 10);
+
+    if (next == str || next >= end || !isspace((unsigned char) *next)) {
+      return false;
+    }
+
+    str = next;
+  }
+
+  return str + strspn(str, " \t") == end;
+}
+
+/**
+ * Read next frame from input
+ *
+ * @retval E_EMPTY End of input
+ * @retval E_CORRUPT Malformed frame, input is positioned at the next one
+ */
+static error_t ra02_pipe_read_frame(FILE * file, ra02_pipe_format_t format, uint8_t * buf, size_t * size) {
+  if (format == RA02_PIPE_FORMAT_BINARY) {
+    int len = fgetc(file);
+
+    if (len == EOF) {
+      return E_EMPTY;
+    }
+
+    ASSERT_RETURN(len, E_CORRUPT);
+
+    if (len > RA02_MAX_PACKET_SIZE) {
+      /* Skip oversized frame, so next one is read from its length byte */
+      for (int i = 0; i < len; ++i) {
+        ASSERT_RETURN(fgetc(file) != EOF, E_EMPTY);
+      }
+      return E_CORRUPT;
+    }
+
+    ASSERT_RETURN(fread(buf, 1, len, file) == (size_t) len, E_EMPTY);
+
+    *size = len;
+
+    return E_OK;
+  }
+
+  ASSERT_RETURN(format == RA02_PIPE_FORMAT_HEX, E_INVAL);
+
+  char line[RA02_PIPE_LINE_SIZE];
+
+  while (fgets(line, sizeof(line), file)) {
+    size_t len = strlen(line);
+
+    if (len && line[len - 1] != '\n' && !feof(file)) {
+      /* Skip rest of too long line */
+      int c;
+      while ((c = fgetc(file)) != EOF && c != '\n') {}
+      return E_CORRUPT;
+    }
+
+    while (len && isspace((unsigned char) line[len - 1])) {
+      line[--len] = '\0';
+    }
+
+    if (!len || line[strspn(line, " \t")] == '#') {
+      continue;
+    }
+
+    /* Frame is the last token of the line */
+    const char * hex = line + len;
+
+    while (hex > line && !isspace((unsigned char) hex[-1])) {
+      --hex;
+    }
+
+    /* Anything else before it must be metadata of RX output */
+    ASSERT_RETURN(hex == line + strspn(line, " \t") || ra02_pipe_is_rx_prefix(line, hex), E_CORRUPT);
+
+    size_t digits = line + len - hex;
+    ASSERT_RETURN(digits % 2 == 0 && digits / 2 <= RA02_MAX_PACKET_SIZE, E_CORRUPT);
+
+    for (size_t i = 0; i < digits / 2; ++i) {
+      int hi = ra02_pipe_hex_digit(hex[2 * i]);
+      int lo = ra02_pipe_hex_digit(hex[2 * i + 1]);
+      ASSERT_RETURN(hi >= 0 && lo >= 0, E_CORRUPT);
+
+      buf[i] = (hi << 4) | lo;
+    }
+
+    *size = digits / 2;
+
+    return E_OK;
+  }
+
+  return E_EMPTY;
+}
+
+static bool ra02_pipe_write_frame(FILE * file, ra02_pipe_format_t format, const ra02_daemon_packet_t * frame) {
+  switch (format) {
+    case RA02_PIPE_FORMAT_BINARY: {
+      uint8_t header[RA02_PIPE_BINARY_HEADER_SIZE] = {frame->size, frame->rssi, frame->snr};
+
+      for (size_t i = 0; i < 8; ++i) {
+        header[3 + i] = frame->rx_ns >> (8 * i);
+      }
+
+      return fwrite(header, 1, sizeof(header), file) == sizeof(header)
+          && fwrite(frame->data, 1, frame->size, file) == frame->size;
+    }
+
+    case RA02_PIPE_FORMAT_HEX:
+    case RA02_PIPE_FORMAT_JSON: {
+      static const char digits[] = "0123456789abcdef";
+      char hex[2 * RA02_MAX_PACKET_SIZE + 1];
+
+      for (size_t i = 0; i < frame->size; ++i) {
+        hex[2 * i]     = digits[frame->data[i] >> 4];
+        hex[2 * i + 1] = digits[frame->data[i] & 0x0F];
+      }
+
+      hex[2 * frame->size] = '\0';
+
+      if (format == RA02_PIPE_FORMAT_HEX) {
+        return fprintf(file, "%llu %d %d %s\n", (unsigned long long) (frame->rx_ns / 1000),
+                       frame->rssi, frame->snr, hex) > 0;
+      }
+
+      return fprintf(file, "{\"time_us\":%llu,\"rssi\":%d,\"snr\":%d,\"size\":%u,\"data\":\"%s\"}\n",
+                     (unsigned long long) (frame->rx_ns / 1000), frame->rssi, frame->snr, frame->size, hex) > 0;
+    }
+
+    default:
+      return false;
+  }
+}
+
+/**
+ * Writer thread: formats queued frames, flushes output when queue runs empty
+ */
+static void * ra02_pipe_writer(void * arg) {
+  ra02_pipe_queue_t * queue = arg;
+  FILE * file = queue->cfg->file;
+
+  pthread_mutex_lock(&queue->lock);
+
+  while (!queue->failed) {
+    if (!queue->count) {
+      if (queue->done) {
+        break;
+      }
+
+      /* Consumer sees frames right away, when radio is idle, and in large writes under load */
+      pthread_mutex_unlock(&queue->lock);
+      bool flushed = fflush(file) == 0;
+      pthread_mutex_lock(&queue->lock);
+
+      if (!flushed) {
+        queue->failed = true;
+        break;
+      }
+
+      if (!queue->count && !queue->done) {
+        pthread_cond_wait(&queue->cond, &queue->lock);
+      }
+
+      continue;
+    }
+
+    ra02_daemon_packet_t frame = queue->frames[queue->head];
+    queue->head = (queue->head + 1) % RA02_PIPE_QUEUE_SIZE;
+    queue->count--;
+
+    pthread_mutex_unlock(&queue->lock);
+    bool written = ra02_pipe_write_frame(file, queue->cfg->format, &frame);
+    pthread_mutex_lock(&queue->lock);
+
+    if (written) {
+      queue->stats.frames++;
+      queue->stats.bytes += frame.size;
+    } else {
+      queue->failed = true;
+    }
+  }
+
+  pthread_mutex_unlock(&queue->lock);
+
+  if (!queue->failed && fflush(file)) {
+    queue->failed = true;
+  }
+
+  return NULL;
+}
+
+/**
+ * Receive single frame from radio or daemon
+ */
+static error_t ra02_pipe_recv(const ra02_pipe_cfg_t * cfg, ra02_daemon_packet_t * frame) {
+  if (cfg->client_fd >= 0) {
+    return ra02_client_next(cfg->client_fd, frame, RA02_PIPE_RX_SLICE_MS);
+  }
+
+  TIMEOUT_CREATE(t, RA02_PIPE_RX_SLICE_MS);
+
+  size_t size = sizeof(frame->data);
+  ERROR_CHECK_RETURN(ra02_recv(cfg->ra02, frame->data, &size, &t));
+
+  frame->rx_ns = cfg->ra02->last_rx_ns;
+  frame->rssi  = cfg->ra02->last_rssi;
+  frame->snr   = cfg->ra02->last_snr;
+  frame->size  = size;
+
+  return E_OK;
+}
+
+/* Shared functions ========================================================= */
+error_t ra02_pipe_parse_format(const char * name, ra02_pipe_format_t * format) {
+  ASSERT_RETURN(name && format, E_NULL);
+
+  static const char * names[] = {
+    [RA02_PIPE_FORMAT_BINARY] = "binary",
+    [RA02_PIPE_FORMAT_HEX]    = "hex",
+    [RA02_PIPE_FORMAT_JSON]   = "json",
+  };
+
+  for (size_t i = 0; i < UTIL_ARR_SIZE(names); ++i) {
+    if (!strcmp(name, names[i])) {
+      *format = i;
+      return E_OK;
+    }
+  }
+
+  return E_NOTFOUND;
+}
+
+error_t ra02_pipe_tx(const ra02_pipe_cfg_t * cfg, volatile bool * running, ra02_pipe_stats_t * stats) {
+  ASSERT_RETURN(cfg && cfg->file && (cfg->ra02 || cfg->client_fd >= 0), E_NULL);
+  ASSERT_RETURN(cfg->format != RA02_PIPE_FORMAT_JSON, E_NOTIMPL);
+
+  ra02_pipe_stats_t result = {0};
+  uint8_t buf[RA02_MAX_PACKET_SIZE];
+  error_t err = E_OK;
+
+  while (RA02_PIPE_RUNNING(running)) {
+    size_t size = 0;
+
+    err = ra02_pipe_read_frame(cfg->file, cfg->format, buf, &size);
+
+    if (err == E_EMPTY) {
+      err = E_OK;
+      break;
+    }
+
+    if (err == E_OK) {
+      err = cfg->client_fd >= 0 ? ra02_client_send(cfg->client_fd, buf, size) : ra02_send(cfg->ra02, buf, size);
+    }
+
+    if (err != E_OK) {
+      log_warn("Frame %d: %s", result.frames + result.errors, error2str(err));
+      result.errors++;
+      err = E_OK;
+      continue;
+    }
+
+    result.frames++;
+    result.bytes += size;
+  }
+
+  if (stats) {
+    *stats = result;
+  }
+
+  return err;
+}
+
+error_t ra02_pipe_rx(const ra02_pipe_cfg_t * cfg, volatile bool * running, ra02_pipe_stats_t * stats) {
+  ASSERT_RETURN(cfg && cfg->file && (cfg->ra02 || cfg->client_fd >= 0), E_NULL);
+
+  ra02_pipe_queue_t queue = {.cfg = cfg};
+  pthread_t thread;
+  error_t err = E_OK;
+  uint32_t received = 0;
+  bool failed = false;
+
+  if (cfg->client_fd >= 0) {
+    ERROR_CHECK_RETURN(ra02_client_subscribe(cfg->client_fd));
+  }
+
+  pthread_mutex_init(&queue.lock, NULL);
+  pthread_cond_init(&queue.cond, NULL);
+
+  if (pthread_create(&thread, NULL, ra02_pipe_writer, &queue)) {
+    pthread_cond_destroy(&queue.cond);
+    pthread_mutex_destroy(&queue.lock);
+    return E_FAILED;
+  }
+
+  while (RA02_PIPE_RUNNING(running) && !failed && (!cfg->count || received < cfg->count)) {
+    ra02_daemon_packet_t frame;
+
+    err = ra02_pipe_recv(cfg, &frame);
+
+    if (err == E_TIMEOUT) {
+      err = E_OK;
+      continue;
+    }
+
+    pthread_mutex_lock(&queue.lock);
+
+    failed = queue.failed;
+
+    if (err == E_CORRUPT) {
+      err = E_OK;
+      queue.stats.errors++;
+      pthread_mutex_unlock(&queue.lock);
+      continue;
+    }
+
+    if (err != E_OK) {
+      pthread_mutex_unlock(&queue.lock);
+      break;
+    }
+
+    received++;
+
+    if (queue.count == RA02_PIPE_QUEUE_SIZE) {
+      queue.stats.dropped++;
+    } else {
+      queue.frames[(queue.head + queue.count++) % RA02_PIPE_QUEUE_SIZE] = frame;
+      pthread_cond_signal(&queue.cond);
+    }
+
+    pthread_mutex_unlock(&queue.lock);
+  }
+
+  pthread_mutex_lock(&queue.lock);
+  queue.done = true;
+  pthread_cond_signal(&queue.cond);
+  pthread_mutex_unlock(&queue.lock);
+
+  pthread_join(thread, NULL);
+  pthread_cond_destroy(&queue.cond);
+  pthread_mutex_destroy(&queue.lock);
+
+  if (stats) {
+    *stats = queue.stats;
+  }
+
+  if (err == E_OK && queue.failed) {
+    log_error("Output write failed");
+    err = E_FAILED;
+  }
+
+  return err;
+}
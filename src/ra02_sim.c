@@ -0,0 +1,738 @@
+/** ========================================================================= *
+ *
+ * @file ra02_sim.c
+ * @date 17-10-2026
+ * @author Maksym Tkachuk <max.r.tkachuk@gmail.com>
+ *
+ *  ========================================================================= */
+
+/* Includes ================================================================= */
+#include <ra02_sim.h>
+#include <ra02_emu.h>
+#include <ra02_regs.h>
+#include <timeout.h>
+#include <assertion.h>
+#include <util.h>
+#include <log.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <math.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <ucontext.h>
+
+/* Defines ================================================================== */
+#define LOG_TAG SIM
+
+/** Defaults */
+#define RA02_SIM_DEFAULT_SIDE_M       10000
+#define RA02_SIM_DEFAULT_INTERVAL_MS  60000
+#define RA02_SIM_DEFAULT_PAYLOAD_SIZE RA02_SIM_HEADER_SIZE
+#define RA02_SIM_DEFAULT_BANDWIDTH    125000
+#define RA02_SIM_DEFAULT_POWER        14
+#define RA02_SIM_DEFAULT_LOOKAHEAD_US 1000
+#define RA02_SIM_DEFAULT_POLL_US      1000
+#define RA02_SIM_DEFAULT_SPI_US       5
+
+/** Link budget: log-distance path loss (as in mesh simulation), noise floor */
+#define RA02_SIM_PL0_DB               40
+#define RA02_SIM_PL_EXP               2.7
+#define RA02_SIM_NOISE_DBM            -120
+
+/** SNR margin over demodulation floor, that per node SF selection keeps */
+#define RA02_SIM_SF_MARGIN_DB         5
+
+/** LBT: CAD attempts before uplink is given up, max backoff in frame airtimes */
+#define RA02_SIM_LBT_ATTEMPTS         8
+#define RA02_SIM_LBT_BACKOFF_MAX      4
+
+/** Gateway RX slice, end of simulation is checked between slices */
+#define RA02_SIM_RX_SLICE_MS          1000
+
+/** Latency histogram, 1 ms buckets, last one collects the rest */
+#define RA02_SIM_LATENCY_BUCKETS      10000
+
+/** Coroutine stack of a radio */
+#define RA02_SIM_STACK_SIZE           (64 * 1024)
+
+/** Virtual time of simulation start, so that no timestamp looks unset */
+#define RA02_SIM_EPOCH_NS             1000000000ULL
+
+/** SPI write access bit */
+#define RA02_SIM_SPI_WRITE            0x80
+
+/* Macros =================================================================== */
+/** Radio, that emulated SX1278 belongs to */
+#define RA02_SIM_NODE_OF(__emu) ((ra02_sim_node_t *) ((char *) (__emu) - offsetof(ra02_sim_node_t, emu)))
+
+/* Exposed macros =========================================================== */
+/* Enums ==================================================================== */
+/* Types ==================================================================== */
+typedef struct ra02_sim_s ra02_sim_t;
+typedef struct ra02_sim_worker_s ra02_sim_worker_t;
+
+/**
+ * Simulated radio: end node or one radio of a gateway
+ */
+typedef struct {
+  ra02_sim_t *        sim;
+  ra02_sim_worker_t * worker;
+  uint32_t            id;
+  bool                gateway;
+  uint8_t             sf;
+  double              x;
+  double              y;
+  unsigned int        seed;
+  ucontext_t          context;
+  void *              stack;
+  bool                done;
+  error_t             err;
+  uint64_t            now_ns;         /** Virtual clock */
+  timeout_clock_t     clock;
+  spi_t               spi;
+  ra02_emu_t          emu;
+  ra02_t              ra02;
+  uint64_t            transfers;
+
+  /* End node */
+  atomic_uint         delivered_seq;  /** Last delivered seq + 1, updated by gateways */
+  uint32_t            offered;
+  uint32_t            sent;
+  uint32_t            deferred;
+  uint32_t            dropped;
+  uint64_t            airtime_us;
+
+  /* Gateway radio */
+  uint32_t            delivered;
+  uint32_t            corrupt;
+  uint64_t            latency_sum_us;
+  uint32_t            latency_max_us;
+  uint32_t *          latency_ms;     /** Histogram */
+} ra02_sim_node_t;
+
+/**
+ * Worker thread, runs its partition of radios in order of their clocks
+ */
+struct ra02_sim_worker_s {
+  ra02_sim_t *        sim;
+  pthread_t           thread;
+  ucontext_t          context;
+  ra02_sim_node_t **  heap;           /** Runnable radios, min-heap by clock */
+  size_t              size;
+  atomic_uint_fast64_t min_ns;        /** Lower bound of clocks of own radios, UINT64_MAX - done */
+};
+
+/**
+ * Simulation
+ */
+struct ra02_sim_s {
+  ra02_sim_cfg_t      cfg;            /** Defaults applied */
+  ra02_emu_air_t      air;
+  ra02_sim_node_t *   nodes;          /** End nodes, then gateway radios */
+  size_t              count;
+  ra02_sim_worker_t * workers;
+  uint32_t            threads;
+  uint64_t            end_ns;
+  uint64_t            lookahead_ns;
+  uint64_t            poll_ns;
+  uint64_t            spi_ns;
+};
+
+/* Variables ================================================================ */
+/** Radio, that worker thread is about to start */
+static __thread ra02_sim_node_t * ra02_sim_current = NULL;
+
+static const char * ra02_sim_proto_names[] = {
+  [RA02_MAC_PROTO_ALOHA] = "aloha",
+  [RA02_MAC_PROTO_LBT]   = "lbt",
+};
+
+/* Private functions ======================================================== */
+static void ra02_sim_put_u32(uint8_t * buf, uint32_t value) {
+  for (size_t i = 0; i < 4; ++i) {
+    buf[i] = value >> (8 * i);
+  }
+}
+
+static uint32_t ra02_sim_get_u32(const uint8_t * buf) {
+  return buf[0] | (buf[1] << 8) | (buf[2] << 16) | ((uint32_t) buf[3] << 24);
+}
+
+/**
+ * Uniform random number in (0, 1)
+ */
+static double ra02_sim_random(unsigned int * seed) {
+  return (rand_r(seed) + 1.0) / ((double) RAND_MAX + 2.0);
+}
+
+static double ra02_sim_path_loss_at(double x1, double y1, double x2, double y2) {
+  return RA02_SIM_PL0_DB + 10 * RA02_SIM_PL_EXP * log10(UTIL_MAX(hypot(x1 - x2, y1 - y2), 1.0));
+}
+
+static float ra02_sim_path_loss(void * ctx, const ra02_emu_t * from, const ra02_emu_t * to) {
+  ra02_sim_node_t * a = RA02_SIM_NODE_OF(from);
+  ra02_sim_node_t * b = RA02_SIM_NODE_OF(to);
+
+  UTIL_UNUSED(ctx);
+
+  return ra02_sim_path_loss_at(a->x, a->y, b->x, b->y);
+}
+
+/**
+ * Lowest SF, that closes link to nearest gateway with margin
+ */
+static uint8_t ra02_sim_pick_sf(ra02_sim_t * sim, ra02_sim_node_t * node) {
+  double loss = INFINITY;
+
+  for (size_t i = sim->cfg.nodes; i < sim->count; ++i) {
+    loss = UTIL_MIN(loss, ra02_sim_path_loss_at(node->x, node->y, sim->nodes[i].x, sim->nodes[i].y));
+  }
+
+  double snr = sim->cfg.power - loss - RA02_SIM_NOISE_DBM;
+
+  for (uint8_t sf = RA02_SCAN_SF_MIN; sf < RA02_SCAN_SF_MAX; ++sf) {
+    /* Demodulation floor is -7.5 dB at SF7 and 2.5 dB lower per SF step */
+    if (snr >= -5.0 - 2.5 * (sf - 6) + RA02_SIM_SF_MARGIN_DB) {
+      return sf;
+    }
+  }
+
+  return RA02_SCAN_SF_MAX;
+}
+
+static uint64_t ra02_sim_min_ns(ra02_sim_t * sim) {
+  uint64_t min = UINT64_MAX;
+
+  for (uint32_t i = 0; i < sim->threads; ++i) {
+    min = UTIL_MIN(min, atomic_load(&sim->workers[i].min_ns));
+  }
+
+  return min;
+}
+
+/**
+ * Whether radio can run at given time: every radio of every worker is
+ * less than lookahead behind, so every frame it can observe is on air
+ */
+static bool ra02_sim_is_safe(ra02_sim_t * sim, uint64_t ns) {
+  uint64_t min = ra02_sim_min_ns(sim);
+
+  return min == UINT64_MAX || ns < min + sim->lookahead_ns;
+}
+
+static bool ra02_sim_heap_less(ra02_sim_worker_t * worker, size_t a, size_t b) {
+  return worker->heap[a]->now_ns < worker->heap[b]->now_ns;
+}
+
+static void ra02_sim_heap_swap(ra02_sim_worker_t * worker, size_t a, size_t b) {
+  ra02_sim_node_t * node = worker->heap[a];
+  worker->heap[a] = worker->heap[b];
+  worker->heap[b] = node;
+}
+
+static void ra02_sim_heap_push(ra02_sim_worker_t * worker, ra02_sim_node_t * node) {
+  size_t i = worker->size++;
+
+  worker->heap[i] = node;
+
+  while (i && ra02_sim_heap_less(worker, i, (i - 1) / 2)) {
+    ra02_sim_heap_swap(worker, i, (i - 1) / 2);
+    i = (i - 1) / 2;
+  }
+}
+
+static ra02_sim_node_t * ra02_sim_heap_pop(ra02_sim_worker_t * worker) {
+  ra02_sim_node_t * node = worker->heap[0];
+  size_t i = 0;
+
+  worker->heap[0] = worker->heap[--worker->size];
+
+  while (1) {
+    size_t min = i;
+
+    for (size_t child = 2 * i + 1; child <= 2 * i + 2 && child < worker->size; ++child) {
+      min = ra02_sim_heap_less(worker, child, min) ? child : min;
+    }
+
+    if (min == i) {
+      break;
+    }
+
+    ra02_sim_heap_swap(worker, i, min);
+    i = min;
+  }
+
+  return node;
+}
+
+/**
+ * Advance virtual clock of running radio, yields to worker when radio gets
+ * too far ahead of others
+ */
+static void ra02_sim_advance(ra02_sim_node_t * node, uint64_t ns) {
+  node->now_ns = UTIL_MAX(node->now_ns, ns);
+
+  if (!ra02_sim_is_safe(node->sim, node->now_ns)) {
+    swapcontext(&node->context, &node->worker->context);
+  }
+}
+
+static uint64_t ra02_sim_clock_now_ns(void * ctx) {
+  ra02_sim_node_t * node = ctx;
+  return node->now_ns;
+}
+
+static void ra02_sim_clock_sleep_until_ns(void * ctx, uint64_t ns) {
+  ra02_sim_advance(ctx, ns);
+}
+
+/**
+ * SPI transfer to emulated radio, costs virtual time. Idle IRQ poll skips
+ * to the next known event of emulated radio, or poll interval ahead
+ */
+static error_t ra02_sim_transfer(void * ctx, uint8_t * tx_buf, uint8_t * rx_buf, size_t size) {
+  ra02_sim_node_t * node = ctx;
+  ra02_sim_t * sim = node->sim;
+
+  node->transfers++;
+  ra02_sim_advance(node, node->now_ns + sim->spi_ns);
+
+  ERROR_CHECK_RETURN(ra02_emu_transfer(&node->emu, tx_buf, rx_buf, size));
+
+  /* Driver clears IRQ flags it has just read, so writing 0 means nothing has happened */
+  if (size == 2 && tx_buf[0] == (RA02_LORA_REG_IRQ_FLAGS | RA02_SIM_SPI_WRITE) && !tx_buf[1]) {
+    ra02_sim_advance(node, UTIL_MIN(ra02_emu_next_event_ns(&node->emu), node->now_ns + sim->poll_ns));
+  }
+
+  return E_OK;
+}
+
+static error_t ra02_sim_radio_init(ra02_sim_node_t * node) {
+  ERROR_CHECK_RETURN(ra02_init(&node->ra02, &(ra02_cfg_t) {.spi = &node->spi}));
+  ERROR_CHECK_RETURN(ra02_set_sf(&node->ra02, node->sf));
+  ERROR_CHECK_RETURN(ra02_set_bandwidth(&node->ra02, node->sim->cfg.bandwidth));
+
+  return E_OK;
+}
+
+/**
+ * LBT: CAD until channel is free, random backoff while it's busy
+ *
+ * @retval E_BUSY Channel stayed busy
+ */
+static error_t ra02_sim_lbt(ra02_sim_node_t * node, uint32_t airtime_us) {
+  for (uint32_t i = 0; i < RA02_SIM_LBT_ATTEMPTS; ++i) {
+    bool detected = false;
+
+    ERROR_CHECK_RETURN(ra02_cad(&node->ra02, &detected));
+
+    if (!detected) {
+      return E_OK;
+    }
+
+    node->deferred++;
+    timeout_sleep_until_ns(timeout_now_ns()
+                           + ra02_sim_random(&node->seed) * RA02_SIM_LBT_BACKOFF_MAX * airtime_us * 1000.0);
+  }
+
+  return E_BUSY;
+}
+
+/**
+ * End node: Poisson uplinks until the end of simulation
+ */
+static error_t ra02_sim_end_node(ra02_sim_node_t * node) {
+  ra02_sim_t * sim = node->sim;
+  uint8_t frame[RA02_MAX_PACKET_SIZE] = {0};
+  uint64_t interval_ns = sim->cfg.interval_ms * 1000000ULL;
+  uint32_t airtime_us = 0;
+
+  ERROR_CHECK_RETURN(ra02_sim_radio_init(node));
+  ERROR_CHECK_RETURN(ra02_get_time_on_air(&node->ra02, sim->cfg.payload_size, &airtime_us));
+
+  uint64_t next = timeout_now_ns() - log(ra02_sim_random(&node->seed)) * interval_ns;
+
+  for (uint32_t seq = 0; next < sim->end_ns; ++seq) {
+    timeout_sleep_until_ns(next);
+
+    uint64_t created = timeout_now_ns();
+    node->offered++;
+
+    if (sim->cfg.proto == RA02_MAC_PROTO_LBT) {
+      error_t err = ra02_sim_lbt(node, airtime_us);
+
+      if (err == E_BUSY) {
+        node->dropped++;
+      } else {
+        ERROR_CHECK_RETURN(err);
+      }
+    }
+
+    if (node->offered > node->dropped + node->sent) {
+      ra02_sim_put_u32(&frame[0], node->id);
+      ra02_sim_put_u32(&frame[4], seq);
+      ra02_sim_put_u32(&frame[8], created);
+      ra02_sim_put_u32(&frame[12], created >> 32);
+
+      ERROR_CHECK_RETURN(ra02_send(&node->ra02, frame, sim->cfg.payload_size));
+
+      node->sent++;
+      node->airtime_us += airtime_us;
+    }
+
+    /* Uplinks, that would be generated while busy, are delayed */
+    next = UTIL_MAX(next - log(ra02_sim_random(&node->seed)) * interval_ns, timeout_now_ns());
+  }
+
+  return ra02_sleep(&node->ra02);
+}
+
+/**
+ * Gateway: count uplink, unless other gateway radio already did
+ */
+static void ra02_sim_gateway_rx(ra02_sim_node_t * node, const uint8_t * frame, size_t size) {
+  ra02_sim_t * sim = node->sim;
+
+  if (size < RA02_SIM_HEADER_SIZE || ra02_sim_get_u32(&frame[0]) >= sim->cfg.nodes) {
+    return;
+  }
+
+  ra02_sim_node_t * sender = &sim->nodes[ra02_sim_get_u32(&frame[0])];
+  uint32_t seq = ra02_sim_get_u32(&frame[4]);
+  uint64_t created = ra02_sim_get_u32(&frame[8]) | ((uint64_t) ra02_sim_get_u32(&frame[12]) << 32);
+  unsigned int delivered = atomic_load(&sender->delivered_seq);
+
+  /* Uplinks of a node never overlap, so only the last one can be received again */
+  do {
+    if (seq + 1 <= delivered) {
+      return;
+    }
+  } while (!atomic_compare_exchange_weak(&sender->delivered_seq, &delivered, seq + 1));
+
+  uint32_t latency_us = (node->ra02.last_rx_ns - created) / 1000;
+
+  node->delivered++;
+  node->latency_sum_us += latency_us;
+  node->latency_max_us = UTIL_MAX(node->latency_max_us, latency_us);
+  node->latency_ms[UTIL_MIN(latency_us / 1000, RA02_SIM_LATENCY_BUCKETS - 1)]++;
+}
+
+/**
+ * Gateway radio: receive on own SF until the end of simulation
+ */
+static error_t ra02_sim_gateway(ra02_sim_node_t * node) {
+  ERROR_CHECK_RETURN(ra02_sim_radio_init(node));
+
+  while (timeout_now_ns() < node->sim->end_ns) {
+    uint8_t frame[RA02_MAX_PACKET_SIZE];
+    size_t size = sizeof(frame);
+    TIMEOUT_CREATE(t, RA02_SIM_RX_SLICE_MS);
+
+    error_t err = ra02_recv(&node->ra02, frame, &size, &t);
+
+    if (err == E_CORRUPT) {
+      node->corrupt++;
+    } else if (err == E_OK) {
+      ra02_sim_gateway_rx(node, frame, size);
+    } else if (err != E_TIMEOUT) {
+      return err;
+    }
+  }
+
+  return ra02_sleep(&node->ra02);
+}
+
+static void ra02_sim_node_main(void) {
+  ra02_sim_node_t * node = ra02_sim_current;
+
+  node->err = node->gateway ? ra02_sim_gateway(node) : ra02_sim_end_node(node);
+
+  if (node->err != E_OK) {
+    log_error("%s %d: %s", node->gateway ? "gateway radio" : "node", node->id, error2str(node->err));
+  }
+
+  node->done = true;
+}
+
+static void * ra02_sim_worker(void * arg) {
+  ra02_sim_worker_t * worker = arg;
+
+  while (worker->size) {
+    ra02_sim_node_t * node = worker->heap[0];
+
+    atomic_store(&worker->min_ns, node->now_ns);
+
+    while (!ra02_sim_is_safe(worker->sim, node->now_ns)) {
+      sched_yield();
+    }
+
+    ra02_sim_heap_pop(worker);
+
+    ra02_sim_current = node;
+    timeout_set_thread_clock(&node->clock);
+    swapcontext(&worker->context, &node->context);
+    timeout_set_thread_clock(NULL);
+
+    if (!node->done) {
+      ra02_sim_heap_push(worker, node);
+    }
+  }
+
+  atomic_store(&worker->min_ns, UINT64_MAX);
+
+  return NULL;
+}
+
+static error_t ra02_sim_node_init(ra02_sim_t * sim, ra02_sim_node_t * node, ra02_sim_worker_t * worker) {
+  node->sim = sim;
+  node->worker = worker;
+  node->now_ns = RA02_SIM_EPOCH_NS;
+  node->clock = (timeout_clock_t) {
+    .now_ns = ra02_sim_clock_now_ns,
+    .sleep_until_ns = ra02_sim_clock_sleep_until_ns,
+    .ctx = node,
+  };
+
+  ERROR_CHECK_RETURN(ra02_emu_init(&node->emu, &sim->air, &node->spi));
+  node->emu.power = sim->cfg.power;
+  node->emu.noise = RA02_SIM_NOISE_DBM;
+  node->spi.transfer = ra02_sim_transfer;
+  node->spi.ctx = node;
+
+  node->stack = malloc(RA02_SIM_STACK_SIZE);
+  ASSERT_RETURN(node->stack, E_NOMEM);
+
+  if (node->gateway) {
+    node->latency_ms = calloc(RA02_SIM_LATENCY_BUCKETS, sizeof(uint32_t));
+    ASSERT_RETURN(node->latency_ms, E_NOMEM);
+  }
+
+  getcontext(&node->context);
+  node->context.uc_stack.ss_sp = node->stack;
+  node->context.uc_stack.ss_size = RA02_SIM_STACK_SIZE;
+  node->context.uc_link = &worker->context;
+  makecontext(&node->context, ra02_sim_node_main, 0);
+
+  ra02_sim_heap_push(worker, node);
+
+  return E_OK;
+}
+
+/**
+ * Place gateways on a grid, nodes randomly, pick SFs and distribute radios over workers
+ */
+static error_t ra02_sim_setup(ra02_sim_t * sim, uint32_t gateways) {
+  ra02_sim_cfg_t * cfg = &sim->cfg;
+  unsigned int seed = cfg->seed;
+  uint32_t columns = ceil(sqrt(gateways));
+  uint32_t rows = (gateways + columns - 1) / columns;
+  uint32_t sfs = cfg->sf ? 1 : RA02_SCAN_SF_COUNT;
+
+  sim->count = cfg->nodes + gateways * sfs;
+  sim->nodes = calloc(sim->count, sizeof(ra02_sim_node_t));
+  sim->workers = calloc(sim->threads, sizeof(ra02_sim_worker_t));
+  ASSERT_RETURN(sim->nodes && sim->workers, E_NOMEM);
+
+  for (uint32_t i = 0; i < sim->threads; ++i) {
+    sim->workers[i].sim = sim;
+    sim->workers[i].heap = calloc(sim->count / sim->threads + 1, sizeof(ra02_sim_node_t *));
+    ASSERT_RETURN(sim->workers[i].heap, E_NOMEM);
+    atomic_init(&sim->workers[i].min_ns, RA02_SIM_EPOCH_NS);
+  }
+
+  for (size_t i = cfg->nodes; i < sim->count; ++i) {
+    ra02_sim_node_t * node = &sim->nodes[i];
+    uint32_t gateway = (i - cfg->nodes) / sfs;
+
+    node->id = i - cfg->nodes;
+    node->gateway = true;
+    node->sf = cfg->sf ? cfg->sf : RA02_SCAN_SF_MIN + (i - cfg->nodes) % sfs;
+    node->x = (gateway % columns + 0.5) * cfg->side_m / columns;
+    node->y = (gateway / columns + 0.5) * cfg->side_m / rows;
+  }
+
+  for (size_t i = 0; i < cfg->nodes; ++i) {
+    ra02_sim_node_t * node = &sim->nodes[i];
+
+    node->id = i;
+    node->seed = cfg->seed + i;
+    node->x = ra02_sim_random(&seed) * cfg->side_m;
+    node->y = ra02_sim_random(&seed) * cfg->side_m;
+    node->sf = cfg->sf ? cfg->sf : ra02_sim_pick_sf(sim, node);
+  }
+
+  for (size_t i = 0; i < sim->count; ++i) {
+    ERROR_CHECK_RETURN(ra02_sim_node_init(sim, &sim->nodes[i], &sim->workers[i % sim->threads]));
+  }
+
+  return E_OK;
+}
+
+static void ra02_sim_cleanup(ra02_sim_t * sim) {
+  for (size_t i = 0; sim->nodes && i < sim->count; ++i) {
+    ra02_deinit(&sim->nodes[i].ra02);
+    ra02_emu_deinit(&sim->nodes[i].emu);
+    free(sim->nodes[i].stack);
+    free(sim->nodes[i].latency_ms);
+  }
+
+  for (uint32_t i = 0; sim->workers && i < sim->threads; ++i) {
+    free(sim->workers[i].heap);
+  }
+
+  free(sim->nodes);
+  free(sim->workers);
+  ra02_emu_air_deinit(&sim->air);
+}
+
+/**
+ * Latency percentile from merged histogram, upper bound of the bucket
+ */
+static uint32_t ra02_sim_percentile(const uint32_t * histogram, uint32_t count, uint32_t percent) {
+  uint32_t rank = UTIL_MAX(((uint64_t) count * percent + 99) / 100, 1);
+  uint32_t seen = 0;
+
+  for (uint32_t i = 0; i < RA02_SIM_LATENCY_BUCKETS; ++i) {
+    seen += histogram[i];
+
+    if (seen >= rank) {
+      return (i + 1) * 1000;
+    }
+  }
+
+  return RA02_SIM_LATENCY_BUCKETS * 1000;
+}
+
+static error_t ra02_sim_collect(ra02_sim_t * sim, ra02_sim_result_t * result) {
+  uint32_t * histogram = calloc(RA02_SIM_LATENCY_BUCKETS, sizeof(uint32_t));
+  uint64_t latency_sum_us = 0;
+  uint64_t airtime_us = 0;
+  uint32_t channels = 0;
+  error_t err = E_OK;
+
+  ASSERT_RETURN(histogram, E_NOMEM);
+
+  for (size_t i = 0; i < sim->count; ++i) {
+    ra02_sim_node_t * node = &sim->nodes[i];
+    uint8_t sf = node->sf - RA02_SCAN_SF_MIN;
+
+    err = err == E_OK ? node->err : err;
+    result->transfers += node->transfers;
+
+    if (node->gateway) {
+      result->delivered += node->delivered;
+      result->delivered_sf[sf] += node->delivered;
+      result->corrupt += node->corrupt;
+      result->latency_max_us = UTIL_MAX(result->latency_max_us, node->latency_max_us);
+      latency_sum_us += node->latency_sum_us;
+
+      for (size_t j = 0; j < RA02_SIM_LATENCY_BUCKETS; ++j) {
+        histogram[j] += node->latency_ms[j];
+      }
+    } else {
+      channels += !result->sent_sf[sf] && node->sent;
+      result->offered += node->offered;
+      result->sent += node->sent;
+      result->sent_sf[sf] += node->sent;
+      result->deferred += node->deferred;
+      result->dropped += node->dropped;
+      airtime_us += node->airtime_us;
+    }
+  }
+
+  double duration_s = sim->cfg.duration_ms / 1000.0;
+
+  result->delivery_ratio = result->offered ? (double) result->delivered / result->offered : 0;
+  result->utilization = channels ? airtime_us / (duration_s * 1e6 * channels) : 0;
+  result->goodput_bps = result->delivered * sim->cfg.payload_size * 8 / duration_s;
+
+  if (result->delivered) {
+    result->latency_avg_us = latency_sum_us / result->delivered;
+    result->latency_p50_us = ra02_sim_percentile(histogram, result->delivered, 50);
+    result->latency_p99_us = ra02_sim_percentile(histogram, result->delivered, 99);
+  }
+
+  free(histogram);
+
+  return err;
+}
+
+/* Shared functions ========================================================= */
+error_t ra02_sim_parse_proto(const char * name, ra02_mac_proto_t * proto) {
+  ASSERT_RETURN(name && proto, E_NULL);
+
+  for (size_t i = 0; i < UTIL_ARR_SIZE(ra02_sim_proto_names); ++i) {
+    if (!strcmp(name, ra02_sim_proto_names[i])) {
+      *proto = i;
+      return E_OK;
+    }
+  }
+
+  return E_NOTFOUND;
+}
+
+error_t ra02_sim_run(const ra02_sim_cfg_t * cfg, ra02_sim_result_t * result) {
+  ASSERT_RETURN(cfg && result, E_NULL);
+  ASSERT_RETURN(cfg->nodes && cfg->duration_ms, E_INVAL);
+  ASSERT_RETURN(cfg->proto == RA02_MAC_PROTO_ALOHA || cfg->proto == RA02_MAC_PROTO_LBT, E_NOTIMPL);
+  ASSERT_RETURN(!cfg->sf || (cfg->sf >= RA02_SCAN_SF_MIN && cfg->sf <= RA02_SCAN_SF_MAX), E_INVAL);
+  ASSERT_RETURN(!cfg->payload_size
+                || (cfg->payload_size >= RA02_SIM_HEADER_SIZE && cfg->payload_size <= RA02_MAX_PACKET_SIZE), E_INVAL);
+
+  ra02_sim_t sim = {.cfg = *cfg};
+  uint64_t start_ns = timeout_now_ns();
+
+  sim.cfg.side_m = cfg->side_m ? cfg->side_m : RA02_SIM_DEFAULT_SIDE_M;
+  sim.cfg.interval_ms = cfg->interval_ms ? cfg->interval_ms : RA02_SIM_DEFAULT_INTERVAL_MS;
+  sim.cfg.payload_size = cfg->payload_size ? cfg->payload_size : RA02_SIM_DEFAULT_PAYLOAD_SIZE;
+  sim.cfg.bandwidth = cfg->bandwidth ? cfg->bandwidth : RA02_SIM_DEFAULT_BANDWIDTH;
+  sim.cfg.power = cfg->power ? cfg->power : RA02_SIM_DEFAULT_POWER;
+  sim.threads = cfg->threads ? cfg->threads : UTIL_MAX(sysconf(_SC_NPROCESSORS_ONLN), 1);
+  sim.end_ns = RA02_SIM_EPOCH_NS + cfg->duration_ms * 1000000ULL;
+  sim.lookahead_ns = (cfg->lookahead_us ? cfg->lookahead_us : RA02_SIM_DEFAULT_LOOKAHEAD_US) * 1000ULL;
+  sim.poll_ns = (cfg->poll_us ? cfg->poll_us : RA02_SIM_DEFAULT_POLL_US) * 1000ULL;
+  sim.spi_ns = (cfg->spi_us ? cfg->spi_us : RA02_SIM_DEFAULT_SPI_US) * 1000ULL;
+
+  memset(result, 0, sizeof(*result));
+
+  ERROR_CHECK_RETURN(ra02_emu_air_init(&sim.air));
+  sim.air.latency_ns = sim.lookahead_ns;
+  sim.air.path_loss = ra02_sim_path_loss;
+  sim.air.ctx = &sim;
+
+  error_t err = ra02_sim_setup(&sim, cfg->gateways ? cfg->gateways : 1);
+  uint32_t started = 0;
+
+  for (; err == E_OK && started < sim.threads; ++started) {
+    if (pthread_create(&sim.workers[started].thread, NULL, ra02_sim_worker, &sim.workers[started])) {
+      log_error("Can't start worker %d", started);
+      err = E_FAILED;
+      break;
+    }
+  }
+
+  /* Workers, that didn't start, mustn't hold others back */
+  for (uint32_t i = started; sim.workers && i < sim.threads; ++i) {
+    atomic_store(&sim.workers[i].min_ns, UINT64_MAX);
+  }
+
+  for (uint32_t i = 0; i < started; ++i) {
+    pthread_join(sim.workers[i].thread, NULL);
+  }
+
+  if (err == E_OK) {
+    err = ra02_sim_collect(&sim, result);
+  }
+
+  result->wall_ms = (timeout_now_ns() - start_ns) / 1000000;
+  result->speedup = result->wall_ms ? (double) cfg->duration_ms / result->wall_ms : 0;
+
+  log_info("%d radios on %d threads: %d ms simulated in %d ms", (int) sim.count, sim.threads,
+           cfg->duration_ms, result->wall_ms);
+
+  ra02_sim_cleanup(&sim);
+
+  return err;
+}
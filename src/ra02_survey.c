@@ -0,0 +1,201 @@
+/** ========================================================================= *
+ *
+ * @file ra02_survey.c
+ * @date 17-10-2026
+ * @author Maksym Tkachuk <max.r.tkachuk@gmail.com>
+ *
+ *  ========================================================================= */
+
+/* Includes ================================================================= */
+#include <ra02_survey.h>
+#include <timeout.h>
+#include <assertion.h>
+#include <util.h>
+#include <log.h>
+#include <string.h>
+#include <unistd.h>
+
+/* Defines ================================================================== */
+#define LOG_TAG SURVEY
+
+/** Default delay between samples */
+#define RA02_SURVEY_DEFAULT_INTERVAL_US 100
+
+/** Default delay after retune, covers PLL lock & RSSI averaging */
+#define RA02_SURVEY_DEFAULT_SETTLE_US   500
+
+/** Default occupancy threshold */
+#define RA02_SURVEY_DEFAULT_THRESHOLD   -100
+
+/** Samples read at once, dwell time is checked between batches */
+#define RA02_SURVEY_BATCH               16
+
+/* Macros =================================================================== */
+#define RA02_SURVEY_OR_DEFAULT(value, def) ((value) ? (value) : (def))
+
+/* Exposed macros =========================================================== */
+/* Enums ==================================================================== */
+/* Types ==================================================================== */
+/* Variables ================================================================ */
+/* Private functions ======================================================== */
+/**
+ * Smallest RSSI, that at least given share of samples don't exceed
+ */
+static int8_t ra02_survey_percentile(const uint32_t * histogram, uint32_t samples, uint32_t percent) {
+  uint32_t rank = UTIL_MAX((samples * percent + 99) / 100, 1);
+  uint32_t seen = 0;
+
+  for (int i = 0; i < 256; ++i) {
+    seen += histogram[i];
+
+    if (seen >= rank) {
+      return i + INT8_MIN;
+    }
+  }
+
+  return INT8_MAX;
+}
+
+/**
+ * Tune to channel and collect its statistics
+ */
+static error_t ra02_survey_channel(const ra02_survey_cfg_t * cfg, uint32_t khz, ra02_survey_channel_t * channel) {
+  uint32_t histogram[256] = {0};
+  int8_t batch[RA02_SURVEY_BATCH];
+  int64_t sum = 0;
+  uint32_t busy = 0;
+  uint16_t interval_us = RA02_SURVEY_OR_DEFAULT(cfg->interval_us, RA02_SURVEY_DEFAULT_INTERVAL_US);
+  int8_t threshold = RA02_SURVEY_OR_DEFAULT(cfg->threshold, RA02_SURVEY_DEFAULT_THRESHOLD);
+
+  ERROR_CHECK_RETURN(ra02_listen(cfg->ra02, khz));
+  timeout_sleep_us(RA02_SURVEY_OR_DEFAULT(cfg->settle_us, RA02_SURVEY_DEFAULT_SETTLE_US));
+
+  memset(channel, 0, sizeof(*channel));
+  channel->freq_khz = khz;
+  channel->min = INT8_MAX;
+  channel->max = INT8_MIN;
+
+  uint64_t deadline = timeout_now_ns()
+                    + RA02_SURVEY_OR_DEFAULT(cfg->dwell_ms, RA02_SURVEY_DEFAULT_DWELL_MS) * 1000000ULL;
+
+  do {
+    ERROR_CHECK_RETURN(ra02_sample_rssi(cfg->ra02, batch, NULL, RA02_SURVEY_BATCH, interval_us));
+
+    for (size_t i = 0; i < RA02_SURVEY_BATCH; ++i) {
+      histogram[batch[i] - INT8_MIN]++;
+      sum += batch[i];
+      busy += batch[i] > threshold;
+      channel->min = UTIL_MIN(channel->min, batch[i]);
+      channel->max = UTIL_MAX(channel->max, batch[i]);
+    }
+
+    channel->samples += RA02_SURVEY_BATCH;
+  } while (timeout_now_ns() < deadline);
+
+  channel->avg = (float) sum / channel->samples;
+  channel->p50 = ra02_survey_percentile(histogram, channel->samples, 50);
+  channel->p90 = ra02_survey_percentile(histogram, channel->samples, 90);
+  channel->p99 = ra02_survey_percentile(histogram, channel->samples, 99);
+  channel->occupancy = (float) busy / channel->samples;
+
+  return E_OK;
+}
+
+/* Shared functions ========================================================= */
+error_t ra02_survey_parse_format(const char * name, ra02_survey_format_t * format) {
+  ASSERT_RETURN(name && format, E_NULL);
+
+  static const char * names[] = {
+    [RA02_SURVEY_FORMAT_CSV]  = "csv",
+    [RA02_SURVEY_FORMAT_JSON] = "json",
+  };
+
+  for (size_t i = 0; i < UTIL_ARR_SIZE(names); ++i) {
+    if (!strcmp(name, names[i])) {
+      *format = i;
+      return E_OK;
+    }
+  }
+
+  return E_NOTFOUND;
+}
+
+error_t ra02_survey_channel_count(const ra02_survey_cfg_t * cfg, size_t * count) {
+  ASSERT_RETURN(cfg && count, E_NULL);
+
+  uint32_t start = RA02_SURVEY_OR_DEFAULT(cfg->start_khz, RA02_SURVEY_DEFAULT_START_KHZ);
+  uint32_t stop = RA02_SURVEY_OR_DEFAULT(cfg->stop_khz, RA02_SURVEY_DEFAULT_STOP_KHZ);
+  uint32_t step = RA02_SURVEY_OR_DEFAULT(cfg->step_khz, RA02_SURVEY_DEFAULT_STEP_KHZ);
+
+  ASSERT_RETURN(start <= stop, E_INVAL);
+
+  *count = (stop - start) / step + 1;
+
+  return E_OK;
+}
+
+error_t ra02_survey_run(
+  const ra02_survey_cfg_t * cfg,
+  ra02_survey_channel_t * channels,
+  size_t * count,
+  volatile bool * running
+) {
+  ASSERT_RETURN(cfg && cfg->ra02 && channels && count, E_NULL);
+
+  size_t total = 0;
+  ERROR_CHECK_RETURN(ra02_survey_channel_count(cfg, &total));
+  ASSERT_RETURN(total <= *count, E_OVERFLOW);
+
+  uint32_t start = RA02_SURVEY_OR_DEFAULT(cfg->start_khz, RA02_SURVEY_DEFAULT_START_KHZ);
+  uint32_t step = RA02_SURVEY_OR_DEFAULT(cfg->step_khz, RA02_SURVEY_DEFAULT_STEP_KHZ);
+  uint64_t start_ns = timeout_now_ns();
+  error_t err = E_OK;
+  size_t i = 0;
+
+  for (; i < total && (!running || *running); ++i) {
+    err = ra02_survey_channel(cfg, start + i * step, &channels[i]);
+
+    if (err != E_OK) {
+      break;
+    }
+  }
+
+  *count = i;
+
+  log_info("Surveyed %d channels in %d ms", (int) i, (int) ((timeout_now_ns() - start_ns) / 1000000));
+
+  ERROR_CHECK_RETURN(ra02_sleep(cfg->ra02));
+
+  return err;
+}
+
+error_t ra02_survey_write(FILE * file, ra02_survey_format_t format, const ra02_survey_channel_t * channels, size_t count) {
+  ASSERT_RETURN(file && (channels || !count), E_NULL);
+
+  if (format == RA02_SURVEY_FORMAT_CSV) {
+    fprintf(file, "freq_khz,samples,min_dbm,avg_dbm,max_dbm,p50_dbm,p90_dbm,p99_dbm,occupancy\n");
+  } else {
+    fprintf(file, "[\n");
+  }
+
+  for (size_t i = 0; i < count; ++i) {
+    const ra02_survey_channel_t * ch = &channels[i];
+
+    if (format == RA02_SURVEY_FORMAT_CSV) {
+      fprintf(file, "%u,%u,%d,%.1f,%d,%d,%d,%d,%.4f\n",
+              ch->freq_khz, ch->samples, ch->min, ch->avg, ch->max, ch->p50, ch->p90, ch->p99, ch->occupancy);
+    } else {
+      fprintf(file, "  {\"freq_khz\":%u,\"samples\":%u,\"min\":%d,\"avg\":%.1f,\"max\":%d,"
+                    "\"p50\":%d,\"p90\":%d,\"p99\":%d,\"occupancy\":%.4f}%s\n",
+              ch->freq_khz, ch->samples, ch->min, ch->avg, ch->max, ch->p50, ch->p90, ch->p99, ch->occupancy,
+              i + 1 < count ? "," : "");
+    }
+  }
+
+  if (format == RA02_SURVEY_FORMAT_JSON) {
+    fprintf(file, "]\n");
+  }
+
+  /* Flushed here, as process exits without running stdio cleanup */
+  return fflush(file) || ferror(file) ? E_FAILED : E_OK;
+}
@@ -0,0 +1,367 @@
+/** ========================================================================= *
+ *
+ * @file ra02_timesync.c
+ * @date 17-10-2026
+ * @author Maksym Tkachuk <max.r.tkachuk@gmail.com>
+ *
+ *  ========================================================================= */
+
+/* Includes ================================================================= */
+#include <ra02_timesync.h>
+#include <ra02_emu.h>
+#include <assertion.h>
+#include <util.h>
+#include <log.h>
+#include <string.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+/* Defines ================================================================== */
+#define LOG_TAG TIMESYNC
+
+/** Default PI filter gains */
+#define RA02_TIMESYNC_DEFAULT_KP      0.7f
+#define RA02_TIMESYNC_DEFAULT_KI      0.3f
+
+/** Default error above which clock is stepped */
+#define RA02_TIMESYNC_DEFAULT_STEP_NS 1000000
+
+/** Max frequency correction (crystals are within +-100 ppm) */
+#define RA02_TIMESYNC_MAX_RATE        0.0005
+
+/** Missed beacon instant is replaced by a later one: attempts & lead of new instant */
+#define RA02_TIMESYNC_SEND_RETRIES    3
+#define RA02_TIMESYNC_RETRY_LEAD_NS   2000000
+
+/* Macros =================================================================== */
+/* Exposed macros =========================================================== */
+/* Enums ==================================================================== */
+/* Types ==================================================================== */
+/**
+ * Skewed clock of emulated follower
+ */
+typedef struct {
+  uint64_t base_ns;
+  int64_t  offset_ns;
+  int32_t  skew_ppb;
+} ra02_timesync_sim_clock_t;
+
+/**
+ * Emulated coordinator thread arguments
+ */
+typedef struct {
+  ra02_timesync_t * ts;
+  uint32_t period_ms;
+  uint32_t beacons;
+  uint64_t start_ns;
+} ra02_timesync_sim_coordinator_t;
+
+/* Variables ================================================================ */
+/* Private functions ======================================================== */
+static void ra02_timesync_put_u64(uint8_t * buf, uint64_t value) {
+  for (size_t i = 0; i < sizeof(value); ++i) {
+    buf[i] = value >> (8 * i);
+  }
+}
+
+static uint64_t ra02_timesync_get_u64(const uint8_t * buf) {
+  uint64_t value = 0;
+
+  for (size_t i = 0; i < sizeof(value); ++i) {
+    value |= (uint64_t) buf[i] << (8 * i);
+  }
+
+  return value;
+}
+
+static uint64_t ra02_timesync_sim_clock(void * ctx, uint64_t mono_ns) {
+  ra02_timesync_sim_clock_t * clock = ctx;
+  int64_t elapsed = mono_ns - clock->base_ns;
+
+  return mono_ns + clock->offset_ns + elapsed * (double) clock->skew_ppb / 1e9;
+}
+
+static void * ra02_timesync_sim_coordinator(void * arg) {
+  ra02_timesync_sim_coordinator_t * coordinator = arg;
+
+  for (uint32_t i = 0; i < coordinator->beacons; ++i) {
+    uint64_t at_ns = coordinator->start_ns + (uint64_t) (i + 1) * coordinator->period_ms * 1000000;
+    error_t err = ra02_timesync_send_beacon(coordinator->ts, at_ns);
+
+    if (err != E_OK) {
+      log_warn("coordinator: beacon %d: %s", i, error2str(err));
+    }
+  }
+
+  return NULL;
+}
+
+static error_t ra02_timesync_sim_node_init(ra02_emu_t * emu, spi_t * spi, gpio_t dio[2], ra02_t * ra02, uint8_t sf) {
+  ERROR_CHECK_RETURN(ra02_emu_dio_init(emu, 0, &dio[0]));
+  ERROR_CHECK_RETURN(ra02_emu_dio_init(emu, 1, &dio[1]));
+  ERROR_CHECK_RETURN(ra02_init(ra02, &(ra02_cfg_t){.spi = spi, .dio0 = &dio[0], .dio1 = &dio[1]}));
+
+  return ra02_set_sf(ra02, sf);
+}
+
+/* Shared functions ========================================================= */
+error_t ra02_timesync_init(ra02_timesync_t * ts, const ra02_timesync_cfg_t * cfg) {
+  ASSERT_RETURN(ts && cfg && cfg->ra02, E_NULL);
+
+  memset(ts, 0, sizeof(*ts));
+  memcpy(&ts->cfg, cfg, sizeof(*cfg));
+
+  ts->cfg.kp = cfg->kp ? cfg->kp : RA02_TIMESYNC_DEFAULT_KP;
+  ts->cfg.ki = cfg->ki ? cfg->ki : RA02_TIMESYNC_DEFAULT_KI;
+  ts->cfg.step_ns = cfg->step_ns ? cfg->step_ns : RA02_TIMESYNC_DEFAULT_STEP_NS;
+  ts->synced = cfg->coordinator;
+
+  return E_OK;
+}
+
+uint64_t ra02_timesync_local_ns(ra02_timesync_t * ts, uint64_t mono_ns) {
+  return ts->cfg.clock ? ts->cfg.clock(ts->cfg.clock_ctx, mono_ns) : mono_ns;
+}
+
+uint64_t ra02_timesync_net_at(ra02_timesync_t * ts, uint64_t local_ns) {
+  if (ts->cfg.coordinator || !ts->synced) {
+    return local_ns;
+  }
+
+  int64_t elapsed = local_ns - ts->ref_local_ns;
+
+  return ts->ref_net_ns + elapsed + (int64_t) (elapsed * ts->rate);
+}
+
+uint64_t ra02_net_time_ns(ra02_timesync_t * ts) {
+  return ra02_timesync_net_at(ts, ra02_timesync_local_ns(ts, timeout_now_ns()));
+}
+
+error_t ra02_timesync_encode(ra02_timesync_t * ts, uint64_t at_ns, uint8_t * buf) {
+  ASSERT_RETURN(ts && buf, E_NULL);
+  ASSERT_RETURN(ts->cfg.coordinator, E_INVAL);
+
+  buf[0] = RA02_TIMESYNC_BEACON_MAGIC;
+  buf[1] = ts->seq++;
+  ra02_timesync_put_u64(&buf[2], ra02_timesync_local_ns(ts, at_ns) + RA02_TIMESYNC_TX_DELAY_NS);
+
+  return E_OK;
+}
+
+error_t ra02_timesync_send_beacon(ra02_timesync_t * ts, uint64_t at_ns) {
+  ASSERT_RETURN(ts, E_NULL);
+
+  uint8_t beacon[RA02_TIMESYNC_BEACON_SIZE];
+  uint64_t last_tx_ns = ts->cfg.ra02->last_tx_ns;
+
+  ERROR_CHECK_RETURN(ra02_timesync_encode(ts, at_ns, beacon));
+
+  error_t err = ra02_send_at(ts->cfg.ra02, beacon, sizeof(beacon), at_ns, RA02_SEND_AT_MAX_LATE_NS);
+
+  /* Late beacon would carry wrong timestamp, so it's restamped for a later instant instead */
+  for (size_t i = 0; i < RA02_TIMESYNC_SEND_RETRIES
+                     && err == E_TIMEOUT && ts->cfg.ra02->last_tx_ns == last_tx_ns; ++i) {
+    log_debug("beacon %d: missed instant, retrying", beacon[1]);
+
+    at_ns = timeout_now_ns() + RA02_TIMESYNC_RETRY_LEAD_NS;
+    ra02_timesync_put_u64(&beacon[2], ra02_timesync_local_ns(ts, at_ns) + RA02_TIMESYNC_TX_DELAY_NS);
+
+    err = ra02_send_at(ts->cfg.ra02, beacon, sizeof(beacon), at_ns, RA02_SEND_AT_MAX_LATE_NS);
+  }
+
+  return err;
+}
+
+error_t ra02_timesync_process(ra02_timesync_t * ts, const uint8_t * buf, size_t size, uint64_t rx_ns) {
+  ASSERT_RETURN(ts && buf, E_NULL);
+  ASSERT_RETURN(!ts->cfg.coordinator, E_INVAL);
+  ASSERT_RETURN(size >= RA02_TIMESYNC_BEACON_SIZE && buf[0] == RA02_TIMESYNC_BEACON_MAGIC, E_INVAL);
+
+  uint32_t airtime_us;
+
+  ERROR_CHECK_RETURN(ra02_get_time_on_air(ts->cfg.ra02, size, &airtime_us));
+
+  /* RX_DONE happens at the end of the frame, that was started at beacon timestamp */
+  uint64_t net_ns = ra02_timesync_get_u64(&buf[2]) + airtime_us * 1000ULL + RA02_TIMESYNC_RX_DELAY_NS;
+  uint64_t local_ns = ra02_timesync_local_ns(ts, rx_ns);
+
+  ts->seq = buf[1];
+  ts->beacons++;
+
+  if (!ts->synced) {
+    ts->ref_local_ns = local_ns;
+    ts->ref_net_ns = net_ns;
+    ts->rate = 0;
+    ts->last_error_ns = 0;
+    ts->synced = true;
+
+    log_debug("first beacon, offset %lld ns", (long long) (net_ns - local_ns));
+    return E_OK;
+  }
+
+  uint64_t predicted_ns = ra02_timesync_net_at(ts, local_ns);
+  int64_t error_ns = net_ns - predicted_ns;
+  int64_t elapsed_ns = local_ns - ts->ref_local_ns;
+
+  ts->last_error_ns = error_ns;
+
+  if (llabs(error_ns) > ts->cfg.step_ns || elapsed_ns <= 0) {
+    log_debug("beacon %d: error %lld ns, stepping", ts->seq, (long long) error_ns);
+    ts->ref_local_ns = local_ns;
+    ts->ref_net_ns = net_ns;
+    return E_OK;
+  }
+
+  /* PI filter: proportional part corrects phase, integral part - frequency */
+  ts->rate += ts->cfg.ki * (double) error_ns / elapsed_ns;
+  ts->rate = UTIL_CAP(ts->rate, -RA02_TIMESYNC_MAX_RATE, RA02_TIMESYNC_MAX_RATE);
+  ts->ref_net_ns = predicted_ns + (int64_t) (ts->cfg.kp * error_ns);
+  ts->ref_local_ns = local_ns;
+
+  log_debug("beacon %d: error %lld ns, rate %.1f ppb", ts->seq, (long long) error_ns, ts->rate * 1e9);
+
+  return E_OK;
+}
+
+error_t ra02_timesync_recv_beacon(ra02_timesync_t * ts, timeout_t * timeout) {
+  ASSERT_RETURN(ts && timeout, E_NULL);
+
+  uint8_t buf[RA02_MAX_PACKET_SIZE];
+  size_t size = sizeof(buf);
+
+  ERROR_CHECK_RETURN(ra02_recv(ts->cfg.ra02, buf, &size, timeout));
+
+  return ra02_timesync_process(ts, buf, size, ts->cfg.ra02->last_rx_ns);
+}
+
+error_t ra02_timesync_simulate(const ra02_timesync_sim_cfg_t * cfg, ra02_timesync_sim_result_t * result) {
+  ASSERT_RETURN(cfg && result, E_NULL);
+  ASSERT_RETURN(cfg->period_ms && cfg->beacons > cfg->settle, E_INVAL);
+
+  ra02_emu_air_t air;
+  ra02_emu_t emu[2];
+  spi_t spi[2];
+  gpio_t dio[2][2];
+  ra02_t ra02[2] = {0};
+  ra02_timesync_t ts[2];
+  error_t err = E_OK;
+
+  /* Number of nodes, that need cleanup */
+  size_t nodes = 0;
+
+  memset(result, 0, sizeof(*result));
+
+  ERROR_CHECK_RETURN(ra02_emu_air_init(&air));
+
+  for (size_t i = 0; i < 2; ++i) {
+    err = ra02_emu_init(&emu[i], &air, &spi[i]);
+
+    if (err != E_OK) {
+      goto cleanup;
+    }
+
+    dio[i][0].fd = -1;
+    dio[i][1].fd = -1;
+    nodes++;
+
+    err = ra02_timesync_sim_node_init(&emu[i], &spi[i], dio[i], &ra02[i], cfg->sf ? cfg->sf : RA02_SCAN_SF_MIN);
+
+    if (err != E_OK) {
+      goto cleanup;
+    }
+  }
+
+  ra02_timesync_sim_clock_t clock = {
+    .base_ns = timeout_now_ns(),
+    .offset_ns = cfg->offset_ns,
+    .skew_ppb = cfg->skew_ppb,
+  };
+
+  err = ra02_timesync_init(&ts[0], &(ra02_timesync_cfg_t){
+    .ra02 = &ra02[0],
+    .coordinator = true,
+  });
+
+  if (err != E_OK) {
+    goto cleanup;
+  }
+
+  err = ra02_timesync_init(&ts[1], &(ra02_timesync_cfg_t){
+    .ra02 = &ra02[1],
+    .clock = ra02_timesync_sim_clock,
+    .clock_ctx = &clock,
+    .kp = cfg->kp,
+    .ki = cfg->ki,
+  });
+
+  if (err != E_OK) {
+    goto cleanup;
+  }
+
+  ra02_timesync_sim_coordinator_t coordinator = {
+    .ts = &ts[0],
+    .period_ms = cfg->period_ms,
+    .beacons = cfg->beacons,
+    .start_ns = timeout_now_ns(),
+  };
+
+  pthread_t thread;
+
+  if (pthread_create(&thread, NULL, ra02_timesync_sim_coordinator, &coordinator)) {
+    err = E_FAILED;
+    goto cleanup;
+  }
+
+  uint64_t total_abs_ns = 0;
+
+  for (uint32_t i = 0; i < cfg->beacons; ++i) {
+    uint8_t buf[RA02_MAX_PACKET_SIZE];
+    size_t size = sizeof(buf);
+
+    TIMEOUT_CREATE(t, cfg->period_ms * 2);
+
+    err = ra02_recv(&ra02[1], buf, &size, &t);
+
+    if (err != E_OK) {
+      log_warn("follower: beacon %d: %s", i, error2str(err));
+      continue;
+    }
+
+    /* Coordinator clock is CLOCK_MONOTONIC, so true network time at RX_DONE is known exactly */
+    uint64_t rx_ns = ra02[1].last_rx_ns;
+    int64_t error_ns = ra02_timesync_net_at(&ts[1], ra02_timesync_local_ns(&ts[1], rx_ns)) - rx_ns;
+
+    err = ra02_timesync_process(&ts[1], buf, size, rx_ns);
+
+    if (err != E_OK) {
+      continue;
+    }
+
+    if (++result->received > cfg->settle) {
+      uint64_t abs_ns = llabs(error_ns);
+
+      total_abs_ns += abs_ns;
+      result->max_abs_ns = UTIL_MAX(result->max_abs_ns, abs_ns);
+      result->measured++;
+    }
+  }
+
+  pthread_join(thread, NULL);
+
+  result->mean_abs_ns = result->measured ? total_abs_ns / result->measured : 0;
+  result->rate_ppb = ts[1].rate * 1e9;
+
+  err = result->measured ? E_OK : E_TIMEOUT;
+
+cleanup:
+  for (size_t i = 0; i < nodes; ++i) {
+    ra02_deinit(&ra02[i]);
+    gpio_deinit(&dio[i][0]);
+    gpio_deinit(&dio[i][1]);
+    ra02_emu_deinit(&emu[i]);
+  }
+
+  ra02_emu_air_deinit(&air);
+
+  return err;
+}
@@ -8,7 +8,9 @@
 
 /* Includes ================================================================= */
 #include <spi.h>
+#include <timeout.h>
 #include <assertion.h>
+#include <util.h>
 #include <string.h>
 #include <unistd.h>
 #include <fcntl.h>
@@ -39,6 +41,8 @@ error_t spi_init(spi_t * spi, spi_cfg_t * cfg, const char * dev) {
   ASSERT_RETURN(spi && cfg && dev, E_NULL);
 
   memcpy(&spi->cfg, cfg, sizeof(*cfg));
+  spi->transfer = NULL;
+  spi->ctx = NULL;
   spi->fd = open(dev, O_RDWR);
 
   return spi->fd < 0 ? E_FAILED : E_OK;
@@ -47,7 +51,9 @@ error_t spi_init(spi_t * spi, spi_cfg_t * cfg, const char * dev) {
 error_t spi_deinit(spi_t * spi) {
   ASSERT_RETURN(spi, E_NULL);
 
-  close(spi->fd);
+  if (spi->fd >= 0) {
+    close(spi->fd);
+  }
 
   return E_OK;
 }
@@ -60,6 +66,10 @@ error_t spi_transcieve(
 ) {
   ASSERT_RETURN(spi, E_NULL);
 
+  if (spi->transfer) {
+    return spi->transfer(spi->ctx, tx_buf, rx_buf, size);
+  }
+
   struct spi_ioc_transfer trx = {0};
 
   trx.tx_buf = (unsigned long long) tx_buf;
@@ -72,3 +82,51 @@ error_t spi_transcieve(
 
   return ioctl(spi->fd, SPI_IOC_MESSAGE(1), &trx) == size ? E_OK : E_FAILED;
 }
+
+error_t spi_transcieve_batch(spi_t * spi, spi_xfer_t * xfers, size_t count) {
+  ASSERT_RETURN(spi && (xfers || !count), E_NULL);
+
+  if (spi->transfer) {
+    for (size_t i = 0; i < count; ++i) {
+      ERROR_CHECK_RETURN(spi->transfer(spi->ctx, xfers[i].tx_buf, xfers[i].rx_buf, xfers[i].size));
+
+      if (xfers[i].delay_us) {
+        timeout_sleep_us(xfers[i].delay_us);
+      }
+    }
+
+    return E_OK;
+  }
+
+  struct spi_ioc_transfer trx[SPI_BATCH_MAX];
+
+  for (size_t done = 0; done < count;) {
+    size_t chunk = count - done < SPI_BATCH_MAX ? count - done : SPI_BATCH_MAX;
+    size_t total = 0;
+
+    memset(trx, 0, chunk * sizeof(trx[0]));
+
+    for (size_t i = 0; i < chunk; ++i) {
+      spi_xfer_t * xfer = &xfers[done + i];
+
+      trx[i].tx_buf = (unsigned long long) xfer->tx_buf;
+      trx[i].rx_buf = (unsigned long long) xfer->rx_buf;
+      trx[i].len = xfer->size;
+      trx[i].speed_hz = spi->cfg.speed;
+      trx[i].delay_usecs = spi->cfg.delay_us + xfer->delay_us;
+      trx[i].bits_per_word = spi->cfg.bits_per_word;
+      /* Release chip select between transfers, so each is a separate register access */
+      trx[i].cs_change = i + 1 < chunk;
+
+      total += xfer->size;
+    }
+
+    if (ioctl(spi->fd, SPI_IOC_MESSAGE(chunk), trx) != (int) total) {
+      return E_FAILED;
+    }
+
+    done += chunk;
+  }
+
+  return E_OK;
+}
@@ -9,20 +9,77 @@
 /* Includes ================================================================= */
 #include <timeout.h>
 #include <assertion.h>
+#include <util.h>
 #include <time.h>
+#include <errno.h>
 
 /* Defines ================================================================== */
+/** Last part of timeout_sleep_until_precise_ns, that is spent spinning instead of sleeping */
+#define TIMEOUT_SPIN_NS 200000
+
+/** Default virtual clock tick */
+#define TIMEOUT_VIRTUAL_TICK_NS 1000
+
 /* Macros =================================================================== */
 /* Enums ==================================================================== */
 /* Types ==================================================================== */
 /* Variables ================================================================ */
+static uint64_t timeout_monotonic_now_ns(void * ctx);
+static void timeout_monotonic_sleep_until_ns(void * ctx, uint64_t ns);
+
+static const timeout_clock_t timeout_monotonic_clock = {
+  .now_ns = timeout_monotonic_now_ns,
+  .sleep_until_ns = timeout_monotonic_sleep_until_ns,
+};
+
+/** Time source of the process */
+static const timeout_clock_t * timeout_process_clock = &timeout_monotonic_clock;
+
+/** Time source of current thread, NULL - process clock */
+static __thread const timeout_clock_t * timeout_thread_clock = NULL;
+
 /* Private functions ======================================================== */
-static uint64_t get_system_time_ms(void) {
+static uint64_t timeout_monotonic_now_ns(void * ctx) {
   struct timespec spec;
 
-  clock_gettime(CLOCK_REALTIME, &spec);
+  UTIL_UNUSED(ctx);
+
+  clock_gettime(CLOCK_MONOTONIC, &spec);
+
+  return spec.tv_sec * 1000000000ULL + spec.tv_nsec;
+}
+
+static void timeout_monotonic_sleep_until_ns(void * ctx, uint64_t ns) {
+  struct timespec spec = {
+    .tv_sec = ns / 1000000000ULL,
+    .tv_nsec = ns % 1000000000ULL,
+  };
+
+  UTIL_UNUSED(ctx);
+
+  while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &spec, NULL) == EINTR) {}
+}
+
+static uint64_t timeout_virtual_now_ns(void * ctx) {
+  timeout_virtual_clock_t * vclock = ctx;
+
+  vclock->now_ns += vclock->tick_ns;
+
+  return vclock->now_ns;
+}
+
+static void timeout_virtual_sleep_until_ns(void * ctx, uint64_t ns) {
+  timeout_virtual_clock_t * vclock = ctx;
+
+  vclock->now_ns = ns > vclock->now_ns ? ns : vclock->now_ns;
+}
+
+static inline const timeout_clock_t * timeout_clock(void) {
+  return timeout_thread_clock ? timeout_thread_clock : timeout_process_clock;
+}
 
-  return spec.tv_sec * 1000 + (spec.tv_nsec / 1.0e6);
+static uint64_t get_system_time_ms(void) {
+  return timeout_now_ns() / 1000000;
 }
 
 /* Shared functions ========================================================= */
@@ -49,4 +106,77 @@ void timeout_expire(timeout_t * timeout) {
   ASSERT_RETURN(timeout);
 
   timeout->duration = 0;
-}
\ No newline at end of file
+}
+
+uint64_t timeout_remaining_ms(const timeout_t * timeout) {
+  ASSERT_RETURN(timeout, 0);
+
+  uint64_t now = get_system_time_ms();
+
+  return now >= (timeout->start + timeout->duration) ? 0 : timeout->start + timeout->duration - now;
+}
+
+uint64_t timeout_now_us(void) {
+  return timeout_now_ns() / 1000;
+}
+
+uint64_t timeout_now_ns(void) {
+  const timeout_clock_t * clock = timeout_clock();
+
+  return clock->now_ns(clock->ctx);
+}
+
+void timeout_sleep_until_ns(uint64_t ns) {
+  const timeout_clock_t * clock = timeout_clock();
+
+  clock->sleep_until_ns(clock->ctx, ns);
+}
+
+void timeout_sleep_until_precise_ns(uint64_t ns) {
+  const timeout_clock_t * clock = timeout_clock();
+
+  /* Other time sources don't have wakeup latency to compensate */
+  if (clock != &timeout_monotonic_clock) {
+    clock->sleep_until_ns(clock->ctx, ns);
+    return;
+  }
+
+  if (ns > TIMEOUT_SPIN_NS) {
+    timeout_monotonic_sleep_until_ns(NULL, ns - TIMEOUT_SPIN_NS);
+  }
+
+  while (timeout_monotonic_now_ns(NULL) < ns) {}
+}
+
+void timeout_sleep_us(uint64_t us) {
+  const timeout_clock_t * clock = timeout_clock();
+
+  clock->sleep_until_ns(clock->ctx, clock->now_ns(clock->ctx) + us * 1000);
+}
+
+bool timeout_clock_is_monotonic(void) {
+  return timeout_clock() == &timeout_monotonic_clock;
+}
+
+void timeout_set_clock(const timeout_clock_t * clock) {
+  timeout_process_clock = clock ? clock : &timeout_monotonic_clock;
+}
+
+void timeout_set_thread_clock(const timeout_clock_t * clock) {
+  timeout_thread_clock = clock;
+}
+
+const timeout_clock_t * timeout_virtual_clock_init(timeout_virtual_clock_t * vclock, uint64_t start_ns,
+                                                   uint64_t tick_ns) {
+  ASSERT_RETURN(vclock, NULL);
+
+  vclock->now_ns = start_ns;
+  vclock->tick_ns = tick_ns ? tick_ns : TIMEOUT_VIRTUAL_TICK_NS;
+  vclock->clock = (timeout_clock_t) {
+    .now_ns = timeout_virtual_now_ns,
+    .sleep_until_ns = timeout_virtual_sleep_until_ns,
+    .ctx = vclock,
+  };
+
+  return &vclock->clock;
+}
@@ -19,6 +19,18 @@ set(FEATURE_TOGGLES
     LD_LOADER_PATH="/lib/ld-linux-aarch64.so.1"
     LOG_ENABLE_RA02=0
     LOG_ENABLE_MAIN=0
+    LOG_ENABLE_EMU=0
+    LOG_ENABLE_TIMESYNC=0
+    LOG_ENABLE_MAC=0
+    LOG_ENABLE_MESH=0
+    LOG_ENABLE_FWD=0
+    LOG_ENABLE_DAEMON=0
+    LOG_ENABLE_PIPE=0
+    LOG_ENABLE_SURVEY=0
+    LOG_ENABLE_BENCH=0
+    LOG_ENABLE_MICROBENCH=0
+    LOG_ENABLE_SIM=0
+    LOG_ENABLE_MGR=0
 )
 
 foreach (feature ${FEATURE_TOGGLES})